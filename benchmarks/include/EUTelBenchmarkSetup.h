@@ -0,0 +1,134 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBENCHMARKSETUP_H
+#define EUTELBENCHMARKSETUP_H 1
+
+// eutelescope includes ".h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelSyntheticEventGenerator.h"
+#include "EUTelTripletGBLUtility.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+// system includes <>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  namespace benchmarks {
+
+    //! The GEAR file of the benchmarks, set with --gear
+    extern std::string gearFile;
+
+    //! Returns the sensor IDs of the first planes along z
+    /*! The geometry is initialised from the GEAR file at the first
+     *  call.
+     *  @throw InvalidParameterException if the geometry has less than
+     *  noOfPlanes planes
+     */
+    std::vector<int> getSensorIDs(int noOfPlanes);
+
+    //! Synthetic events shared by the benchmarks
+    /*! The events are generated with the EUTelSyntheticEventGenerator
+     *  for the first noOfPlanes planes of the geometry, with a noise
+     *  occupancy of 1e-5. They are stored in the forms the hot paths
+     *  consume: the zero suppressed data, the decoded pixels, the
+     *  clusters and the global hits made from them as in
+     *  EUTelProcessorHitMaker.
+     */
+    class EventSample {
+
+    public:
+      //! Number of events of a sample
+      static const std::size_t NOOFEVENTS = 64;
+
+      //! Constructor
+      EventSample(int noOfPlanes, double tracksPerEvent);
+
+      std::size_t getNoOfEvents() const { return _zsData.size(); }
+
+      std::size_t getNoOfPlanes() const { return _planes.size(); }
+
+      const EUTelSyntheticEventGenerator::Plane &
+      getPlane(std::size_t plane) const {
+        return _planes.at(plane);
+      }
+
+      //! Returns the zero suppressed data of a plane
+      IMPL::TrackerDataImpl *getZSData(std::size_t event,
+                                       std::size_t plane) const {
+        return _zsData.at(event).at(plane).get();
+      }
+
+      //! Returns the pixels of a plane
+      const std::vector<EUTelGenericSparsePixel> &
+      getPixels(std::size_t event, std::size_t plane) const {
+        return _pixels.at(event).at(plane);
+      }
+
+      //! Returns the clusters of a plane
+      const std::vector<std::unique_ptr<IMPL::TrackerDataImpl>> &
+      getClusters(std::size_t event, std::size_t plane) const {
+        return _clusters.at(event).at(plane);
+      }
+
+      //! Returns the global hits of all planes
+      const std::vector<EUTelTripletGBLUtility::hit> &
+      getHits(std::size_t event) const {
+        return _hits.at(event);
+      }
+
+      //! Returns the mean number of fired pixels per plane and event
+      double getMeanNoOfPixels() const;
+
+    private:
+      std::vector<EUTelSyntheticEventGenerator::Plane> _planes;
+      std::vector<std::vector<std::unique_ptr<IMPL::TrackerDataImpl>>> _zsData;
+      std::vector<std::vector<std::vector<EUTelGenericSparsePixel>>> _pixels;
+      std::vector<
+          std::vector<std::vector<std::unique_ptr<IMPL::TrackerDataImpl>>>>
+          _clusters;
+      std::vector<std::vector<EUTelTripletGBLUtility::hit>> _hits;
+    };
+
+    //! Returns the sample of a plane count and occupancy
+    /*! The samples are made once and kept for all the benchmarks.
+     */
+    const EventSample &getEventSample(int noOfPlanes, int tracksPerEvent);
+
+    //! Makes the global hit of a cluster as EUTelProcessorHitMaker
+    /*! This is the centre of gravity in pixel indices, moved to the
+     *  local frame with the sensor centre as origin and transformed
+     *  with local2Master.
+     */
+    void makeHit(const EUTelSyntheticEventGenerator::Plane &plane,
+                 IMPL::TrackerDataImpl *cluster, double globalPos[3]);
+
+    //! Adds the plane count and occupancy arguments to a benchmark
+    /*! The plane counts are 6 and 10, the occupancies 1, 10 and 50
+     *  tracks per event.
+     */
+    void planesAndOccupancy(::benchmark::internal::Benchmark *bench);
+
+    //! Sets the common counters of a benchmark on a sample
+    void setSampleCounters(::benchmark::State &state,
+                           const EventSample &sample);
+
+  } // namespace benchmarks
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTelGeometricPixel.h"
+#include "EUTelUtility.h"
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+// system includes <>
+#include <functional>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace eutelescope::benchmarks;
+
+namespace {
+
+  //! The sparse clustering of EUTelProcessorSparseClustering
+  void BM_SparseClustering(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    // the processor clusters the reference wrappers of the decoded pixels
+    vector<vector<vector<reference_wrapper<EUTelBaseSparsePixel const>>>>
+        refs(sample.getNoOfEvents());
+    for (size_t iEvent = 0; iEvent < sample.getNoOfEvents(); ++iEvent) {
+      for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+        auto const &pixels = sample.getPixels(iEvent, iPlane);
+        refs[iEvent].emplace_back(pixels.begin(), pixels.end());
+      }
+    }
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (auto const &planeRefs : refs[iEvent]) {
+        auto clusters = Utility::findSparseClusters(planeRefs, 2);
+        benchmark::DoNotOptimize(clusters.data());
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_SparseClustering)->Apply(planesAndOccupancy);
+
+  //! The geometric clustering of EUTelProcessorGeometricClustering
+  /*! The pixel centres and half sizes are those of the rectangular
+   *  pixels of the GEAR planes, the navigation in the pixel geometry
+   *  which finds them in the processor is not included.
+   */
+  void BM_GeometricClustering(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    vector<vector<vector<EUTelGeometricPixel>>> geometricPixels(
+        sample.getNoOfEvents());
+    for (size_t iEvent = 0; iEvent < sample.getNoOfEvents(); ++iEvent) {
+      for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+        const EUTelSyntheticEventGenerator::Plane &plane =
+            sample.getPlane(iPlane);
+        const float xSize = plane.noOfPixelsX * plane.pitchX;
+        const float ySize = plane.noOfPixelsY * plane.pitchY;
+        geometricPixels[iEvent].emplace_back();
+        for (auto const &pixel : sample.getPixels(iEvent, iPlane)) {
+          geometricPixels[iEvent].back().emplace_back(
+              pixel, (pixel.getXCoord() + 0.5f) * plane.pitchX - xSize / 2.f,
+              (pixel.getYCoord() + 0.5f) * plane.pitchY - ySize / 2.f,
+              plane.pitchX / 2.f, plane.pitchY / 2.f);
+        }
+      }
+    }
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (auto const &pixels : geometricPixels[iEvent]) {
+        auto clusters = Utility::findGeometricClusters(pixels, 0.f);
+        benchmark::DoNotOptimize(clusters.data());
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_GeometricClustering)->Apply(planesAndOccupancy);
+
+} // namespace
@@ -0,0 +1,126 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTelEtaAccumulator.h"
+#include "EUTelEtaFunctionImpl.h"
+#include "EUTelGenericSparseClusterImpl.h"
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+// system includes <>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace eutelescope::benchmarks;
+
+namespace {
+
+  //! The CoG along x relative to the nearest pixel centre, per event
+  vector<vector<double>> getCoGs(const EventSample &sample) {
+    vector<vector<double>> cogs(sample.getNoOfEvents());
+    for (size_t iEvent = 0; iEvent < sample.getNoOfEvents(); ++iEvent) {
+      for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+        for (auto const &cluster : sample.getClusters(iEvent, iPlane)) {
+          float xCoG = 0.f;
+          float yCoG = 0.f;
+          EUTelGenericSparseClusterImpl<EUTelGenericSparsePixel>(
+              cluster.get())
+              .getCenterOfGravity(xCoG, yCoG);
+          cogs[iEvent].push_back(xCoG - std::round(xCoG));
+        }
+      }
+    }
+    return cogs;
+  }
+
+  //! The eta function of the sample, as EUTelCalculateEtaProcessor
+  /*! @param uniformTable Whether the function keeps the uniform table
+   *  or uses the binary search
+   */
+  std::unique_ptr<EUTelEtaFunctionImpl>
+  getEtaFunction(const vector<vector<double>> &cogs, bool uniformTable) {
+    EUTelEtaAccumulator accumulator(0, 1000, -0.5, 0.5);
+    for (auto const &eventCoGs : cogs) {
+      for (double cog : eventCoGs) {
+        accumulator.fill(cog);
+      }
+    }
+    std::unique_ptr<EUTelEtaFunctionImpl> table(accumulator.makeEtaFunction());
+    if (uniformTable) {
+      return table;
+    }
+    std::unique_ptr<EUTelEtaFunctionImpl> function =
+        std::make_unique<EUTelEtaFunctionImpl>(table->getNoOfBin());
+    function->setBinCenterVector(table->getBinCenterVector());
+    function->setEtaValueVector(table->getEtaValueVector());
+    return function;
+  }
+
+  //! Eta lookup with the binary search
+  void BM_EtaLookup(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const vector<vector<double>> cogs = getCoGs(sample);
+    std::unique_ptr<EUTelEtaFunctionImpl> function =
+        getEtaFunction(cogs, false);
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (double cog : cogs[iEvent]) {
+        benchmark::DoNotOptimize(function->getEtaFromCoG(cog));
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_EtaLookup)->Apply(planesAndOccupancy);
+
+  //! Eta lookup in the uniform table, one value at a time
+  void BM_EtaLookupTable(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const vector<vector<double>> cogs = getCoGs(sample);
+    std::unique_ptr<EUTelEtaFunctionImpl> function = getEtaFunction(cogs, true);
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (double cog : cogs[iEvent]) {
+        benchmark::DoNotOptimize(function->getEtaFromCoG(cog));
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_EtaLookupTable)->Apply(planesAndOccupancy);
+
+  //! Eta lookup in the uniform table, all values of an event at once
+  void BM_EtaLookupBatch(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    const vector<vector<double>> cogs = getCoGs(sample);
+    std::unique_ptr<EUTelEtaFunctionImpl> function = getEtaFunction(cogs, true);
+
+    vector<double> eta;
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      function->getEtaFromCoG(cogs[iEvent], eta);
+      benchmark::DoNotOptimize(eta.data());
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_EtaLookupBatch)->Apply(planesAndOccupancy);
+
+} // namespace
@@ -0,0 +1,86 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+// system includes <>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace eutelescope::benchmarks;
+
+namespace {
+
+  //! Transformation of the hits of an event from the local frames
+  void BM_Local2Master(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (auto const &hit : sample.getHits(iEvent)) {
+        const double localPos[3] = {hit.x, hit.y, 0.};
+        double globalPos[3];
+        geo::gGeometry().local2Master(static_cast<int>(hit.plane), localPos,
+                                      globalPos);
+        benchmark::DoNotOptimize(globalPos);
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_Local2Master)->Apply(planesAndOccupancy);
+
+  //! Transformation of the hits of an event into the local frames
+  void BM_Master2Local(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (auto const &hit : sample.getHits(iEvent)) {
+        const double globalPos[3] = {hit.x, hit.y, hit.z};
+        double localPos[3];
+        geo::gGeometry().master2Local(static_cast<int>(hit.plane), globalPos,
+                                      localPos);
+        benchmark::DoNotOptimize(localPos);
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_Master2Local)->Apply(planesAndOccupancy);
+
+  //! Making the global hits from the clusters, as EUTelProcessorHitMaker
+  void BM_HitMaking(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+        for (auto const &cluster : sample.getClusters(iEvent, iPlane)) {
+          double globalPos[3];
+          makeHit(sample.getPlane(iPlane), cluster.get(), globalPos);
+          benchmark::DoNotOptimize(globalPos);
+        }
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_HitMaking)->Apply(planesAndOccupancy);
+
+} // namespace
@@ -0,0 +1,212 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTELESCOPE.h"
+#include "EUTelExceptions.h"
+#include "EUTelGenericSparseClusterImpl.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelUtility.h"
+
+// gear includes <.h>
+#include <gear/GearMgr.h>
+#include <gearxml/GearXML.h>
+
+// lcio includes <.h>
+#include <IMPL/LCCollectionVec.h>
+#include <UTIL/CellIDEncoder.h>
+
+// system includes <>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <utility>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace eutelescope {
+  namespace benchmarks {
+
+    std::string gearFile;
+
+    std::vector<int> getSensorIDs(int noOfPlanes) {
+      static gear::GearMgr *gearMgr = nullptr;
+      if (gearMgr == nullptr) {
+        gear::GearXML gearXML(gearFile);
+        gearMgr = gearXML.createGearMgr();
+        geo::gGeometry(gearMgr).initializeTGeoDescription(
+            EUTELESCOPE::GEOFILENAME, false);
+      }
+
+      vector<int> sensorIDs = geo::gGeometry().sensorIDsVec();
+      if (noOfPlanes <= 0 ||
+          sensorIDs.size() < static_cast<size_t>(noOfPlanes)) {
+        stringstream ss;
+        ss << "The geometry of " << gearFile << " has " << sensorIDs.size()
+           << " planes, " << noOfPlanes << " requested";
+        throw InvalidParameterException(ss.str());
+      }
+
+      vector<pair<double, int>> zOrder;
+      for (int sensorID : sensorIDs) {
+        array<double, 3> const localOrigin{{0., 0., 0.}};
+        array<double, 3> origin;
+        geo::gGeometry().local2Master(sensorID, localOrigin, origin);
+        zOrder.emplace_back(origin[2], sensorID);
+      }
+      std::sort(zOrder.begin(), zOrder.end());
+
+      vector<int> firstIDs;
+      for (int iPlane = 0; iPlane < noOfPlanes; ++iPlane) {
+        firstIDs.push_back(zOrder[iPlane].second);
+      }
+      return firstIDs;
+    }
+
+    void makeHit(const EUTelSyntheticEventGenerator::Plane &plane,
+                 IMPL::TrackerDataImpl *cluster, double globalPos[3]) {
+      float xPos = 0;
+      float yPos = 0;
+      EUTelGenericSparseClusterImpl<EUTelGenericSparsePixel> sparseCluster(
+          cluster);
+      sparseCluster.getCenterOfGravity(xPos, yPos);
+
+      const double xSize = plane.noOfPixelsX * plane.pitchX;
+      const double ySize = plane.noOfPixelsY * plane.pitchY;
+      const double localPos[3] = {(xPos + 0.5) * plane.pitchX - xSize / 2.,
+                                  (yPos + 0.5) * plane.pitchY - ySize / 2.,
+                                  0.};
+      geo::gGeometry().local2Master(plane.sensorID, localPos, globalPos);
+    }
+
+    EventSample::EventSample(int noOfPlanes, double tracksPerEvent)
+        : _planes(), _zsData(), _pixels(), _clusters(), _hits() {
+
+      EUTelSyntheticEventGenerator::Settings settings;
+      settings.tracksPerEvent = tracksPerEvent;
+      settings.noiseOccupancy = 1e-5;
+      EUTelSyntheticEventGenerator generator(
+          EUTelSyntheticEventGenerator::getGeometryPlanes(
+              getSensorIDs(noOfPlanes)),
+          settings);
+      for (size_t iPlane = 0; iPlane < generator.getNoOfPlanes(); ++iPlane) {
+        _planes.push_back(generator.getPlane(iPlane));
+      }
+
+      // the cell IDs as written by the EUTelSyntheticDataSource
+      IMPL::LCCollectionVec zsCollection(EVENT::LCIO::TRACKERDATA);
+      UTIL::CellIDEncoder<IMPL::TrackerDataImpl> zsDataEncoder(
+          EUTELESCOPE::ZSDATADEFAULTENCODING, &zsCollection);
+
+      for (size_t iEvent = 0; iEvent < NOOFEVENTS; ++iEvent) {
+        generator.generate(iEvent);
+        _zsData.emplace_back();
+        _pixels.emplace_back();
+        _clusters.emplace_back();
+        _hits.emplace_back();
+
+        for (size_t iPlane = 0; iPlane < _planes.size(); ++iPlane) {
+          const EUTelSyntheticEventGenerator::Plane &plane = _planes[iPlane];
+
+          std::unique_ptr<IMPL::TrackerDataImpl> zsData =
+              std::make_unique<IMPL::TrackerDataImpl>();
+          zsDataEncoder["sensorID"] = plane.sensorID;
+          zsDataEncoder["sparsePixelType"] =
+              static_cast<int>(kEUTelGenericSparsePixel);
+          zsDataEncoder.setCellID(zsData.get());
+          EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> sparseData(
+              zsData.get());
+          vector<EUTelGenericSparsePixel> pixels;
+          for (const EUTelSyntheticEventGenerator::Pixel &pixel :
+               generator.getPixels(iPlane)) {
+            sparseData.emplace_back(pixel.x, pixel.y, pixel.signal);
+            pixels.emplace_back(pixel.x, pixel.y, pixel.signal);
+          }
+
+          vector<std::unique_ptr<IMPL::TrackerDataImpl>> clusters;
+          vector<std::reference_wrapper<EUTelBaseSparsePixel const>> refs(
+              pixels.begin(), pixels.end());
+          for (auto const &clusterPixels :
+               Utility::findSparseClusters(refs, 2)) {
+            std::unique_ptr<IMPL::TrackerDataImpl> cluster =
+                std::make_unique<IMPL::TrackerDataImpl>();
+            EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>
+                clusterData(cluster.get());
+            for (auto const &pixel : clusterPixels) {
+              clusterData.push_back(pixel.get());
+            }
+
+            double pos[3];
+            makeHit(plane, cluster.get(), pos);
+            EUTelTripletGBLUtility::hit hit(pos, plane.sensorID);
+            hit.ex = plane.pitchX / std::sqrt(12.);
+            hit.ey = plane.pitchY / std::sqrt(12.);
+            hit.ez = 0.;
+            hit.clustersize = static_cast<int>(clusterPixels.size());
+            hit.clustersizex = hit.clustersize;
+            hit.clustersizey = hit.clustersize;
+            hit.locx = 0.;
+            hit.locy = 0.;
+            hit.id = static_cast<int>(_hits.back().size());
+            _hits.back().push_back(hit);
+
+            clusters.push_back(std::move(cluster));
+          }
+
+          _zsData.back().push_back(std::move(zsData));
+          _pixels.back().push_back(std::move(pixels));
+          _clusters.back().push_back(std::move(clusters));
+        }
+      }
+    }
+
+    double EventSample::getMeanNoOfPixels() const {
+      size_t noOfPixels = 0;
+      for (auto const &event : _pixels) {
+        for (auto const &plane : event) {
+          noOfPixels += plane.size();
+        }
+      }
+      return static_cast<double>(noOfPixels) /
+             (getNoOfEvents() * getNoOfPlanes());
+    }
+
+    const EventSample &getEventSample(int noOfPlanes, int tracksPerEvent) {
+      static map<pair<int, int>, std::unique_ptr<EventSample>> samples;
+      std::unique_ptr<EventSample> &sample =
+          samples[make_pair(noOfPlanes, tracksPerEvent)];
+      if (!sample) {
+        sample = std::make_unique<EventSample>(noOfPlanes, tracksPerEvent);
+      }
+      return *sample;
+    }
+
+    void planesAndOccupancy(::benchmark::internal::Benchmark *bench) {
+      bench->ArgNames({"planes", "tracks"});
+      for (int noOfPlanes : {6, 10}) {
+        for (int tracksPerEvent : {1, 10, 50}) {
+          bench->Args({noOfPlanes, tracksPerEvent});
+        }
+      }
+    }
+
+    void setSampleCounters(::benchmark::State &state,
+                           const EventSample &sample) {
+      state.SetItemsProcessed(state.iterations());
+      state.counters["pixels"] = sample.getMeanNoOfPixels();
+    }
+
+  } // namespace benchmarks
+} // namespace eutelescope
@@ -0,0 +1,70 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTELESCOPE.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelUtility.h"
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+using namespace std;
+using namespace eutelescope;
+using namespace eutelescope::benchmarks;
+
+namespace {
+
+  //! Decoding of the zero suppressed data into pixels
+  void BM_SparseDataDecoding(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+        EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> sparseData(
+            sample.getZSData(iEvent, iPlane));
+        float charge = 0.f;
+        for (auto const &pixel : sparseData) {
+          charge += pixel.getSignal();
+        }
+        benchmark::DoNotOptimize(charge);
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_SparseDataDecoding)->Apply(planesAndOccupancy);
+
+  //! Decoding through the polymorphic interface, as the processors do
+  void BM_SparseDataPolymorphicDecoding(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+        auto sparseData = Utility::getSparseData(
+            sample.getZSData(iEvent, iPlane), kEUTelGenericSparsePixel);
+        auto const &pixels = sparseData->getPixels();
+        float charge = 0.f;
+        for (auto const &pixel : pixels) {
+          charge += pixel.get().getSignal();
+        }
+        benchmark::DoNotOptimize(charge);
+      }
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_SparseDataPolymorphicDecoding)->Apply(planesAndOccupancy);
+
+} // namespace
@@ -0,0 +1,249 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTelDafTrackerSystem.h"
+#include "EUTelStraightLineGBLFitter.h"
+
+#ifdef USE_GBL
+// GBL
+#include "include/GblTrajectory.h"
+#endif
+
+// Eigen
+#include <Eigen/Core>
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+// system includes <>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace eutelescope::benchmarks;
+
+namespace {
+
+  //! Beam energy of the fits in GeV
+  const double BEAMENERGY = 5.;
+
+  //! Radiation length of air in mm
+  const double AIRRADLENGTH = 304200.;
+
+  //! Variance of the Highland scattering angle
+  double getScatterVariance(double radLength) {
+    double theta = 0.0136 / BEAMENERGY * std::sqrt(radLength) *
+                   (1. + 0.038 * std::log(radLength));
+    return theta * theta;
+  }
+
+  //! Straight line tracks through the first NPLANES planes
+  /*! The topology has a scatterer at each plane and two air
+   *  scatterers in each gap, as in EUTelGBLFitter. The measurements
+   *  are simulated along the topology with the plane resolution.
+   */
+  template <int NPLANES> struct TrackSample {
+    static const int NPOINTS = 3 * NPLANES - 2;
+    typedef EUTelStraightLineGBLFitter<NPOINTS> Fitter;
+
+    struct Track {
+      typename Fitter::PointVector2dArray meas;
+      typename Fitter::PointVector2dArray prec;
+    };
+
+    std::array<double, NPOINTS - 1> steps;
+    typename Fitter::PointVector2dArray scat;
+    std::vector<Track> tracks;
+
+    explicit TrackSample(size_t noOfTracks) {
+      const EventSample &sample = getEventSample(NPLANES, 1);
+      for (int ipl = 0; ipl < NPLANES; ++ipl) {
+        const EUTelSyntheticEventGenerator::Plane &plane =
+            sample.getPlane(ipl);
+        scat[3 * ipl] = Eigen::Vector2d::Constant(
+            1. / getScatterVariance(plane.materialBudget));
+        if (ipl < NPLANES - 1) {
+          double distance =
+              sample.getPlane(ipl + 1).origin.z() - plane.origin.z();
+          steps[3 * ipl] = 0.21 * distance;
+          steps[3 * ipl + 1] = 0.58 * distance;
+          steps[3 * ipl + 2] = 0.21 * distance;
+          double air =
+              1. / getScatterVariance(0.5 * distance / AIRRADLENGTH);
+          scat[3 * ipl + 1] = Eigen::Vector2d::Constant(air);
+          scat[3 * ipl + 2] = Eigen::Vector2d::Constant(air);
+        }
+      }
+
+      std::mt19937 generator(42);
+      std::normal_distribution<double> gauss(0., 1.);
+      tracks.resize(noOfTracks);
+      for (Track &track : tracks) {
+        double slope[2] = {1e-4 * gauss(generator), 1e-4 * gauss(generator)};
+        double offset[2] = {0., 0.};
+        for (int i = 0; i < NPOINTS; ++i) {
+          track.meas[i] = Eigen::Vector2d::Zero();
+          track.prec[i] = Eigen::Vector2d::Zero();
+          if (i > 0) {
+            for (int proj = 0; proj < 2; ++proj) {
+              offset[proj] += slope[proj] * steps[i - 1];
+              slope[proj] += gauss(generator) / std::sqrt(scat[i][proj]);
+            }
+          }
+          if (i % 3 == 0) {
+            const EUTelSyntheticEventGenerator::Plane &plane =
+                sample.getPlane(i / 3);
+            double res[2] = {plane.pitchX / std::sqrt(12.),
+                             plane.pitchY / std::sqrt(12.)};
+            for (int proj = 0; proj < 2; ++proj) {
+              track.meas[i][proj] = offset[proj] + res[proj] * gauss(generator);
+              track.prec[i][proj] = 1. / (res[proj] * res[proj]);
+            }
+          }
+        }
+      }
+    }
+  };
+
+  //! The fixed topology GBL fit of EUTelGBLFitter
+  template <int NPLANES>
+  void BM_StraightLineGBLFit(benchmark::State &state) {
+    typedef TrackSample<NPLANES> Sample;
+    Sample sample(static_cast<size_t>(state.range(0)));
+    typename Sample::Fitter fitter(sample.steps, sample.scat);
+    typename Sample::Fitter::Result result;
+
+    for (auto _ : state) {
+      for (auto const &track : sample.tracks) {
+        fitter.fit(track.meas, track.prec, result);
+        benchmark::DoNotOptimize(result.getChi2());
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * sample.tracks.size());
+  }
+  BENCHMARK_TEMPLATE(BM_StraightLineGBLFit, 6)
+      ->ArgNames({"tracks"})
+      ->Arg(1)
+      ->Arg(10)
+      ->Arg(50);
+  BENCHMARK_TEMPLATE(BM_StraightLineGBLFit, 10)
+      ->ArgNames({"tracks"})
+      ->Arg(1)
+      ->Arg(10)
+      ->Arg(50);
+
+#ifdef USE_GBL
+  //! The generic GBL trajectory fit of the same tracks
+  template <int NPLANES> void BM_GBLTrajectoryFit(benchmark::State &state) {
+    typedef TrackSample<NPLANES> Sample;
+    Sample sample(static_cast<size_t>(state.range(0)));
+
+    const Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
+    const Eigen::Vector2d kink = Eigen::Vector2d::Zero();
+    for (auto _ : state) {
+      for (auto const &track : sample.tracks) {
+        std::vector<gbl::GblPoint> points;
+        for (int i = 0; i < Sample::NPOINTS; ++i) {
+          Eigen::Matrix<double, 5, 5> jac =
+              Eigen::Matrix<double, 5, 5>::Identity();
+          if (i > 0) {
+            jac(3, 1) = sample.steps[i - 1];
+            jac(4, 2) = sample.steps[i - 1];
+          }
+          points.emplace_back(jac);
+          if (track.prec[i][0] > 0.) {
+            points.back().addMeasurement(proL2m, track.meas[i], track.prec[i]);
+          }
+          points.back().addScatterer(kink, sample.scat[i]);
+        }
+        double chi2, lostWeight;
+        int ndf;
+        gbl::GblTrajectory traj(points, false);
+        traj.fit(chi2, ndf, lostWeight, "");
+        benchmark::DoNotOptimize(chi2);
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * sample.tracks.size());
+  }
+  BENCHMARK_TEMPLATE(BM_GBLTrajectoryFit, 6)
+      ->ArgNames({"tracks"})
+      ->Arg(1)
+      ->Arg(10)
+      ->Arg(50);
+  BENCHMARK_TEMPLATE(BM_GBLTrajectoryFit, 10)
+      ->ArgNames({"tracks"})
+      ->Arg(1)
+      ->Arg(10)
+      ->Arg(50);
+#endif
+
+  //! Track finding and DAF fitting of an event, as EUTelDafFitter
+  /*! The tracks are found with the simple cluster finder, the
+   *  coordinates are in um as in EUTelDafBase.
+   */
+  void BM_DafFit(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+
+    daffitter::TrackerSystem<float, 4> system;
+    std::vector<int> sensorIDs;
+    for (size_t iPlane = 0; iPlane < sample.getNoOfPlanes(); ++iPlane) {
+      const EUTelSyntheticEventGenerator::Plane &plane = sample.getPlane(iPlane);
+      system.addPlane(
+          plane.sensorID, static_cast<float>(plane.origin.z() * 1000.),
+          static_cast<float>(plane.pitchX / std::sqrt(12.) * 1000.),
+          static_cast<float>(plane.pitchY / std::sqrt(12.) * 1000.),
+          static_cast<float>(getScatterVariance(plane.materialBudget)), false);
+      sensorIDs.push_back(plane.sensorID);
+    }
+    system.setClusterRadius(300.f);
+    system.setNominalXdz(0.f);
+    system.setNominalYdz(0.f);
+    system.setXdzMaxDeviance(0.01f);
+    system.setYdzMaxDeviance(0.01f);
+    system.setChi2OverNdofCut(9999.f);
+    system.setDAFChi2Cut(300.f);
+    system.init(true);
+
+    double noOfTracks = 0.;
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      system.clear();
+      auto const &hits = sample.getHits(iEvent);
+      for (size_t iHit = 0; iHit < hits.size(); ++iHit) {
+        // the planes are ordered in z, as in the system
+        size_t planeIndex = 0;
+        while (sensorIDs[planeIndex] != static_cast<int>(hits[iHit].plane)) {
+          ++planeIndex;
+        }
+        system.addMeasurement(planeIndex,
+                              static_cast<float>(hits[iHit].x * 1000.),
+                              static_cast<float>(hits[iHit].y * 1000.),
+                              static_cast<float>(hits[iHit].z * 1000.), true,
+                              iHit);
+      }
+      system.clusterTracker();
+      for (size_t iTrack = 0; iTrack < system.getNtracks(); ++iTrack) {
+        system.fitPlanesInfoDaf(system.tracks.at(iTrack));
+        benchmark::DoNotOptimize(system.tracks.at(iTrack).chi2);
+      }
+      noOfTracks += system.getNtracks();
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+    state.counters["found"] = noOfTracks / state.iterations();
+  }
+  BENCHMARK(BM_DafFit)->Apply(planesAndOccupancy);
+
+} // namespace
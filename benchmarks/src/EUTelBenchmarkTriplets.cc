@@ -0,0 +1,109 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBenchmarkSetup.h"
+#include "EUTelTripletGBLUtility.h"
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+// system includes <>
+#include <array>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace eutelescope::benchmarks;
+
+namespace {
+
+  //! Triplet cuts as in the EUTelAlignGBL examples, in mm and rad
+  const double TRIPLETRESCUT = 0.1;
+  const double TRIPLETSLOPECUT = 0.01;
+  const double MATCHINGCUT = 0.1;
+
+  //! The sensor IDs of the upstream and the downstream triplet
+  void getTripletIDs(const EventSample &sample, array<unsigned, 3> &up,
+                     array<unsigned, 3> &down) {
+    const size_t last = sample.getNoOfPlanes() - 1;
+    for (size_t i = 0; i < 3; ++i) {
+      up[i] = static_cast<unsigned>(sample.getPlane(i).sensorID);
+      down[i] = static_cast<unsigned>(sample.getPlane(last - 2 + i).sensorID);
+    }
+  }
+
+  //! Finding the upstream and downstream triplets of an event
+  void BM_FindTriplets(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    array<unsigned, 3> up, down;
+    getTripletIDs(sample, up, down);
+
+    EUTelTripletGBLUtility gblutil;
+    vector<EUTelTripletGBLUtility::triplet> triplets;
+    vector<EUTelTripletGBLUtility::triplet> driplets;
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      triplets.clear();
+      driplets.clear();
+      gblutil.FindTriplets(sample.getHits(iEvent), up, TRIPLETRESCUT,
+                           TRIPLETSLOPECUT, triplets, false);
+      gblutil.FindTriplets(sample.getHits(iEvent), down, TRIPLETRESCUT,
+                           TRIPLETSLOPECUT, driplets, false);
+      benchmark::DoNotOptimize(triplets.data());
+      benchmark::DoNotOptimize(driplets.data());
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+  }
+  BENCHMARK(BM_FindTriplets)->Apply(planesAndOccupancy);
+
+  //! Matching the triplets of an event to tracks
+  void BM_MatchTriplets(benchmark::State &state) {
+    const EventSample &sample = getEventSample(
+        static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    array<unsigned, 3> up, down;
+    getTripletIDs(sample, up, down);
+    const double zMatch =
+        0.5 * (sample.getPlane(2).origin.z() +
+               sample.getPlane(sample.getNoOfPlanes() - 3).origin.z());
+
+    EUTelTripletGBLUtility gblutil;
+    vector<vector<EUTelTripletGBLUtility::triplet>> triplets(
+        sample.getNoOfEvents());
+    vector<vector<EUTelTripletGBLUtility::triplet>> driplets(
+        sample.getNoOfEvents());
+    double noOfTracks = 0.;
+    for (size_t iEvent = 0; iEvent < sample.getNoOfEvents(); ++iEvent) {
+      gblutil.FindTriplets(sample.getHits(iEvent), up, TRIPLETRESCUT,
+                           TRIPLETSLOPECUT, triplets[iEvent], false);
+      gblutil.FindTriplets(sample.getHits(iEvent), down, TRIPLETRESCUT,
+                           TRIPLETSLOPECUT, driplets[iEvent], false);
+      vector<EUTelTripletGBLUtility::track> tracks;
+      gblutil.MatchTriplets(triplets[iEvent], driplets[iEvent], zMatch,
+                            MATCHINGCUT, tracks);
+      noOfTracks += tracks.size();
+    }
+
+    vector<EUTelTripletGBLUtility::track> tracks;
+    size_t iEvent = 0;
+    for (auto _ : state) {
+      tracks.clear();
+      gblutil.MatchTriplets(triplets[iEvent], driplets[iEvent], zMatch,
+                            MATCHINGCUT, tracks);
+      benchmark::DoNotOptimize(tracks.data());
+      iEvent = (iEvent + 1) % sample.getNoOfEvents();
+    }
+    setSampleCounters(state, sample);
+    state.counters["matched"] = noOfTracks / sample.getNoOfEvents();
+  }
+  BENCHMARK(BM_MatchTriplets)->Apply(planesAndOccupancy);
+
+} // namespace
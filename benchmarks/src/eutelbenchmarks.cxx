@@ -0,0 +1,51 @@
+// eutelescope includes ""
+#include "EUTelBenchmarkSetup.h"
+
+// benchmark includes <>
+#include <benchmark/benchmark.h>
+
+//system includes <>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char **argv) {
+
+  // the GEAR file option is ours, all the others go to the benchmark
+  // library, e.g. --benchmark_filter or --benchmark_out
+  eutelescope::benchmarks::gearFile = EUTEL_BENCHMARK_GEAR;
+  vector<char *> args;
+  for (int iArg = 0; iArg < argc; ++iArg) {
+    if (strncmp(argv[iArg], "--gear=", 7) == 0) {
+      eutelescope::benchmarks::gearFile = argv[iArg] + 7;
+    } else if (strcmp(argv[iArg], "-h") == 0 ||
+               strcmp(argv[iArg], "--help") == 0) {
+      cout << "\n"
+              "This program runs the micro-benchmarks of the reconstruction hot paths\n"
+              "on synthetic events in the geometry of a GEAR file.\n"
+              "\n"
+              "eutelbenchmarks [--gear=file.xml] [--benchmark_...]\n"
+              "\n"
+              "--gear=file.xml                 The GEAR file (default " EUTEL_BENCHMARK_GEAR ")\n"
+              "--benchmark_filter=regex        Run only the matching benchmarks\n"
+              "--benchmark_out=file.json       Write the results to a file\n"
+              "--benchmark_out_format=json     Format of the results file\n"
+           << endl;
+      return 0;
+    } else {
+      args.push_back(argv[iArg]);
+    }
+  }
+
+  int noOfArgs = static_cast<int>(args.size());
+  benchmark::Initialize(&noOfArgs, args.data());
+  if (benchmark::ReportUnrecognizedArguments(noOfArgs, args.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
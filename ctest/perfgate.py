@@ -0,0 +1,246 @@
+#!/usr/bin/env python
+"""
+perfgate: runs a test command and checks its performance against a baseline
+
+The command (usually a jobsub call) is run with its output passed through
+unchanged. Afterwards the following values are reported as CDash
+measurements:
+
+  wall_s                     wall clock time of the whole command
+  events_per_s               processed events per second of wall time
+  peak_rss_mb                peak resident set size of the largest process
+  cpu_ms_per_event:<proc>    CPU time per event of every Marlin processor,
+                             from the timing table Marlin prints at the end
+  wall_ms_per_event:<label>  wall clock time per event of every profiling
+                             checkpoint, if the steering file contains
+                             EUTelUtilityProfiler checkpoints
+
+The baseline values are read from '#PERF_BASELINE <metric> <value>' lines
+of the test file. A value which is worse than its baseline by more than
+the tolerance (and by more than a small absolute slack, to ignore the
+jitter of very short measurements) is reported as
+
+  Performance regression: ...
+
+which the ctest harness uses as a failure condition. The tolerance in
+percent is given on the command line and can be overridden in the test
+file with '#PERF_TOLERANCE <percent>' or, for the metrics matching a
+shell style pattern, with '#PERF_TOLERANCE <pattern> <percent>'.
+
+With --record the measured values replace the baseline of the test file.
+
+Run
+python perfgate.py --help
+to see the list of command line options.
+"""
+import argparse
+import fnmatch
+import re
+import resource
+import subprocess
+import sys
+import time
+
+# per event values of tests with fewer events are dominated by the start up
+# and are neither recorded nor checked
+MIN_EVENTS = 100
+
+# absolute differences below these are never a regression, by unit
+ABSOLUTE_SLACK = {"s": 1., "mb": 20., "ms_per_event": 0.05, "per_s": 0.}
+
+# Marlin's processor timing table, e.g.
+# MyProcessor    1.23e+00 s in    1000 events  ==>  1.23e-03 [ s/evt.]
+MARLIN_TIMING = re.compile(r"(\S+)\s+([-+.0-9eE]+) s in\s+(\d+) events\s+==>")
+
+# the per checkpoint lines of the EUTelProfiler summary
+PROFILER_HEADER = re.compile(r"Checkpoint\s+Stage\s+Entries\s+Mean\[ms\]")
+PROFILER_LINE = re.compile(r"^(\S+)\s+event\s+(\d+)\s+([.0-9]+)\s")
+
+
+def getUnit(metric):
+    """ return the unit of a metric, used to look up the absolute slack """
+    if metric.startswith("events_per_s"):
+        return "per_s"
+    if metric.startswith("peak_rss_mb"):
+        return "mb"
+    if metric.startswith("wall_s"):
+        return "s"
+    return "ms_per_event"
+
+
+def isHigherBetter(metric):
+    """ rates get worse when they drop, everything else when it grows """
+    return getUnit(metric) == "per_s"
+
+
+def runCommand(command):
+    """ run the command, pass its output through and parse the timing
+
+    returns the return code and a dict with the measured values
+    """
+    start = time.time()
+    process = subprocess.Popen(command, stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT)
+
+    values = {}
+    noOfEvents = 0
+    inProfilerSummary = False
+    for rawLine in iter(process.stdout.readline, b""):
+        line = rawLine.decode("utf-8", "replace")
+        sys.stdout.write(line)
+
+        match = MARLIN_TIMING.search(line)
+        if match:
+            processor = match.group(1).rstrip(":")
+            seconds = float(match.group(2))
+            events = int(match.group(3))
+            noOfEvents = max(noOfEvents, events)
+            if processor != "Total" and events > 0:
+                values["cpu_ms_per_event:" + processor] = 1e3 * seconds / events
+            continue
+
+        if PROFILER_HEADER.search(line):
+            inProfilerSummary = True
+            continue
+        if inProfilerSummary:
+            match = PROFILER_LINE.match(line)
+            if match:
+                values["wall_ms_per_event:" + match.group(1)] = float(
+                    match.group(3))
+            elif not re.match(r"^\S+\s+end\s", line):
+                inProfilerSummary = False
+
+    returnCode = process.wait()
+    wall = time.time() - start
+    sys.stdout.flush()
+
+    # ru_maxrss of the children is the peak of the largest process which
+    # has been waited for, i.e. Marlin, in kB on Linux
+    peakRSS = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss / 1024.
+
+    values["wall_s"] = wall
+    values["peak_rss_mb"] = peakRSS
+    if noOfEvents >= MIN_EVENTS:
+        values["events_per_s"] = noOfEvents / wall
+    else:
+        values = dict((metric, value) for metric, value in values.items()
+                      if ":" not in metric)
+    return returnCode, values
+
+
+def readTestFile(fileName):
+    """ return the baseline values and the tolerance patterns of a test """
+    baseline = {}
+    tolerances = []
+    with open(fileName) as testFile:
+        for line in testFile:
+            tokens = line.split()
+            if not tokens:
+                continue
+            if tokens[0] == "#PERF_BASELINE" and len(tokens) == 3:
+                baseline[tokens[1]] = float(tokens[2])
+            elif tokens[0] == "#PERF_TOLERANCE" and len(tokens) == 2:
+                tolerances.append(("*", float(tokens[1])))
+            elif tokens[0] == "#PERF_TOLERANCE" and len(tokens) == 3:
+                tolerances.append((tokens[1], float(tokens[2])))
+    return baseline, tolerances
+
+
+def getTolerance(metric, tolerances, default):
+    """ the last matching tolerance of the test file wins """
+    tolerance = default
+    for pattern, percent in tolerances:
+        if fnmatch.fnmatchcase(metric, pattern):
+            tolerance = percent
+    return tolerance
+
+
+def checkBaseline(values, baseline, tolerances, defaultTolerance):
+    """ return the list of regression messages """
+    regressions = []
+    for metric in sorted(baseline):
+        if metric not in values:
+            continue
+        reference = baseline[metric]
+        value = values[metric]
+        tolerance = getTolerance(metric, tolerances, defaultTolerance)
+        slack = ABSOLUTE_SLACK[getUnit(metric)]
+        if isHigherBetter(metric):
+            limit = reference * (1. - tolerance / 100.)
+            worse = value < limit and reference - value > slack
+        else:
+            limit = reference * (1. + tolerance / 100.)
+            worse = value > limit and value - reference > slack
+        if worse:
+            regressions.append(
+                "Performance regression: %s is %.4g, baseline %.4g, "
+                "limit %.4g (tolerance %g%%)" %
+                (metric, value, reference, limit, tolerance))
+    return regressions
+
+
+def recordBaseline(fileName, values):
+    """ replace the baseline lines of the test file by the given values """
+    with open(fileName) as testFile:
+        lines = [line for line in testFile
+                 if not line.startswith("#PERF_BASELINE ")]
+    if lines and not lines[-1].endswith("\n"):
+        lines[-1] += "\n"
+    for metric in sorted(values):
+        lines.append("#PERF_BASELINE %s %.4g\n" % (metric, values[metric]))
+    with open(fileName, "w") as testFile:
+        testFile.writelines(lines)
+
+
+def printMeasurement(metric, value):
+    """ output in the format picked up by CTest for CDash """
+    print('<DartMeasurement name="%s" type="numeric/double">%.6g'
+          '</DartMeasurement>' % (metric, value))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        description="Runs a test command and compares its performance with "
+        "the baseline stored in the test file")
+    parser.add_argument("--test", required=True,
+                        help="Test file with the #PERF_ lines")
+    parser.add_argument("--tolerance", type=float, default=50.,
+                        help="Default tolerance in percent [default: %(default)s]")
+    parser.add_argument("--record", action="store_true",
+                        help="Store the measured values as the new baseline "
+                        "instead of checking them")
+    parser.add_argument("command", nargs=argparse.REMAINDER,
+                        help="The command to run, usually jobsub")
+    args = parser.parse_args(argv)
+
+    command = args.command
+    if command and command[0] == "--":
+        command = command[1:]
+    if not command:
+        parser.error("no command given")
+
+    returnCode, values = runCommand(command)
+
+    for metric in sorted(values):
+        printMeasurement(metric, values[metric])
+
+    if returnCode != 0:
+        # neither record nor check the performance of a failed job
+        return returnCode
+
+    if args.record:
+        recordBaseline(args.test, values)
+        print("Performance baseline recorded in " + args.test)
+        return 0
+
+    baseline, tolerances = readTestFile(args.test)
+    regressions = checkBaseline(values, baseline, tolerances, args.tolerance)
+    for regression in regressions:
+        print(regression)
+    if regressions:
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
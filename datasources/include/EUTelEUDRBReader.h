@@ -277,6 +277,12 @@ namespace eutelescope {
 
     //! The buffer container
     int *_buffer;
+
+    //! The first frame used by the calculation algorithm (from 0)
+    int _firstFrame;
+
+    //! True for CDS, where the next frame is subtracted
+    bool _isCDS;
   };
 
 } // end namespace eutelescope
@@ -0,0 +1,128 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELSYNTHETICDATASOURCE_H
+#define EUTELSYNTHETICDATASOURCE_H
+
+// personal includes ".h"
+#include "EUTelSyntheticEventGenerator.h"
+
+// marlin includes ".h"
+#include "marlin/DataSourceProcessor.h"
+
+// lcio includes <.h>
+
+// system includes <>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Generates synthetic telescope events
+  /*! This data source produces events with straight tracks through
+   *  the planes of the GEAR geometry, using the
+   *  EUTelSyntheticEventGenerator, so that the reconstruction can be
+   *  run on large and reproducible data sets without an external
+   *  simulation. The fired pixels are written as zero suppressed data
+   *  (TrackerData with EUTelGenericSparsePixel and the
+   *  ZSDATADEFAULTENCODING), as consumed by the clustering
+   *  processors.
+   *
+   *  The events of a given RandomSeed only depend on the event number,
+   *  so a data set can be produced in parts with FirstEventNumber.
+   *
+   *  Make sure to not specify any LCIOInputFiles in the steering.
+   *
+   *  @param OutputCollectionName The name of the zero suppressed data
+   *  collection
+   *  @param NumberOfEvents The number of events to generate
+   *  @param SensorIDs The planes to generate, all if empty
+   */
+  class EUTelSyntheticDataSource : public marlin::DataSourceProcessor {
+
+  public:
+    //! Default constructor
+    EUTelSyntheticDataSource();
+
+    //! New processor
+    virtual EUTelSyntheticDataSource *newProcessor();
+
+    //! Generates the events
+    virtual void readDataSource(int numEvents);
+
+    //! Init method
+    /*! Reads the planes from the geometry and prepares the generator
+     */
+    virtual void init();
+
+    //! End method
+    virtual void end();
+
+  protected:
+    //! Output collection name
+    std::string _outputCollectionName;
+
+    //! Number of events to generate
+    int _noOfEvents;
+
+    //! Number of the first event
+    int _firstEventNumber;
+
+    //! Run number
+    int _runNumber;
+
+    //! The sensors to generate, all if empty
+    std::vector<int> _sensorIDVec;
+
+    //! Beam energy in GeV
+    float _beamEnergy;
+
+    //! Mean number of tracks per event
+    float _tracksPerEvent;
+
+    //! Beam spot sigma along x and y in mm
+    std::vector<float> _beamSpot;
+
+    //! Beam divergence sigma in rad
+    float _beamDivergence;
+
+    //! Switch for the multiple scattering
+    bool _multipleScattering;
+
+    //! Charge cloud sigma in mm
+    float _chargeSigma;
+
+    //! Charge of a track
+    float _clusterCharge;
+
+    //! Pixel threshold, in the units of the charge
+    float _threshold;
+
+    //! Noise hit probability per pixel and event
+    float _noiseOccupancy;
+
+    //! Fraction of hot pixels
+    float _hotPixelFraction;
+
+    //! Fraction of dead pixels
+    float _deadPixelFraction;
+
+    //! Seed of the random numbers
+    int _randomSeed;
+
+    //! The generator
+    std::unique_ptr<EUTelSyntheticEventGenerator> _generator;
+  };
+
+  //! A global instance of the processor
+  EUTelSyntheticDataSource gEUTelSyntheticDataSource;
+
+} // end namespace eutelescope
+#endif
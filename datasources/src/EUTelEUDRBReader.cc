@@ -14,6 +14,7 @@
 #include "EUTelEUDRBReader.h"
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
+#include "EUTelExceptions.h"
 #include "EUTelRunHeaderImpl.h"
 
 // marlin includes
@@ -30,6 +31,7 @@
 // #include <UTIL/LCTOOLS.h>
 
 // system includes
+#include <cstddef>
 #include <fstream>
 
 using namespace std;
@@ -43,8 +45,56 @@ namespace eutelescope {
 
 using namespace eutelescope;
 
+namespace {
+
+  //! Extracts the ADC value of one channel from a record
+  inline short getADC(int record, int bitMask, int rightShift) {
+    return static_cast<short>((record & bitMask) >> rightShift);
+  }
+
+  //! Decodes one frame (LF) or the difference of two frames (CDS)
+  /*! The records of a frame alternate between channels A/B and
+   *  channels C/D, so pixel i of the four channels is in records 2i
+   *  and 2i + 1. The algorithm is a template parameter and the output
+   *  arrays are already sized, so that the loop is a plain sequence
+   *  of mask, shift and subtract the compiler can vectorise.
+   */
+  template <bool isCDS>
+  void decodeFrame(const int *frame, const int *nextFrame, size_t noOfPixels,
+                   int chACBitMask, int chACRightShift, int chBDBitMask,
+                   int chBDRightShift, short *channelA, short *channelB,
+                   short *channelC, short *channelD) {
+    for (size_t iPixel = 0; iPixel < noOfPixels; ++iPixel) {
+      const int recordAB = frame[2 * iPixel];
+      const int recordCD = frame[2 * iPixel + 1];
+      short pixelA = getADC(recordAB, chACBitMask, chACRightShift);
+      short pixelB = getADC(recordAB, chBDBitMask, chBDRightShift);
+      short pixelC = getADC(recordCD, chACBitMask, chACRightShift);
+      short pixelD = getADC(recordCD, chBDBitMask, chBDRightShift);
+      if (isCDS) {
+        const int nextAB = nextFrame[2 * iPixel];
+        const int nextCD = nextFrame[2 * iPixel + 1];
+        pixelA = static_cast<short>(
+            getADC(nextAB, chACBitMask, chACRightShift) - pixelA);
+        pixelB = static_cast<short>(
+            getADC(nextAB, chBDBitMask, chBDRightShift) - pixelB);
+        pixelC = static_cast<short>(
+            getADC(nextCD, chACBitMask, chACRightShift) - pixelC);
+        pixelD = static_cast<short>(
+            getADC(nextCD, chBDBitMask, chBDRightShift) - pixelD);
+      }
+      channelA[iPixel] = pixelA;
+      channelB[iPixel] = pixelB;
+      channelC[iPixel] = pixelC;
+      channelD[iPixel] = pixelD;
+    }
+  }
+
+} // namespace
+
 EUTelEUDRBReader::EUTelEUDRBReader()
-    : DataSourceProcessor("EUTelEUDRBReader"), _fileHeader(nullptr) {
+    : DataSourceProcessor("EUTelEUDRBReader"), _fileHeader(nullptr),
+      _buffer(nullptr), _firstFrame(0), _isCDS(true) {
 
   _description =
       "Reads data files and creates LCEvent with TrackerRawData collection.\n"
@@ -55,15 +105,28 @@ EUTelEUDRBReader::EUTelEUDRBReader()
                              std::string("input.dat"));
 
   registerProcessorParameter("CalculationAlgorithm",
-                             "Select if you want CDS or LF", _algo,
-                             std::string("CDS"));
+                             "Select one of CDS21, CDS32, LF1, LF2 or LF3",
+                             _algo, std::string("CDS32"));
 }
 
 EUTelEUDRBReader *EUTelEUDRBReader::newProcessor() {
   return new EUTelEUDRBReader;
 }
 
-void EUTelEUDRBReader::init() { printParameters(); }
+void EUTelEUDRBReader::init() {
+  printParameters();
+
+  // the algorithm is selected here once for the whole run
+  if (_algo == "CDS21" || _algo == "CDS32") {
+    _isCDS = true;
+    _firstFrame = (_algo == "CDS21") ? 0 : 1;
+  } else if (_algo == "LF1" || _algo == "LF2" || _algo == "LF3") {
+    _isCDS = false;
+    _firstFrame = _algo[2] - '1';
+  } else {
+    throw InvalidParameterException("Unknown CalculationAlgorithm " + _algo);
+  }
+}
 
 void EUTelEUDRBReader::readDataSource(int numEvents) {
 
@@ -92,9 +155,9 @@ void EUTelEUDRBReader::readDataSource(int numEvents) {
 
   if (isFirstEvent()) {
 
-    IMPL::LCRunHeaderImpl rdr = new IMPL::LCRunHeaderImpl;
-    EUTelRunHeaderImpl *runHeader =
-        new EUTelRunHeaderImpl(rdr) runHeader->setDAQHWName("EUDRB");
+    IMPL::LCRunHeaderImpl *rdr = new IMPL::LCRunHeaderImpl;
+    EUTelRunHeaderImpl *runHeader = new EUTelRunHeaderImpl(rdr);
+    runHeader->setDAQHWName("EUDRB");
     runHeader->setNoOfEvent(_fileHeader->numberOfEvent + 1);
     runHeader->setNoOfDetector(_fileHeader->numberOfDetector * 4);
     IntVec minX, minY, maxX, maxY;
@@ -121,6 +184,25 @@ void EUTelEUDRBReader::readDataSource(int numEvents) {
     _buffer = new int[_fileHeader->dataSize / sizeof(int)];
   }
 
+  const size_t noOfPixels = static_cast<size_t>(_fileHeader->nXPixel) *
+                            static_cast<size_t>(_fileHeader->nYPixel);
+  const size_t frameRecordSize = noOfPixels * 4 /*frame*/ /
+                                 2 /*pixel per record*/;
+  const size_t noOfFrames =
+      static_cast<size_t>(_firstFrame) + (_isCDS ? 2 : 1);
+  if (noOfFrames * frameRecordSize >
+      static_cast<size_t>(_fileHeader->dataSize) / sizeof(int)) {
+    message<ERROR5>(log() << "The data block is too short for the "
+                          << _algo << " algorithm");
+    exit(-1);
+  }
+  const int *frame =
+      _buffer + static_cast<size_t>(_firstFrame) * frameRecordSize;
+  const int *nextFrame = frame + frameRecordSize;
+  void (*decode)(const int *, const int *, size_t, int, int, int, int,
+                 short *, short *, short *, short *) =
+      _isCDS ? decodeFrame<true> : decodeFrame<false>;
+
   int iEvent;
   for (iEvent = 0; iEvent < _fileHeader->numberOfEvent; iEvent++) {
 
@@ -163,10 +245,6 @@ void EUTelEUDRBReader::readDataSource(int numEvents) {
       exit(-1);
     }
 
-    // this is made between frame 3 and frame 2
-    int frameRecordSize = _fileHeader->nXPixel * _fileHeader->nYPixel *
-                          4 /*frame*/ / 2 /*pixel per record*/;
-
     TrackerRawDataImpl *channelA = new TrackerRawDataImpl;
     idEncoder["sensorID"] = 0;
     idEncoder["xMin"] = 0;
@@ -199,63 +277,15 @@ void EUTelEUDRBReader::readDataSource(int numEvents) {
     idEncoder["yMax"] = _fileHeader->nYPixel - 1;
     idEncoder.setCellID(channelD);
 
-    int firstFrame = -1;
-    int secondFrame = -1;
-    if ((_algo == "CDS32") || (_algo == "LF2")) {
-      firstFrame = 1;
-      secondFrame = 2;
-    } else if ((_algo == "CDS21") || (_algo == "LF1")) {
-      firstFrame = 0;
-      secondFrame = 1;
-    } else if (_algo == "LF3") {
-      firstFrame = 2;
-      secondFrame = 3;
-    }
-
-    for (int iRecord = firstFrame * frameRecordSize;
-         iRecord < secondFrame * frameRecordSize; iRecord++) {
-
-      short pixelA1 =
-          static_cast<short>((_buffer[iRecord] & _fileHeader->chACBitMask) >>
-                             _fileHeader->chACRightShift);
-      short pixelB1 =
-          static_cast<short>((_buffer[iRecord] & _fileHeader->chBDBitMask) >>
-                             _fileHeader->chBDRightShift);
-      if (_algo.compare(0, 3, "CDS") == 0) {
-        short pixelA2 = static_cast<short>(
-            (_buffer[iRecord + frameRecordSize] & _fileHeader->chACBitMask) >>
-            _fileHeader->chACRightShift);
-        short pixelB2 = static_cast<short>(
-            (_buffer[iRecord + frameRecordSize] & _fileHeader->chBDBitMask) >>
-            _fileHeader->chBDRightShift);
-        channelA->adcValues().push_back(pixelA2 - pixelA1);
-        channelB->adcValues().push_back(pixelB2 - pixelB1);
-      } else if (_algo.compare(0, 2, "LF") == 0) {
-        channelA->adcValues().push_back(pixelA1);
-        channelB->adcValues().push_back(pixelB1);
-      }
-
-      ++iRecord;
-      short pixelC1 =
-          static_cast<short>((_buffer[iRecord] & _fileHeader->chACBitMask) >>
-                             _fileHeader->chACRightShift);
-      short pixelD1 =
-          static_cast<short>((_buffer[iRecord] & _fileHeader->chBDBitMask) >>
-                             _fileHeader->chBDRightShift);
-      if (_algo.compare(0, 3, "CDS") == 0) {
-        short pixelC2 = static_cast<short>(
-            (_buffer[iRecord + frameRecordSize] & _fileHeader->chACBitMask) >>
-            _fileHeader->chACRightShift);
-        short pixelD2 = static_cast<short>(
-            (_buffer[iRecord + frameRecordSize] & _fileHeader->chBDBitMask) >>
-            _fileHeader->chBDRightShift);
-        channelC->adcValues().push_back(pixelC2 - pixelC1);
-        channelD->adcValues().push_back(pixelD2 - pixelD1);
-      } else if (_algo.compare(0, 2, "LF") == 0) {
-        channelC->adcValues().push_back(pixelC1);
-        channelD->adcValues().push_back(pixelD1);
-      }
-    }
+    channelA->adcValues().resize(noOfPixels);
+    channelB->adcValues().resize(noOfPixels);
+    channelC->adcValues().resize(noOfPixels);
+    channelD->adcValues().resize(noOfPixels);
+    decode(frame, nextFrame, noOfPixels, _fileHeader->chACBitMask,
+           _fileHeader->chACRightShift, _fileHeader->chBDBitMask,
+           _fileHeader->chBDRightShift, channelA->adcValues().data(),
+           channelB->adcValues().data(), channelC->adcValues().data(),
+           channelD->adcValues().data());
 
     rawData->push_back(channelA);
     rawData->push_back(channelB);
@@ -0,0 +1,251 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal includes
+#include "EUTelSyntheticDataSource.h"
+#include "EUTELESCOPE.h"
+#include "EUTelEventImpl.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelRunHeaderImpl.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+
+// marlin includes
+#include "marlin/DataSourceProcessor.h"
+#include "marlin/Global.h"
+#include "marlin/Processor.h"
+#include "marlin/ProcessorMgr.h"
+
+// lcio includes
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDEncoder.h>
+#include <UTIL/LCTime.h>
+
+// system includes
+#include <algorithm>
+#include <memory>
+
+using namespace std;
+using namespace marlin;
+using namespace eutelescope;
+
+EUTelSyntheticDataSource::EUTelSyntheticDataSource()
+    : DataSourceProcessor("EUTelSyntheticDataSource"), _generator(nullptr) {
+
+  _description =
+      "Generates synthetic events with straight tracks through the planes "
+      "of the GEAR geometry and writes the fired pixels as zero suppressed "
+      "data.\n"
+      "Make sure to not specify any LCIOInputFiles in the steering.";
+
+  registerOutputCollection(LCIO::TRACKERDATA, "OutputCollectionName",
+                           "The zero suppressed data collection",
+                           _outputCollectionName, string("zsdata"));
+
+  registerProcessorParameter("NumberOfEvents",
+                             "Number of events to generate", _noOfEvents,
+                             1000);
+
+  registerOptionalParameter("FirstEventNumber",
+                            "Number of the first event, to generate a data "
+                            "set in parts",
+                            _firstEventNumber, 0);
+
+  registerOptionalParameter("RunNumber", "The run number", _runNumber, 0);
+
+  registerOptionalParameter("SensorIDs",
+                            "The sensors to generate, all if empty",
+                            _sensorIDVec, vector<int>());
+
+  registerProcessorParameter("BeamEnergy", "The beam momentum in GeV",
+                             _beamEnergy, 5.f);
+
+  registerProcessorParameter("TracksPerEvent",
+                             "Mean number of tracks per event (Poisson)",
+                             _tracksPerEvent, 1.f);
+
+  registerOptionalParameter("BeamSpotSize",
+                            "Sigma of the beam spot along x and y in mm",
+                            _beamSpot, vector<float>{3.f, 3.f});
+
+  registerOptionalParameter("BeamDivergence",
+                            "Sigma of the beam divergence in rad",
+                            _beamDivergence, 1e-4f);
+
+  registerOptionalParameter("MultipleScattering",
+                            "Scatter the tracks in the planes",
+                            _multipleScattering, true);
+
+  registerOptionalParameter("ChargeSharingSigma",
+                            "Sigma of the Gaussian charge cloud in mm",
+                            _chargeSigma, 0.005f);
+
+  registerOptionalParameter("ClusterCharge", "The charge of a track",
+                            _clusterCharge, 1000.f);
+
+  registerOptionalParameter("Threshold",
+                            "A pixel fires if its charge is at least the "
+                            "threshold",
+                            _threshold, 100.f);
+
+  registerOptionalParameter("NoiseOccupancy",
+                            "Probability of a noise hit per pixel and event",
+                            _noiseOccupancy, 0.f);
+
+  registerOptionalParameter("HotPixelFraction",
+                            "Fraction of the pixels firing in every event",
+                            _hotPixelFraction, 0.f);
+
+  registerOptionalParameter("DeadPixelFraction",
+                            "Fraction of the pixels never firing",
+                            _deadPixelFraction, 0.f);
+
+  registerOptionalParameter("RandomSeed", "Seed of the random numbers",
+                            _randomSeed, 4357);
+}
+
+EUTelSyntheticDataSource *EUTelSyntheticDataSource::newProcessor() {
+  return new EUTelSyntheticDataSource;
+}
+
+void EUTelSyntheticDataSource::init() {
+  printParameters();
+
+  geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
+                                             EUTELESCOPE::DUMPGEOROOT);
+
+  vector<int> sensorIDVec = _sensorIDVec;
+  if (sensorIDVec.empty()) {
+    sensorIDVec = geo::gGeometry().sensorIDsVec();
+  }
+
+  vector<EUTelSyntheticEventGenerator::Plane> planes =
+      EUTelSyntheticEventGenerator::getGeometryPlanes(sensorIDVec);
+
+  EUTelSyntheticEventGenerator::Settings settings;
+  settings.beamEnergy = _beamEnergy;
+  settings.tracksPerEvent = _tracksPerEvent;
+  if (_beamSpot.size() >= 2) {
+    settings.beamSpotX = _beamSpot[0];
+    settings.beamSpotY = _beamSpot[1];
+  }
+  settings.beamDivergence = _beamDivergence;
+  settings.multipleScattering = _multipleScattering;
+  settings.chargeSigma = _chargeSigma;
+  settings.clusterCharge = _clusterCharge;
+  settings.threshold = _threshold;
+  settings.noiseOccupancy = _noiseOccupancy;
+  settings.hotPixelFraction = _hotPixelFraction;
+  settings.deadPixelFraction = _deadPixelFraction;
+  settings.seed = static_cast<uint64_t>(_randomSeed);
+
+  _generator =
+      std::make_unique<EUTelSyntheticEventGenerator>(planes, settings);
+}
+
+void EUTelSyntheticDataSource::readDataSource(int numEvents) {
+
+  int noOfEvents = _noOfEvents;
+  if (numEvents > 0) {
+    noOfEvents = std::min(noOfEvents, numEvents);
+  }
+  const string detectorName = Global::GEAR->getDetectorName();
+
+  // the run header
+  auto lcHeader = std::make_unique<IMPL::LCRunHeaderImpl>();
+  auto runHeader = std::make_unique<EUTelRunHeaderImpl>(lcHeader.get());
+  runHeader->addProcessor(type());
+  runHeader->lcRunHeader()->setDescription(
+      " Events generated by the EUTelSyntheticDataSource");
+  runHeader->lcRunHeader()->setRunNumber(_runNumber);
+  runHeader->lcRunHeader()->setDetectorName(detectorName);
+  runHeader->setHeaderVersion(0.0001);
+  runHeader->setDataType(EUTELESCOPE::SIMULDATA);
+  runHeader->setDateTime();
+  runHeader->setSimulSWName(type());
+  runHeader->setSimulSWVersion(0.0001);
+  runHeader->setBeamEnergy(_beamEnergy);
+  runHeader->setNoOfEvent(noOfEvents);
+  runHeader->setNoOfDetector(static_cast<int>(_generator->getNoOfPlanes()));
+  IntVec minX, maxX, minY, maxY;
+  for (size_t iPlane = 0; iPlane < _generator->getNoOfPlanes(); ++iPlane) {
+    minX.push_back(0);
+    maxX.push_back(_generator->getPlane(iPlane).noOfPixelsX - 1);
+    minY.push_back(0);
+    maxY.push_back(_generator->getPlane(iPlane).noOfPixelsY - 1);
+  }
+  runHeader->setMinX(minX);
+  runHeader->setMaxX(maxX);
+  runHeader->setMinY(minY);
+  runHeader->setMaxY(maxY);
+  ProcessorMgr::instance()->processRunHeader(
+      static_cast<lcio::LCRunHeader *>(lcHeader.release()));
+  _isFirstEvent = false;
+
+  int eventNumber = _firstEventNumber;
+  for (int iEvent = 0; iEvent < noOfEvents; ++iEvent, ++eventNumber) {
+
+    if (iEvent % 10000 == 0)
+      message<MESSAGE5>(log() << "Generating event " << eventNumber);
+
+    _generator->generate(static_cast<uint64_t>(eventNumber));
+
+    auto event = std::make_unique<EUTelEventImpl>();
+    event->setDetectorName(detectorName);
+    event->setEventType(kDE);
+    event->setRunNumber(_runNumber);
+    event->setEventNumber(eventNumber);
+    event->setTimeStamp(LCTime().timeStamp());
+
+    LCCollectionVec *zsData = new LCCollectionVec(LCIO::TRACKERDATA);
+    CellIDEncoder<TrackerDataImpl> zsDataEncoder(
+        EUTELESCOPE::ZSDATADEFAULTENCODING, zsData);
+
+    for (size_t iPlane = 0; iPlane < _generator->getNoOfPlanes(); ++iPlane) {
+      const vector<EUTelSyntheticEventGenerator::Pixel> &pixels =
+          _generator->getPixels(iPlane);
+      if (pixels.empty()) {
+        continue;
+      }
+      TrackerDataImpl *sparsified = new TrackerDataImpl;
+      zsDataEncoder["sensorID"] = _generator->getPlane(iPlane).sensorID;
+      zsDataEncoder["sparsePixelType"] =
+          static_cast<int>(kEUTelGenericSparsePixel);
+      zsDataEncoder.setCellID(sparsified);
+
+      EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> sparseData(
+          sparsified);
+      for (const EUTelSyntheticEventGenerator::Pixel &pixel : pixels) {
+        sparseData.emplace_back(pixel.x, pixel.y, pixel.signal);
+      }
+      zsData->push_back(sparsified);
+    }
+
+    event->addCollection(zsData, _outputCollectionName);
+    ProcessorMgr::instance()->processEvent(
+        static_cast<LCEventImpl *>(event.get()));
+  }
+
+  auto event = std::make_unique<EUTelEventImpl>();
+  event->setDetectorName(detectorName);
+  event->setTimeStamp(LCTime().timeStamp());
+  event->setRunNumber(_runNumber);
+  event->setEventNumber(eventNumber);
+  event->setEventType(kEORE);
+  ProcessorMgr::instance()->processEvent(
+      static_cast<LCEventImpl *>(event.get()));
+}
+
+void EUTelSyntheticDataSource::end() {
+  _generator.reset();
+  message<MESSAGE5>("Successfully finished");
+}
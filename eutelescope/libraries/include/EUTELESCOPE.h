@@ -329,6 +329,13 @@ namespace eutelescope {
      */
     static const char *FIXEDWEIGHT;
 
+    //! Running average algorithm for the pedestal / noise update
+    /*! The name for the pedestal and noise update algorithm with a
+     *  weight growing at each update. @see
+     *  EUTelUpdatePedestalNoiseProcessor
+     */
+    static const char *RUNNINGAVERAGE;
+
     //! Cluster separation algorithm with only flagging capability
     /*! The name for the cluster separation algorithm that is not
      *  really dividing merging clusters, but only flagging their
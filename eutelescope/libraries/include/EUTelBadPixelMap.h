@@ -0,0 +1,102 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBADPIXELMAP_H
+#define EUTELBADPIXELMAP_H 1
+
+// lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Bitmap of the bad (hot, masked, dead) pixels of one sensor
+  /*! Analysis processors reject tracks passing close to bad pixels.
+   *  Instead of looping over all bad pixels for every track, the bad
+   *  pixels are collected once in a bitmap, from which a summed-area
+   *  table is built. Whether there is a bad pixel in a rectangular
+   *  window is then answered with four lookups, independent of the
+   *  number of bad pixels and of the window size.
+   *
+   *  Positions are local to the sensor, in the same units as the
+   *  pitches, with the centre of pixel (i, j) at
+   *  ((i + 0.5) * pitchX, (j + 0.5) * pitchY).
+   *
+   *  The index is (re)built on the first query after pixels have been
+   *  added, so a map should be filled completely before it is used.
+   */
+  class EUTelBadPixelMap {
+
+  public:
+    //! Constructor of an empty map
+    /*! @throw InvalidParameterException if the number of pixels or the
+     *  pitches are not positive
+     */
+    EUTelBadPixelMap(int noOfPixelsX, int noOfPixelsY, double pitchX,
+                     double pitchY);
+
+    //! Marks a pixel as bad
+    /*! @return False if the pixel is outside of the sensor and was
+     *  ignored
+     */
+    bool addPixel(int x, int y);
+
+    //! Marks all pixels of a sparse data object as bad
+    /*! @param sparseData TrackerData with EUTelGenericSparsePixel, as
+     *  written by the hot pixel and dead column finders
+     *  @return The number of pixels outside of the sensor, which were
+     *  ignored
+     */
+    std::size_t addPixels(IMPL::TrackerDataImpl *sparseData);
+
+    //! Returns true if the pixel is marked as bad
+    bool isBad(int x, int y) const;
+
+    //! Returns the number of distinct bad pixels
+    std::size_t getNoOfBadPixels() const { return _noOfBadPixels; }
+
+    //! Is there a bad pixel with |x - xc| < limit and |y - yc| < limit?
+    /*! xc and yc are the pixel centres.
+     */
+    bool hasBadPixelWithin(double x, double y, double limit) const;
+
+    //! Is there a bad pixel in any column with |x - xc| < limit?
+    bool hasBadColumnWithin(double x, double limit) const;
+
+  private:
+    //! First and last pixel index with |pos - centre| < limit
+    /*! @return False if there is no such pixel
+     */
+    static bool getRange(double pos, double limit, double pitch,
+                         int noOfPixels, int &first, int &last);
+
+    void buildIndex() const;
+
+    int _noOfPixelsX;
+    int _noOfPixelsY;
+    double _pitchX;
+    double _pitchY;
+
+    //! One entry per pixel, x running fastest
+    std::vector<unsigned char> _bitmap;
+    std::size_t _noOfBadPixels;
+
+    //! Summed-area table with (noOfPixelsX + 1) * (noOfPixelsY + 1)
+    //! entries, (i, j) holds the number of bad pixels with x < i and y < j
+    mutable std::vector<unsigned int> _areaSum;
+    //! Number of bad pixels in the columns with x < i
+    mutable std::vector<unsigned int> _columnSum;
+    mutable bool _indexed;
+  };
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELCONDITIONSCACHE_H
+#define EUTELCONDITIONSCACHE_H 1
+
+// lcio includes <.h>
+#include <EVENT/LCCollection.h>
+#include <EVENT/LCEvent.h>
+
+// lccd includes <.h>
+#include <lccd/IConditionsChangeListener.hh>
+
+// system includes <>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Run level cache of the decoded condition collections
+  /*! The condition collections (pedestal, noise, status, noisy pixels)
+   *  are attached to every event by the conditions processor, but
+   *  every processor used to decode them into its own copy. The cache
+   *  decodes a condition collection once and hands out the result as
+   *  a shared read only object to all processors of the job.
+   *
+   *  For a collection loaded by an LCCD conditions handler, an entry is
+   *  valid within a run until the handler reports a new validity range.
+   *  The cache counts these changes with a listener on the handler, so
+   *  it does not depend on the address of the collection object, which
+   *  can be reused by the next collection. A collection without a
+   *  conditions handler is decoded again in every event.
+   *
+   *  The cache is a singleton, its methods can be called from several
+   *  threads.
+   */
+  class EUTelConditionsCache {
+
+  public:
+    //! Sorted Utility::cantorEncode indices of the noisy pixels per sensor
+    typedef std::map<int, std::vector<int>> NoisyPixelMap;
+
+    //! Position of each sensor in a condition collection
+    typedef std::map<int, int> SensorIndexMap;
+
+    //! Returns the single instance
+    static EUTelConditionsCache &getInstance();
+
+    //! Returns the noisy pixels of a collection of sparse pixels
+    /*! The map has the format of Utility::readNoisyPixelList. If the
+     *  event does not contain the collection, an empty map is returned
+     *  and nothing is cached.
+     */
+    std::shared_ptr<const NoisyPixelMap>
+    getNoisyPixels(EVENT::LCEvent *event, const std::string &collectionName);
+
+    //! Returns the position of each sensor ID in a condition collection
+    /*! The sensor ID is read from the cell ID of the TrackerData or
+     *  TrackerRawData elements, as for the pedestal, noise and status
+     *  collections.
+     *  @throw lcio::DataNotAvailableException if the event does not
+     *  contain the collection
+     */
+    std::shared_ptr<const SensorIndexMap>
+    getSensorIndices(EVENT::LCEvent *event, const std::string &collectionName);
+
+    //! Returns the position of a sensor ID in a condition collection
+    /*! @throw IncompatibleDataSetException if the collection has no
+     *  element for this sensor
+     */
+    static int getSensorIndex(const SensorIndexMap &sensorIndices,
+                              int sensorID, const std::string &collectionName);
+
+    //! Returns the number of new validity ranges of a condition collection
+    /*! Processors keeping state derived from a condition collection
+     *  compare it between events to detect new conditions. A collection
+     *  without LCCD conditions handler never reports a change and is
+     *  taken as constant within a run, 0 is returned for it.
+     */
+    unsigned long getChanges(const std::string &collectionName);
+
+    //! Drops all entries
+    void clear();
+
+  private:
+    EUTelConditionsCache() = default;
+    EUTelConditionsCache(const EUTelConditionsCache &) = delete;
+    EUTelConditionsCache &operator=(const EUTelConditionsCache &) = delete;
+
+    //! Counts the new validity ranges of one condition collection
+    class ChangeCounter : public lccd::IConditionsChangeListener {
+    public:
+      void conditionsChanged(EVENT::LCCollection *) override { ++_changes; }
+      unsigned long getChanges() const { return _changes; }
+
+    private:
+      std::atomic<unsigned long> _changes{0};
+    };
+
+    //! The conditions an entry was built from
+    struct Key {
+      //! Number of changes reported by the conditions handler
+      unsigned long changes;
+      int run;
+      //! The event number, -1 for collections with a conditions handler
+      int event;
+      bool operator==(const Key &other) const {
+        return changes == other.changes && run == other.run &&
+               event == other.event;
+      }
+    };
+
+    //! Returns the change counter of a collection, null without handler
+    /*! Registers the change counter on the first call for a collection.
+     *  The mutex has to be locked by the caller.
+     */
+    ChangeCounter *getChangeCounter(const std::string &collectionName);
+
+    //! Returns the key of the collection in this event
+    /*! The mutex has to be locked by the caller.
+     */
+    Key makeKey(EVENT::LCEvent *event, const std::string &collectionName);
+
+    template <class T> struct Entry {
+      Key key;
+      std::shared_ptr<const T> value;
+    };
+
+    std::mutex _mutex;
+    //! Change counters by collection name, null without conditions handler
+    /*! They are registered on the LCCD handlers and never dropped.
+     */
+    std::map<std::string, std::unique_ptr<ChangeCounter>> _changeCounters;
+    std::map<std::string, Entry<NoisyPixelMap>> _noisyPixels;
+    std::map<std::string, Entry<SensorIndexMap>> _sensorIndices;
+  };
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELDIGITALCLUSTERMATRIX_H
+#define EUTELDIGITALCLUSTERMATRIX_H 1
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Packed bit matrix of the hit pixels of one binary readout sensor
+  /*! The digital clustering of binary sensors (Mimosa26, FE-I4 in
+   *  digital mode) only needs to know whether a pixel is hit. The
+   *  matrix stores one bit per pixel, column by column: column x is a
+   *  sequence of 64 bit words with bit y % 64 of word y / 64 set for a
+   *  hit pixel (x, y). Counting the hits in a window is done with a
+   *  shift, a mask and a popcount per column and word instead of one
+   *  lookup per pixel.
+   *
+   *  A second matrix of the same layout holds a pixel mask, e.g. the
+   *  hot pixels, which is kept across events and removed from the hits
+   *  word by word with applyMask().
+   *
+   *  Only the columns with hits are cleared at the next event, so a
+   *  matrix should be kept per sensor and reused.
+   */
+  class EUTelDigitalClusterMatrix {
+
+  public:
+    //! Constructor of an empty matrix
+    /*! @throw InvalidParameterException if the number of pixels is not
+     *  positive
+     */
+    EUTelDigitalClusterMatrix(int noOfPixelsX, int noOfPixelsY);
+
+    //! Returns the number of pixels along x
+    int getNoOfPixelsX() const { return _noOfPixelsX; }
+
+    //! Returns the number of pixels along y
+    int getNoOfPixelsY() const { return _noOfPixelsY; }
+
+    //! Removes all hits, the mask is kept
+    void clear();
+
+    //! Sets a pixel as hit
+    /*! @return False if the pixel is outside of the sensor and was
+     *  ignored
+     */
+    bool addHit(int x, int y);
+
+    //! Removes the hit of a pixel
+    void removeHit(int x, int y);
+
+    //! Returns true if the pixel is hit
+    bool isHit(int x, int y) const;
+
+    //! Adds a pixel to the mask
+    /*! @return False if the pixel is outside of the sensor and was
+     *  ignored
+     */
+    bool maskPixel(int x, int y);
+
+    //! Returns true if the pixel is masked
+    bool isMasked(int x, int y) const;
+
+    //! Removes the masked pixels from the hits
+    void applyMask();
+
+    //! Returns the number of hits with x0 <= x <= x1 and y0 <= y <= y1
+    /*! The window is clipped to the sensor.
+     */
+    unsigned int countHits(int x0, int x1, int y0, int y1) const;
+
+    //! Appends the hits with x0 <= x <= x1 and y0 <= y <= y1
+    /*! The window is clipped to the sensor. The hits are ordered by x
+     *  and then by y.
+     */
+    void getHits(int x0, int x1, int y0, int y1,
+                 std::vector<std::pair<int, int>> &hits) const;
+
+    //! Appends all hits, ordered by x and then by y
+    void getHits(std::vector<std::pair<int, int>> &hits) const;
+
+  private:
+    typedef std::uint64_t Word;
+    static const int WORDBITS = 64;
+
+    //! Index of the word holding pixel (x, y)
+    std::size_t getWordIndex(int x, int y) const {
+      return static_cast<std::size_t>(x) * _wordsPerColumn +
+             static_cast<std::size_t>(y / WORDBITS);
+    }
+
+    //! Bit of pixel y in its word
+    static Word getBit(int y) {
+      return static_cast<Word>(1) << (y % WORDBITS);
+    }
+
+    //! Bits y0 <= y <= y1 of word number iWord of a column
+    static Word getRangeMask(int iWord, int y0, int y1);
+
+    bool isInside(int x, int y) const {
+      return x >= 0 && x < _noOfPixelsX && y >= 0 && y < _noOfPixelsY;
+    }
+
+    //! Clips a window to the sensor, false if nothing is left
+    bool clip(int &x0, int &x1, int &y0, int &y1) const;
+
+    int _noOfPixelsX;
+    int _noOfPixelsY;
+    std::size_t _wordsPerColumn;
+
+    std::vector<Word> _hits;
+    std::vector<Word> _mask;
+
+    //! One bit per column which may contain hits
+    std::vector<Word> _usedColumns;
+  };
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELETAACCUMULATOR_H
+#define EUTELETAACCUMULATOR_H 1
+
+// lcio includes <.h>
+#include <EVENT/LCGenericObject.h>
+#include <IMPL/LCGenericObjectImpl.h>
+
+// system includes <>
+#include <cstdint>
+#include <vector>
+
+namespace eutelescope {
+
+  class EUTelEtaFunctionImpl;
+
+  //! Center of gravity distribution of one sensor and direction
+  /*! The eta function is the normalised cumulative distribution of
+   *  the cluster center of gravity shift within the seed pixel. This
+   *  class counts the shifts in fixed bins with integer counters, so
+   *  that it can be filled event by event, and two accumulators with
+   *  the same binning filled on different parts of a run can be merged
+   *  without any loss: the result is the same as filling one
+   *  accumulator with the full run.
+   *
+   *  The binning is the one of EUTelPseudo1DHistogram, used before by
+   *  the EUTelCalculateEtaProcessor, including the treatment of the
+   *  under- and overflow.
+   *
+   *  For the merging of partial results, an accumulator can be stored
+   *  in an LCGenericObject. The integers are the sensor ID and the
+   *  number of bins, the doubles the lower and upper limit, the
+   *  underflow, the overflow and the bin counts. The counts are exact
+   *  up to 2^53 entries.
+   */
+  class EUTelEtaAccumulator {
+
+  public:
+    //! Constructor
+    /*! @throw InvalidParameterException if the number of bins is not
+     *  positive or the range is empty
+     */
+    EUTelEtaAccumulator(int sensorID, int noOfBins, double min, double max);
+
+    //! Constructor from an object written with makeGenericObject()
+    /*! @throw InvalidParameterException if the object is not a valid
+     *  accumulator
+     */
+    explicit EUTelEtaAccumulator(EVENT::LCGenericObject *object);
+
+    //! Counts a center of gravity shift
+    void fill(double x);
+
+    //! Adds the counts of another accumulator
+    /*! @throw InvalidParameterException if the sensor or the binning
+     *  are different
+     */
+    void merge(const EUTelEtaAccumulator &other);
+
+    //! Returns the sensor ID
+    int getSensorID() const { return _sensorID; }
+
+    //! Returns the number of bins
+    int getNoOfBins() const { return static_cast<int>(_counts.size()); }
+
+    //! Returns the center of the bin, starting from 0
+    double getBinCenter(int bin) const;
+
+    //! Returns the number of entries in the bin, starting from 0
+    std::uint64_t getBinCount(int bin) const { return _counts.at(bin); }
+
+    //! Returns the number of entries in the range
+    std::uint64_t getNoOfEntries() const;
+
+    //! Fills the bin centers and the eta values
+    void getEtaFunction(std::vector<double> &center,
+                        std::vector<double> &value) const;
+
+    //! Returns a new eta function, owned by the caller
+    EUTelEtaFunctionImpl *makeEtaFunction() const;
+
+    //! Returns a new generic object with the counts, owned by the caller
+    IMPL::LCGenericObjectImpl *makeGenericObject() const;
+
+  private:
+    int _sensorID;
+    double _min;
+    double _max;
+    double _binWidth;
+    std::uint64_t _underflow;
+    std::uint64_t _overflow;
+    std::vector<std::uint64_t> _counts;
+  };
+
+} // namespace eutelescope
+
+#endif
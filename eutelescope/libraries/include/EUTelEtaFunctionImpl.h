@@ -10,14 +10,16 @@
 #ifndef EUTELETAFUNCTIONIMPL_H
 #define EUTELETAFUNCTIONIMPL_H
 
-#define ETA_VERSION 2
+#define ETA_VERSION 3
 
 // lcio includes <.h>
 #include <IMPL/LCGenericObjectImpl.h>
 #include <lcio.h>
 
 // system includes <>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace eutelescope {
 
@@ -33,6 +35,13 @@ namespace eutelescope {
    *  Some convenience methods have been introduced to allow the user
    *  to set/get the full bin center and the full eta value vectors
    *
+   *  Optionally, the function resampled on a uniform grid can be
+   *  appended with buildUniformTable(). Then the second integer is
+   *  @a nBin, the third the number of grid points @a nGrid, and the
+   *  double values are followed by the first grid point, the inverse
+   *  grid step and the @a nGrid eta values. Objects without the table,
+   *  e.g. from older condition files, are still understood.
+   *
    *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
    *  @version $Id$
    */
@@ -128,12 +137,11 @@ namespace eutelescope {
      *  \li Note 1: It is possible to use the lower_bound algorithm
      *  because the CoG vector is sorted by definition.
      *
-     *  \li Note 2: In the case the x axis binning during the Eta
-     *  function calculation was kept constant and uniform, then the
-     *  binary search algorthim can be replaced with a much faster
-     *  calculation of the x closest pair of values. Because of this
-     *  lack in generality, we prefer to invest some calculation power
-     *  in the binary search.
+     *  \li Note 2: If the uniform table has been built, it is used
+     *  instead of the binary search: the grid point on the left of
+     *  @a x is computed directly and the interpolation is done
+     *  without branches. For the uniform binning produced by the
+     *  EUTelCalculateEtaProcessor both give the same result.
      *
      *  @param x is the current CoG value
      *  @return the corresponding Eta value
@@ -141,6 +149,36 @@ namespace eutelescope {
      */
     double getEtaFromCoG(double x) const;
 
+    //! Get Eta for an array of CoG values
+    /*! Same as getEtaFromCoG(double) for @a n values at once, which
+     *  allows the compiler to vectorise the uniform table lookup.
+     *
+     *  @param cog The CoG values
+     *  @param eta Filled with the @a n eta values, may be equal to @a cog
+     *  @param n The number of values
+     */
+    void getEtaFromCoG(const double *cog, double *eta, std::size_t n) const;
+
+    //! Get Eta for a vector of CoG values
+    /*! @param cog The CoG values
+     *  @param eta Resized and filled with the eta values
+     */
+    void getEtaFromCoG(const std::vector<double> &cog,
+                       std::vector<double> &eta) const;
+
+    //! Resample the function on a uniform grid
+    /*! The grid spans the bin centers. Calling it again replaces the
+     *  table.
+     *
+     *  @param nGrid The number of grid points, 0 to use the number of
+     *  bins if the bin centers are uniform already (the resampling is
+     *  exact then) and four times as many points otherwise.
+     */
+    void buildUniformTable(int nGrid = 0);
+
+    //! Returns true if the uniform table is available
+    bool hasUniformTable() const;
+
   protected:
     //! Get the begin iterator for the CoG vector
     /*! This method is used to get an iterator corresponding to the
@@ -175,6 +213,9 @@ namespace eutelescope {
     std::vector<double>::const_iterator getEtaEndConstIterator() const;
 
   private:
+    //! Eta from the bin centers and values by binary search
+    double getEtaFromBins(double x) const;
+
     void getNFloat() { ; }
     void getFloatVal() { ; }
     void setFloatVal(unsigned int, float) { ; }
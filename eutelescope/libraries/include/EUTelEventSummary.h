@@ -0,0 +1,52 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELEVENTSUMMARY_H
+#define EUTELEVENTSUMMARY_H 1
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+
+// system includes <>
+#include <map>
+#include <string>
+
+namespace eutelescope {
+
+  //! Per sensor multiplicity of a collection, stored as event parameters
+  /*! The processors producing pixel or cluster collections store the
+   *  number of elements per sensor as two IntVec event parameters,
+   *  <tt>&lt;collection&gt;_SensorIDs</tt> and
+   *  <tt>&lt;collection&gt;_Counts</tt>. These summaries are written
+   *  into the LCIO file together with the event, so that a later job
+   *  can select events (see EUTelProcessorEventPreFilter) without
+   *  decoding the collections themselves.
+   */
+  namespace EventSummary {
+
+    //! Adds the per sensor counts to the summary of a collection
+    /*! Counts already stored for the collection, e.g. by another
+     *  processor appending to the same collection, are summed up.
+     */
+    void addCounts(EVENT::LCEvent *event, const std::string &collectionName,
+                   const std::map<int, int> &counts);
+
+    //! Reads the per sensor counts of a collection
+    /*! A summary without any sensor, e.g. of an empty collection, gives
+     *  empty counts.
+     *  @return False if the event has no summary for the collection
+     */
+    bool getCounts(const EVENT::LCEvent *event,
+                   const std::string &collectionName,
+                   std::map<int, int> &counts);
+
+  } // namespace EventSummary
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELFRAMECALIBRATOR_H
+#define EUTELFRAMECALIBRATOR_H 1
+
+// eutelescope includes ".h"
+#include "EUTelSeedFinder.h"
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Calibration and seed search of a full frame in a single pass
+  /*! Calibrates the raw ADC values of a full frame (NZS) sensor with
+   *  the same arithmetic of the EUTelCalibrateEventProcessor: pedestal
+   *  subtraction, followed by the optional full frame or row wise
+   *  common mode correction. The pixels with a signal above
+   *  HitRejectionCut times their noise and the pixels without the good
+   *  status are excluded from the common mode.
+   *
+   *  The frame is processed in blocks of rows small enough to stay in
+   *  the cache: each block is corrected and searched for seed
+   *  candidates (see EUTelSeedFinder) right after its pedestal
+   *  subtraction, instead of going through the whole frame once per
+   *  step. Only the full frame common mode needs a first pass over the
+   *  frame before the correction.
+   */
+  class EUTelFrameCalibrator {
+
+  public:
+    //! The common mode algorithms, as the PerformCommonMode parameter
+    enum CommonMode {
+      kNoCommonMode = 0,
+      kFullFrameCommonMode = 1,
+      kRowWiseCommonMode = 2
+    };
+
+    EUTelFrameCalibrator();
+
+    //! Sets the common mode algorithm
+    /*! @throw InvalidParameterException if the algorithm is unknown
+     */
+    void setCommonMode(int commonMode);
+
+    //! Sets the pixel SNR above which a pixel is rejected from the
+    //! common mode
+    void setHitRejectionCut(float hitRejectionCut) {
+      _hitRejectionCut = hitRejectionCut;
+    }
+
+    //! Sets the maximum number of rejected pixels of the full frame
+    //! common mode, -1 for no limit
+    void setMaxNoOfRejectedPixels(int maxNoOfRejectedPixels) {
+      _maxNoOfRejectedPixels = maxNoOfRejectedPixels;
+    }
+
+    //! Sets the maximum number of rejected pixels of a row for the row
+    //! wise common mode
+    void setMaxNoOfRejectedPixelPerRow(int maxNoOfRejectedPixelPerRow) {
+      _maxNoOfRejectedPixelPerRow = maxNoOfRejectedPixelPerRow;
+    }
+
+    //! Sets the maximum number of rows without common mode
+    void setMaxNoOfSkippedRow(int maxNoOfSkippedRow) {
+      _maxNoOfSkippedRow = maxNoOfSkippedRow;
+    }
+
+    //! Calibrates a frame and finds its seed candidates
+    /*! @param rawValues The raw ADC values, row after row
+     *  @param pedestal The pedestal of each pixel
+     *  @param noise The noise of each pixel
+     *  @param status The status of each pixel
+     *  @param noOfPixelsPerRow The length of a row
+     *  @param goodStatus The status of the pixels to be considered
+     *  @param seedCut The cut on the charge over noise ratio of a seed
+     *  @param charges Replaced by the calibrated charges
+     *  @param candidates Replaced by the seed candidates in increasing
+     *  pixel index
+     *  @return False if the common mode could not be computed, in which
+     *  case the event has to be skipped and the output is incomplete
+     *  @throw InvalidParameterException if the array sizes differ or
+     *  the frame is not made of full rows
+     */
+    bool calibrate(const std::vector<short> &rawValues,
+                   const std::vector<float> &pedestal,
+                   const std::vector<float> &noise,
+                   const std::vector<short> &status,
+                   std::size_t noOfPixelsPerRow, short goodStatus,
+                   float seedCut, std::vector<float> &charges,
+                   std::vector<EUTelSeedFinder::Candidate> &candidates);
+
+    //! Number of pixels rejected from the common mode by the last call
+    int getNoOfSkippedPixels() const { return _noOfSkippedPixels; }
+
+    //! Number of rows without common mode in the last call
+    int getNoOfSkippedRows() const { return _noOfSkippedRows; }
+
+  private:
+    //! Minimum number of pixels of a block of rows
+    static const std::size_t BLOCKSIZE = 4096;
+
+    //! Adds the pixels first ... last - 1 to the common mode sum
+    void addToCommonMode(const std::vector<float> &charges,
+                         const std::vector<float> &noise,
+                         const std::vector<short> &status, short goodStatus,
+                         std::size_t first, std::size_t last,
+                         double &pixelSum, int &goodPixel,
+                         int &skippedPixel) const;
+
+    int _commonMode;
+    float _hitRejectionCut;
+    int _maxNoOfRejectedPixels;
+    int _maxNoOfRejectedPixelPerRow;
+    int _maxNoOfSkippedRow;
+
+    int _noOfSkippedPixels;
+    int _noOfSkippedRows;
+
+    EUTelSeedFinder _seedFinder;
+  };
+
+} // namespace eutelescope
+
+#endif
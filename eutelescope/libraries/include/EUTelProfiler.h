@@ -0,0 +1,207 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPROFILER_H
+#define EUTELPROFILER_H 1
+
+// system includes <>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Timing and memory bookkeeping for a chain of Marlin processors
+  /*! Marlin does not offer any hook around the calls of the single
+   *  processors. The profiler therefore works with checkpoints: a
+   *  checkpoint is placed after each processor (or group of
+   *  processors) to be measured, and the resources used between a
+   *  checkpoint and the preceding one in the chain are attributed to
+   *  it. The first checkpoint of the chain measures everything between
+   *  the last checkpoint of the previous event and itself, i.e. the
+   *  reading of the event and the processors in front of it.
+   *
+   *  For every interval the wall clock time, the CPU time of the
+   *  process, the number of heap allocations and the growth of the
+   *  peak resident set size are recorded. Per checkpoint and stage
+   *  the profiler keeps running statistics, a logarithmic latency
+   *  histogram for the percentiles and a fixed size ring buffer with
+   *  the most recent intervals, used for the trace export.
+   *
+   *  Allocations are only counted if the library is compiled with
+   *  EUTEL_PROFILE_ALLOCATIONS. In this case the global operator new
+   *  of the library has to be used by the whole job, which for Marlin
+   *  means preloading the library with LD_PRELOAD.
+   *
+   *  The profiler is a singleton and not thread safe, it is meant to
+   *  be used from the Marlin thread only.
+   */
+  class EUTelProfiler {
+
+  public:
+    //! The processing stages which are distinguished
+    /*! Marlin calls processEvent and check of one processor right
+     *  after each other, so the two can't be separated and are
+     *  measured together as the event stage.
+     */
+    enum Stage { kEvent = 0, kEnd = 1, kNoOfStages = 2 };
+
+    //! Resource usage at a given moment
+    struct Snapshot {
+      //! Wall clock time since the creation of the profiler in us
+      double wall;
+      //! CPU time used by the process in us
+      double cpu;
+      //! Number of heap allocations, -1 if not counted
+      long long allocations;
+      //! Peak resident set size in kB
+      long peakRSS;
+    };
+
+    //! A single measured interval
+    struct Interval {
+      int run;
+      int event;
+      Stage stage;
+      //! Start of the interval since the creation of the profiler in us
+      double start;
+      //! Wall clock time in us
+      double wall;
+      //! CPU time in us
+      double cpu;
+      //! Number of heap allocations, -1 if not counted
+      long long allocations;
+      //! Growth of the peak resident set size in kB
+      long peakRSSGrowth;
+    };
+
+    //! Running statistics of one checkpoint in one stage
+    struct Statistics {
+      Statistics();
+
+      //! Adds an interval
+      void fill(const Interval &interval);
+
+      //! Returns the q-quantile of the wall clock time in us
+      /*! The value is the upper edge of the latency histogram bin
+       *  containing the quantile, i.e. it is accurate to about 25%.
+       */
+      double getWallQuantile(double q) const;
+
+      unsigned long long entries;
+      double sumWall;
+      double sumCpu;
+      double minWall;
+      double maxWall;
+      long long sumAllocations;
+      long sumPeakRSSGrowth;
+      //! Latency histogram of the wall clock time, see getBinEdge()
+      std::vector<unsigned long long> latency;
+    };
+
+    //! All information stored for one checkpoint
+    struct Checkpoint {
+      std::string label;
+      Statistics stats[kNoOfStages];
+      //! Intervals which couldn't be attributed, e.g. skipped events
+      unsigned long long dropped;
+      //! The most recent intervals, oldest first from ringNext
+      std::vector<Interval> ring;
+      std::size_t ringNext;
+      std::size_t ringCapacity;
+    };
+
+    //! Number of latency histogram bins per decade
+    static const int BINSPERDECADE = 10;
+
+    //! Number of latency histogram bins, from 1 us to 1000 s
+    static const int NOOFBINS = 9 * BINSPERDECADE;
+
+    //! Returns the lower edge of a latency histogram bin in us
+    /*! Bin 0 also collects everything below 1 us and the last bin
+     *  everything above its lower edge.
+     */
+    static double getBinEdge(int bin);
+
+    //! Returns the bin of the latency histogram for a time in us
+    static int findBin(double wall);
+
+    //! Returns the single instance
+    static EUTelProfiler &getInstance();
+
+    //! Takes a snapshot of the current resource usage
+    Snapshot takeSnapshot() const;
+
+    //! Adds a checkpoint at the end of the chain
+    /*! @param label The name under which the checkpoint is reported
+     *  @param ringCapacity The number of intervals kept for the trace
+     *  @return The position of the checkpoint in the chain
+     */
+    std::size_t addCheckpoint(const std::string &label,
+                              std::size_t ringCapacity);
+
+    //! Passes a checkpoint
+    /*! The interval since the previous checkpoint is attributed to
+     *  this one if the previous checkpoint is its predecessor in the
+     *  chain. Otherwise, e.g. if a processor skipped the rest of the
+     *  event, the interval is dropped.
+     *
+     *  @param interval Is set to the recorded interval
+     *  @return False if the interval was dropped
+     */
+    bool pass(std::size_t position, Stage stage, int run, int event,
+              Interval &interval);
+
+    //! Returns the number of checkpoints in the chain
+    std::size_t getNoOfCheckpoints() const { return _checkpoints.size(); }
+
+    //! Returns a checkpoint
+    const Checkpoint &getCheckpoint(std::size_t position) const {
+      return _checkpoints.at(position);
+    }
+
+    //! Prints the summary table for all checkpoints and stages
+    void printSummary(std::ostream &os) const;
+
+    //! Writes the intervals in the ring buffers as a Chrome trace
+    /*! The file uses the JSON trace event format understood by
+     *  chrome://tracing and the Perfetto UI. Every checkpoint is shown
+     *  as a separate track.
+     *
+     *  @throw eutelescope::InvalidParameterException if the file can't
+     *  be opened
+     */
+    void writeChromeTrace(const std::string &fileName) const;
+
+    //! Returns the name of the stage
+    static std::string getStageName(Stage stage);
+
+    //! Returns the number of allocations so far or -1 if not counted
+    static long long getAllocationCount();
+
+  private:
+    EUTelProfiler();
+    EUTelProfiler(const EUTelProfiler &) = delete;
+    EUTelProfiler &operator=(const EUTelProfiler &) = delete;
+
+    //! Monotonic clock at the creation of the profiler in us
+    double _origin;
+
+    //! The checkpoints in chain order
+    std::vector<Checkpoint> _checkpoints;
+
+    //! The previous checkpoint passed and the snapshot taken there
+    bool _hasPrevious;
+    std::size_t _previous;
+    Snapshot _previousSnapshot;
+  };
+
+} // namespace eutelescope
+
+#endif
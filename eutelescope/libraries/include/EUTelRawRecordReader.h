@@ -0,0 +1,207 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELRAWRECORDREADER_H
+#define EUTELRAWRECORDREADER_H 1
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Buffered reader for binary raw data files
+  /*! Several converters (AlibavaConverter, Ph2ACF2LCIOConverter, ...)
+   *  decode binary files made of a file header followed by a sequence
+   *  of records. Reading those with many small std::ifstream::read
+   *  calls is dominated by the per call overhead.
+   *
+   *  This reader fetches the file in large, page aligned blocks using
+   *  pread. Optionally a prefetch thread keeps a ring of blocks filled
+   *  ahead of the consumer, so that disk I/O overlaps with the
+   *  creation of the LCIO events on the Marlin thread. The consumer
+   *  side is a simple sequential stream with read/skip/seek.
+   *
+   *  The reader also carries the byte range [first, last) a converter
+   *  was asked to process. Only records starting inside this range
+   *  should be converted, so that a large run can be split into
+   *  several independent conversion jobs whose outputs are
+   *  concatenated afterwards. The records themselves may extend past
+   *  the end of the range.
+   *
+   *  This class is not thread safe: only one consumer thread is
+   *  allowed.
+   */
+  class EUTelRawRecordReader {
+
+  public:
+    //! Default block size in bytes
+    static const std::size_t DEFAULTBLOCKSIZE = 4 * 1024 * 1024;
+
+    //! Default number of blocks in the prefetch ring
+    static const std::size_t DEFAULTNOOFBLOCKS = 4;
+
+    //! Constructor
+    /*! @param blockSize The size of a single read, rounded up to a
+     *  multiple of the page size
+     *  @param noOfBlocks The number of blocks in the prefetch ring
+     *  @param prefetch If true, a background thread reads ahead
+     */
+    EUTelRawRecordReader(std::size_t blockSize = DEFAULTBLOCKSIZE,
+                         std::size_t noOfBlocks = DEFAULTNOOFBLOCKS,
+                         bool prefetch = true);
+
+    //! Destructor, closes the file and stops the prefetch thread
+    ~EUTelRawRecordReader();
+
+    EUTelRawRecordReader(const EUTelRawRecordReader &) = delete;
+    EUTelRawRecordReader &operator=(const EUTelRawRecordReader &) = delete;
+
+    //! Open a file
+    /*! The stream is positioned at the beginning of the file, also
+     *  when a byte range is given, since the file header always has
+     *  to be decoded.
+     *
+     *  @param fileName The input file
+     *  @param first First byte of the range to be converted
+     *  @param last One past the last byte of the range, a negative
+     *  value means the end of the file
+     *
+     *  @throw lcio::IOException if the file cannot be opened
+     *  @throw InvalidParameterException if the range is inconsistent
+     */
+    void open(const std::string &fileName, std::int64_t first = 0,
+              std::int64_t last = -1);
+
+    //! Close the file
+    void close();
+
+    //! True if a file is currently open
+    bool isOpen() const { return _fd >= 0; }
+
+    //! Read @c n bytes into @c dest
+    /*! @return False if the end of the file was reached before @c n
+     *  bytes could be read. In this case the content of @c dest is
+     *  undefined.
+     */
+    bool read(void *dest, std::size_t n);
+
+    //! Read a trivially copyable value in native byte order
+    template <typename T> bool read(T &value) {
+      return read(&value, sizeof(T));
+    }
+
+    //! Skip @c n bytes
+    bool skip(std::size_t n);
+
+    //! Move to an absolute position in the file
+    /*! The prefetch ring is discarded and restarted from the block
+     *  containing @c offset.
+     */
+    void seek(std::int64_t offset);
+
+    //! The current position in the file
+    std::int64_t tell() const { return _position; }
+
+    //! True if the last read hit the end of the file
+    bool eof() const { return _eof; }
+
+    //! The size of the open file
+    std::int64_t getFileSize() const { return _fileSize; }
+
+    //! First byte of the selected range
+    std::int64_t getRangeBegin() const { return _rangeBegin; }
+
+    //! One past the last byte of the selected range
+    std::int64_t getRangeEnd() const { return _rangeEnd; }
+
+    //! True if a record starting at @c offset belongs to the range
+    bool isInRange(std::int64_t offset) const {
+      return offset >= _rangeBegin && offset < _rangeEnd;
+    }
+
+    //! First record boundary inside the range
+    /*! For files made of fixed length records following a header, this
+     *  returns the offset of the first record starting at or after the
+     *  beginning of the range.
+     *
+     *  @param dataStart Offset of the first record in the file
+     *  @param recordLength Length of every record in bytes
+     */
+    std::int64_t firstRecordInRange(std::int64_t dataStart,
+                                    std::int64_t recordLength) const;
+
+    //! Parse a byte range given as processor parameter
+    /*! The range is given as up to two numbers, the first and one
+     *  past the last byte. Strings are used since processor integer
+     *  parameters are only 32 bits wide. An empty vector selects the
+     *  whole file.
+     *
+     *  @throw InvalidParameterException if the range cannot be parsed
+     */
+    static void parseByteRange(const std::vector<std::string> &range,
+                               std::int64_t &first, std::int64_t &last);
+
+  private:
+    //! One block of the prefetch ring
+    struct Block {
+      char *data;
+      std::size_t size;
+      std::int64_t offset;
+    };
+
+    //! Read a full block at the given offset, returns the bytes read
+    std::size_t fillBlock(Block &block, std::int64_t offset);
+
+    //! Move the consumer to the next block, false at end of file
+    bool nextBlock();
+
+    //! Body of the prefetch thread
+    void prefetchLoop();
+
+    //! (Re)start reading at the block containing @c offset
+    void startReading(std::int64_t offset);
+
+    //! Stop the prefetch thread and empty the ring
+    void stopReading();
+
+    std::string _fileName;
+    int _fd;
+    std::int64_t _fileSize;
+    std::int64_t _rangeBegin;
+    std::int64_t _rangeEnd;
+
+    std::size_t _blockSize;
+    bool _prefetch;
+    std::vector<Block> _ring;
+
+    //! Ring state shared with the prefetch thread
+    std::size_t _head;
+    std::size_t _tail;
+    std::size_t _filled;
+    std::int64_t _readOffset;
+    bool _producerDone;
+    bool _stop;
+    int _readErrno;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::thread _thread;
+
+    //! Consumer state
+    bool _haveCurrent;
+    std::size_t _pos;
+    std::int64_t _position;
+    bool _eof;
+  };
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSEEDFINDER_H
+#define EUTELSEEDFINDER_H 1
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Seed pixel search of the full frame (NZS) clustering
+  /*! A seed candidate is a good pixel with a charge above seedCut
+   *  times its noise. The search over the full frame is done in two
+   *  passes over blocks of pixels: a branch free comparison of the
+   *  charge, noise and status arrays into a flag array, which the
+   *  compiler vectorises, followed by a stream compaction which skips
+   *  the blocks without candidates eight flags at a time.
+   *
+   *  The candidates are then taken by decreasing charge (and decreasing
+   *  pixel index for equal charges) from a heap, so that only the
+   *  candidates actually needed are ordered.
+   */
+  class EUTelSeedFinder {
+
+  public:
+    //! A seed candidate: the charge and the pixel index
+    typedef std::pair<float, unsigned int> Candidate;
+
+    EUTelSeedFinder();
+
+    //! Replaces the candidates by the seed candidates of a frame
+    /*! @param charges The calibrated charge of each pixel
+     *  @param noise The noise of each pixel
+     *  @param status The status of each pixel
+     *  @param goodStatus The status of the pixels to be considered
+     *  @param seedCut The cut on the charge over noise ratio
+     *  @param candidates The candidates in increasing pixel index
+     *  @throw InvalidParameterException if the array sizes differ
+     */
+    void findCandidates(const std::vector<float> &charges,
+                        const std::vector<float> &noise,
+                        const std::vector<short> &status, short goodStatus,
+                        float seedCut, std::vector<Candidate> &candidates);
+
+    //! Appends the seed candidates among the pixels first ... last - 1
+    /*! Used to search a frame block by block while it is produced,
+     *  e.g. by EUTelFrameCalibrator. The parameters are the ones of
+     *  findCandidates.
+     *  @throw InvalidParameterException if the array sizes differ or
+     *  the range is outside of the arrays
+     */
+    void appendCandidates(const std::vector<float> &charges,
+                          const std::vector<float> &noise,
+                          const std::vector<short> &status, short goodStatus,
+                          float seedCut, std::size_t first, std::size_t last,
+                          std::vector<Candidate> &candidates);
+
+    //! Arranges the candidates for popCandidate
+    static void orderCandidates(std::vector<Candidate> &candidates);
+
+    //! Removes and returns the candidate with the largest charge
+    /*! The candidates must have been arranged with orderCandidates
+     *  and must not be empty.
+     */
+    static Candidate popCandidate(std::vector<Candidate> &candidates);
+
+  private:
+    //! Number of pixels compared at once
+    static const std::size_t BLOCKSIZE = 256;
+
+    //! The comparison result of a block, one byte per pixel
+    std::vector<unsigned char> _flags;
+  };
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTelStraightLineGBLFitter_h
+#define EUTelStraightLineGBLFitter_h 1
+
+// Eigen include
+#include <Eigen/Core>
+
+// system includes <>
+#include <array>
+#include <cstddef>
+#include <map>
+
+namespace eutelescope {
+
+  //! General Broken Lines fit of a straight line with a fixed topology
+  /*! For a track without curvature and with measurement and
+   *  scattering precisions which are diagonal in the local x and y
+   *  directions, the GBL fit decouples into two independent fits, one
+   *  per projection. The fit parameters are the track offsets u_i at
+   *  the NPOINTS points of the trajectory, which are connected by
+   *  straight line steps. The chi2 is
+   *
+   *    sum_i w_i (m_i - u_i)^2 + sum_{0<i<N-1} p_i k_i^2
+   *
+   *  with the measurements m_i of precision w_i and the kinks
+   *  k_i = (u_{i+1}-u_i)/ds_i - (u_i-u_{i-1})/ds_{i-1} at the interior
+   *  points, where p_i is the scattering precision. As in GBL,
+   *  scatterers at the first and the last point are ignored. This is
+   *  exactly the linear problem gbl::GblTrajectory solves for this
+   *  case, so the results agree with GBL up to rounding.
+   *
+   *  The steps and scattering precisions are fixed when the fitter is
+   *  created, so the kink part of the (pentadiagonal) normal matrix is
+   *  built once. The banded Cholesky factorisation and the offset
+   *  variances only depend on the measurement precisions in addition.
+   *  They are cached per precision pattern, so that for the usual
+   *  small set of cluster size dependent resolutions only the right
+   *  hand side changes from track to track.
+   *
+   *  A point without measurement has precision zero.
+   */
+  template <int NPOINTS> class EUTelStraightLineGBLFitter {
+
+  public:
+    static_assert(NPOINTS >= 3, "A broken line needs at least three points");
+
+    typedef std::array<double, NPOINTS> PointArray;
+    typedef std::array<Eigen::Vector2d, NPOINTS> PointVector2dArray;
+
+    //! The result of a single fit
+    /*! The variances refer to the cache of the fitter, a result is
+     *  only valid until the next fit.
+     */
+    class Result {
+    public:
+      //! Returns the fitted offset at a point in projection 0 (x) or 1 (y)
+      double getOffset(int point, int proj) const {
+        return _offset[proj][point];
+      }
+
+      //! Returns the fitted slope after a point
+      /*! At the last point this is the slope in front of it. This is
+       *  the slope GBL reports for a positive point label.
+       */
+      double getSlope(int point, int proj) const;
+
+      //! Returns the variance of the fitted offset at a point
+      double getOffsetVariance(int point, int proj) const {
+        return _variance[proj][point];
+      }
+
+      //! Returns the residual measurement - offset at a point
+      double getMeasResidual(int point, int proj) const {
+        return _meas[proj][point] - _offset[proj][point];
+      }
+
+      //! Returns the error of the measurement residual at a point
+      /*! As in GBL this is sqrt(1/w - V(u)) and is used for the pulls.
+       *  Zero for points without measurement.
+       */
+      double getMeasResidualError(int point, int proj) const;
+
+      //! Returns the kink residual (0 - fitted kink) at a point
+      /*! Zero at the first and the last point, where scatterers are
+       *  ignored.
+       */
+      double getKinkResidual(int point, int proj) const;
+
+      double getChi2() const { return _chi2; }
+      int getNdf() const { return _ndf; }
+
+    private:
+      friend class EUTelStraightLineGBLFitter<NPOINTS>;
+
+      PointArray _offset[2];
+      PointArray _meas[2];
+      PointArray _prec[2];
+      const PointArray *_variance;
+      const PointArray *_invStep;
+      double _chi2;
+      int _ndf;
+    };
+
+    //! Constructor
+    /*! @param steps The distances between consecutive points, all of
+     *  them have to be positive
+     *  @param scatPrecision The x and y scattering precisions at each
+     *  point, the first and last entry are not used
+     *  @throw eutelescope::InvalidParameterException if a step is not
+     *  positive
+     */
+    EUTelStraightLineGBLFitter(const std::array<double, NPOINTS - 1> &steps,
+                               const PointVector2dArray &scatPrecision);
+
+    //! Fits one track
+    /*! @param meas The x and y measurements at each point, local to
+     *  the reference trajectory
+     *  @param measPrecision The x and y precisions of the measurements,
+     *  zero for points without measurement
+     *  @param result Filled with the fit result
+     *  @return False if the normal matrix is not positive definite,
+     *  e.g. if a projection has less than two measurements
+     */
+    bool fit(const PointVector2dArray &meas,
+             const PointVector2dArray &measPrecision, Result &result);
+
+    //! Returns the number of cached factorisations
+    std::size_t getCacheSize() const { return _cache.size(); }
+
+    //! Maximal number of cached factorisations, the cache is emptied
+    //! if it grows beyond
+    static const std::size_t MAXCACHESIZE = 1024;
+
+  private:
+    //! The banded Cholesky factor L of both projections and the
+    //! diagonal of the inverse normal matrix
+    struct Factorisation {
+      bool valid;
+      PointArray l0[2];
+      PointArray l1[2];
+      PointArray l2[2];
+      PointArray variance[2];
+    };
+
+    typedef std::array<double, 2 * NPOINTS> PrecisionKey;
+
+    const Factorisation &factorise(const PointVector2dArray &measPrecision);
+
+    void solve(const Factorisation &fac, int proj, PointArray &x) const;
+
+    //! 1/ds for the steps
+    PointArray _invStep;
+
+    //! Kink part of the normal matrix, diagonal and sub diagonals
+    PointArray _kinkDiag[2];
+    PointArray _kinkSub1[2];
+    PointArray _kinkSub2[2];
+
+    //! The scattering precisions
+    PointArray _scatPrec[2];
+
+    std::map<PrecisionKey, Factorisation> _cache;
+
+    //! The factorisation of the previous fit and its key
+    const Factorisation *_last;
+    PrecisionKey _lastKey;
+  };
+
+} // namespace eutelescope
+
+#include "EUTelStraightLineGBLFitter.tcc"
+
+#endif
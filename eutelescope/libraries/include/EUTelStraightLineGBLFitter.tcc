@@ -0,0 +1,232 @@
+#ifndef EUTelStraightLineGBLFitter_tcc
+#define EUTelStraightLineGBLFitter_tcc
+
+// eutelescope includes ".h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <cmath>
+#include <sstream>
+
+namespace eutelescope {
+
+template <int NPOINTS>
+double
+EUTelStraightLineGBLFitter<NPOINTS>::Result::getSlope(int point,
+                                                      int proj) const {
+  int i = (point < NPOINTS - 1) ? point : point - 1;
+  return (_offset[proj][i + 1] - _offset[proj][i]) * (*_invStep)[i];
+}
+
+template <int NPOINTS>
+double EUTelStraightLineGBLFitter<NPOINTS>::Result::getMeasResidualError(
+    int point, int proj) const {
+  if (_prec[proj][point] <= 0.) {
+    return 0.;
+  }
+  double var = 1. / _prec[proj][point] - _variance[proj][point];
+  return (var > 0.) ? std::sqrt(var) : 0.;
+}
+
+template <int NPOINTS>
+double
+EUTelStraightLineGBLFitter<NPOINTS>::Result::getKinkResidual(int point,
+                                                             int proj) const {
+  if (point <= 0 || point >= NPOINTS - 1) {
+    return 0.;
+  }
+  const PointArray &u = _offset[proj];
+  double kink = (u[point + 1] - u[point]) * (*_invStep)[point] -
+                (u[point] - u[point - 1]) * (*_invStep)[point - 1];
+  return -kink;
+}
+
+template <int NPOINTS>
+EUTelStraightLineGBLFitter<NPOINTS>::EUTelStraightLineGBLFitter(
+    const std::array<double, NPOINTS - 1> &steps,
+    const PointVector2dArray &scatPrecision)
+    : _invStep(), _kinkDiag(), _kinkSub1(), _kinkSub2(), _scatPrec(),
+      _cache(), _last(nullptr), _lastKey() {
+
+  _invStep.fill(0.);
+  for (int i = 0; i < NPOINTS - 1; ++i) {
+    if (!(steps[i] > 0.)) {
+      std::stringstream ss;
+      ss << "EUTelStraightLineGBLFitter: step " << i << " is " << steps[i]
+         << ", all steps between points have to be positive";
+      throw InvalidParameterException(ss.str());
+    }
+    _invStep[i] = 1. / steps[i];
+  }
+
+  // the kink at point i is a u_{i-1} + b u_i + c u_{i+1}, its
+  // contribution to the normal matrix is p g g^T with g = (a, b, c)
+  for (int proj = 0; proj < 2; ++proj) {
+    _kinkDiag[proj].fill(0.);
+    _kinkSub1[proj].fill(0.);
+    _kinkSub2[proj].fill(0.);
+    _scatPrec[proj].fill(0.);
+    for (int i = 1; i < NPOINTS - 1; ++i) {
+      double p = scatPrecision[i][proj];
+      if (p <= 0.) {
+        continue;
+      }
+      _scatPrec[proj][i] = p;
+      double a = _invStep[i - 1];
+      double c = _invStep[i];
+      double b = -(a + c);
+      _kinkDiag[proj][i - 1] += p * a * a;
+      _kinkDiag[proj][i] += p * b * b;
+      _kinkDiag[proj][i + 1] += p * c * c;
+      _kinkSub1[proj][i] += p * b * a;
+      _kinkSub1[proj][i + 1] += p * c * b;
+      _kinkSub2[proj][i + 1] += p * c * a;
+    }
+  }
+}
+
+template <int NPOINTS>
+const typename EUTelStraightLineGBLFitter<NPOINTS>::Factorisation &
+EUTelStraightLineGBLFitter<NPOINTS>::factorise(
+    const PointVector2dArray &measPrecision) {
+
+  PrecisionKey key;
+  for (int i = 0; i < NPOINTS; ++i) {
+    key[2 * i] = measPrecision[i][0];
+    key[2 * i + 1] = measPrecision[i][1];
+  }
+
+  // consecutive tracks very often share the pattern
+  if (_last && key == _lastKey) {
+    return *_last;
+  }
+
+  auto it = _cache.find(key);
+  if (it == _cache.end()) {
+    if (_cache.size() >= MAXCACHESIZE) {
+      _cache.clear();
+      _last = nullptr;
+    }
+    Factorisation &fac = _cache[key];
+    fac.valid = true;
+
+    for (int proj = 0; proj < 2 && fac.valid; ++proj) {
+      PointArray &l0 = fac.l0[proj];
+      PointArray &l1 = fac.l1[proj];
+      PointArray &l2 = fac.l2[proj];
+      l0.fill(0.);
+      l1.fill(0.);
+      l2.fill(0.);
+
+      for (int i = 0; i < NPOINTS; ++i) {
+        if (i >= 2) {
+          l2[i] = _kinkSub2[proj][i] / l0[i - 2];
+        }
+        if (i >= 1) {
+          l1[i] = (_kinkSub1[proj][i] - ((i >= 2) ? l2[i] * l1[i - 1] : 0.)) /
+                  l0[i - 1];
+        }
+        double d = _kinkDiag[proj][i] + measPrecision[i][proj] -
+                   l1[i] * l1[i] - l2[i] * l2[i];
+        if (!(d > 0.)) {
+          fac.valid = false;
+          break;
+        }
+        l0[i] = std::sqrt(d);
+      }
+    }
+
+    // diagonal of the inverse, column by column
+    for (int proj = 0; proj < 2 && fac.valid; ++proj) {
+      for (int i = 0; i < NPOINTS; ++i) {
+        PointArray column;
+        column.fill(0.);
+        column[i] = 1.;
+        solve(fac, proj, column);
+        fac.variance[proj][i] = column[i];
+      }
+    }
+    it = _cache.find(key);
+  }
+
+  _last = &it->second;
+  _lastKey = key;
+  return it->second;
+}
+
+template <int NPOINTS>
+void EUTelStraightLineGBLFitter<NPOINTS>::solve(const Factorisation &fac,
+                                                int proj, PointArray &x) const {
+  const PointArray &l0 = fac.l0[proj];
+  const PointArray &l1 = fac.l1[proj];
+  const PointArray &l2 = fac.l2[proj];
+
+  // L y = b
+  for (int i = 0; i < NPOINTS; ++i) {
+    double sum = x[i];
+    if (i >= 1) {
+      sum -= l1[i] * x[i - 1];
+    }
+    if (i >= 2) {
+      sum -= l2[i] * x[i - 2];
+    }
+    x[i] = sum / l0[i];
+  }
+  // L^T x = y
+  for (int i = NPOINTS - 1; i >= 0; --i) {
+    double sum = x[i];
+    if (i + 1 < NPOINTS) {
+      sum -= l1[i + 1] * x[i + 1];
+    }
+    if (i + 2 < NPOINTS) {
+      sum -= l2[i + 2] * x[i + 2];
+    }
+    x[i] = sum / l0[i];
+  }
+}
+
+template <int NPOINTS>
+bool EUTelStraightLineGBLFitter<NPOINTS>::fit(
+    const PointVector2dArray &meas, const PointVector2dArray &measPrecision,
+    Result &result) {
+
+  const Factorisation &fac = factorise(measPrecision);
+  if (!fac.valid) {
+    return false;
+  }
+
+  result._invStep = &_invStep;
+  result._variance = fac.variance;
+  result._chi2 = 0.;
+  result._ndf = 0;
+
+  for (int proj = 0; proj < 2; ++proj) {
+    PointArray &u = result._offset[proj];
+    for (int i = 0; i < NPOINTS; ++i) {
+      result._meas[proj][i] = meas[i][proj];
+      result._prec[proj][i] = measPrecision[i][proj];
+      u[i] = measPrecision[i][proj] * meas[i][proj];
+    }
+    solve(fac, proj, u);
+
+    for (int i = 0; i < NPOINTS; ++i) {
+      double w = measPrecision[i][proj];
+      if (w > 0.) {
+        double r = meas[i][proj] - u[i];
+        result._chi2 += w * r * r;
+        ++result._ndf;
+      }
+      if (_scatPrec[proj][i] > 0.) {
+        double k = result.getKinkResidual(i, proj);
+        result._chi2 += _scatPrec[proj][i] * k * k;
+        ++result._ndf;
+      }
+    }
+    result._ndf -= NPOINTS;
+  }
+  return true;
+}
+
+} // namespace eutelescope
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSYNTHETICEVENTGENERATOR_H
+#define EUTELSYNTHETICEVENTGENERATOR_H 1
+
+// eigen includes <>
+#include <Eigen/Core>
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Fast generator of synthetic telescope events
+  /*! The generator produces the fired pixels of a set of planes for
+   *  straight tracks with multiple scattering, without any external
+   *  simulation. It is meant to produce large, reproducible data sets
+   *  for load and regression tests of the reconstruction.
+   *
+   *  For every event:
+   *  - the number of tracks is Poisson distributed. The tracks start
+   *    along the z axis with a Gaussian beam spot and divergence;
+   *  - each track is intersected with the planes ordered in z and
+   *    scattered at each plane, with the Highland width for its
+   *    material budget;
+   *  - the charge is shared between the pixels around the impact
+   *    point with a Gaussian charge cloud, and a pixel fires if its
+   *    charge is at least the threshold;
+   *  - noise pixels are added with the given occupancy, the hot
+   *    pixels always fire and the dead pixels never do.
+   *
+   *  The hot and dead pixels are chosen once, from the seed. The
+   *  random engine is reseeded from the seed and the event number at
+   *  every event, so an event only depends on these two numbers and
+   *  a data set can be produced in independent parts.
+   *
+   *  The local pixel centres are at ((i + 0.5) * pitchX - sizeX / 2,
+   *  (j + 0.5) * pitchY - sizeY / 2), where the size is the number of
+   *  pixels times the pitch.
+   */
+  class EUTelSyntheticEventGenerator {
+
+  public:
+    //! Description of one plane
+    struct Plane {
+      int sensorID;
+      //! Global position of the local origin in mm
+      Eigen::Vector3d origin;
+      //! Global directions of the local axes
+      Eigen::Vector3d xAxis;
+      Eigen::Vector3d yAxis;
+      Eigen::Vector3d normal;
+      int noOfPixelsX;
+      int noOfPixelsY;
+      //! Pitches in mm
+      double pitchX;
+      double pitchY;
+      //! Thickness over radiation length at normal incidence
+      double materialBudget;
+    };
+
+    //! Settings of the generator
+    struct Settings {
+      //! Beam momentum in GeV
+      double beamEnergy = 5.;
+      //! Mean number of tracks per event
+      double tracksPerEvent = 1.;
+      //! Beam spot sigma along x and y in mm
+      double beamSpotX = 3.;
+      double beamSpotY = 3.;
+      //! Beam divergence sigma in rad
+      double beamDivergence = 1e-4;
+      bool multipleScattering = true;
+      //! Charge cloud sigma in mm
+      double chargeSigma = 0.005;
+      //! Charge of a track, in the units of the threshold
+      double clusterCharge = 1000.;
+      double threshold = 100.;
+      //! Probability of a noise hit per pixel and event
+      double noiseOccupancy = 0.;
+      double hotPixelFraction = 0.;
+      double deadPixelFraction = 0.;
+      std::uint64_t seed = 4357;
+    };
+
+    //! A fired pixel
+    struct Pixel {
+      short x;
+      short y;
+      float signal;
+    };
+
+    //! Constructor
+    /*! @throw InvalidParameterException if there are no planes, or a
+     *  plane or a setting is not valid
+     */
+    EUTelSyntheticEventGenerator(std::vector<Plane> planes,
+                                 const Settings &settings);
+
+    //! Returns the planes of the given sensors from the geometry
+    /*! The telescope geometry has to be initialised.
+     */
+    static std::vector<Plane>
+    getGeometryPlanes(const std::vector<int> &sensorIDs);
+
+    //! Generates an event
+    void generate(std::uint64_t eventNumber);
+
+    //! Returns the number of planes
+    std::size_t getNoOfPlanes() const { return _planes.size(); }
+
+    //! Returns a plane, ordered in z
+    const Plane &getPlane(std::size_t plane) const { return _planes.at(plane); }
+
+    //! Returns the fired pixels of a plane in the last event
+    /*! The pixels are ordered by row and column.
+     */
+    const std::vector<Pixel> &getPixels(std::size_t plane) const {
+      return _pixels.at(plane);
+    }
+
+    //! Returns the number of tracks of the last event
+    std::size_t getNoOfTracks() const { return _noOfTracks; }
+
+    //! Returns the hot pixels of a plane, as y * noOfPixelsX + x
+    const std::vector<int> &getHotPixels(std::size_t plane) const {
+      return _hotPixels.at(plane);
+    }
+
+  private:
+    //! Adds the charge cloud of a track at local (u, v)
+    void depositCharge(std::size_t plane, double u, double v);
+
+    //! Applies the multiple scattering of a plane to the direction
+    void scatter(const Plane &plane, Eigen::Vector3d &direction);
+
+    std::vector<Plane> _planes;
+    Settings _settings;
+
+    //! Fraction of the charge in the pixels around the seed
+    std::vector<double> _shareX;
+    std::vector<double> _shareY;
+
+    //! Dead pixel flags per plane, y * noOfPixelsX + x
+    std::vector<std::vector<unsigned char>> _deadPixels;
+    std::vector<std::vector<int>> _hotPixels;
+
+    //! Charge per pixel index before the threshold, per plane
+    std::vector<std::vector<std::pair<int, float>>> _charges;
+    std::vector<std::vector<Pixel>> _pixels;
+    std::size_t _noOfTracks;
+
+    std::mt19937_64 _engine;
+  };
+
+} // namespace eutelescope
+
+#endif
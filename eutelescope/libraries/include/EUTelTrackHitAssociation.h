@@ -0,0 +1,148 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRACKHITASSOCIATION_H
+#define EUTELTRACKHITASSOCIATION_H 1
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Association of track impact points to the hits on a DUT
+  /*! The hits of an event are sorted into a grid of square cells with
+   *  the size of the association window, so that the hits which can
+   *  be associated to a track are found by looking at the 3x3 cells
+   *  around the track instead of at all hits. Building the grid is
+   *  O(N log N), a lookup O(log N) plus the number of close hits.
+   *
+   *  A track and a hit can be associated if their distance is within
+   *  the window, either a circle (dx^2 + dy^2 < window^2) or a box
+   *  (|dx| < window and |dy| < window).
+   *
+   *  Two strategies are provided:
+   *  - associateGreedy() lets the tracks take their closest free hit,
+   *    one after the other. The result depends on the order of the
+   *    tracks. findClosestFreeHit() and setUsed() allow processors to
+   *    do the same with their own bookkeeping.
+   *  - associateOptimal() maximises the number of associated tracks
+   *    and then minimises the sum of the distances. The tracks and
+   *    hits are split into groups which share candidates, and each
+   *    group with more than one track and hit is solved with the
+   *    Hungarian algorithm. The groups are small unless the track
+   *    density is of the order of one per window.
+   *  - associateUniqueFirst() first associates the tracks with a single
+   *    candidate, then runs the greedy association over the orderings
+   *    of the remaining tracks. This is the association of
+   *    EUTelProcessorAnalysisPALPIDEfs, its result can differ from the
+   *    optimal one in ambiguous events.
+   *
+   *  Hits with equal distance are resolved in favour of the lower
+   *  index.
+   */
+  class EUTelTrackHitAssociation {
+
+  public:
+    //! Shapes of the association window
+    enum Window { kCircle, kBox };
+
+    //! Constructor
+    /*! @param window The radius or half width of the window
+     *  @param shape The shape of the window
+     *  @throw InvalidParameterException if the window is not positive
+     */
+    explicit EUTelTrackHitAssociation(double window, Window shape = kCircle);
+
+    //! Sets the hits of the event, all hits are free
+    void setHits(const std::vector<double> &hitX,
+                 const std::vector<double> &hitY);
+
+    //! Returns the number of hits
+    std::size_t getNoOfHits() const { return _hitX.size(); }
+
+    //! Returns the closest free hit within the window, or -1
+    /*! @param dist2 Set to the squared distance of the hit
+     */
+    int findClosestFreeHit(double x, double y, double &dist2) const;
+
+    //! Marks a hit as used or free
+    void setUsed(std::size_t hit, bool used = true) { _used.at(hit) = used; }
+
+    //! Returns true if the hit is used
+    bool isUsed(std::size_t hit) const { return _used.at(hit); }
+
+    //! Associates the tracks in their order with the closest free hit
+    /*! The associated hits are marked as used.
+     *  @return For every track the index of its hit or -1
+     */
+    std::vector<int> associateGreedy(const std::vector<double> &trackX,
+                                     const std::vector<double> &trackY);
+
+    //! Associates as many tracks as possible with the smallest total
+    //! distance
+    /*! Only free hits are considered, the associated hits are marked
+     *  as used.
+     *  @return For every track the index of its hit or -1
+     */
+    std::vector<int> associateOptimal(const std::vector<double> &trackX,
+                                      const std::vector<double> &trackY);
+
+    //! Associates the tracks with a single candidate first
+    /*! A track with exactly one free hit in its window takes it, which
+     *  is repeated until no such track is left. For the other tracks
+     *  with candidates, the greedy association is run for every
+     *  ordering, keeping the one with most pairs and then the smallest
+     *  total distance. The search stops at the first ordering which
+     *  associates all of them, and orderings are abandoned as soon as
+     *  they cannot be better than the best one so far.
+     *
+     *  Only free hits are considered, the associated hits are marked
+     *  as used. The number of orderings grows with the factorial of
+     *  the ambiguous tracks.
+     *  @return For every track the index of its hit or -1
+     */
+    std::vector<int> associateUniqueFirst(const std::vector<double> &trackX,
+                                          const std::vector<double> &trackY);
+
+  private:
+    struct Cell {
+      long long x;
+      long long y;
+      std::size_t hit;
+    };
+
+    //! Returns true if a hit at (dx, dy) from a track is inside the window
+    bool inWindow(double dx, double dy) const;
+
+    long long cellIndex(double pos) const;
+
+    //! Calls f(hit) for all free hits within the window
+    template <class F> void forEachCandidate(double x, double y, F f) const;
+
+    //! Solves the assignment of a group of tracks and hits
+    void solveGroup(const std::vector<std::size_t> &tracks,
+                    const std::vector<std::size_t> &hits,
+                    const std::vector<double> &trackX,
+                    const std::vector<double> &trackY,
+                    std::vector<int> &result);
+
+    double _window;
+    Window _shape;
+
+    std::vector<double> _hitX;
+    std::vector<double> _hitY;
+    std::vector<bool> _used;
+
+    //! The hits sorted by cell
+    std::vector<Cell> _cells;
+  };
+
+} // namespace eutelescope
+
+#endif
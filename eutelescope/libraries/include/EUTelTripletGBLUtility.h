@@ -81,6 +81,11 @@ namespace eutelescope {
 	parent = par;
       };
 
+      //! Books the histograms of the parent
+      /*! Without booked histograms, MatchTriplets and
+       *  IsTripletIsolated do not fill any, so the utility can be used
+       *  outside of a processor.
+       */
       void bookHistos();
 
       class hit {
@@ -339,6 +344,9 @@ namespace eutelescope {
 
       AIDA::IHistogram1D * triddaMindutHisto;
 
+      //! Whether bookHistos was called
+      bool _histosBooked;
+
 
   };
 
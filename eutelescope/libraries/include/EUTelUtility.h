@@ -27,6 +27,7 @@
 
 // system includes <>
 #include <iomanip>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -191,6 +192,28 @@ namespace eutelescope {
     std::unique_ptr<EUTelTrackerDataInterfacer>
     getSparseData(IMPL::TrackerDataImpl *const data, int type);
 
+    /*! Groups sparse pixels into clusters of neighbours. Two pixels are
+     *  neighbours if their squared distance in pixel indices is at most
+     *  maxDistanceSquared. A cluster is seeded with the first pixel not
+     *  yet clustered and grown pixel by pixel, the clusters and their
+     *  pixels are returned in this order. This is the clustering of
+     *  EUTelProcessorSparseClustering.
+     */
+    std::vector<std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>>>
+    findSparseClusters(
+        std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> pixels,
+        int maxDistanceSquared);
+
+    /*! Groups geometric pixels into clusters of touching pixels, with
+     *  the same ordering as findSparseClusters. Two pixels touch if the
+     *  distance of their centres is within the sum of their half sizes
+     *  (plus 1% for the precision of the geometry) along x and y, and
+     *  their time difference is at most cutT. This is the clustering of
+     *  EUTelProcessorGeometricClustering.
+     */
+    std::vector<std::vector<EUTelGeometricPixel>>
+    findGeometricClusters(std::vector<EUTelGeometricPixel> pixels, float cutT);
+
     std::map<std::string, bool>
     FillHotPixelMap(EVENT::LCEvent *event,
                     const std::string &hotPixelCollectionName);
@@ -0,0 +1,93 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELWORKERPOOL_H
+#define EUTELWORKERPOOL_H 1
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! A fixed set of threads for data parallel loops inside a processor
+  /*! Marlin calls the processors from a single thread. Processors with
+   *  independent and expensive work items inside an event, e.g. track
+   *  fits, can use this pool to spread them over several cores without
+   *  creating threads for each event.
+   *
+   *  The assignment of the tasks to the workers is static: task i is
+   *  executed by worker i % getNoOfWorkers(), in increasing order of i.
+   *  Outputs kept per worker, e.g. one file per worker, are therefore
+   *  reproducible from job to job. The calling thread is worker 0.
+   *
+   *  run() must not be called concurrently or from inside a task.
+   */
+  class EUTelWorkerPool {
+
+  public:
+    //! The type of the tasks: task index and worker index
+    typedef std::function<void(std::size_t, unsigned int)> Task;
+
+    //! Constructor
+    /*! @param noOfWorkers The number of workers including the calling
+     *  thread, at least one
+     */
+    explicit EUTelWorkerPool(unsigned int noOfWorkers);
+
+    //! Destructor, stops and joins the threads
+    ~EUTelWorkerPool();
+
+    EUTelWorkerPool(const EUTelWorkerPool &) = delete;
+    EUTelWorkerPool &operator=(const EUTelWorkerPool &) = delete;
+
+    //! Returns the number of workers including the calling thread
+    unsigned int getNoOfWorkers() const { return _noOfWorkers; }
+
+    //! Runs task(i, worker) for all i in [0, noOfTasks)
+    /*! Returns once all tasks are done. If tasks throw, the first
+     *  exception is rethrown here after all workers have finished.
+     */
+    void run(std::size_t noOfTasks, const Task &task);
+
+  private:
+    //! Loop of the additional threads
+    void workerLoop(unsigned int worker);
+
+    //! Executes the share of the current tasks of one worker
+    void runShare(unsigned int worker);
+
+    unsigned int _noOfWorkers;
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _startCondition;
+    std::condition_variable _doneCondition;
+
+    //! The tasks of the current run
+    const Task *_task;
+    std::size_t _noOfTasks;
+
+    //! Incremented for every run, tells the threads there is new work
+    unsigned long _generation;
+
+    //! Number of threads still working on the current run
+    unsigned int _pending;
+
+    bool _stop;
+    std::exception_ptr _error;
+  };
+
+} // namespace eutelescope
+
+#endif
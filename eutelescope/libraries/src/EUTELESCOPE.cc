@@ -87,6 +87,7 @@ const char *EUTELESCOPE::ZSCLUSTERDEFAULTENCODING =
     "sensorID:7,sparsePixelType:5,quality:5";
 const char *EUTELESCOPE::HITENCODING = "sensorID:7,properties:7";
 const char *EUTELESCOPE::FIXEDWEIGHT = "FixedWeight";
+const char *EUTELESCOPE::RUNNINGAVERAGE = "RunningAverage";
 
 namespace eutelescope {
 
@@ -0,0 +1,162 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBadPixelMap.h"
+#include "EUTelExceptions.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+EUTelBadPixelMap::EUTelBadPixelMap(int noOfPixelsX, int noOfPixelsY,
+                                   double pitchX, double pitchY)
+    : _noOfPixelsX(noOfPixelsX), _noOfPixelsY(noOfPixelsY), _pitchX(pitchX),
+      _pitchY(pitchY), _bitmap(), _noOfBadPixels(0), _areaSum(),
+      _columnSum(), _indexed(false) {
+
+  if (noOfPixelsX <= 0 || noOfPixelsY <= 0 || !(pitchX > 0.) ||
+      !(pitchY > 0.)) {
+    stringstream ss;
+    ss << "EUTelBadPixelMap: invalid sensor with " << noOfPixelsX << " x "
+       << noOfPixelsY << " pixels of " << pitchX << " x " << pitchY;
+    throw InvalidParameterException(ss.str());
+  }
+  _bitmap.assign(static_cast<size_t>(noOfPixelsX) *
+                     static_cast<size_t>(noOfPixelsY),
+                 0);
+}
+
+bool EUTelBadPixelMap::addPixel(int x, int y) {
+  if (x < 0 || y < 0 || x >= _noOfPixelsX || y >= _noOfPixelsY) {
+    return false;
+  }
+  unsigned char &bit = _bitmap[static_cast<size_t>(y) * _noOfPixelsX + x];
+  if (!bit) {
+    bit = 1;
+    ++_noOfBadPixels;
+    _indexed = false;
+  }
+  return true;
+}
+
+size_t EUTelBadPixelMap::addPixels(IMPL::TrackerDataImpl *sparseData) {
+  size_t ignored = 0;
+  if (!sparseData) {
+    return ignored;
+  }
+  auto sparse = std::make_unique<
+      EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(sparseData);
+  for (auto &pixel : sparse->getPixels()) {
+    if (!addPixel(pixel.getXCoord(), pixel.getYCoord())) {
+      ++ignored;
+    }
+  }
+  return ignored;
+}
+
+bool EUTelBadPixelMap::isBad(int x, int y) const {
+  if (x < 0 || y < 0 || x >= _noOfPixelsX || y >= _noOfPixelsY) {
+    return false;
+  }
+  return _bitmap[static_cast<size_t>(y) * _noOfPixelsX + x] != 0;
+}
+
+bool EUTelBadPixelMap::getRange(double pos, double limit, double pitch,
+                                int noOfPixels, int &first, int &last) {
+  if (!(limit > 0.) || !std::isfinite(pos)) {
+    return false;
+  }
+  double lower = (pos - limit) / pitch - 0.5;
+  double upper = (pos + limit) / pitch - 0.5;
+  if (upper < -1. || lower > noOfPixels) {
+    return false;
+  }
+  first = static_cast<int>(std::floor(std::max(lower, 0.)));
+  last = static_cast<int>(std::ceil(std::min(upper, noOfPixels - 1.)));
+
+  // the candidates are at most one pixel too wide, the final decision
+  // is taken with the same comparison the processors use
+  auto inside = [&](int i) {
+    return std::abs(pos - (i * pitch + pitch / 2.)) < limit;
+  };
+  while (first <= last && !inside(first)) {
+    ++first;
+  }
+  while (last >= first && !inside(last)) {
+    --last;
+  }
+  return first <= last;
+}
+
+void EUTelBadPixelMap::buildIndex() const {
+  const size_t stride = static_cast<size_t>(_noOfPixelsX) + 1;
+  _areaSum.assign(stride * (static_cast<size_t>(_noOfPixelsY) + 1), 0);
+  _columnSum.assign(stride, 0);
+
+  for (int y = 0; y < _noOfPixelsY; ++y) {
+    unsigned int row = 0;
+    const unsigned char *bits = &_bitmap[static_cast<size_t>(y) * _noOfPixelsX];
+    const unsigned int *below = &_areaSum[static_cast<size_t>(y) * stride];
+    unsigned int *current = &_areaSum[static_cast<size_t>(y + 1) * stride];
+    for (int x = 0; x < _noOfPixelsX; ++x) {
+      row += bits[x];
+      current[x + 1] = below[x + 1] + row;
+    }
+  }
+
+  const unsigned int *top = &_areaSum[static_cast<size_t>(_noOfPixelsY) * stride];
+  for (size_t x = 0; x < stride; ++x) {
+    _columnSum[x] = top[x];
+  }
+  _indexed = true;
+}
+
+bool EUTelBadPixelMap::hasBadPixelWithin(double x, double y,
+                                         double limit) const {
+  if (_noOfBadPixels == 0) {
+    return false;
+  }
+  int firstX, lastX, firstY, lastY;
+  if (!getRange(x, limit, _pitchX, _noOfPixelsX, firstX, lastX) ||
+      !getRange(y, limit, _pitchY, _noOfPixelsY, firstY, lastY)) {
+    return false;
+  }
+  if (!_indexed) {
+    buildIndex();
+  }
+  const size_t stride = static_cast<size_t>(_noOfPixelsX) + 1;
+  auto at = [&](int i, int j) {
+    return _areaSum[static_cast<size_t>(j) * stride + i];
+  };
+  unsigned int count = at(lastX + 1, lastY + 1) - at(firstX, lastY + 1) -
+                       at(lastX + 1, firstY) + at(firstX, firstY);
+  return count > 0;
+}
+
+bool EUTelBadPixelMap::hasBadColumnWithin(double x, double limit) const {
+  if (_noOfBadPixels == 0) {
+    return false;
+  }
+  int first, last;
+  if (!getRange(x, limit, _pitchX, _noOfPixelsX, first, last)) {
+    return false;
+  }
+  if (!_indexed) {
+    buildIndex();
+  }
+  return _columnSum[last + 1] - _columnSum[first] > 0;
+}
@@ -0,0 +1,150 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelConditionsCache.h"
+#include "EUTelExceptions.h"
+#include "EUTelUtility.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerRawDataImpl.h>
+#include <UTIL/CellIDDecoder.h>
+#include <lcio.h>
+
+// lccd includes <.h>
+#include <lccd/IConditionsHandler.hh>
+#include <lccd/LCConditionsMgr.hh>
+
+// system includes <>
+#include <sstream>
+
+using namespace std;
+using namespace lcio;
+using namespace eutelescope;
+
+namespace {
+
+  template <class T>
+  void fillSensorIndices(LCCollection *collection,
+                         EUTelConditionsCache::SensorIndexMap &sensorIndices) {
+    CellIDDecoder<T> cellDecoder(collection);
+    for (int i = 0; i < collection->getNumberOfElements(); ++i) {
+      T *data = dynamic_cast<T *>(collection->getElementAt(i));
+      sensorIndices.insert(
+          make_pair(static_cast<int>(cellDecoder(data)["sensorID"]), i));
+    }
+  }
+
+} // namespace
+
+EUTelConditionsCache &EUTelConditionsCache::getInstance() {
+  static EUTelConditionsCache instance;
+  return instance;
+}
+
+shared_ptr<const EUTelConditionsCache::NoisyPixelMap>
+EUTelConditionsCache::getNoisyPixels(LCEvent *event,
+                                     const string &collectionName) {
+
+  try {
+    event->getCollection(collectionName);
+  } catch (lcio::DataNotAvailableException &) {
+    // let readNoisyPixelList issue its warning
+    return make_shared<const NoisyPixelMap>(
+        Utility::readNoisyPixelList(event, collectionName));
+  }
+
+  lock_guard<mutex> lock(_mutex);
+  Key key = makeKey(event, collectionName);
+  Entry<NoisyPixelMap> &entry = _noisyPixels[collectionName];
+  if (!entry.value || !(entry.key == key)) {
+    entry.key = key;
+    entry.value = make_shared<const NoisyPixelMap>(
+        Utility::readNoisyPixelList(event, collectionName));
+  }
+  return entry.value;
+}
+
+shared_ptr<const EUTelConditionsCache::SensorIndexMap>
+EUTelConditionsCache::getSensorIndices(LCEvent *event,
+                                       const string &collectionName) {
+
+  LCCollection *collection = event->getCollection(collectionName);
+
+  lock_guard<mutex> lock(_mutex);
+  Key key = makeKey(event, collectionName);
+  Entry<SensorIndexMap> &entry = _sensorIndices[collectionName];
+  if (!entry.value || !(entry.key == key)) {
+    auto sensorIndices = make_shared<SensorIndexMap>();
+    if (collection->getTypeName() == LCIO::TRACKERRAWDATA) {
+      fillSensorIndices<TrackerRawDataImpl>(collection, *sensorIndices);
+    } else {
+      fillSensorIndices<TrackerDataImpl>(collection, *sensorIndices);
+    }
+    entry.key = key;
+    entry.value = sensorIndices;
+  }
+  return entry.value;
+}
+
+int EUTelConditionsCache::getSensorIndex(const SensorIndexMap &sensorIndices,
+                                         int sensorID,
+                                         const string &collectionName) {
+  auto index = sensorIndices.find(sensorID);
+  if (index == sensorIndices.end()) {
+    stringstream ss;
+    ss << "The condition collection " << collectionName
+       << " has no element for sensor " << sensorID;
+    throw IncompatibleDataSetException(ss.str());
+  }
+  return index->second;
+}
+
+unsigned long EUTelConditionsCache::getChanges(const string &collectionName) {
+  lock_guard<mutex> lock(_mutex);
+  ChangeCounter *counter = getChangeCounter(collectionName);
+  return counter ? counter->getChanges() : 0;
+}
+
+EUTelConditionsCache::ChangeCounter *
+EUTelConditionsCache::getChangeCounter(const string &collectionName) {
+
+  auto counter = _changeCounters.find(collectionName);
+  if (counter == _changeCounters.end()) {
+    unique_ptr<ChangeCounter> newCounter;
+    lccd::IConditionsHandler *handler =
+        lccd::LCConditionsMgr::instance()->getHandler(collectionName);
+    if (handler != nullptr) {
+      newCounter.reset(new ChangeCounter);
+      handler->registerChangeListener(newCounter.get());
+    }
+    counter =
+        _changeCounters.insert(make_pair(collectionName, move(newCounter)))
+            .first;
+  }
+  return counter->second.get();
+}
+
+EUTelConditionsCache::Key
+EUTelConditionsCache::makeKey(LCEvent *event, const string &collectionName) {
+
+  ChangeCounter *counter = getChangeCounter(collectionName);
+  if (counter) {
+    return Key{counter->getChanges(), event->getRunNumber(), -1};
+  }
+  return Key{0, event->getRunNumber(), event->getEventNumber()};
+}
+
+void EUTelConditionsCache::clear() {
+  lock_guard<mutex> lock(_mutex);
+  _noisyPixels.clear();
+  _sensorIndices.clear();
+}
@@ -0,0 +1,192 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelDigitalClusterMatrix.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+
+  inline unsigned int popcount(uint64_t word) {
+    return static_cast<unsigned int>(__builtin_popcountll(word));
+  }
+
+  inline int countTrailingZeros(uint64_t word) {
+    return __builtin_ctzll(word);
+  }
+
+} // namespace
+
+EUTelDigitalClusterMatrix::EUTelDigitalClusterMatrix(int noOfPixelsX,
+                                                     int noOfPixelsY)
+    : _noOfPixelsX(noOfPixelsX), _noOfPixelsY(noOfPixelsY),
+      _wordsPerColumn(0), _hits(), _mask(), _usedColumns() {
+
+  if (noOfPixelsX <= 0 || noOfPixelsY <= 0) {
+    stringstream ss;
+    ss << "EUTelDigitalClusterMatrix: invalid sensor with " << noOfPixelsX
+       << " x " << noOfPixelsY << " pixels";
+    throw InvalidParameterException(ss.str());
+  }
+  _wordsPerColumn =
+      static_cast<size_t>((noOfPixelsY + WORDBITS - 1) / WORDBITS);
+  _hits.assign(static_cast<size_t>(noOfPixelsX) * _wordsPerColumn, 0);
+  _mask.assign(_hits.size(), 0);
+  _usedColumns.assign(
+      static_cast<size_t>((noOfPixelsX + WORDBITS - 1) / WORDBITS), 0);
+}
+
+void EUTelDigitalClusterMatrix::clear() {
+  for (size_t iColumnWord = 0; iColumnWord < _usedColumns.size();
+       ++iColumnWord) {
+    Word used = _usedColumns[iColumnWord];
+    while (used) {
+      int x =
+          static_cast<int>(iColumnWord) * WORDBITS + countTrailingZeros(used);
+      used &= used - 1;
+      fill_n(_hits.begin() + static_cast<ptrdiff_t>(getWordIndex(x, 0)),
+             _wordsPerColumn, 0);
+    }
+    _usedColumns[iColumnWord] = 0;
+  }
+}
+
+bool EUTelDigitalClusterMatrix::addHit(int x, int y) {
+  if (!isInside(x, y)) {
+    return false;
+  }
+  _hits[getWordIndex(x, y)] |= getBit(y);
+  _usedColumns[static_cast<size_t>(x / WORDBITS)] |= getBit(x);
+  return true;
+}
+
+void EUTelDigitalClusterMatrix::removeHit(int x, int y) {
+  if (isInside(x, y)) {
+    _hits[getWordIndex(x, y)] &= ~getBit(y);
+  }
+}
+
+bool EUTelDigitalClusterMatrix::isHit(int x, int y) const {
+  return isInside(x, y) && (_hits[getWordIndex(x, y)] & getBit(y));
+}
+
+bool EUTelDigitalClusterMatrix::maskPixel(int x, int y) {
+  if (!isInside(x, y)) {
+    return false;
+  }
+  _mask[getWordIndex(x, y)] |= getBit(y);
+  return true;
+}
+
+bool EUTelDigitalClusterMatrix::isMasked(int x, int y) const {
+  return isInside(x, y) && (_mask[getWordIndex(x, y)] & getBit(y));
+}
+
+void EUTelDigitalClusterMatrix::applyMask() {
+  for (size_t iColumnWord = 0; iColumnWord < _usedColumns.size();
+       ++iColumnWord) {
+    Word used = _usedColumns[iColumnWord];
+    while (used) {
+      int x =
+          static_cast<int>(iColumnWord) * WORDBITS + countTrailingZeros(used);
+      used &= used - 1;
+      size_t first = getWordIndex(x, 0);
+      for (size_t iWord = first; iWord < first + _wordsPerColumn; ++iWord) {
+        _hits[iWord] &= ~_mask[iWord];
+      }
+    }
+  }
+}
+
+EUTelDigitalClusterMatrix::Word
+EUTelDigitalClusterMatrix::getRangeMask(int iWord, int y0, int y1) {
+  // bits of y0...y1 inside the word covering iWord * 64 ... iWord * 64 + 63
+  int first = max(y0 - iWord * WORDBITS, 0);
+  int last = min(y1 - iWord * WORDBITS, WORDBITS - 1);
+  Word upper = (last == WORDBITS - 1)
+                   ? ~static_cast<Word>(0)
+                   : (static_cast<Word>(1) << (last + 1)) - 1;
+  return upper & (~static_cast<Word>(0) << first);
+}
+
+bool EUTelDigitalClusterMatrix::clip(int &x0, int &x1, int &y0,
+                                     int &y1) const {
+  x0 = max(x0, 0);
+  y0 = max(y0, 0);
+  x1 = min(x1, _noOfPixelsX - 1);
+  y1 = min(y1, _noOfPixelsY - 1);
+  return x0 <= x1 && y0 <= y1;
+}
+
+unsigned int EUTelDigitalClusterMatrix::countHits(int x0, int x1, int y0,
+                                                  int y1) const {
+  if (!clip(x0, x1, y0, y1)) {
+    return 0;
+  }
+  const int firstWord = y0 / WORDBITS;
+  const int lastWord = y1 / WORDBITS;
+  unsigned int count = 0;
+  for (int x = x0; x <= x1; ++x) {
+    const size_t column = getWordIndex(x, 0);
+    for (int iWord = firstWord; iWord <= lastWord; ++iWord) {
+      count += popcount(_hits[column + static_cast<size_t>(iWord)] &
+                        getRangeMask(iWord, y0, y1));
+    }
+  }
+  return count;
+}
+
+void EUTelDigitalClusterMatrix::getHits(int x0, int x1, int y0, int y1,
+                                        vector<pair<int, int>> &hits) const {
+  if (!clip(x0, x1, y0, y1)) {
+    return;
+  }
+  const int firstWord = y0 / WORDBITS;
+  const int lastWord = y1 / WORDBITS;
+  for (int x = x0; x <= x1; ++x) {
+    const size_t column = getWordIndex(x, 0);
+    for (int iWord = firstWord; iWord <= lastWord; ++iWord) {
+      Word word = _hits[column + static_cast<size_t>(iWord)] &
+                  getRangeMask(iWord, y0, y1);
+      while (word) {
+        hits.push_back(
+            make_pair(x, iWord * WORDBITS + countTrailingZeros(word)));
+        word &= word - 1;
+      }
+    }
+  }
+}
+
+void EUTelDigitalClusterMatrix::getHits(vector<pair<int, int>> &hits) const {
+  for (size_t iColumnWord = 0; iColumnWord < _usedColumns.size();
+       ++iColumnWord) {
+    Word used = _usedColumns[iColumnWord];
+    while (used) {
+      int x =
+          static_cast<int>(iColumnWord) * WORDBITS + countTrailingZeros(used);
+      used &= used - 1;
+      const size_t column = getWordIndex(x, 0);
+      for (size_t iWord = 0; iWord < _wordsPerColumn; ++iWord) {
+        Word word = _hits[column + iWord];
+        while (word) {
+          hits.push_back(make_pair(x, static_cast<int>(iWord) * WORDBITS +
+                                          countTrailingZeros(word)));
+          word &= word - 1;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,167 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelEtaAccumulator.h"
+#include "EUTelEtaFunctionImpl.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+  // doubles in front of the bin counts in the generic object
+  const int kHeaderDoubles = 4;
+}
+
+EUTelEtaAccumulator::EUTelEtaAccumulator(int sensorID, int noOfBins,
+                                         double min, double max)
+    : _sensorID(sensorID), _min(min), _max(max), _binWidth(0.),
+      _underflow(0), _overflow(0), _counts() {
+
+  if (noOfBins <= 0 || !(max > min)) {
+    stringstream ss;
+    ss << "EUTelEtaAccumulator: invalid binning with " << noOfBins
+       << " bins from " << min << " to " << max;
+    throw InvalidParameterException(ss.str());
+  }
+  _binWidth = std::fabs(_max - _min) / noOfBins;
+  _counts.assign(static_cast<size_t>(noOfBins), 0);
+}
+
+EUTelEtaAccumulator::EUTelEtaAccumulator(EVENT::LCGenericObject *object)
+    : _sensorID(0), _min(0.), _max(0.), _binWidth(0.), _underflow(0),
+      _overflow(0), _counts() {
+
+  if (!object || object->getNInt() < 2 ||
+      object->getNDouble() < kHeaderDoubles ||
+      object->getIntVal(1) <= 0 ||
+      object->getNDouble() != kHeaderDoubles + object->getIntVal(1)) {
+    throw InvalidParameterException(
+        "EUTelEtaAccumulator: the object is not a valid eta accumulator");
+  }
+
+  _sensorID = object->getIntVal(0);
+  _min = object->getDoubleVal(0);
+  _max = object->getDoubleVal(1);
+  if (!(_max > _min)) {
+    throw InvalidParameterException(
+        "EUTelEtaAccumulator: the object has an empty range");
+  }
+  const int noOfBins = object->getIntVal(1);
+  _binWidth = std::fabs(_max - _min) / noOfBins;
+  _underflow = static_cast<uint64_t>(object->getDoubleVal(2));
+  _overflow = static_cast<uint64_t>(object->getDoubleVal(3));
+  _counts.resize(static_cast<size_t>(noOfBins));
+  for (int bin = 0; bin < noOfBins; ++bin) {
+    _counts[bin] =
+        static_cast<uint64_t>(object->getDoubleVal(kHeaderDoubles + bin));
+  }
+}
+
+void EUTelEtaAccumulator::fill(double x) {
+  if (std::isnan(x)) {
+    return;
+  }
+  if (x < _min) {
+    ++_underflow;
+  } else if (x > _max) {
+    ++_overflow;
+  } else if (x == _max) {
+    ++_counts.back();
+  } else {
+    // same expression as EUTelPseudo1DHistogram, a rounding up to the
+    // number of bins ends up in the overflow as there
+    const size_t noOfBins = _counts.size();
+    size_t bin = static_cast<size_t>(std::floor(
+        (static_cast<double>(noOfBins) / (_max - _min)) * (x - _min)));
+    if (bin < noOfBins) {
+      ++_counts[bin];
+    } else {
+      ++_overflow;
+    }
+  }
+}
+
+void EUTelEtaAccumulator::merge(const EUTelEtaAccumulator &other) {
+  if (other._sensorID != _sensorID || other._counts.size() != _counts.size() ||
+      other._min != _min || other._max != _max) {
+    stringstream ss;
+    ss << "EUTelEtaAccumulator: cannot merge sensor " << other._sensorID
+       << " with " << other._counts.size() << " bins from " << other._min
+       << " to " << other._max << " into sensor " << _sensorID << " with "
+       << _counts.size() << " bins from " << _min << " to " << _max;
+    throw InvalidParameterException(ss.str());
+  }
+  _underflow += other._underflow;
+  _overflow += other._overflow;
+  for (size_t bin = 0; bin < _counts.size(); ++bin) {
+    _counts[bin] += other._counts[bin];
+  }
+}
+
+double EUTelEtaAccumulator::getBinCenter(int bin) const {
+  return _min + (bin + 1) * _binWidth - 0.5 * _binWidth;
+}
+
+uint64_t EUTelEtaAccumulator::getNoOfEntries() const {
+  uint64_t entries = 0;
+  for (uint64_t count : _counts) {
+    entries += count;
+  }
+  return entries;
+}
+
+void EUTelEtaAccumulator::getEtaFunction(vector<double> &center,
+                                         vector<double> &value) const {
+  const int noOfBins = getNoOfBins();
+  center.resize(static_cast<size_t>(noOfBins));
+  value.resize(static_cast<size_t>(noOfBins));
+
+  // the integral is summed in integers, so it does not depend on how
+  // the counts have been merged
+  const double integral = static_cast<double>(getNoOfEntries());
+  uint64_t cumulative = 0;
+  for (int bin = 0; bin < noOfBins; ++bin) {
+    cumulative += _counts[bin];
+    center[bin] = getBinCenter(bin);
+    value[bin] = static_cast<double>(cumulative) / integral - 0.5;
+  }
+}
+
+EUTelEtaFunctionImpl *EUTelEtaAccumulator::makeEtaFunction() const {
+  vector<double> center, value;
+  getEtaFunction(center, value);
+  EUTelEtaFunctionImpl *eta =
+      new EUTelEtaFunctionImpl(getNoOfBins(), center, value);
+  eta->setSensorID(_sensorID);
+  eta->buildUniformTable();
+  return eta;
+}
+
+IMPL::LCGenericObjectImpl *EUTelEtaAccumulator::makeGenericObject() const {
+  const int noOfBins = getNoOfBins();
+  IMPL::LCGenericObjectImpl *object =
+      new IMPL::LCGenericObjectImpl(2, 0, kHeaderDoubles + noOfBins);
+  object->setIntVal(0, _sensorID);
+  object->setIntVal(1, noOfBins);
+  object->setDoubleVal(0, _min);
+  object->setDoubleVal(1, _max);
+  object->setDoubleVal(2, static_cast<double>(_underflow));
+  object->setDoubleVal(3, static_cast<double>(_overflow));
+  for (int bin = 0; bin < noOfBins; ++bin) {
+    object->setDoubleVal(kHeaderDoubles + bin,
+                         static_cast<double>(_counts[bin]));
+  }
+  return object;
+}
@@ -19,19 +19,44 @@
 // system includes <>
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <vector>
 
 using namespace lcio;
 using namespace eutelescope;
 using namespace std;
 
+namespace {
+  // position of the uniform table in the int and double vectors
+  const int NBININDEX = 1;
+  const int NGRIDINDEX = 2;
+
+  // layout of the object without and with the uniform table
+  const char *const BINDESCRIPTION =
+      "The first integer value is the sensor ID. The first nBin double values "
+      "are the bin centers, the second nBin doubles values the corresponding "
+      "eta function value";
+  const char *const TABLEDESCRIPTION =
+      "The integer values are the sensor ID, nBin and nGrid. The first nBin "
+      "double values are the bin centers, the second nBin doubles values the "
+      "corresponding eta function value, followed by the first grid point, "
+      "the inverse grid step and the nGrid eta values on the uniform grid";
+
+  inline double lookupUniform(const double *table, int nGrid, double first,
+                              double invStep, double x) {
+    // a NaN ends up at the first grid point
+    double t = std::max(0., (x - first) * invStep);
+    t = std::min(t, static_cast<double>(nGrid - 1));
+    int i = std::min(static_cast<int>(t), nGrid - 2);
+    double frac = t - i;
+    return table[i] + frac * (table[i + 1] - table[i]);
+  }
+}
+
 EUTelEtaFunctionImpl::EUTelEtaFunctionImpl(int nBin)
     : IMPL::LCGenericObjectImpl(1, 0, 2 * nBin) {
   _typeName = "Eta function";
-  _dataDescription = "The first integer value is the sensor ID. The first nBin "
-                     "double values are the bin centers, the second nBin "
-                     "doubles values"
-                     " the corresponding eta function value";
+  _dataDescription = BINDESCRIPTION;
   _isFixedSize = true;
 }
 
@@ -40,10 +65,7 @@ EUTelEtaFunctionImpl::EUTelEtaFunctionImpl(int nBin,
                                            std::vector<double> valueVec)
     : IMPL::LCGenericObjectImpl(1, 0, 2 * nBin) {
   _typeName = "Eta function";
-  _dataDescription = "The first integer value is the sensor ID. The first nBin "
-                     "double values are the bin centers, the second nBin "
-                     "doubles values"
-                     " the corresponding eta function value";
+  _dataDescription = BINDESCRIPTION;
   _isFixedSize = true;
 
   unsigned int indexCenter;
@@ -61,10 +83,7 @@ EUTelEtaFunctionImpl::EUTelEtaFunctionImpl(int sensorID, int nBin,
                                            std::vector<double> valueVec)
     : IMPL::LCGenericObjectImpl(1, 0, 2 * nBin) {
   _typeName = "Eta function";
-  _dataDescription = "The first integer value is the sensor ID. The first nBin "
-                     "double values are the bin centers, the second nBin "
-                     "doubles values"
-                     " the corresponding eta function value";
+  _dataDescription = BINDESCRIPTION;
   _isFixedSize = true;
 
   setIntVal(0, sensorID);
@@ -89,35 +108,130 @@ void EUTelEtaFunctionImpl::setBinCenterVector(std::vector<double> center) {
   for (indexCenter = 0; indexCenter < center.size(); indexCenter++) {
     setDoubleVal(indexCenter, center[indexCenter]);
   }
+
+  if (hasUniformTable()) {
+    buildUniformTable(getIntVal(NGRIDINDEX));
+  }
 }
 
 void EUTelEtaFunctionImpl::setEtaValueVector(std::vector<double> value) {
 
   unsigned int index;
-  int shift = getNDouble() / 2;
+  int shift = getNoOfBin();
   for (index = 0; index < value.size(); index++) {
     setDoubleVal(index + shift, value[index]);
   }
+
+  if (hasUniformTable()) {
+    buildUniformTable(getIntVal(NGRIDINDEX));
+  }
 }
 
 const vector<double> EUTelEtaFunctionImpl::getBinCenterVector() const {
 
-  vector<double> center(_doubleVec.begin(),
-                        _doubleVec.begin() + (getNDouble() / 2));
+  vector<double> center(getCoGBeginConstIterator(), getCoGEndConstIterator());
 
   return center;
 }
 
 const vector<double> EUTelEtaFunctionImpl::getEtaValueVector() const {
 
-  vector<double> value(_doubleVec.begin() + (getNDouble() / 2),
-                       _doubleVec.end());
+  vector<double> value(getEtaBeginConstIterator(), getEtaEndConstIterator());
   return value;
 }
 
-int EUTelEtaFunctionImpl::getNoOfBin() const { return getNDouble() / 2; }
+int EUTelEtaFunctionImpl::getNoOfBin() const {
+  return hasUniformTable() ? getIntVal(NBININDEX) : getNDouble() / 2;
+}
+
+bool EUTelEtaFunctionImpl::hasUniformTable() const {
+  return getNInt() > NGRIDINDEX && getIntVal(NGRIDINDEX) >= 2;
+}
+
+void EUTelEtaFunctionImpl::buildUniformTable(int nGrid) {
+
+  const int nBin = getNoOfBin();
+
+  // drop an existing table, the bins are always needed
+  _doubleVec.resize(2 * nBin);
+  _intVec.resize(1);
+  _dataDescription = BINDESCRIPTION;
+  if (nBin < 2) {
+    return;
+  }
+
+  const double first = _doubleVec[0];
+  const double last = _doubleVec[nBin - 1];
+  if (nGrid <= 0) {
+    double binStep = (last - first) / (nBin - 1);
+    bool uniform = true;
+    for (int i = 1; i < nBin - 1 && uniform; i++) {
+      uniform = std::abs(_doubleVec[i] - (first + i * binStep)) <=
+                1e-6 * std::abs(binStep);
+    }
+    nGrid = uniform ? nBin : 4 * nBin;
+  }
+  if (nGrid < 2 || !(last > first)) {
+    return;
+  }
+
+  double step = (last - first) / (nGrid - 1);
+  vector<double> table(nGrid);
+  for (int i = 0; i < nGrid; i++) {
+    table[i] = getEtaFromBins(first + i * step);
+  }
+
+  _doubleVec.push_back(first);
+  _doubleVec.push_back(1. / step);
+  _doubleVec.insert(_doubleVec.end(), table.begin(), table.end());
+  _intVec.resize(NGRIDINDEX + 1);
+  _intVec[NBININDEX] = nBin;
+  _intVec[NGRIDINDEX] = nGrid;
+  _dataDescription = TABLEDESCRIPTION;
+
+  // the size now depends on the number of grid points
+  _isFixedSize = false;
+}
 
 double EUTelEtaFunctionImpl::getEtaFromCoG(double x) const {
+  if (hasUniformTable()) {
+    int nBin = getIntVal(NBININDEX);
+    const double *grid = &_doubleVec[2 * nBin];
+    return lookupUniform(grid + 2, getIntVal(NGRIDINDEX), grid[0], grid[1],
+                         x);
+  }
+  return getEtaFromBins(x);
+}
+
+void EUTelEtaFunctionImpl::getEtaFromCoG(const double *cog, double *eta,
+                                         size_t n) const {
+  if (!hasUniformTable()) {
+    for (size_t i = 0; i < n; i++) {
+      eta[i] = getEtaFromBins(cog[i]);
+    }
+    return;
+  }
+
+  int nBin = getIntVal(NBININDEX);
+  const int nGrid = getIntVal(NGRIDINDEX);
+  const double *grid = &_doubleVec[2 * nBin];
+  const double first = grid[0];
+  const double invStep = grid[1];
+  const double *table = grid + 2;
+  for (size_t i = 0; i < n; i++) {
+    eta[i] = lookupUniform(table, nGrid, first, invStep, cog[i]);
+  }
+}
+
+void EUTelEtaFunctionImpl::getEtaFromCoG(const vector<double> &cog,
+                                         vector<double> &eta) const {
+  eta.resize(cog.size());
+  if (!cog.empty()) {
+    getEtaFromCoG(cog.data(), eta.data(), cog.size());
+  }
+}
+
+double EUTelEtaFunctionImpl::getEtaFromBins(double x) const {
 
   typedef vector<double>::const_iterator DoubleIter;
 
@@ -157,15 +271,15 @@ EUTelEtaFunctionImpl::getCoGBeginConstIterator() const {
 
 vector<double>::const_iterator
 EUTelEtaFunctionImpl::getCoGEndConstIterator() const {
-  return _doubleVec.begin() + (getNDouble() / 2);
+  return _doubleVec.begin() + getNoOfBin();
 }
 
 vector<double>::const_iterator
 EUTelEtaFunctionImpl::getEtaBeginConstIterator() const {
-  return _doubleVec.begin() + (getNDouble() / 2);
+  return _doubleVec.begin() + getNoOfBin();
 }
 
 vector<double>::const_iterator
 EUTelEtaFunctionImpl::getEtaEndConstIterator() const {
-  return _doubleVec.end();
+  return _doubleVec.begin() + 2 * getNoOfBin();
 }
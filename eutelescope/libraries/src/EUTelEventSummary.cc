@@ -0,0 +1,72 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelEventSummary.h"
+
+// lcio includes <.h>
+#include <EVENT/LCParameters.h>
+#include <LCIOTypes.h>
+
+// system includes <>
+#include <algorithm>
+
+using namespace std;
+using namespace lcio;
+using namespace eutelescope;
+
+bool EventSummary::getCounts(const LCEvent *event,
+                             const string &collectionName,
+                             map<int, int> &counts) {
+  counts.clear();
+
+  // an empty summary, e.g. of an empty collection, is a valid summary
+  // without any sensor, only a missing parameter means no summary
+  const string idKey = collectionName + "_SensorIDs";
+  const string countKey = collectionName + "_Counts";
+  StringVec keys;
+  event->getParameters().getIntKeys(keys);
+  if (find(keys.begin(), keys.end(), idKey) == keys.end() ||
+      find(keys.begin(), keys.end(), countKey) == keys.end()) {
+    return false;
+  }
+
+  IntVec sensorIDs;
+  IntVec sensorCounts;
+  event->getParameters().getIntVals(idKey, sensorIDs);
+  event->getParameters().getIntVals(countKey, sensorCounts);
+  if (sensorIDs.size() != sensorCounts.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < sensorIDs.size(); ++i) {
+    counts[sensorIDs[i]] += sensorCounts[i];
+  }
+  return true;
+}
+
+void EventSummary::addCounts(LCEvent *event, const string &collectionName,
+                             const map<int, int> &counts) {
+  map<int, int> total;
+  getCounts(event, collectionName, total);
+  for (map<int, int>::const_iterator iter = counts.begin();
+       iter != counts.end(); ++iter) {
+    total[iter->first] += iter->second;
+  }
+
+  IntVec sensorIDs;
+  IntVec sensorCounts;
+  for (map<int, int>::const_iterator iter = total.begin(); iter != total.end();
+       ++iter) {
+    sensorIDs.push_back(iter->first);
+    sensorCounts.push_back(iter->second);
+  }
+  event->parameters().setValues(collectionName + "_SensorIDs", sensorIDs);
+  event->parameters().setValues(collectionName + "_Counts", sensorCounts);
+}
@@ -0,0 +1,142 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelFrameCalibrator.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+EUTelFrameCalibrator::EUTelFrameCalibrator()
+    : _commonMode(kNoCommonMode), _hitRejectionCut(3.5f),
+      _maxNoOfRejectedPixels(3000), _maxNoOfRejectedPixelPerRow(25),
+      _maxNoOfSkippedRow(15), _noOfSkippedPixels(0), _noOfSkippedRows(0),
+      _seedFinder() {}
+
+void EUTelFrameCalibrator::setCommonMode(int commonMode) {
+  if (commonMode != kNoCommonMode && commonMode != kFullFrameCommonMode &&
+      commonMode != kRowWiseCommonMode) {
+    stringstream ss;
+    ss << "EUTelFrameCalibrator: unknown common mode algorithm " << commonMode;
+    throw InvalidParameterException(ss.str());
+  }
+  _commonMode = commonMode;
+}
+
+void EUTelFrameCalibrator::addToCommonMode(
+    const vector<float> &charges, const vector<float> &noise,
+    const vector<short> &status, short goodStatus, size_t first, size_t last,
+    double &pixelSum, int &goodPixel, int &skippedPixel) const {
+  for (size_t i = first; i < last; ++i) {
+    bool isHit = (charges[i] > _hitRejectionCut * noise[i]);
+    bool isGood = (status[i] == goodStatus);
+    if (!isHit && isGood) {
+      pixelSum += charges[i];
+      ++goodPixel;
+    } else if (isHit) {
+      ++skippedPixel;
+    }
+  }
+}
+
+bool EUTelFrameCalibrator::calibrate(
+    const vector<short> &rawValues, const vector<float> &pedestal,
+    const vector<float> &noise, const vector<short> &status,
+    size_t noOfPixelsPerRow, short goodStatus, float seedCut,
+    vector<float> &charges, vector<EUTelSeedFinder::Candidate> &candidates) {
+
+  const size_t noOfPixels = rawValues.size();
+  if (pedestal.size() != noOfPixels || noise.size() != noOfPixels ||
+      status.size() != noOfPixels || noOfPixelsPerRow == 0 ||
+      noOfPixels % noOfPixelsPerRow != 0) {
+    stringstream ss;
+    ss << "EUTelFrameCalibrator: " << noOfPixels << " raw values in rows of "
+       << noOfPixelsPerRow << " pixels, " << pedestal.size() << " pedestal, "
+       << noise.size() << " noise and " << status.size() << " status values";
+    throw InvalidParameterException(ss.str());
+  }
+
+  _noOfSkippedPixels = 0;
+  _noOfSkippedRows = 0;
+  candidates.clear();
+  charges.resize(noOfPixels);
+
+  const size_t noOfRows = noOfPixels / noOfPixelsPerRow;
+  const size_t rowsPerBlock = max<size_t>(1, BLOCKSIZE / noOfPixelsPerRow);
+
+  // the full frame common mode is the only step needing the whole
+  // frame: the pedestal subtraction is done here and the correction
+  // block by block below
+  double commonMode = 0.;
+  if (_commonMode == kFullFrameCommonMode) {
+    for (size_t i = 0; i < noOfPixels; ++i) {
+      charges[i] = rawValues[i] - pedestal[i];
+    }
+    double pixelSum = 0.;
+    int goodPixel = 0;
+    addToCommonMode(charges, noise, status, goodStatus, 0, noOfPixels,
+                    pixelSum, goodPixel, _noOfSkippedPixels);
+    if (((_maxNoOfRejectedPixels != -1) &&
+         (_noOfSkippedPixels >= _maxNoOfRejectedPixels)) ||
+        (goodPixel == 0)) {
+      return false;
+    }
+    commonMode = pixelSum / goodPixel;
+  }
+
+  for (size_t firstRow = 0; firstRow < noOfRows; firstRow += rowsPerBlock) {
+    const size_t lastRow = min(firstRow + rowsPerBlock, noOfRows);
+    const size_t first = firstRow * noOfPixelsPerRow;
+    const size_t last = lastRow * noOfPixelsPerRow;
+
+    if (_commonMode == kFullFrameCommonMode) {
+      for (size_t i = first; i < last; ++i) {
+        charges[i] = static_cast<float>(charges[i] - commonMode);
+      }
+    } else {
+      for (size_t i = first; i < last; ++i) {
+        charges[i] = rawValues[i] - pedestal[i];
+      }
+    }
+
+    if (_commonMode == kRowWiseCommonMode) {
+      for (size_t rowStart = first; rowStart < last;
+           rowStart += noOfPixelsPerRow) {
+        const size_t rowEnd = rowStart + noOfPixelsPerRow;
+        double pixelSum = 0.;
+        int goodPixel = 0;
+        int skippedPixelPerRow = 0;
+        addToCommonMode(charges, noise, status, goodStatus, rowStart, rowEnd,
+                        pixelSum, goodPixel, skippedPixelPerRow);
+        _noOfSkippedPixels += skippedPixelPerRow;
+
+        if ((skippedPixelPerRow < _maxNoOfRejectedPixelPerRow) &&
+            (goodPixel != 0)) {
+          const float rowCommonMode = static_cast<float>(pixelSum / goodPixel);
+          for (size_t i = rowStart; i < rowEnd; ++i) {
+            charges[i] -= rowCommonMode;
+          }
+        } else if (++_noOfSkippedRows > _maxNoOfSkippedRow) {
+          return false;
+        }
+      }
+    }
+
+    // the block is still in the cache: look for the seeds now
+    _seedFinder.appendCandidates(charges, noise, status, goodStatus, seedCut,
+                                 first, last, candidates);
+  }
+
+  return true;
+}
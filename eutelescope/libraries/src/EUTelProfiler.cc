@@ -0,0 +1,304 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelProfiler.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <sys/resource.h>
+#include <time.h>
+
+#ifdef EUTEL_PROFILE_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+  double readClock(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e6 +
+           static_cast<double>(ts.tv_nsec) * 1e-3;
+  }
+
+#ifdef EUTEL_PROFILE_ALLOCATIONS
+  std::atomic<long long> allocationCounter(0);
+#endif
+}
+
+#ifdef EUTEL_PROFILE_ALLOCATIONS
+// counting replacement of the global allocation function, operator new[]
+// and the nothrow versions forward to it
+void *operator new(std::size_t size) {
+  allocationCounter.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#endif
+
+EUTelProfiler::Statistics::Statistics()
+    : entries(0), sumWall(0.), sumCpu(0.),
+      minWall(numeric_limits<double>::max()), maxWall(0.), sumAllocations(0),
+      sumPeakRSSGrowth(0), latency(NOOFBINS, 0) {}
+
+void EUTelProfiler::Statistics::fill(const Interval &interval) {
+  ++entries;
+  sumWall += interval.wall;
+  sumCpu += interval.cpu;
+  minWall = std::min(minWall, interval.wall);
+  maxWall = std::max(maxWall, interval.wall);
+  sumAllocations += interval.allocations;
+  sumPeakRSSGrowth += interval.peakRSSGrowth;
+  ++latency[findBin(interval.wall)];
+}
+
+double EUTelProfiler::Statistics::getWallQuantile(double q) const {
+  if (entries == 0) {
+    return 0.;
+  }
+  double target = q * static_cast<double>(entries);
+  unsigned long long sum = 0;
+  for (int bin = 0; bin < NOOFBINS; ++bin) {
+    sum += latency[bin];
+    if (static_cast<double>(sum) >= target) {
+      // the bin edge is a better estimate than the maximum only if the
+      // maximum isn't in this bin
+      return std::min(getBinEdge(bin + 1), maxWall);
+    }
+  }
+  return maxWall;
+}
+
+double EUTelProfiler::getBinEdge(int bin) {
+  return std::pow(10., static_cast<double>(bin) / BINSPERDECADE);
+}
+
+int EUTelProfiler::findBin(double wall) {
+  if (wall < 1.) {
+    return 0;
+  }
+  int bin = static_cast<int>(std::log10(wall) * BINSPERDECADE);
+  return std::min(bin, NOOFBINS - 1);
+}
+
+EUTelProfiler &EUTelProfiler::getInstance() {
+  static EUTelProfiler instance;
+  return instance;
+}
+
+EUTelProfiler::EUTelProfiler()
+    : _origin(readClock(CLOCK_MONOTONIC)), _checkpoints(), _hasPrevious(false),
+      _previous(0), _previousSnapshot() {}
+
+EUTelProfiler::Snapshot EUTelProfiler::takeSnapshot() const {
+  Snapshot snapshot;
+  snapshot.wall = readClock(CLOCK_MONOTONIC) - _origin;
+  snapshot.cpu = readClock(CLOCK_PROCESS_CPUTIME_ID);
+  snapshot.allocations = getAllocationCount();
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  snapshot.peakRSS = usage.ru_maxrss;
+  return snapshot;
+}
+
+std::size_t EUTelProfiler::addCheckpoint(const std::string &label,
+                                         std::size_t ringCapacity) {
+  Checkpoint checkpoint;
+  checkpoint.label = label;
+  checkpoint.dropped = 0;
+  checkpoint.ringNext = 0;
+  checkpoint.ringCapacity = ringCapacity;
+  checkpoint.ring.reserve(ringCapacity);
+  _checkpoints.push_back(checkpoint);
+  return _checkpoints.size() - 1;
+}
+
+bool EUTelProfiler::pass(std::size_t position, Stage stage, int run,
+                         int event, Interval &interval) {
+  Snapshot now = takeSnapshot();
+  Checkpoint &checkpoint = _checkpoints.at(position);
+
+  std::size_t predecessor =
+      (position + _checkpoints.size() - 1) % _checkpoints.size();
+  bool attributable = _hasPrevious && _previous == predecessor;
+
+  if (attributable) {
+    interval.run = run;
+    interval.event = event;
+    interval.stage = stage;
+    interval.start = _previousSnapshot.wall;
+    interval.wall = now.wall - _previousSnapshot.wall;
+    interval.cpu = now.cpu - _previousSnapshot.cpu;
+    interval.allocations =
+        (now.allocations < 0) ? -1
+                              : now.allocations - _previousSnapshot.allocations;
+    interval.peakRSSGrowth = now.peakRSS - _previousSnapshot.peakRSS;
+
+    checkpoint.stats[stage].fill(interval);
+
+    if (checkpoint.ringCapacity != 0) {
+      if (checkpoint.ring.size() < checkpoint.ringCapacity) {
+        checkpoint.ring.push_back(interval);
+      } else {
+        checkpoint.ring[checkpoint.ringNext] = interval;
+        checkpoint.ringNext = (checkpoint.ringNext + 1) % checkpoint.ringCapacity;
+      }
+    }
+  } else if (_hasPrevious) {
+    ++checkpoint.dropped;
+  }
+
+  _hasPrevious = true;
+  _previous = position;
+  // the bookkeeping above should not be charged to the next checkpoint
+  _previousSnapshot = takeSnapshot();
+  return attributable;
+}
+
+void EUTelProfiler::printSummary(std::ostream &os) const {
+
+  double total = 0.;
+  for (const Checkpoint &checkpoint : _checkpoints) {
+    total += checkpoint.stats[kEvent].sumWall;
+  }
+
+  ios::fmtflags flags = os.flags();
+  streamsize precision = os.precision();
+
+  const int labelWidth = 30;
+  os << setiosflags(ios::left) << setw(labelWidth) << "Checkpoint"
+     << resetiosflags(ios::left) << setw(6) << "Stage" << setw(9) << "Entries"
+     << setw(11) << "Mean[ms]" << setw(11) << "p50[ms]" << setw(11)
+     << "p95[ms]" << setw(11) << "Max[ms]" << setw(11) << "CPU[ms]"
+     << setw(9) << "Share%" << setw(12) << "Allocs/evt" << setw(11)
+     << "dRSS[MB]" << setw(9) << "Dropped" << endl;
+
+  for (const Checkpoint &checkpoint : _checkpoints) {
+    for (int stage = 0; stage < kNoOfStages; ++stage) {
+      const Statistics &stats = checkpoint.stats[stage];
+      if (stats.entries == 0 && (stage != kEvent || checkpoint.dropped == 0)) {
+        continue;
+      }
+      double n = static_cast<double>(std::max(stats.entries, 1ULL));
+
+      std::string label = checkpoint.label;
+      if (static_cast<int>(label.size()) >= labelWidth) {
+        label = label.substr(0, labelWidth - 4) + "...";
+      }
+      os << setiosflags(ios::left) << setw(labelWidth) << label
+         << resetiosflags(ios::left) << setw(6)
+         << getStageName(static_cast<Stage>(stage)) << setw(9) << stats.entries
+         << setiosflags(ios::fixed) << setprecision(3) << setw(11)
+         << stats.sumWall / n * 1e-3 << setw(11)
+         << stats.getWallQuantile(0.50) * 1e-3 << setw(11)
+         << stats.getWallQuantile(0.95) * 1e-3 << setw(11)
+         << stats.maxWall * 1e-3 << setw(11) << stats.sumCpu / n * 1e-3
+         << setprecision(1) << setw(9)
+         << ((stage == kEvent && total > 0.) ? 100. * stats.sumWall / total
+                                             : 0.)
+         << setw(12);
+      if (getAllocationCount() < 0) {
+        os << "n/a";
+      } else {
+        os << static_cast<double>(stats.sumAllocations) / n;
+      }
+      os << setw(11) << static_cast<double>(stats.sumPeakRSSGrowth) / 1024.
+         << resetiosflags(ios::fixed) << setw(9)
+         << ((stage == kEvent) ? checkpoint.dropped : 0ULL) << endl;
+    }
+  }
+
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void EUTelProfiler::writeChromeTrace(const std::string &fileName) const {
+
+  ofstream file(fileName.c_str());
+  if (!file) {
+    throw InvalidParameterException("Unable to open the trace file " +
+                                    fileName);
+  }
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+  file << setiosflags(ios::fixed) << setprecision(3);
+
+  bool first = true;
+  for (std::size_t i = 0; i < _checkpoints.size(); ++i) {
+    const Checkpoint &checkpoint = _checkpoints[i];
+
+    // one named track per checkpoint, in chain order
+    std::stringstream label;
+    for (char c : checkpoint.label) {
+      if (c == '"' || c == '\\') {
+        label << '\\';
+      }
+      label << c;
+    }
+    file << (first ? "" : ",\n")
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i + 1
+         << ",\"args\":{\"name\":\"" << label.str() << "\"}},\n"
+         << "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+         << i + 1 << ",\"args\":{\"sort_index\":" << i << "}}";
+    first = false;
+
+    // oldest interval first
+    for (std::size_t j = 0; j < checkpoint.ring.size(); ++j) {
+      const Interval &interval =
+          checkpoint.ring[(checkpoint.ringNext + j) % checkpoint.ring.size()];
+      file << ",\n{\"name\":\"" << label.str() << "\",\"cat\":\""
+           << getStageName(interval.stage)
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << i + 1
+           << ",\"ts\":" << interval.start << ",\"dur\":" << interval.wall
+           << ",\"args\":{\"run\":" << interval.run
+           << ",\"event\":" << interval.event
+           << ",\"cpu_us\":" << interval.cpu
+           << ",\"allocations\":" << interval.allocations
+           << ",\"peak_rss_growth_kB\":" << interval.peakRSSGrowth << "}}";
+    }
+  }
+  file << "\n]}" << endl;
+}
+
+std::string EUTelProfiler::getStageName(Stage stage) {
+  switch (stage) {
+  case kEvent:
+    return "event";
+  case kEnd:
+    return "end";
+  case kNoOfStages:
+  default:
+    return "unknown";
+  }
+}
+
+long long EUTelProfiler::getAllocationCount() {
+#ifdef EUTEL_PROFILE_ALLOCATIONS
+  return allocationCounter.load(std::memory_order_relaxed);
+#else
+  return -1;
+#endif
+}
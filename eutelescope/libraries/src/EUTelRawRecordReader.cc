@@ -0,0 +1,338 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelRawRecordReader.h"
+#include "EUTelExceptions.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+
+// system includes <>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+  const std::size_t PAGESIZE = 4096;
+}
+
+EUTelRawRecordReader::EUTelRawRecordReader(std::size_t blockSize,
+                                           std::size_t noOfBlocks,
+                                           bool prefetch)
+    : _fileName(), _fd(-1), _fileSize(0), _rangeBegin(0), _rangeEnd(0),
+      _blockSize(((std::max(blockSize, PAGESIZE) + PAGESIZE - 1) / PAGESIZE) *
+                 PAGESIZE),
+      _prefetch(prefetch), _ring(), _head(0), _tail(0), _filled(0),
+      _readOffset(0), _producerDone(false), _stop(false), _readErrno(0),
+      _mutex(), _cond(), _thread(), _haveCurrent(false), _pos(0),
+      _position(0), _eof(false) {
+
+  // without prefetching a single block is all we need
+  std::size_t n = _prefetch ? std::max(noOfBlocks, std::size_t(2)) : 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    void *mem = nullptr;
+    if (posix_memalign(&mem, PAGESIZE, _blockSize) != 0) {
+      throw std::bad_alloc();
+    }
+    Block block;
+    block.data = static_cast<char *>(mem);
+    block.size = 0;
+    block.offset = 0;
+    _ring.push_back(block);
+  }
+}
+
+EUTelRawRecordReader::~EUTelRawRecordReader() {
+  close();
+  for (auto &block : _ring) {
+    free(block.data);
+  }
+}
+
+void EUTelRawRecordReader::open(const std::string &fileName,
+                                std::int64_t first, std::int64_t last) {
+  close();
+
+  _fd = ::open(fileName.c_str(), O_RDONLY);
+  if (_fd < 0) {
+    throw lcio::IOException("EUTelRawRecordReader: cannot open " + fileName +
+                            ": " + strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(_fd, &st) != 0) {
+    int err = errno;
+    close();
+    throw lcio::IOException("EUTelRawRecordReader: cannot stat " + fileName +
+                            ": " + strerror(err));
+  }
+  _fileName = fileName;
+  _fileSize = st.st_size;
+
+  _rangeBegin = std::max(first, std::int64_t(0));
+  _rangeEnd = (last < 0) ? _fileSize : std::min(last, _fileSize);
+  if (_rangeBegin > _rangeEnd) {
+    close();
+    throw InvalidParameterException(
+        "EUTelRawRecordReader: the byte range begins after its end");
+  }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  startReading(0);
+}
+
+void EUTelRawRecordReader::close() {
+  stopReading();
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+  _fileSize = 0;
+  _position = 0;
+  _eof = false;
+}
+
+bool EUTelRawRecordReader::read(void *dest, std::size_t n) {
+  char *out = static_cast<char *>(dest);
+  while (n > 0) {
+    if (!_haveCurrent || _pos >= _ring[_head].size) {
+      if (!nextBlock()) {
+        _eof = true;
+        return false;
+      }
+    }
+    const Block &block = _ring[_head];
+    std::size_t chunk = std::min(n, block.size - _pos);
+    memcpy(out, block.data + _pos, chunk);
+    out += chunk;
+    _pos += chunk;
+    _position += chunk;
+    n -= chunk;
+  }
+  return true;
+}
+
+bool EUTelRawRecordReader::skip(std::size_t n) {
+  // short skips stay inside the ring, longer ones restart the reading
+  if (n > _blockSize) {
+    std::int64_t target = _position + std::int64_t(n);
+    if (target > _fileSize) {
+      seek(_fileSize);
+      _eof = true;
+      return false;
+    }
+    seek(target);
+    return true;
+  }
+  while (n > 0) {
+    if (!_haveCurrent || _pos >= _ring[_head].size) {
+      if (!nextBlock()) {
+        _eof = true;
+        return false;
+      }
+    }
+    std::size_t chunk = std::min(n, _ring[_head].size - _pos);
+    _pos += chunk;
+    _position += chunk;
+    n -= chunk;
+  }
+  return true;
+}
+
+void EUTelRawRecordReader::seek(std::int64_t offset) {
+  stopReading();
+  startReading(offset);
+}
+
+std::int64_t
+EUTelRawRecordReader::firstRecordInRange(std::int64_t dataStart,
+                                         std::int64_t recordLength) const {
+  if (recordLength <= 0 || _rangeBegin <= dataStart) {
+    return dataStart;
+  }
+  std::int64_t records =
+      (_rangeBegin - dataStart + recordLength - 1) / recordLength;
+  return dataStart + records * recordLength;
+}
+
+void EUTelRawRecordReader::parseByteRange(
+    const std::vector<std::string> &range, std::int64_t &first,
+    std::int64_t &last) {
+  first = 0;
+  last = -1;
+  if (range.size() > 2) {
+    throw InvalidParameterException(
+        "EUTelRawRecordReader: a byte range has at most two entries");
+  }
+  for (std::size_t i = 0; i < range.size(); ++i) {
+    char *end = nullptr;
+    errno = 0;
+    long long value = strtoll(range[i].c_str(), &end, 0);
+    if (errno != 0 || end == range[i].c_str() || *end != '\0') {
+      throw InvalidParameterException(
+          "EUTelRawRecordReader: invalid byte range entry " + range[i]);
+    }
+    if (i == 0) {
+      first = value;
+    } else {
+      last = value;
+    }
+  }
+  if (first < 0) {
+    throw InvalidParameterException(
+        "EUTelRawRecordReader: the byte range cannot begin before the file");
+  }
+}
+
+std::size_t EUTelRawRecordReader::fillBlock(Block &block,
+                                            std::int64_t offset) {
+  std::size_t done = 0;
+  while (done < _blockSize) {
+    ssize_t n = pread(_fd, block.data + done, _blockSize - done,
+                      offset + std::int64_t(done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      _readErrno = errno;
+      break;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += std::size_t(n);
+  }
+  block.size = done;
+  block.offset = offset;
+  return done;
+}
+
+bool EUTelRawRecordReader::nextBlock() {
+  if (!_prefetch) {
+    if (_haveCurrent) {
+      _readOffset += std::int64_t(_ring[0].size);
+    }
+    _haveCurrent = true;
+    _pos = 0;
+    if (fillBlock(_ring[0], _readOffset) == 0) {
+      if (_readErrno != 0) {
+        throw lcio::IOException("EUTelRawRecordReader: error reading " +
+                                _fileName + ": " + strerror(_readErrno));
+      }
+      return false;
+    }
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_haveCurrent) {
+    // hand the exhausted block back to the prefetch thread
+    _head = (_head + 1) % _ring.size();
+    --_filled;
+    _haveCurrent = false;
+    _cond.notify_all();
+  }
+  _cond.wait(lock, [this] { return _filled > 0 || _producerDone; });
+  if (_filled == 0) {
+    if (_readErrno != 0) {
+      throw lcio::IOException("EUTelRawRecordReader: error reading " +
+                              _fileName + ": " + strerror(_readErrno));
+    }
+    return false;
+  }
+  _haveCurrent = true;
+  _pos = 0;
+  return _ring[_head].size > 0;
+}
+
+void EUTelRawRecordReader::prefetchLoop() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _cond.wait(lock, [this] { return _stop || _filled < _ring.size(); });
+    if (_stop) {
+      return;
+    }
+    Block &block = _ring[_tail];
+    std::int64_t offset = _readOffset;
+
+    // the slot at _tail is owned by this thread until it is published
+    lock.unlock();
+    std::size_t n = fillBlock(block, offset);
+    lock.lock();
+
+    if (_stop) {
+      return;
+    }
+    _readOffset += std::int64_t(n);
+    if (n > 0) {
+      _tail = (_tail + 1) % _ring.size();
+      ++_filled;
+    }
+    if (n < _blockSize) {
+      _producerDone = true;
+      _cond.notify_all();
+      return;
+    }
+    _cond.notify_all();
+  }
+}
+
+void EUTelRawRecordReader::startReading(std::int64_t offset) {
+  if (_fd < 0) {
+    return;
+  }
+  offset = std::max(std::int64_t(0), std::min(offset, _fileSize));
+
+  // blocks are always read at aligned file offsets
+  std::int64_t aligned = offset - offset % std::int64_t(_blockSize);
+  _head = 0;
+  _tail = 0;
+  _filled = 0;
+  _readOffset = aligned;
+  _producerDone = false;
+  _stop = false;
+  _readErrno = 0;
+  _haveCurrent = false;
+  _pos = 0;
+  _position = aligned;
+  _eof = false;
+
+  if (_prefetch) {
+    _thread = std::thread(&EUTelRawRecordReader::prefetchLoop, this);
+  }
+
+  if (offset > aligned) {
+    skip(std::size_t(offset - aligned));
+  }
+}
+
+void EUTelRawRecordReader::stopReading() {
+  if (_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cond.notify_all();
+    _thread.join();
+  }
+  _haveCurrent = false;
+  _filled = 0;
+  _pos = 0;
+}
@@ -0,0 +1,104 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelSeedFinder.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+EUTelSeedFinder::EUTelSeedFinder() : _flags(BLOCKSIZE, 0) {}
+
+void EUTelSeedFinder::findCandidates(const vector<float> &charges,
+                                     const vector<float> &noise,
+                                     const vector<short> &status,
+                                     short goodStatus, float seedCut,
+                                     vector<Candidate> &candidates) {
+  candidates.clear();
+  appendCandidates(charges, noise, status, goodStatus, seedCut, 0,
+                   charges.size(), candidates);
+}
+
+void EUTelSeedFinder::appendCandidates(const vector<float> &charges,
+                                       const vector<float> &noise,
+                                       const vector<short> &status,
+                                       short goodStatus, float seedCut,
+                                       size_t first, size_t last,
+                                       vector<Candidate> &candidates) {
+
+  if (noise.size() != charges.size() || status.size() != charges.size()) {
+    stringstream ss;
+    ss << "EUTelSeedFinder: " << charges.size() << " charges but "
+       << noise.size() << " noise and " << status.size() << " status values";
+    throw InvalidParameterException(ss.str());
+  }
+  if (first > last || last > charges.size()) {
+    stringstream ss;
+    ss << "EUTelSeedFinder: invalid pixel range " << first << " ... " << last
+       << " for " << charges.size() << " pixels";
+    throw InvalidParameterException(ss.str());
+  }
+
+  const float *charge = charges.data();
+  const float *sigma = noise.data();
+  const short *pixelStatus = status.data();
+  unsigned char *flag = _flags.data();
+
+  for (; first < last; first += BLOCKSIZE) {
+    const size_t blockSize = min(BLOCKSIZE, last - first);
+
+    // branch free comparison, vectorised by the compiler
+    for (size_t i = 0; i < blockSize; ++i) {
+      flag[i] = static_cast<unsigned char>(
+          (pixelStatus[first + i] == goodStatus) &
+          (charge[first + i] > seedCut * sigma[first + i]));
+    }
+
+    // compaction, eight flags at a time
+    size_t i = 0;
+    for (; i + 8 <= blockSize; i += 8) {
+      uint64_t eight;
+      memcpy(&eight, flag + i, sizeof(eight));
+      if (eight == 0) {
+        continue;
+      }
+      for (size_t j = i; j < i + 8; ++j) {
+        if (flag[j]) {
+          candidates.push_back(Candidate(charge[first + j],
+                                         static_cast<unsigned int>(first + j)));
+        }
+      }
+    }
+    for (; i < blockSize; ++i) {
+      if (flag[i]) {
+        candidates.push_back(
+            Candidate(charge[first + i], static_cast<unsigned int>(first + i)));
+      }
+    }
+  }
+}
+
+void EUTelSeedFinder::orderCandidates(vector<Candidate> &candidates) {
+  make_heap(candidates.begin(), candidates.end());
+}
+
+EUTelSeedFinder::Candidate
+EUTelSeedFinder::popCandidate(vector<Candidate> &candidates) {
+  pop_heap(candidates.begin(), candidates.end());
+  Candidate candidate = candidates.back();
+  candidates.pop_back();
+  return candidate;
+}
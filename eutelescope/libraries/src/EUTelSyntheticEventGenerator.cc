@@ -0,0 +1,300 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelSyntheticEventGenerator.h"
+#include "EUTelExceptions.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+
+// eigen includes <>
+#include <Eigen/Geometry>
+
+// system includes <>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+  // picks a fraction of the pixels, distinct and not in exclude. The
+  // rounded fractions of two calls can add up to more than all pixels,
+  // so the count is limited to the free pixels.
+  vector<int> pickPixels(mt19937_64 &engine, int noOfPixels, double fraction,
+                         const vector<unsigned char> &exclude) {
+    size_t count = static_cast<size_t>(std::llround(fraction * noOfPixels));
+    size_t noOfFree = static_cast<size_t>(noOfPixels) -
+                      static_cast<size_t>(std::count(exclude.begin(),
+                                                     exclude.end(), 1));
+    count = std::min(count, noOfFree);
+    uniform_int_distribution<int> pixel(0, noOfPixels - 1);
+    set<int> picked;
+    while (picked.size() < count) {
+      int index = pixel(engine);
+      if (exclude.empty() || !exclude[index]) {
+        picked.insert(index);
+      }
+    }
+    return vector<int>(picked.begin(), picked.end());
+  }
+}
+
+EUTelSyntheticEventGenerator::EUTelSyntheticEventGenerator(
+    std::vector<Plane> planes, const Settings &settings)
+    : _planes(std::move(planes)), _settings(settings), _shareX(), _shareY(),
+      _deadPixels(), _hotPixels(), _charges(), _pixels(), _noOfTracks(0),
+      _engine(settings.seed) {
+
+  if (_planes.empty()) {
+    throw InvalidParameterException(
+        "EUTelSyntheticEventGenerator: no planes to generate");
+  }
+  for (const Plane &plane : _planes) {
+    if (plane.noOfPixelsX <= 0 || plane.noOfPixelsY <= 0 ||
+        plane.noOfPixelsX > numeric_limits<short>::max() ||
+        plane.noOfPixelsY > numeric_limits<short>::max() ||
+        !(plane.pitchX > 0.) || !(plane.pitchY > 0.) ||
+        plane.materialBudget < 0.) {
+      stringstream ss;
+      ss << "EUTelSyntheticEventGenerator: invalid plane " << plane.sensorID;
+      throw InvalidParameterException(ss.str());
+    }
+  }
+  const Settings &s = _settings;
+  if (!(s.beamEnergy > 0.) || s.tracksPerEvent < 0. || s.beamSpotX < 0. ||
+      s.beamSpotY < 0. || s.beamDivergence < 0. || s.chargeSigma < 0. ||
+      s.noiseOccupancy < 0. || s.noiseOccupancy > 1. ||
+      s.hotPixelFraction < 0. || s.deadPixelFraction < 0. ||
+      s.hotPixelFraction + s.deadPixelFraction > 1.) {
+    throw InvalidParameterException(
+        "EUTelSyntheticEventGenerator: invalid settings");
+  }
+
+  std::stable_sort(_planes.begin(), _planes.end(),
+                   [](const Plane &a, const Plane &b) {
+                     return a.origin.z() < b.origin.z();
+                   });
+
+  // the dead and hot pixels do not change during the run
+  for (const Plane &plane : _planes) {
+    const int noOfPixels = plane.noOfPixelsX * plane.noOfPixelsY;
+    vector<unsigned char> dead;
+    if (_settings.deadPixelFraction > 0.) {
+      dead.assign(static_cast<size_t>(noOfPixels), 0);
+      for (int index : pickPixels(_engine, noOfPixels,
+                                  _settings.deadPixelFraction, dead)) {
+        dead[index] = 1;
+      }
+    }
+    _hotPixels.push_back(
+        pickPixels(_engine, noOfPixels, _settings.hotPixelFraction, dead));
+    _deadPixels.push_back(std::move(dead));
+  }
+
+  _charges.resize(_planes.size());
+  _pixels.resize(_planes.size());
+}
+
+std::vector<EUTelSyntheticEventGenerator::Plane>
+EUTelSyntheticEventGenerator::getGeometryPlanes(
+    const std::vector<int> &sensorIDs) {
+  vector<Plane> planes;
+  for (int sensorID : sensorIDs) {
+    Plane plane;
+    plane.sensorID = sensorID;
+    array<double, 3> const localOrigin{{0., 0., 0.}};
+    array<double, 3> origin;
+    geo::gGeometry().local2Master(sensorID, localOrigin, origin);
+    plane.origin = Eigen::Vector3d(origin.data());
+    plane.xAxis = geo::gGeometry().getPlaneXVector(sensorID);
+    plane.yAxis = geo::gGeometry().getPlaneYVector(sensorID);
+    plane.normal = geo::gGeometry().getPlaneNormalVector(sensorID);
+    plane.noOfPixelsX = geo::gGeometry().getPlaneNumberOfPixelsX(sensorID);
+    plane.noOfPixelsY = geo::gGeometry().getPlaneNumberOfPixelsY(sensorID);
+    plane.pitchX = geo::gGeometry().getPlaneXPitch(sensorID);
+    plane.pitchY = geo::gGeometry().getPlaneYPitch(sensorID);
+    plane.materialBudget = geo::gGeometry().getPlaneZSize(sensorID) /
+                           geo::gGeometry().getPlaneRadiationLength(sensorID);
+    planes.push_back(plane);
+  }
+  return planes;
+}
+
+void EUTelSyntheticEventGenerator::generate(std::uint64_t eventNumber) {
+
+  _engine.seed(_settings.seed ^ ((eventNumber + 1) * 0x9E3779B97F4A7C15ULL));
+
+  for (auto &charges : _charges) {
+    charges.clear();
+  }
+
+  // tracks
+  // a poisson distribution needs a positive mean
+  _noOfTracks = 0;
+  if (_settings.tracksPerEvent > 0.) {
+    poisson_distribution<int> tracks(_settings.tracksPerEvent);
+    _noOfTracks = static_cast<size_t>(tracks(_engine));
+  }
+  normal_distribution<double> gauss(0., 1.);
+  for (size_t iTrack = 0; iTrack < _noOfTracks; ++iTrack) {
+    Eigen::Vector3d position(_settings.beamSpotX * gauss(_engine),
+                             _settings.beamSpotY * gauss(_engine),
+                             _planes.front().origin.z());
+    Eigen::Vector3d direction(_settings.beamDivergence * gauss(_engine),
+                              _settings.beamDivergence * gauss(_engine), 1.);
+    direction.normalize();
+
+    for (size_t iPlane = 0; iPlane < _planes.size(); ++iPlane) {
+      const Plane &plane = _planes[iPlane];
+      double cosine = direction.dot(plane.normal);
+      if (std::abs(cosine) < 1e-9) {
+        continue;
+      }
+      position += direction * ((plane.origin - position).dot(plane.normal) /
+                               cosine);
+      Eigen::Vector3d local = position - plane.origin;
+      depositCharge(iPlane, local.dot(plane.xAxis), local.dot(plane.yAxis));
+      if (_settings.multipleScattering) {
+        scatter(plane, direction);
+      }
+    }
+  }
+
+  // noise and hot pixels get the threshold charge
+  const float noiseCharge = static_cast<float>(_settings.threshold);
+  for (size_t iPlane = 0; iPlane < _planes.size(); ++iPlane) {
+    const int noOfPixels =
+        _planes[iPlane].noOfPixelsX * _planes[iPlane].noOfPixelsY;
+    vector<pair<int, float>> &charges = _charges[iPlane];
+    for (int index : _hotPixels[iPlane]) {
+      charges.emplace_back(index, noiseCharge);
+    }
+    if (_settings.noiseOccupancy > 0.) {
+      poisson_distribution<int> noise(_settings.noiseOccupancy * noOfPixels);
+      uniform_int_distribution<int> pixel(0, noOfPixels - 1);
+      for (int iNoise = noise(_engine); iNoise > 0; --iNoise) {
+        charges.emplace_back(pixel(_engine), noiseCharge);
+      }
+    }
+  }
+
+  // sum up the charges per pixel and apply the threshold
+  for (size_t iPlane = 0; iPlane < _planes.size(); ++iPlane) {
+    const int noOfPixelsX = _planes[iPlane].noOfPixelsX;
+    const vector<unsigned char> &dead = _deadPixels[iPlane];
+    vector<pair<int, float>> &charges = _charges[iPlane];
+    vector<Pixel> &pixels = _pixels[iPlane];
+    pixels.clear();
+
+    std::sort(charges.begin(), charges.end(),
+              [](const pair<int, float> &a, const pair<int, float> &b) {
+                return a.first < b.first;
+              });
+    for (size_t i = 0; i < charges.size();) {
+      int index = charges[i].first;
+      float charge = 0.f;
+      for (; i < charges.size() && charges[i].first == index; ++i) {
+        charge += charges[i].second;
+      }
+      if (charge >= _settings.threshold && (dead.empty() || !dead[index])) {
+        pixels.push_back({static_cast<short>(index % noOfPixelsX),
+                          static_cast<short>(index / noOfPixelsX), charge});
+      }
+    }
+  }
+}
+
+void EUTelSyntheticEventGenerator::depositCharge(std::size_t iPlane, double u,
+                                                 double v) {
+  const Plane &plane = _planes[iPlane];
+  const double sizeX = plane.noOfPixelsX * plane.pitchX;
+  const double sizeY = plane.noOfPixelsY * plane.pitchY;
+  const double columnPos = (u + sizeX / 2.) / plane.pitchX;
+  const double rowPos = (v + sizeY / 2.) / plane.pitchY;
+  if (!(columnPos >= 0.) || !(rowPos >= 0.) || columnPos >= plane.noOfPixelsX ||
+      rowPos >= plane.noOfPixelsY) {
+    return;
+  }
+  const int seedX = static_cast<int>(columnPos);
+  const int seedY = static_cast<int>(rowPos);
+
+  // charge fractions of the pixels within 3 sigma of the seed, the
+  // charge cloud factorises in x and y
+  auto share = [this](double pos, double pitch, int seed,
+                      vector<double> &fraction) {
+    const double sigma = _settings.chargeSigma;
+    const int reach =
+        (sigma > 0.) ? static_cast<int>(std::ceil(3. * sigma / pitch)) : 0;
+    fraction.assign(static_cast<size_t>(2 * reach + 1), 0.);
+    if (reach == 0) {
+      fraction[0] = 1.;
+      return reach;
+    }
+    const double norm = 1. / (std::sqrt(2.) * sigma);
+    for (int i = -reach; i <= reach; ++i) {
+      double lower = (seed + i - pos) * pitch;
+      double upper = lower + pitch;
+      fraction[i + reach] =
+          0.5 * (std::erf(upper * norm) - std::erf(lower * norm));
+    }
+    return reach;
+  };
+  const int reachX = share(columnPos, plane.pitchX, seedX, _shareX);
+  const int reachY = share(rowPos, plane.pitchY, seedY, _shareY);
+
+  vector<pair<int, float>> &charges = _charges[iPlane];
+  for (int j = -reachY; j <= reachY; ++j) {
+    int y = seedY + j;
+    if (y < 0 || y >= plane.noOfPixelsY) {
+      continue;
+    }
+    for (int i = -reachX; i <= reachX; ++i) {
+      int x = seedX + i;
+      if (x < 0 || x >= plane.noOfPixelsX) {
+        continue;
+      }
+      double charge =
+          _settings.clusterCharge * _shareX[i + reachX] * _shareY[j + reachY];
+      if (charge > 0.) {
+        charges.emplace_back(y * plane.noOfPixelsX + x,
+                             static_cast<float>(charge));
+      }
+    }
+  }
+}
+
+void EUTelSyntheticEventGenerator::scatter(const Plane &plane,
+                                           Eigen::Vector3d &direction) {
+  if (plane.materialBudget <= 0.) {
+    return;
+  }
+  // Highland formula for a singly charged particle with beta = 1
+  const double budget =
+      plane.materialBudget / std::abs(direction.dot(plane.normal));
+  const double theta0 = 0.0136 / _settings.beamEnergy * std::sqrt(budget) *
+                        (1. + 0.038 * std::log(budget));
+  if (!(theta0 > 0.)) {
+    return;
+  }
+
+  Eigen::Vector3d first = direction.cross(Eigen::Vector3d::UnitX());
+  if (first.squaredNorm() < 1e-6) {
+    first = direction.cross(Eigen::Vector3d::UnitY());
+  }
+  first.normalize();
+  Eigen::Vector3d second = direction.cross(first);
+
+  normal_distribution<double> gauss(0., theta0);
+  direction += gauss(_engine) * first + gauss(_engine) * second;
+  direction.normalize();
+}
@@ -0,0 +1,370 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelTrackHitAssociation.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+  bool cellLess(long long ax, long long ay, long long bx, long long by) {
+    return ax < bx || (ax == bx && ay < by);
+  }
+
+  // union-find over the tracks and hits for the grouping
+  size_t findRoot(vector<size_t> &parent, size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+}
+
+EUTelTrackHitAssociation::EUTelTrackHitAssociation(double window,
+                                                   Window shape)
+    : _window(window), _shape(shape), _hitX(), _hitY(), _used(), _cells() {
+  if (!(window > 0.) || !std::isfinite(window)) {
+    stringstream ss;
+    ss << "EUTelTrackHitAssociation: the window has to be positive, it is "
+       << window;
+    throw InvalidParameterException(ss.str());
+  }
+}
+
+bool EUTelTrackHitAssociation::inWindow(double dx, double dy) const {
+  if (_shape == kBox) {
+    return std::abs(dx) < _window && std::abs(dy) < _window;
+  }
+  return dx * dx + dy * dy < _window * _window;
+}
+
+long long EUTelTrackHitAssociation::cellIndex(double pos) const {
+  // far away positions share the outermost cells, which is harmless
+  const double maxCell = 1e15;
+  double cell = std::floor(pos / _window);
+  return static_cast<long long>(std::max(-maxCell, std::min(maxCell, cell)));
+}
+
+void EUTelTrackHitAssociation::setHits(const std::vector<double> &hitX,
+                                       const std::vector<double> &hitY) {
+  if (hitX.size() != hitY.size()) {
+    throw InvalidParameterException(
+        "EUTelTrackHitAssociation: different number of x and y positions");
+  }
+  _hitX = hitX;
+  _hitY = hitY;
+  _used.assign(hitX.size(), false);
+
+  _cells.clear();
+  _cells.reserve(hitX.size());
+  for (size_t i = 0; i < hitX.size(); ++i) {
+    if (std::isfinite(hitX[i]) && std::isfinite(hitY[i])) {
+      _cells.push_back({cellIndex(hitX[i]), cellIndex(hitY[i]), i});
+    }
+  }
+  std::sort(_cells.begin(), _cells.end(), [](const Cell &a, const Cell &b) {
+    return cellLess(a.x, a.y, b.x, b.y) ||
+           (a.x == b.x && a.y == b.y && a.hit < b.hit);
+  });
+}
+
+template <class F>
+void EUTelTrackHitAssociation::forEachCandidate(double x, double y,
+                                                F f) const {
+  if (!std::isfinite(x) || !std::isfinite(y)) {
+    return;
+  }
+  long long cx = cellIndex(x);
+  long long cy = cellIndex(y);
+  // the cells (cx + i, cy - 1 ... cy + 1) are contiguous in _cells
+  for (long long i = -1; i <= 1; ++i) {
+    auto it = std::lower_bound(
+        _cells.begin(), _cells.end(), cx + i, [cy](const Cell &c, long long cellX) {
+          return cellLess(c.x, c.y, cellX, cy - 1);
+        });
+    for (; it != _cells.end() && it->x == cx + i && it->y <= cy + 1; ++it) {
+      size_t hit = it->hit;
+      if (!_used[hit] && inWindow(_hitX[hit] - x, _hitY[hit] - y)) {
+        f(hit);
+      }
+    }
+  }
+}
+
+int EUTelTrackHitAssociation::findClosestFreeHit(double x, double y,
+                                                 double &dist2) const {
+  int best = -1;
+  dist2 = std::numeric_limits<double>::max();
+  forEachCandidate(x, y, [&](size_t hit) {
+    double dx = _hitX[hit] - x;
+    double dy = _hitY[hit] - y;
+    double d2 = dx * dx + dy * dy;
+    if (d2 < dist2 || (d2 == dist2 && static_cast<int>(hit) < best)) {
+      dist2 = d2;
+      best = static_cast<int>(hit);
+    }
+  });
+  return best;
+}
+
+std::vector<int>
+EUTelTrackHitAssociation::associateGreedy(const std::vector<double> &trackX,
+                                          const std::vector<double> &trackY) {
+  std::vector<int> result(trackX.size(), -1);
+  for (size_t i = 0; i < trackX.size() && i < trackY.size(); ++i) {
+    double dist2;
+    int hit = findClosestFreeHit(trackX[i], trackY[i], dist2);
+    if (hit >= 0) {
+      result[i] = hit;
+      _used[static_cast<size_t>(hit)] = true;
+    }
+  }
+  return result;
+}
+
+std::vector<int>
+EUTelTrackHitAssociation::associateOptimal(const std::vector<double> &trackX,
+                                           const std::vector<double> &trackY) {
+  const size_t nTracks = std::min(trackX.size(), trackY.size());
+  const size_t nHits = _hitX.size();
+  std::vector<int> result(trackX.size(), -1);
+
+  // group the tracks and hits connected by candidate pairs
+  std::vector<size_t> parent(nTracks + nHits);
+  std::iota(parent.begin(), parent.end(), 0);
+  std::vector<bool> hasCandidate(nTracks, false);
+  for (size_t t = 0; t < nTracks; ++t) {
+    forEachCandidate(trackX[t], trackY[t], [&](size_t hit) {
+      hasCandidate[t] = true;
+      size_t a = findRoot(parent, t);
+      size_t b = findRoot(parent, nTracks + hit);
+      if (a != b) {
+        parent[std::max(a, b)] = std::min(a, b);
+      }
+    });
+  }
+
+  // the root of a group with a track is its lowest track
+  std::vector<std::vector<size_t>> groupTracks(nTracks);
+  std::vector<std::vector<size_t>> groupHits(nTracks);
+  for (size_t t = 0; t < nTracks; ++t) {
+    if (hasCandidate[t]) {
+      groupTracks[findRoot(parent, t)].push_back(t);
+    }
+  }
+  for (size_t h = 0; h < nHits; ++h) {
+    size_t root = findRoot(parent, nTracks + h);
+    if (root < nTracks) {
+      groupHits[root].push_back(h);
+    }
+  }
+
+  for (size_t g = 0; g < nTracks; ++g) {
+    if (!groupTracks[g].empty()) {
+      solveGroup(groupTracks[g], groupHits[g], trackX, trackY, result);
+    }
+  }
+  return result;
+}
+
+std::vector<int> EUTelTrackHitAssociation::associateUniqueFirst(
+    const std::vector<double> &trackX, const std::vector<double> &trackY) {
+  const size_t nTracks = std::min(trackX.size(), trackY.size());
+  std::vector<int> result(trackX.size(), -1);
+
+  // lock the tracks with a single candidate, this can leave a single
+  // candidate to other tracks. A track without candidate stays without.
+  std::vector<bool> decided(nTracks, false);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t t = 0; t < nTracks; ++t) {
+      if (decided[t]) {
+        continue;
+      }
+      size_t nCandidates = 0;
+      size_t candidate = 0;
+      forEachCandidate(trackX[t], trackY[t], [&](size_t hit) {
+        ++nCandidates;
+        candidate = hit;
+      });
+      if (nCandidates == 1) {
+        result[t] = static_cast<int>(candidate);
+        _used[candidate] = true;
+        changed = true;
+      }
+      decided[t] = (nCandidates <= 1);
+    }
+  }
+
+  std::vector<size_t> order;
+  for (size_t t = 0; t < nTracks; ++t) {
+    if (!decided[t]) {
+      order.push_back(t);
+    }
+  }
+  if (order.empty()) {
+    return result;
+  }
+
+  // greedy association of the ambiguous tracks in every ordering
+  const std::vector<bool> lockedUsed = _used;
+  std::vector<int> best = result;
+  std::vector<bool> bestUsed = _used;
+  size_t maxAssociations = 0;
+  double minDistance = std::numeric_limits<double>::max();
+  bool complete = false;
+  do {
+    _used = lockedUsed;
+    std::vector<int> current = result;
+    size_t associations = 0;
+    double totalDistance = 0.;
+    for (size_t i = 0; i < order.size(); ++i) {
+      double dist2;
+      int hit = findClosestFreeHit(trackX[order[i]], trackY[order[i]], dist2);
+      if (hit >= 0) {
+        ++associations;
+        current[order[i]] = hit;
+        _used[static_cast<size_t>(hit)] = true;
+        totalDistance += std::sqrt(dist2);
+      }
+      // further tracks cannot make this ordering better than the best
+      if (totalDistance > minDistance ||
+          i + 1 - associations > order.size() - maxAssociations) {
+        break;
+      }
+    }
+    complete = (associations == order.size());
+    if (associations >= maxAssociations && totalDistance < minDistance) {
+      best = current;
+      bestUsed = _used;
+      maxAssociations = associations;
+      minDistance = totalDistance;
+    }
+  } while (!complete && std::next_permutation(order.begin(), order.end()));
+
+  _used = bestUsed;
+  return best;
+}
+
+void EUTelTrackHitAssociation::solveGroup(const std::vector<size_t> &tracks,
+                                          const std::vector<size_t> &hits,
+                                          const std::vector<double> &trackX,
+                                          const std::vector<double> &trackY,
+                                          std::vector<int> &result) {
+
+  auto distance = [&](size_t t, size_t h) {
+    double dx = _hitX[h] - trackX[t];
+    double dy = _hitY[h] - trackY[t];
+    return inWindow(dx, dy) ? std::sqrt(dx * dx + dy * dy) : -1.;
+  };
+
+  // a single track or hit: only one pair can be formed
+  if (tracks.size() == 1 || hits.size() == 1) {
+    double best = std::numeric_limits<double>::max();
+    size_t bestTrack = 0;
+    size_t bestHit = 0;
+    for (size_t t : tracks) {
+      for (size_t h : hits) {
+        double d = distance(t, h);
+        if (d >= 0. && d < best) {
+          best = d;
+          bestTrack = t;
+          bestHit = h;
+        }
+      }
+    }
+    result[bestTrack] = static_cast<int>(bestHit);
+    _used[bestHit] = true;
+    return;
+  }
+
+  // Hungarian algorithm on the smaller side as rows. Pairs outside of
+  // the window get a cost larger than any sum of real distances, so
+  // that the number of pairs is maximised first.
+  const bool tracksAsRows = tracks.size() <= hits.size();
+  const std::vector<size_t> &rows = tracksAsRows ? tracks : hits;
+  const std::vector<size_t> &cols = tracksAsRows ? hits : tracks;
+  const size_t n = rows.size();
+  const size_t m = cols.size();
+  const double forbidden = 4. * _window * static_cast<double>(n + 1);
+
+  std::vector<double> cost(n * m);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < m; ++j) {
+      double d = tracksAsRows ? distance(rows[i], cols[j])
+                              : distance(cols[j], rows[i]);
+      cost[i * m + j] = (d >= 0.) ? d : forbidden;
+    }
+  }
+
+  const double inf = std::numeric_limits<double>::max();
+  std::vector<double> u(n + 1, 0.), v(m + 1, 0.), minv(m + 1);
+  std::vector<size_t> p(m + 1, 0), way(m + 1, 0);
+  std::vector<bool> done(m + 1);
+  for (size_t i = 1; i <= n; ++i) {
+    p[0] = i;
+    size_t j0 = 0;
+    std::fill(minv.begin(), minv.end(), inf);
+    std::fill(done.begin(), done.end(), false);
+    do {
+      done[j0] = true;
+      size_t i0 = p[j0];
+      size_t j1 = 0;
+      double delta = inf;
+      for (size_t j = 1; j <= m; ++j) {
+        if (!done[j]) {
+          double cur = cost[(i0 - 1) * m + (j - 1)] - u[i0] - v[j];
+          if (cur < minv[j]) {
+            minv[j] = cur;
+            way[j] = j0;
+          }
+          if (minv[j] < delta) {
+            delta = minv[j];
+            j1 = j;
+          }
+        }
+      }
+      for (size_t j = 0; j <= m; ++j) {
+        if (done[j]) {
+          u[p[j]] += delta;
+          v[j] -= delta;
+        } else {
+          minv[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (p[j0] != 0);
+    do {
+      size_t j1 = way[j0];
+      p[j0] = p[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+
+  for (size_t j = 1; j <= m; ++j) {
+    if (p[j] == 0 || cost[(p[j] - 1) * m + (j - 1)] >= forbidden) {
+      continue;
+    }
+    size_t track = tracksAsRows ? rows[p[j] - 1] : cols[j - 1];
+    size_t hit = tracksAsRows ? cols[j - 1] : rows[p[j] - 1];
+    result[track] = static_cast<int>(hit);
+    _used[hit] = true;
+  }
+}
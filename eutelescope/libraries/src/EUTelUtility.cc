@@ -166,6 +166,100 @@ namespace eutelescope {
       return getSparseData(data, static_cast<SparsePixelType>(type));
     }
 
+    std::vector<std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>>>
+    findSparseClusters(
+        std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> pixels,
+        int maxDistanceSquared) {
+      std::vector<
+          std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>>>
+          clusters;
+      std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>>
+          newlyAdded;
+
+      while (!pixels.empty()) {
+        // the first pixel not yet clustered seeds a new cluster
+        clusters.emplace_back();
+        auto &cluster = clusters.back();
+        newlyAdded.push_back(pixels.front());
+        cluster.push_back(pixels.front());
+        pixels.erase(pixels.begin());
+
+        // grow the cluster with the neighbours of the newly added pixels
+        while (!newlyAdded.empty()) {
+          bool newlyDone = true;
+          auto x1 = newlyAdded.front().get().getXCoord();
+          auto y1 = newlyAdded.front().get().getYCoord();
+          for (auto hitVec = pixels.begin(); hitVec != pixels.end();
+               ++hitVec) {
+            auto dX = x1 - hitVec->get().getXCoord();
+            auto dY = y1 - hitVec->get().getYCoord();
+            int distance = dX * dX + dY * dY;
+            if (distance <= maxDistanceSquared) {
+              newlyAdded.push_back(*hitVec);
+              cluster.push_back(*hitVec);
+              pixels.erase(hitVec);
+              // the pixel we test might have other neighbours
+              newlyDone = false;
+              break;
+            }
+          }
+          // no neighbour left among _ALL_ non cluster pixels
+          if (newlyDone)
+            newlyAdded.erase(newlyAdded.begin());
+        }
+      }
+      return clusters;
+    }
+
+    std::vector<std::vector<EUTelGeometricPixel>>
+    findGeometricClusters(std::vector<EUTelGeometricPixel> pixels,
+                          float cutT) {
+      std::vector<std::vector<EUTelGeometricPixel>> clusters;
+      std::vector<EUTelGeometricPixel> newlyAdded;
+
+      while (!pixels.empty()) {
+        // the first pixel not yet clustered seeds a new cluster
+        clusters.emplace_back();
+        auto &cluster = clusters.back();
+        newlyAdded.push_back(pixels.front());
+        cluster.push_back(pixels.front());
+        pixels.erase(pixels.begin());
+
+        // grow the cluster with the neighbours of the newly added pixels
+        while (!newlyAdded.empty()) {
+          bool newlyDone = true;
+          float x1 = newlyAdded.front().getPosX();
+          float y1 = newlyAdded.front().getPosY();
+          float t1 = newlyAdded.front().getTime();
+          float cx1 = newlyAdded.front().getBoundaryX();
+          float cy1 = newlyAdded.front().getBoundaryY();
+          for (auto hitVec = pixels.begin(); hitVec != pixels.end();
+               ++hitVec) {
+            float dX = x1 - hitVec->getPosX();
+            float dY = y1 - hitVec->getPosY();
+            float dT = t1 - hitVec->getTime();
+            // this additional 1% is accounting for precision uncertainty
+            // with the geo framework
+            float cutX = (cx1 + hitVec->getBoundaryX()) * 1.01;
+            float cutY = (cy1 + hitVec->getBoundaryY()) * 1.01;
+            if ((dX * dX <= cutX * cutX) && (dY * dY <= cutY * cutY) &&
+                (dT * dT <= cutT * cutT)) {
+              newlyAdded.push_back(*hitVec);
+              cluster.push_back(*hitVec);
+              pixels.erase(hitVec);
+              // the pixel we test might have other neighbours
+              newlyDone = false;
+              break;
+            }
+          }
+          // no neighbour left among _ALL_ non cluster pixels
+          if (newlyDone)
+            newlyAdded.erase(newlyAdded.begin());
+        }
+      }
+      return clusters;
+    }
+
     std::unique_ptr<EUTelClusterDataInterfacerBase>
     getClusterData(IMPL::TrackerDataImpl *const data, int type) {
       return getClusterData(data, static_cast<SparsePixelType>(type));
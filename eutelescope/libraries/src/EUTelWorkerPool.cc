@@ -0,0 +1,113 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelWorkerPool.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace std;
+using namespace eutelescope;
+
+EUTelWorkerPool::EUTelWorkerPool(unsigned int noOfWorkers)
+    : _noOfWorkers(std::max(noOfWorkers, 1u)), _threads(), _mutex(),
+      _startCondition(), _doneCondition(), _task(nullptr), _noOfTasks(0),
+      _generation(0), _pending(0), _stop(false), _error() {
+
+  for (unsigned int worker = 1; worker < _noOfWorkers; ++worker) {
+    _threads.emplace_back(&EUTelWorkerPool::workerLoop, this, worker);
+  }
+}
+
+EUTelWorkerPool::~EUTelWorkerPool() {
+  {
+    lock_guard<mutex> lock(_mutex);
+    _stop = true;
+  }
+  _startCondition.notify_all();
+  for (thread &t : _threads) {
+    t.join();
+  }
+}
+
+void EUTelWorkerPool::run(std::size_t noOfTasks, const Task &task) {
+
+  if (noOfTasks == 0) {
+    return;
+  }
+
+  // not worth waking up the threads
+  if (_threads.empty() || noOfTasks == 1) {
+    for (std::size_t i = 0; i < noOfTasks; ++i) {
+      task(i, static_cast<unsigned int>(i % _noOfWorkers));
+    }
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(_mutex);
+    _task = &task;
+    _noOfTasks = noOfTasks;
+    _pending = static_cast<unsigned int>(_threads.size());
+    _error = nullptr;
+    ++_generation;
+  }
+  _startCondition.notify_all();
+
+  runShare(0);
+
+  unique_lock<mutex> lock(_mutex);
+  _doneCondition.wait(lock, [this] { return _pending == 0; });
+  _task = nullptr;
+  if (_error) {
+    exception_ptr error = _error;
+    _error = nullptr;
+    rethrow_exception(error);
+  }
+}
+
+void EUTelWorkerPool::workerLoop(unsigned int worker) {
+  unsigned long seen = 0;
+  while (true) {
+    {
+      unique_lock<mutex> lock(_mutex);
+      _startCondition.wait(lock,
+                           [this, seen] { return _stop || _generation != seen; });
+      if (_stop) {
+        return;
+      }
+      seen = _generation;
+    }
+
+    runShare(worker);
+
+    bool last = false;
+    {
+      lock_guard<mutex> lock(_mutex);
+      last = (--_pending == 0);
+    }
+    if (last) {
+      _doneCondition.notify_one();
+    }
+  }
+}
+
+void EUTelWorkerPool::runShare(unsigned int worker) {
+  try {
+    for (std::size_t i = worker; i < _noOfTasks; i += _noOfWorkers) {
+      (*_task)(i, worker);
+    }
+  } catch (...) {
+    lock_guard<mutex> lock(_mutex);
+    if (!_error) {
+      _error = current_exception();
+    }
+  }
+}
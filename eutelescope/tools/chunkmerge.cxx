@@ -0,0 +1,562 @@
+// eutelescope includes ""
+#include "anyoption.h"
+#include "EUTELESCOPE.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+
+// lcio includes <>
+#include <IO/LCWriter.h>
+#include <IO/LCReader.h>
+#include <lcio.h>
+#include <Exceptions.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/LCEventImpl.h>
+#include <UTIL/LCTime.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDEncoder.h>
+#include <UTIL/CellIDDecoder.h>
+
+// ROOT includes <>
+#include <TROOT.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TClass.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TList.h>
+#include <TTree.h>
+#include <TChain.h>
+
+//system includes <>
+#include <glob.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace IMPL;
+using namespace eutelescope;
+
+namespace {
+
+  //! Pairwise tree reduction of @c parts into parts[0]
+  /*! At each level the part i+stride is merged into the part i, the
+   *  pairs of one level are independent and are processed by up to
+   *  @c nThreads threads. The merge order only depends on the number
+   *  of parts, so the result is reproducible.
+   */
+  template <class T, class Merger>
+  void treeReduce( vector< T > & parts, unsigned int nThreads, Merger merge ) {
+
+    for ( size_t stride = 1; stride < parts.size(); stride *= 2 ) {
+
+      vector< pair< size_t, size_t > > pairs;
+      for ( size_t i = 0; i + stride < parts.size(); i += 2 * stride ) {
+        pairs.push_back( make_pair( i, i + stride ) );
+      }
+
+      atomic< size_t > next( 0 );
+      auto worker = [&]() {
+        for ( size_t iPair = next++; iPair < pairs.size(); iPair = next++ ) {
+          merge( parts[ pairs[ iPair ].first ], parts[ pairs[ iPair ].second ] );
+        }
+      };
+
+      size_t nWorkers = min< size_t >( nThreads, pairs.size() );
+      vector< thread > workers;
+      for ( size_t iWorker = 1; iWorker < nWorkers; ++iWorker ) {
+        workers.emplace_back( worker );
+      }
+      worker();
+      for ( auto & w : workers ) w.join();
+    }
+  }
+
+  bool hasExtension( const string & name, const string & ext ) {
+    return name.size() >= ext.size() && name.compare( name.size() - ext.size(), ext.size(), ext ) == 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  // ROOT histogram files
+  // ---------------------------------------------------------------------------
+
+  //! The content of one ROOT file, histograms are held in memory
+  struct RootContent {
+    vector< string > directories;
+    vector< string > trees;
+    vector< pair< string, unique_ptr< TH1 > > > histos;
+    map< string, size_t > histoIndex;
+    bool good = true;
+  };
+
+  void readRootDirectory( TDirectory * dir, const string & prefix, RootContent & content ) {
+
+    // keys are listed with the highest cycle first, older cycles are skipped
+    set< string > seen;
+    TIter next( dir->GetListOfKeys() );
+    while ( TKey * key = static_cast< TKey * >( next() ) ) {
+      string name = key->GetName();
+      if ( ! seen.insert( name ).second ) continue;
+
+      string path = prefix.empty() ? name : prefix + "/" + name;
+      TClass * cl = TClass::GetClass( key->GetClassName() );
+      if ( cl == nullptr ) {
+        cerr << "Unknown class " << key->GetClassName() << " for " << path << ", skipping" << endl;
+      } else if ( cl->InheritsFrom( TDirectory::Class() ) ) {
+        content.directories.push_back( path );
+        readRootDirectory( dir->GetDirectory( name.c_str() ), path, content );
+      } else if ( cl->InheritsFrom( TTree::Class() ) ) {
+        content.trees.push_back( path );
+      } else if ( cl->InheritsFrom( TH1::Class() ) ) {
+        unique_ptr< TH1 > histo( dynamic_cast< TH1 * >( key->ReadObj() ) );
+        histo->SetDirectory( nullptr );
+        content.histoIndex[ path ] = content.histos.size();
+        content.histos.push_back( make_pair( path, move( histo ) ) );
+      } else {
+        cerr << "Objects of class " << key->GetClassName() << " cannot be merged, skipping " << path << endl;
+      }
+    }
+  }
+
+  //! Merge the content of @c other into @c content
+  /*! Objects missing in one of the two are taken over, this happens
+   *  for histograms which are only booked on demand.
+   */
+  void mergeRootContent( RootContent & content, RootContent & other ) {
+
+    content.good = content.good && other.good;
+
+    for ( auto & dir : other.directories ) {
+      if ( find( content.directories.begin(), content.directories.end(), dir ) == content.directories.end() ) {
+        content.directories.push_back( dir );
+      }
+    }
+    for ( auto & tree : other.trees ) {
+      if ( find( content.trees.begin(), content.trees.end(), tree ) == content.trees.end() ) {
+        content.trees.push_back( tree );
+      }
+    }
+
+    for ( auto & entry : other.histos ) {
+      auto iter = content.histoIndex.find( entry.first );
+      if ( iter == content.histoIndex.end() ) {
+        content.histoIndex[ entry.first ] = content.histos.size();
+        content.histos.push_back( move( entry ) );
+        continue;
+      }
+      TH1 * target = content.histos[ iter->second ].second.get();
+      TList list;
+      list.Add( entry.second.get() );
+      if ( target->Merge( &list ) < 0 ) {
+        cerr << "Error merging " << entry.first << endl;
+        content.good = false;
+      }
+    }
+    other.histos.clear();
+    other.histoIndex.clear();
+  }
+
+  TDirectory * makeDirectory( TDirectory * top, const string & path ) {
+    TDirectory * current = top;
+    size_t begin = 0;
+    while ( begin < path.size() ) {
+      size_t end = path.find( '/', begin );
+      if ( end == string::npos ) end = path.size();
+      string name = path.substr( begin, end - begin );
+      TDirectory * sub = current->GetDirectory( name.c_str() );
+      if ( sub == nullptr ) sub = current->mkdir( name.c_str() );
+      current = sub;
+      begin = end + 1;
+    }
+    return current;
+  }
+
+  void splitPath( const string & path, string & dir, string & name ) {
+    size_t slash = path.rfind( '/' );
+    dir  = ( slash == string::npos ) ? "" : path.substr( 0, slash );
+    name = ( slash == string::npos ) ? path : path.substr( slash + 1 );
+  }
+
+  int mergeRootFiles( const string & outputFileName, const vector< string > & inputFileNames, unsigned int nThreads ) {
+
+    // each thread opens its own files, histograms are detached from them
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory( kFALSE );
+
+    // read all inputs in parallel, this is also the first reduction level
+    vector< RootContent > parts( inputFileNames.size() );
+    atomic< size_t > next( 0 );
+    auto reader = [&]() {
+      for ( size_t iFile = next++; iFile < inputFileNames.size(); iFile = next++ ) {
+        unique_ptr< TFile > file( TFile::Open( inputFileNames[ iFile ].c_str(), "READ" ) );
+        if ( ! file || file->IsZombie() ) {
+          cerr << "Unable to open " << inputFileNames[ iFile ] << endl;
+          parts[ iFile ].good = false;
+          continue;
+        }
+        readRootDirectory( file.get(), "", parts[ iFile ] );
+      }
+    };
+    vector< thread > readers;
+    for ( size_t iThread = 1; iThread < min< size_t >( nThreads, inputFileNames.size() ); ++iThread ) {
+      readers.emplace_back( reader );
+    }
+    reader();
+    for ( auto & r : readers ) r.join();
+
+    treeReduce( parts, nThreads, mergeRootContent );
+    RootContent & merged = parts.front();
+    if ( ! merged.good ) {
+      cerr << "Not all inputs could be merged, no output written" << endl;
+      return 4;
+    }
+
+    unique_ptr< TFile > outputFile( TFile::Open( outputFileName.c_str(), "RECREATE" ) );
+    if ( ! outputFile || outputFile->IsZombie() ) {
+      cerr << "Unable to create " << outputFileName << endl;
+      return 3;
+    }
+
+    for ( auto & dir : merged.directories ) {
+      makeDirectory( outputFile.get(), dir );
+    }
+
+    string dirName, objectName;
+    for ( auto & entry : merged.histos ) {
+      splitPath( entry.first, dirName, objectName );
+      makeDirectory( outputFile.get(), dirName )->WriteTObject( entry.second.get(), objectName.c_str() );
+    }
+
+    // tuples are concatenated in the order of the inputs, so the entries
+    // come in the same order as in a single job over the whole run
+    for ( auto & tree : merged.trees ) {
+      TChain chain( tree.c_str() );
+      for ( auto & input : inputFileNames ) chain.Add( input.c_str() );
+
+      splitPath( tree, dirName, objectName );
+      makeDirectory( outputFile.get(), dirName )->cd();
+      TTree * mergedTree = chain.CloneTree( -1, "fast" );
+      if ( mergedTree == nullptr ) {
+        cerr << "Error merging tree " << tree << endl;
+        return 4;
+      }
+      mergedTree->SetName( objectName.c_str() );
+      mergedTree->Write();
+    }
+
+    outputFile->Close();
+
+    cout << "Merged " << merged.histos.size() << " histograms and " << merged.trees.size()
+         << " trees from " << inputFileNames.size() << " files" << endl;
+    return 0;
+  }
+
+  // ---------------------------------------------------------------------------
+  // noisy pixel databases
+  // ---------------------------------------------------------------------------
+
+  //! The hit counts of one or more noisy pixel databases
+  struct PixelDB {
+    int nEvents = 0;
+    // the NoOfEvents parameter of EUTelProcessorNoisyPixelFinder
+    int configuredNoOfEvents = 0;
+    float maxAllowedFiringFreq = 0;
+    // sensorID -> ( x, y ) -> number of hits
+    map< int, map< pair< int, int >, long int > > hitCounts;
+  };
+
+  void mergePixelDB( PixelDB & db, PixelDB & other ) {
+    db.nEvents += other.nEvents;
+    for ( auto & sensor : other.hitCounts ) {
+      auto & target = db.hitCounts[ sensor.first ];
+      for ( auto & pixel : sensor.second ) {
+        target[ pixel.first ] += pixel.second;
+      }
+    }
+    other.hitCounts.clear();
+  }
+
+  //! Read a db written by EUTelProcessorNoisyPixelFinder with HitCountCollectionName set
+  bool readPixelDB( lcio::LCReader * lcReader, const string & fileName, const string & hitCountCollectionName, PixelDB & db ) {
+
+    try {
+      lcReader->open( fileName );
+      lcio::LCEvent * event = lcReader->readNextEvent();
+      if ( event == nullptr ) {
+        cerr << fileName << " contains no db event" << endl;
+        lcReader->close();
+        return false;
+      }
+
+      db.nEvents = event->getParameters().getIntVal( "NoOfEvents" );
+      lcio::StringVec intKeys;
+      event->getParameters().getIntKeys( intKeys );
+      if ( find( intKeys.begin(), intKeys.end(), "ConfiguredNoOfEvents" ) == intKeys.end() ) {
+        cerr << fileName << " does not contain the configured NoOfEvents, it was written by an older"
+             << " EUTelProcessorNoisyPixelFinder" << endl;
+        lcReader->close();
+        return false;
+      }
+      db.configuredNoOfEvents = event->getParameters().getIntVal( "ConfiguredNoOfEvents" );
+      db.maxAllowedFiringFreq = event->getParameters().getFloatVal( "MaxAllowedFiringFreq" );
+
+      lcio::LCCollection * collection = event->getCollection( hitCountCollectionName );
+      lcio::CellIDDecoder< TrackerDataImpl > cellDecoder( collection );
+      for ( int iElement = 0; iElement < collection->getNumberOfElements(); ++iElement ) {
+        TrackerDataImpl * frame = dynamic_cast< TrackerDataImpl * >( collection->getElementAt( iElement ) );
+        int sensorID = static_cast< int >( cellDecoder( frame )[ "sensorID" ] );
+
+        // make sure sensors without any hit are kept as well
+        auto & counts = db.hitCounts[ sensorID ];
+        EUTelTrackerDataInterfacerImpl< EUTelGenericSparsePixel > sparseFrame( frame );
+        auto & pixels = sparseFrame.getPixels();
+
+        // the exact counts are the integers of the collection parameter, the
+        // signal of the pixels is a float
+        lcio::IntVec pixelCounts;
+        collection->getParameters().getIntVals( "HitCounts_" + to_string( sensorID ), pixelCounts );
+        if ( pixelCounts.size() != pixels.size() ) {
+          cerr << fileName << ": " << pixelCounts.size() << " integer hit counts for the " << pixels.size()
+               << " pixels of sensor " << sensorID << endl;
+          lcReader->close();
+          return false;
+        }
+        for ( size_t iPixel = 0; iPixel < pixels.size(); ++iPixel ) {
+          counts[ make_pair( pixels[ iPixel ].getXCoord(), pixels[ iPixel ].getYCoord() ) ] += pixelCounts[ iPixel ];
+        }
+      }
+      lcReader->close();
+
+    } catch ( lcio::DataNotAvailableException& e ) {
+      cerr << fileName << ": " << e.what() << endl
+           << "Was it written by EUTelProcessorNoisyPixelFinder with HitCountCollectionName set?" << endl;
+      return false;
+    } catch ( lcio::IOException& e ) {
+      cerr << e.what() << endl;
+      return false;
+    }
+    return true;
+  }
+
+  //! Add a collection of sparse pixels, with the integer hit counts of each sensor if given
+  void addPixelCollection( lcio::LCEventImpl * event, const string & name, const map< int, vector< EUTelGenericSparsePixel > > & pixels,
+                           const map< int, lcio::IntVec > * hitCounts = nullptr ) {
+
+    lcio::LCCollectionVec * collection = new lcio::LCCollectionVec( lcio::LCIO::TRACKERDATA );
+    if ( hitCounts != nullptr ) {
+      for ( auto & sensor : *hitCounts ) {
+        collection->parameters().setValues( "HitCounts_" + to_string( sensor.first ), sensor.second );
+      }
+    }
+    for ( auto & sensor : pixels ) {
+      lcio::CellIDEncoder< TrackerDataImpl > encoder( EUTELESCOPE::ZSDATADEFAULTENCODING, collection );
+      encoder[ "sensorID" ] = sensor.first;
+      encoder[ "sparsePixelType" ] = kEUTelGenericSparsePixel;
+
+      unique_ptr< TrackerDataImpl > frame( new TrackerDataImpl );
+      encoder.setCellID( frame.get() );
+      EUTelTrackerDataInterfacerImpl< EUTelGenericSparsePixel > sparseFrame( frame.get() );
+      for ( auto & pixel : sensor.second ) sparseFrame.push_back( pixel );
+      collection->push_back( frame.release() );
+    }
+    event->addCollection( collection, name );
+  }
+
+  int mergePixelDBs( const string & outputFileName, const vector< string > & inputFileNames, unsigned int nThreads,
+                     const string & noisyPixelCollectionName, const string & hitCountCollectionName ) {
+
+    // the LCIO readers are not thread safe, the dbs are read one after the other
+    vector< PixelDB > parts( inputFileNames.size() );
+    unique_ptr< lcio::LCReader > lcReader( lcio::LCFactory::getInstance()->createLCReader() );
+    for ( size_t iFile = 0 ; iFile < inputFileNames.size(); ++iFile ) {
+      if ( ! readPixelDB( lcReader.get(), inputFileNames[ iFile ], hitCountCollectionName, parts[ iFile ] ) ) return 4;
+      if ( parts[ iFile ].maxAllowedFiringFreq != parts.front().maxAllowedFiringFreq ) {
+        cerr << "Error! " << inputFileNames[ iFile ] << " was produced with MaxAllowedFiringFreq "
+             << parts[ iFile ].maxAllowedFiringFreq << " instead of " << parts.front().maxAllowedFiringFreq << endl;
+        return 4;
+      }
+      if ( parts[ iFile ].configuredNoOfEvents != parts.front().configuredNoOfEvents ) {
+        cerr << "Error! " << inputFileNames[ iFile ] << " was produced with NoOfEvents "
+             << parts[ iFile ].configuredNoOfEvents << " instead of " << parts.front().configuredNoOfEvents << endl;
+        return 4;
+      }
+    }
+
+    treeReduce( parts, nThreads, mergePixelDB );
+    PixelDB & merged = parts.front();
+    if ( merged.nEvents <= 0 ) {
+      cerr << "Error! The inputs contain no events" << endl;
+      return 4;
+    }
+    // a single job stops counting after NoOfEvents events, the sum of more
+    // events would give different noisy pixels
+    if ( merged.nEvents > merged.configuredNoOfEvents ) {
+      cerr << "Error! The inputs contain " << merged.nEvents << " events, more than the NoOfEvents "
+           << merged.configuredNoOfEvents << " they were produced with" << endl
+           << "Set NoOfEvents to at least the number of events of the whole run" << endl;
+      return 4;
+    }
+
+    // apply the cut exactly as EUTelProcessorNoisyPixelFinder does, pixels
+    // are ordered by x and then y in both cases
+    map< int, vector< EUTelGenericSparsePixel > > noisyPixels, hitCountPixels;
+    map< int, lcio::IntVec > hitCounts;
+    for ( auto & sensor : merged.hitCounts ) {
+      auto & noisy = noisyPixels[ sensor.first ];
+      auto & countPixels = hitCountPixels[ sensor.first ];
+      auto & counts = hitCounts[ sensor.first ];
+      for ( auto & pixel : sensor.second ) {
+        if ( pixel.second > numeric_limits< int >::max() ) {
+          cerr << "Error! The hit count of pixel " << pixel.first.first << ", " << pixel.first.second
+               << " of sensor " << sensor.first << " does not fit into an integer" << endl;
+          return 4;
+        }
+        EUTelGenericSparsePixel countPixel( pixel.first.first, pixel.first.second, static_cast< float >( pixel.second ) );
+        countPixels.push_back( countPixel );
+        counts.push_back( static_cast< int >( pixel.second ) );
+
+        double fireFreq = static_cast< double >( pixel.second ) / static_cast< double >( merged.nEvents );
+        if ( fireFreq > merged.maxAllowedFiringFreq ) {
+          EUTelGenericSparsePixel noisyPixel;
+          noisyPixel.setXCoord( pixel.first.first );
+          noisyPixel.setYCoord( pixel.first.second );
+          noisyPixel.setSignal( fireFreq );
+          noisy.push_back( noisyPixel );
+        }
+      }
+      cout << "Found " << noisy.size() << " noisy pixels on sensor: " << sensor.first << endl;
+    }
+
+    unique_ptr< lcio::LCWriter > lcWriter( lcio::LCFactory::getInstance()->createLCWriter() );
+    try {
+      lcWriter->open( outputFileName, lcio::LCIO::WRITE_NEW );
+
+      lcio::LCRunHeaderImpl lcHeader;
+      lcHeader.setRunNumber( 0 );
+      lcWriter->writeRunHeader( &lcHeader );
+
+      lcio::LCEventImpl event;
+      event.setRunNumber( 0 );
+      event.setEventNumber( 0 );
+      event.setDetectorName( "EUTelNoisyPixel" );
+      lcio::LCTime now;
+      event.setTimeStamp( now.timeStamp() );
+
+      addPixelCollection( &event, noisyPixelCollectionName, noisyPixels );
+      event.parameters().setValue( "NoOfEvents", merged.nEvents );
+      event.parameters().setValue( "ConfiguredNoOfEvents", merged.configuredNoOfEvents );
+      event.parameters().setValue( "MaxAllowedFiringFreq", merged.maxAllowedFiringFreq );
+      // keep the summed counts so that the output can be merged again
+      addPixelCollection( &event, hitCountCollectionName, hitCountPixels, &hitCounts );
+
+      lcWriter->writeEvent( &event );
+      lcWriter->close();
+    } catch ( lcio::IOException& e ) {
+      cerr << e.what() << endl;
+      return 3;
+    }
+
+    cout << "Merged " << inputFileNames.size() << " noisy pixel dbs with " << merged.nEvents << " events" << endl;
+    return 0;
+  }
+
+}
+
+int main( int argc, char ** argv ) {
+
+  unique_ptr<AnyOption> option( new AnyOption );
+
+  string usageString =
+    "\n"
+    "This program merges the outputs of a run processed in chunks (see jobsub --chunks)\n"
+    "into the output a single job over the whole run would have produced.\n"
+    "\n"
+    "ROOT files: histograms and profiles are summed, tuples are concatenated in the\n"
+    "order of the input files.\n"
+    "LCIO files: noisy pixel dbs written by EUTelProcessorNoisyPixelFinder with\n"
+    "HitCountCollectionName set. The hit counts are summed and the firing frequency\n"
+    "cut is applied again to the total number of events, which must not exceed the\n"
+    "NoOfEvents the dbs were produced with.\n"
+    "\n"
+    "The inputs are merged in a pairwise tree reduction using several threads.\n"
+    "\n"
+    "chunkmerge [option] -o output.root chunk1.root chunk2.root [chunkN.root]\n"
+    "chunkmerge [option] -o output.slcio chunk1.slcio chunk2.slcio [chunkN.slcio]\n"
+    "\n"
+    "-h --help                    Print this help\n"
+    "-j --jobs N                  Number of threads (default: number of cores)\n"
+    "--hotpixel-collection name   Name of the noisy pixel collection (default: noisyPixel)\n"
+    "--count-collection name      Name of the hit count collection (default: hitCount)\n";
+
+  option->addUsage( usageString.c_str() );
+  option->setFlag( "help", 'h');
+  option->setOption( "output", 'o' );
+  option->setOption( "jobs", 'j' );
+  option->setOption( "hotpixel-collection" );
+  option->setOption( "count-collection" );
+
+  option->processCommandArgs( argc,  argv );
+
+  if ( option->getFlag('h') || option->getFlag( "help" ) ) {
+    option->printUsage();
+    return 0;
+  }
+
+  if ( option->getValue( "output" ) == nullptr ) {
+    cerr << "Please provide an output file name using -o option" << endl;
+    return 2;
+  }
+  string outputFileName = option->getValue( "output" );
+
+  unsigned int nThreads = max( 1u, thread::hardware_concurrency() );
+  if ( option->getValue( "jobs" ) != nullptr ) {
+    nThreads = static_cast< unsigned int >( max( 1, atoi( option->getValue( "jobs" ) ) ) );
+  }
+
+  string noisyPixelCollectionName = "noisyPixel";
+  if ( option->getValue( "hotpixel-collection" ) != nullptr ) noisyPixelCollectionName = option->getValue( "hotpixel-collection" );
+  string hitCountCollectionName = "hitCount";
+  if ( option->getValue( "count-collection" ) != nullptr ) hitCountCollectionName = option->getValue( "count-collection" );
+
+  // the input files may be using wildcards
+  glob_t globbuf;
+  for ( size_t iArg = 0 ; iArg < static_cast<size_t>(option->getArgc()); ++iArg ) {
+    if ( iArg == 0 ) glob( option->getArgv( iArg ), 0, nullptr, &globbuf);
+    else  glob( option->getArgv( iArg ), GLOB_APPEND, nullptr, &globbuf);
+  }
+
+  vector< string > inputFileNames;
+  if ( option->getArgc() > 0 ) {
+    inputFileNames.assign( &globbuf.gl_pathv[0], &globbuf.gl_pathv[ globbuf.gl_pathc ] );
+    globfree( &globbuf );
+  }
+
+  if ( inputFileNames.size() <= 1 ) {
+    cerr << "Please provide at least two valid input files" << endl;
+    return 1;
+  }
+
+  cout << "Target file: " << outputFileName << endl;
+  for ( size_t iFile = 0; iFile < inputFileNames.size() ; ++iFile ) {
+    cout << "Input file: " << inputFileNames.at( iFile ) << endl;
+  }
+
+  if ( hasExtension( outputFileName, ".root" ) ) {
+    return mergeRootFiles( outputFileName, inputFileNames, nThreads );
+  } else if ( hasExtension( outputFileName, ".slcio" ) ) {
+    return mergePixelDBs( outputFileName, inputFileNames, nThreads, noisyPixelCollectionName, hitCountCollectionName );
+  }
+
+  cerr << "Unknown output type, please use either a .root or a .slcio file" << endl;
+  return 2;
+}
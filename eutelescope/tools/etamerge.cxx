@@ -0,0 +1,236 @@
+// eutelescope includes ""
+#include "anyoption.h"
+#include "EUTELESCOPE.h"
+#include "EUTelEtaAccumulator.h"
+#include "EUTelEtaFunctionImpl.h"
+#include "EUTelExceptions.h"
+
+// lcio includes <>
+#include <IO/LCWriter.h>
+#include <IO/LCReader.h>
+#include <lcio.h>
+#include <Exceptions.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/LCEventImpl.h>
+#include <UTIL/LCTime.h>
+#include <IMPL/LCCollectionVec.h>
+
+//system includes <>
+#include <glob.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace IMPL;
+using namespace eutelescope;
+
+namespace {
+
+  //! Adds the accumulators of one collection to the sensor map
+  /*! @return false if the collection is not in the event
+   */
+  bool addCounts( lcio::LCEvent * event, const string & collectionName, map< int, EUTelEtaAccumulator > & accumulators ) {
+
+    lcio::LCCollection * collection = nullptr;
+    try {
+      collection = event->getCollection( collectionName );
+    } catch ( lcio::DataNotAvailableException& e ) {
+      return false;
+    }
+
+    for ( int iElement = 0; iElement < collection->getNumberOfElements(); ++iElement ) {
+      EUTelEtaAccumulator counts( dynamic_cast< lcio::LCGenericObject * > ( collection->getElementAt( iElement ) ) );
+      map< int, EUTelEtaAccumulator >::iterator iter = accumulators.find( counts.getSensorID() );
+      if ( iter == accumulators.end() ) {
+        accumulators.insert( make_pair( counts.getSensorID(), counts ) );
+      } else {
+        iter->second.merge( counts );
+      }
+    }
+    return true;
+  }
+
+}
+
+int main( int argc, char ** argv ) {
+
+  unique_ptr<AnyOption> option( new AnyOption );
+
+  string usageString =
+    "\n"
+    "This program merges the eta calculations done on different parts of the data.\n"
+    "The input files are written by the EUTelCalculateEtaProcessor with\n"
+    "WriteEtaCounts set to true. The CoG bin counts of each sensor are summed\n"
+    "and the eta functions are calculated from the sum, so the result is the\n"
+    "same as the one of a single job on all the data. The merged counts are\n"
+    "saved as well, so the output can be merged again.\n"
+    "\n"
+    "etamerge [option] -o outputfile.slcio file1.slcio file2.slcio [fileN.slcio]\n"
+    "\n"
+    "-h --help             Print this help\n"
+    "--eta-x name          The eta collection along x (default xEtaCondition)\n"
+    "--eta-y name          The eta collection along y (default yEtaCondition)\n"
+    "--counts-x name       The counts collection along x (default xEtaCounts)\n"
+    "--counts-y name       The counts collection along y (default yEtaCounts)\n";
+
+  option->addUsage( usageString.c_str() );
+  option->setFlag( "help", 'h');
+  option->setOption( "output", 'o' );
+  option->setOption( "eta-x" );
+  option->setOption( "eta-y" );
+  option->setOption( "counts-x" );
+  option->setOption( "counts-y" );
+
+  option->processCommandArgs( argc,  argv );
+
+  if ( option->getFlag('h') || option->getFlag( "help" ) ) {
+    option->printUsage();
+    return 0;
+  }
+
+  if ( option->getValue( "output" ) == nullptr ) {
+    cerr << "Please provide an output file name using -o option" << endl;
+    return 2;
+  }
+
+  string outputFileName = option->getValue( "output" );
+  // check if the output lcio file has the extension
+  if ( outputFileName.rfind( ".slcio", string::npos ) == string::npos ) {
+    outputFileName.append( ".slcio" );
+  }
+
+  string etaXCollectionName = "xEtaCondition";
+  if ( option->getValue( "eta-x" ) != nullptr ) etaXCollectionName = option->getValue( "eta-x" );
+  string etaYCollectionName = "yEtaCondition";
+  if ( option->getValue( "eta-y" ) != nullptr ) etaYCollectionName = option->getValue( "eta-y" );
+  string countsXCollectionName = "xEtaCounts";
+  if ( option->getValue( "counts-x" ) != nullptr ) countsXCollectionName = option->getValue( "counts-x" );
+  string countsYCollectionName = "yEtaCounts";
+  if ( option->getValue( "counts-y" ) != nullptr ) countsYCollectionName = option->getValue( "counts-y" );
+
+  // the input files may be using wildcards
+  glob_t globbuf;
+  for ( size_t iArg = 0 ; iArg < static_cast<size_t>(option->getArgc()); ++iArg ) {
+    if ( iArg == 0 ) glob( option->getArgv( iArg ), 0, nullptr, &globbuf);
+    else  glob( option->getArgv( iArg ), GLOB_APPEND, nullptr, &globbuf);
+  }
+
+  vector< string > inputFileNames;
+  if ( option->getArgc() > 0 ) {
+    inputFileNames.assign( &globbuf.gl_pathv[0], &globbuf.gl_pathv[ globbuf.gl_pathc ] );
+    globfree( &globbuf );
+  }
+
+  if ( inputFileNames.empty() ) {
+    cerr << "Please provide at least one valid input file" << endl;
+    return 1;
+  }
+
+  // print some information
+  cout << "Target file: " << outputFileName << endl;
+  for ( size_t iFile = 0; iFile < inputFileNames.size() ; ++iFile ) {
+    cout << "Input file: " << inputFileNames.at( iFile ) << endl;
+  }
+
+  map< int, EUTelEtaAccumulator > accumulatorsX;
+  map< int, EUTelEtaAccumulator > accumulatorsY;
+  string detectorName;
+  int runNumber = 0;
+
+  lcio::LCReader * lcReader = lcio::LCFactory::getInstance()->createLCReader();
+
+  for ( size_t iFile = 0 ; iFile < inputFileNames.size(); ++iFile ) {
+
+    size_t noOfCounts = 0;
+    try {
+      lcReader->open( inputFileNames.at( iFile ).c_str() );
+
+      lcio::LCEvent * inputEvent = nullptr;
+      while ( ( inputEvent = lcReader->readNextEvent() ) != nullptr ) {
+        if ( detectorName.empty() ) {
+          detectorName = inputEvent->getDetectorName();
+          runNumber = inputEvent->getRunNumber();
+        }
+        if ( addCounts( inputEvent, countsXCollectionName, accumulatorsX ) ) ++noOfCounts;
+        addCounts( inputEvent, countsYCollectionName, accumulatorsY );
+      }
+
+      lcReader->close();
+
+    } catch ( lcio::IOException& e ) {
+      cerr << e.what() << endl;
+      return 3;
+    } catch ( InvalidParameterException& e ) {
+      cerr << "Error in " << inputFileNames.at( iFile ) << ": " << e.what() << endl;
+      return 4;
+    }
+
+    if ( noOfCounts == 0 ) {
+      cerr << "Warning: no " << countsXCollectionName << " collection in " << inputFileNames.at( iFile )
+           << ", was it written with WriteEtaCounts?" << endl;
+    }
+  }
+  delete lcReader;
+
+  if ( accumulatorsX.empty() ) {
+    cerr << "No eta counts found in the input files" << endl;
+    return 5;
+  }
+
+  // open the LCIO output file
+  lcio::LCWriter * lcWriter = lcio::LCFactory::getInstance()->createLCWriter();
+
+  try {
+      lcWriter->open( outputFileName.c_str() , lcio::LCIO::WRITE_NEW );
+  } catch ( lcio::IOException& e ) {
+    cerr << e.what() << endl;
+    return 3;
+  }
+
+  lcio::LCRunHeaderImpl * lcHeader  = new lcio::LCRunHeaderImpl;
+  lcHeader->setRunNumber( runNumber );
+  lcHeader->setDetectorName( detectorName );
+  lcWriter->writeRunHeader(lcHeader);
+  delete lcHeader;
+
+  lcio::LCEventImpl * event = new lcio::LCEventImpl;
+  event->setDetectorName( detectorName );
+  event->setRunNumber( runNumber );
+  event->setEventNumber( 0 );
+
+  lcio::LCTime * now = new lcio::LCTime;
+  event->setTimeStamp( now->timeStamp() );
+  delete now;
+
+  lcio::LCCollectionVec * etaXCollection    = new lcio::LCCollectionVec( lcio::LCIO::LCGENERICOBJECT );
+  lcio::LCCollectionVec * etaYCollection    = new lcio::LCCollectionVec( lcio::LCIO::LCGENERICOBJECT );
+  lcio::LCCollectionVec * countsXCollection = new lcio::LCCollectionVec( lcio::LCIO::LCGENERICOBJECT );
+  lcio::LCCollectionVec * countsYCollection = new lcio::LCCollectionVec( lcio::LCIO::LCGENERICOBJECT );
+
+  for ( map< int, EUTelEtaAccumulator >::iterator iter = accumulatorsX.begin(); iter != accumulatorsX.end(); ++iter ) {
+    cout << "Sensor " << iter->first << ": " << iter->second.getNoOfEntries() << " entries" << endl;
+    etaXCollection->push_back( iter->second.makeEtaFunction() );
+    countsXCollection->push_back( iter->second.makeGenericObject() );
+  }
+  for ( map< int, EUTelEtaAccumulator >::iterator iter = accumulatorsY.begin(); iter != accumulatorsY.end(); ++iter ) {
+    etaYCollection->push_back( iter->second.makeEtaFunction() );
+    countsYCollection->push_back( iter->second.makeGenericObject() );
+  }
+
+  event->addCollection( etaXCollection, etaXCollectionName );
+  event->addCollection( etaYCollection, etaYCollectionName );
+  event->addCollection( countsXCollection, countsXCollectionName );
+  event->addCollection( countsYCollection, countsYCollectionName );
+
+  lcWriter->writeEvent( event );
+  delete event;
+
+  lcWriter->close();
+  delete lcWriter;
+
+  return 0;
+
+}
@@ -0,0 +1,284 @@
+// eutelescope includes ""
+#include "anyoption.h"
+#include "EUTelStraightLineGBLFitter.h"
+
+// GBL
+#include "include/GblTrajectory.h"
+
+// Eigen
+#include <Eigen/Core>
+
+//system includes <>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+
+namespace {
+
+  // six planes, two air scatterers in each gap, as in EUTelGBLFitter
+  const int NPLANES = 6;
+  const int NPOINTS = 16;
+  typedef EUTelStraightLineGBLFitter<NPOINTS> Fitter;
+
+  struct Track {
+    Fitter::PointVector2dArray meas;
+    Fitter::PointVector2dArray prec;
+  };
+
+  struct Output {
+    double chi2;
+    int ndf;
+    std::array<Eigen::Vector2d, NPLANES> offset;
+    std::array<Eigen::Vector2d, NPLANES> slope;
+    std::array<Eigen::Vector2d, NPLANES> variance;
+  };
+
+  // largest differences between the two fits over all tracks
+  struct Difference {
+    double chi2 = 0.;
+    double offset = 0.;
+    double slope = 0.;
+    double variance = 0.;
+    size_t ndf = 0;
+  };
+
+  double relativeDifference(double a, double b) {
+    return std::fabs(a - b) / std::max(std::max(std::fabs(a), std::fabs(b)), 1e-12);
+  }
+
+  Eigen::Matrix<double, 5, 5> jacobianPointToPoint(double ds) {
+    Eigen::Matrix<double, 5, 5> jac = Eigen::Matrix<double, 5, 5>::Identity();
+    jac(3, 1) = ds;
+    jac(4, 2) = ds;
+    return jac;
+  }
+
+  Output fitGBL(const Track &track, const std::array<double, NPOINTS - 1> &steps,
+                const Fitter::PointVector2dArray &scat) {
+    std::vector<gbl::GblPoint> points;
+    Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
+    Eigen::Vector2d kink = Eigen::Vector2d::Zero();
+    for (int i = 0; i < NPOINTS; ++i) {
+      points.emplace_back(jacobianPointToPoint(i == 0 ? 0. : steps[i - 1]));
+      if (track.prec[i][0] > 0.) {
+        points.back().addMeasurement(proL2m, track.meas[i], track.prec[i]);
+      }
+      points.back().addScatterer(kink, scat[i]);
+    }
+
+    Output out;
+    double lostWeight;
+    gbl::GblTrajectory traj(points, false);
+    traj.fit(out.chi2, out.ndf, lostWeight, "");
+
+    Eigen::VectorXd correction(5);
+    Eigen::MatrixXd covariance(5, 5);
+    for (int ipl = 0; ipl < NPLANES; ++ipl) {
+      traj.getResults(3 * ipl + 1, correction, covariance);
+      out.offset[ipl] = Eigen::Vector2d(correction[3], correction[4]);
+      out.slope[ipl] = Eigen::Vector2d(correction[1], correction[2]);
+      out.variance[ipl] = Eigen::Vector2d(covariance(3, 3), covariance(4, 4));
+    }
+    return out;
+  }
+
+  Output fitFixed(const Track &track, Fitter &fitter) {
+    Output out;
+    Fitter::Result result;
+    fitter.fit(track.meas, track.prec, result);
+    out.chi2 = result.getChi2();
+    out.ndf = result.getNdf();
+    for (int ipl = 0; ipl < NPLANES; ++ipl) {
+      out.offset[ipl] = Eigen::Vector2d(result.getOffset(3 * ipl, 0),
+                                        result.getOffset(3 * ipl, 1));
+      out.slope[ipl] = Eigen::Vector2d(result.getSlope(3 * ipl, 0),
+                                       result.getSlope(3 * ipl, 1));
+      out.variance[ipl] = Eigen::Vector2d(result.getOffsetVariance(3 * ipl, 0),
+                                          result.getOffsetVariance(3 * ipl, 1));
+    }
+    return out;
+  }
+}
+
+int main(int argc, char **argv) {
+
+  unique_ptr<AnyOption> option(new AnyOption);
+
+  string usageString =
+      "\n"
+      "This program compares the speed and the results of the generic GBL\n"
+      "trajectory fit with the fixed topology straight line fit used by\n"
+      "EUTelGBLFitter for a six plane telescope with simulated tracks.\n"
+      "\n"
+      "The offsets, slopes and offset variances at the planes and the chi2\n"
+      "of both fits are compared, the program fails if they differ by more\n"
+      "than the tolerances. It is run as a test when GBL is available.\n"
+      "\n"
+      "gblfitbenchmark [option]\n"
+      "\n"
+      "-h --help         Print this help\n"
+      "-n --tracks       Number of tracks (default 100000)\n"
+      "-e --energy       Beam energy in GeV (default 4)\n"
+      "-d --distance     Distance between the planes in mm (default 150)\n"
+      "-a --abstol       Tolerance on the offsets in mm, on the slopes divided\n"
+      "                  by the distance (default 1e-9)\n"
+      "-r --reltol       Relative tolerance on the variances and the chi2\n"
+      "                  (default 1e-6)\n";
+
+  option->addUsage(usageString.c_str());
+  option->setFlag("help", 'h');
+  option->setOption("tracks", 'n');
+  option->setOption("energy", 'e');
+  option->setOption("distance", 'd');
+  option->setOption("abstol", 'a');
+  option->setOption("reltol", 'r');
+
+  option->processCommandArgs(argc, argv);
+
+  if (option->getFlag('h') || option->getFlag("help")) {
+    option->printUsage();
+    return 0;
+  }
+
+  int nTracks = 100000;
+  double eBeam = 4.;
+  double distance = 150.;
+  double absTolerance = 1e-9;
+  double relTolerance = 1e-6;
+  if (option->getValue("tracks")) {
+    nTracks = atoi(option->getValue("tracks"));
+  }
+  if (option->getValue("energy")) {
+    eBeam = atof(option->getValue("energy"));
+  }
+  if (option->getValue("distance")) {
+    distance = atof(option->getValue("distance"));
+  }
+  if (option->getValue("abstol")) {
+    absTolerance = atof(option->getValue("abstol"));
+  }
+  if (option->getValue("reltol")) {
+    relTolerance = atof(option->getValue("reltol"));
+  }
+  if (nTracks <= 0 || eBeam <= 0. || distance <= 0. || absTolerance <= 0. ||
+      relTolerance <= 0.) {
+    cerr << "The number of tracks, the energy, the distance and the tolerances have to be positive" << endl;
+    return 1;
+  }
+
+  // topology and scattering as computed in EUTelGBLFitter::init
+  double totalRadLength = (NPLANES - 1) * distance / 304200.;
+  double radLengthSi = 0.050 / 93.66 + 0.050 / 286.6;
+  totalRadLength += NPLANES * radLengthSi;
+  double highland = 0.0136 / eBeam * (1 + 0.038 * std::log(totalRadLength));
+  double tetSi = highland * std::sqrt(radLengthSi);
+  double tetAir = highland * std::sqrt(0.5 * distance / 304200.);
+
+  std::array<double, NPOINTS - 1> steps;
+  Fitter::PointVector2dArray scat;
+  for (int ipl = 0; ipl < NPLANES; ++ipl) {
+    scat[3 * ipl] = Eigen::Vector2d::Constant(1. / (tetSi * tetSi));
+    if (ipl < NPLANES - 1) {
+      steps[3 * ipl] = 0.21 * distance;
+      steps[3 * ipl + 1] = 0.58 * distance;
+      steps[3 * ipl + 2] = 0.21 * distance;
+      scat[3 * ipl + 1] = Eigen::Vector2d::Constant(1. / (tetAir * tetAir));
+      scat[3 * ipl + 2] = Eigen::Vector2d::Constant(1. / (tetAir * tetAir));
+    }
+  }
+
+  // cluster size dependent resolutions, as in the TelescopeResolution
+  // parameter
+  const std::array<double, 4> resolution = {{3.5e-3, 3.2e-3, 3.8e-3, 4.5e-3}};
+
+  std::mt19937 generator(42);
+  std::normal_distribution<double> gauss(0., 1.);
+  std::uniform_int_distribution<size_t> clusterSize(0, resolution.size() - 1);
+
+  std::vector<Track> tracks(static_cast<size_t>(nTracks));
+  for (Track &track : tracks) {
+    double slope[2] = {1e-4 * gauss(generator), 1e-4 * gauss(generator)};
+    double offset[2] = {0., 0.};
+    for (int i = 0; i < NPOINTS; ++i) {
+      track.meas[i] = Eigen::Vector2d::Zero();
+      track.prec[i] = Eigen::Vector2d::Zero();
+      if (i > 0) {
+        for (int proj = 0; proj < 2; ++proj) {
+          offset[proj] += slope[proj] * steps[i - 1];
+          slope[proj] += gauss(generator) / std::sqrt(scat[i][proj]);
+        }
+      }
+      if (i % 3 == 0) {
+        for (int proj = 0; proj < 2; ++proj) {
+          double res = resolution[clusterSize(generator)];
+          track.meas[i][proj] = offset[proj] + res * gauss(generator);
+          track.prec[i][proj] = 1. / (res * res);
+        }
+      }
+    }
+  }
+
+  std::vector<Output> gblOutput(tracks.size());
+  std::vector<Output> fixedOutput(tracks.size());
+
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    gblOutput[i] = fitGBL(tracks[i], steps, scat);
+  }
+  auto middle = chrono::steady_clock::now();
+  Fitter fitter(steps, scat);
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    fixedOutput[i] = fitFixed(tracks[i], fitter);
+  }
+  auto stop = chrono::steady_clock::now();
+
+  double gblTime = chrono::duration<double>(middle - start).count();
+  double fixedTime = chrono::duration<double>(stop - middle).count();
+
+  Difference diff;
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    const Output &a = gblOutput[i];
+    const Output &b = fixedOutput[i];
+    diff.chi2 = std::max(diff.chi2, relativeDifference(a.chi2, b.chi2));
+    for (int ipl = 0; ipl < NPLANES; ++ipl) {
+      diff.offset = std::max(diff.offset, (a.offset[ipl] - b.offset[ipl]).cwiseAbs().maxCoeff());
+      diff.slope = std::max(diff.slope, (a.slope[ipl] - b.slope[ipl]).cwiseAbs().maxCoeff());
+      for (int proj = 0; proj < 2; ++proj) {
+        diff.variance = std::max(diff.variance, relativeDifference(a.variance[ipl][proj],
+                                                                   b.variance[ipl][proj]));
+      }
+    }
+    if (a.ndf != b.ndf) {
+      ++diff.ndf;
+    }
+  }
+
+  bool passed = diff.ndf == 0 && diff.chi2 <= relTolerance &&
+                diff.offset <= absTolerance &&
+                diff.slope <= absTolerance / distance &&
+                diff.variance <= relTolerance;
+
+  cout << "Tracks:                 " << tracks.size() << endl;
+  cout << "GBL trajectory fit:     " << tracks.size() / gblTime << " tracks/s" << endl;
+  cout << "Fixed topology fit:     " << tracks.size() / fixedTime << " tracks/s" << endl;
+  cout << "Speed-up:               " << gblTime / fixedTime << endl;
+  cout << "Cached factorisations:  " << fitter.getCacheSize() << endl;
+  cout << "Max rel. chi2 diff.:    " << diff.chi2 << endl;
+  cout << "Max offset diff. [mm]:  " << diff.offset << endl;
+  cout << "Max slope diff.:        " << diff.slope << endl;
+  cout << "Max rel. variance diff: " << diff.variance << endl;
+  cout << "Ndf mismatches:         " << diff.ndf << endl;
+  cout << (passed ? "Fixed topology fit agrees with GBL" : "Fixed topology fit differs from GBL") << endl;
+
+  return passed ? 0 : 1;
+}
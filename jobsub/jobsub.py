@@ -301,6 +301,207 @@ def runMarlin(jobtask, runnr, filenamebase, logbase, silent):
         exit(1)
     return rcode
 
+def chunkSuffix(ichunk):
+    """ Returns the string identifying the output of a chunk in file names """
+    return "-chunk" + str(ichunk).zfill(3)
+
+def splitEventRange(nevents, nchunks):
+    """ Splits nevents events into nchunks consecutive ranges of (nearly) equal size
+    and returns a list of (first event, number of events) tuples. The last chunk
+    has no upper limit (number of events is 0) so that no event is lost if the
+    given total is too small. """
+    chunks = []
+    first = 0
+    for ichunk in range(nchunks):
+        count = nevents // nchunks + (1 if ichunk < nevents % nchunks else 0)
+        if ichunk == nchunks - 1:
+            count = 0
+        chunks.append((first, count))
+        first = first + count
+    return chunks
+
+def splitByteRange(nbytes, nchunks):
+    """ Splits a file of nbytes bytes into nchunks consecutive byte ranges and
+    returns a list of (first byte, one past the last byte) tuples. The last
+    chunk has no upper limit (None) so that no record is lost. """
+    chunks = []
+    for ichunk in range(nchunks):
+        first = nbytes * ichunk // nchunks
+        last = nbytes * (ichunk + 1) // nchunks if ichunk < nchunks - 1 else None
+        chunks.append((first, last))
+    return chunks
+
+# data source processors, which read the events themselves: Marlin does not
+# apply the global SkipNEvents to them and some ignore MaxRecordNumber, so
+# their chunks have to be selected through the ByteRange parameter of the
+# converter, which only some of them have
+BYTERANGECONVERTERS = ("AlibavaConverter", "Ph2ACF2LCIOConverter")
+DATASOURCES = BYTERANGECONVERTERS + ("EUTelNativeReader", "CMSBuncher", "EUTelEUDRBReader", "EUTelStrasMimoTelReader", "EUTelSucimaImagerReader", "EUTelSyntheticDataSource")
+
+def findDataSource(sstring):
+    """ Returns the name and type of the data source processor executed by a
+    Marlin steering string, or None if it reads LCIO files """
+    import re
+    definitions = re.findall(r"<processor\s+name\s*=\s*\"([^\"]*)\"\s+type\s*=\s*\"([^\"]*)\"", sstring, re.IGNORECASE)
+    types = dict(definitions)
+    execute = re.search(r"<execute>.*?</execute>", sstring, re.DOTALL | re.IGNORECASE)
+    if execute:
+        names = re.findall(r"<processor\s+name\s*=\s*\"([^\"]*)\"", execute.group(0), re.IGNORECASE)
+    else:
+        names = [name for name, type in definitions]
+    for name in names:
+        if types.get(name) in DATASOURCES:
+            return (name, types[name])
+    return None
+
+def findSection(sstring, start, end):
+    """ Returns the match of the section of a Marlin steering string starting
+    with the regular expression start and ending with the tag end """
+    import re
+    section = re.search(start + r".*?" + end, sstring, re.DOTALL | re.IGNORECASE)
+    if not section:
+        raise EOFError("Could not find the section " + start)
+    return section
+
+def setSectionParameter(sstring, section, end, name, value):
+    """ Sets a parameter of a section found by findSection, adding it if it
+    is not present yet, and returns the modified steering string """
+    import re
+    text = section.group(0)
+    parameter = re.compile(r"<parameter\s+name\s*=\s*\"" + name + r"\"[^>]*?(/>|>.*?</parameter>)", re.DOTALL | re.IGNORECASE)
+    newparameter = '<parameter name="' + name + '" value="' + str(value) + '"/>'
+    if parameter.search(text):
+        text = parameter.sub(newparameter, text)
+    else:
+        body = text[:-len(end)]
+        indent = body[len(body.rstrip(" \t")):]
+        text = body.rstrip(" \t") + indent + "  " + newparameter + "\n" + indent + end
+    return sstring[:section.start()] + text + sstring[section.end():]
+
+def setGlobalParameter(sstring, name, value):
+    """ Sets a parameter of the <global> section of a Marlin steering string,
+    adding it if it is not present yet """
+    return setSectionParameter(sstring, findSection(sstring, r"<global>", "</global>"), "</global>", name, value)
+
+def processorSection(sstring, processor):
+    """ Returns the match of the definition of a processor in a Marlin steering string """
+    import re
+    return findSection(sstring, r"<processor\s+name\s*=\s*\"" + re.escape(processor) + r"\"\s+type", "</processor>")
+
+def setProcessorParameter(sstring, processor, name, value):
+    """ Sets a parameter of a processor of a Marlin steering string, adding
+    it if it is not present yet """
+    return setSectionParameter(sstring, processorSection(sstring, processor), "</processor>", name, value)
+
+def getProcessorParameter(sstring, processor, name):
+    """ Returns the value of a parameter of a processor of a Marlin steering
+    string, or None if it is not set """
+    import re
+    parameter = re.search(r"<parameter\s+name\s*=\s*\"" + name + r"\"([^>]*?)(/>|>(.*?)</parameter>)", processorSection(sstring, processor).group(0), re.DOTALL | re.IGNORECASE)
+    if not parameter:
+        return None
+    value = re.search(r"value\s*=\s*\"([^\"]*)\"", parameter.group(1), re.IGNORECASE)
+    if value:
+        return value.group(1).strip()
+    return (parameter.group(3) or "").strip()
+
+def runMarlinChunks(jobtask, runnr, chunkfilenamebases, logbase, silent, njobs):
+    """ Runs one Marlin process per chunk steering file, with at most njobs
+    processes at the same time, and returns the list of return codes """
+    import threading
+    try:
+        from Queue import Queue, Empty # python 2.x
+    except ImportError:
+        from queue import Queue, Empty  # python 3.x
+    log = logging.getLogger('jobsub.' + jobtask)
+
+    tasks = Queue()
+    for ichunk, filenamebase in enumerate(chunkfilenamebases):
+        tasks.put((ichunk, filenamebase))
+    rcodes = [None] * len(chunkfilenamebases)
+
+    def worker():
+        """ process chunks from the task queue until it is empty """
+        while True:
+            try:
+                ichunk, filenamebase = tasks.get_nowait()
+            except Empty:
+                return
+            try:
+                rcodes[ichunk] = runMarlin(jobtask, runnr + chunkSuffix(ichunk), filenamebase, logbase, silent)
+            except SystemExit: # runMarlin exits on fatal errors
+                rcodes[ichunk] = 1
+
+    log.info("Running " + str(len(chunkfilenamebases)) + " chunks of run " + runnr + " on " + str(njobs) + " parallel Marlin processes")
+    workers = [threading.Thread(target=worker) for i in range(min(njobs, len(chunkfilenamebases)))]
+    for thread in workers:
+        thread.daemon = True
+        thread.start()
+    for thread in workers:
+        thread.join()
+    return rcodes
+
+def mergeChunkOutputs(jobtask, steeringString, nchunks):
+    """ Merges the output files of all chunks of a run: every file name in the
+    steering file containing the suffix of the first chunk is an output whose
+    chunks are merged into the file name without suffix. LCIO files are
+    concatenated with lcio_merge_files, ROOT files are added with hadd. Returns
+    the number of outputs that could not be merged. Where available, the
+    chunkmerge tool is used for ROOT files and for noisy pixel databases,
+    which cannot be merged by simple concatenation. """
+    import os, re, shlex, subprocess
+    log = logging.getLogger('jobsub.' + jobtask)
+    firstsuffix = chunkSuffix(0)
+    outputs = sorted(set(re.findall(r"[^\s\"'<>]*" + re.escape(firstsuffix) + r"[^\s\"'<>]*", steeringString)))
+    failed = 0
+    for output in outputs:
+        chunkfiles = [output.replace(firstsuffix, chunkSuffix(ichunk)) for ichunk in range(nchunks)]
+        # AIDA processors append the extension themselves
+        if not os.path.isfile(chunkfiles[0]) and os.path.isfile(chunkfiles[0] + ".root"):
+            chunkfiles = [chunkfile + ".root" for chunkfile in chunkfiles]
+            output = output + ".root"
+        missing = [chunkfile for chunkfile in chunkfiles if not os.path.isfile(chunkfile)]
+        if missing:
+            log.error("Cannot merge " + output.replace(firstsuffix, "") + ", missing chunk outputs: " + ', '.join(missing))
+            failed = failed + 1
+            continue
+        merged = output.replace(firstsuffix, "")
+        isPixelDB = re.search(r"name\s*=\s*\"HotPixelDBFile\"[^<]*" + re.escape(output), steeringString)
+        if merged.endswith(".slcio") and isPixelDB:
+            tool = check_program("chunkmerge")
+            cmd = [tool, "-o", merged] if tool else None
+        elif merged.endswith(".slcio"):
+            tool = check_program("lcio_merge_files")
+            cmd = [tool, merged] if tool else None
+        elif merged.endswith(".root"):
+            tool = check_program("chunkmerge")
+            if tool:
+                cmd = [tool, "-o", merged]
+            else:
+                tool = check_program("hadd")
+                cmd = [tool, "-f", merged] if tool else None
+        else:
+            log.warning("Do not know how to merge " + merged + ", keeping the chunk outputs")
+            continue
+        if not cmd:
+            log.error("No tool found in PATH to merge " + merged)
+            failed = failed + 1
+            continue
+        log.info("Merging " + str(nchunks) + " chunks into " + merged)
+        log.debug("Executing: " + ' '.join(cmd + chunkfiles))
+        try:
+            if subprocess.call(cmd + chunkfiles) != 0:
+                log.error("Merging into " + merged + " failed")
+                failed = failed + 1
+                continue
+        except OSError, e:
+            log.error("Problem merging into %s: error #%s, %s", merged, e.errno, e.strerror)
+            failed = failed + 1
+            continue
+        for chunkfile in chunkfiles:
+            os.remove(chunkfile)
+    return failed
+
 def submitHTCondor(jobtask, runnr, filenamebase, logbase, condorsubfile):
     """ Submits the Marlin job to HTCondor """
     import os, shlex, subprocess
@@ -407,6 +608,194 @@ def submitLXPLUS(jobtask, runnr, filenamebase, bsubfile):
         exit(1)
     return 0
 
+def pipelineMarker(logpath, jobtask, runnr):
+    """ Returns the file marking a pipeline step of a run as finished """
+    import os
+    return os.path.join(logpath, jobtask + '-' + runnr + '.done')
+
+def loadPipelineSteps(conffile, steps, cmdoptions):
+    """ Returns the log path and the memory needed (in MB, 0 if not given
+    through the 'memory' option) of every pipeline step, taken from the
+    config file section of the step and the command line options """
+    import os
+    import ConfigParser
+    log = logging.getLogger('jobsub')
+    config = ConfigParser.SafeConfigParser()
+    config.set("DEFAULT", "HOME", str(os.environ.get('HOME')))
+    if not os.environ.get('EUTELESCOPE') is None:
+        config.set("DEFAULT", "EUTelescopePath", str(os.environ.get('EUTELESCOPE')))
+    if conffile and not config.read([conffile]):
+        raise ValueError("Could not read config file '" + conffile + "'")
+    stepparameters = {}
+    for step in steps:
+        parameters = {"logpath":"./output/logs", "memory":"0"}
+        if config.has_section(step):
+            parameters.update(dict(config.items(step)))
+        elif conffile:
+            log.warning("Config file '%s' is missing a section [%s]!", conffile, step)
+        parameters.update(cmdoptions)
+        try:
+            memory = int(parameters["memory"])
+        except ValueError:
+            raise ValueError("Cannot interpret the memory '" + parameters["memory"] + "' of step " + step + " as MB")
+        stepparameters[step] = (os.path.abspath(parameters["logpath"]), memory)
+    return stepparameters
+
+def runPipeline(args, steps, runs, cmdoptions):
+    """ Runs the chain of tasks given by steps for all runs as separate
+    jobsub processes on the local machine. The steps of a run are executed
+    one after the other, different runs are independent. At most args.jobs
+    processes run at the same time, and the summed memory of the running
+    steps (their 'memory' option in MB) stays below args.memory. A finished
+    step is marked by a .done file next to its log, so that calling the
+    pipeline again resumes every run after its last finished step. """
+    import os, subprocess, signal, time
+    import ConfigParser
+    log = logging.getLogger('jobsub.pipeline')
+
+    try:
+        stepparameters = loadPipelineSteps(args.conf_file, steps, cmdoptions)
+    except ValueError, e:
+        log.error(str(e))
+        return 1
+    except ConfigParser.Error, e:
+        log.error("Problem reading config file '%s': %s", args.conf_file, e)
+        return 1
+
+    # the options every step is called with
+    jobsub = [sys.executable, os.path.abspath(os.path.realpath(__file__))]
+    if args.conf_file:
+        jobsub = jobsub + ["-c", args.conf_file]
+    if args.csv_file:
+        jobsub = jobsub + ["-csv", args.csv_file]
+    for optlist in args.option or []:
+        jobsub = jobsub + ["-o", optlist]
+    jobsub = jobsub + ["-l", args.log, "--plain"]
+    if args.silent:
+        jobsub.append("-s")
+    if args.dry_run:
+        jobsub.append("--dry-run")
+
+    # resume: every run starts at its first step without marker, all later
+    # steps are outdated once this one is run again
+    nextstep = {}
+    for run in runs:
+        runnr = str(run).zfill(6)
+        istep = 0
+        while istep < len(steps) and os.path.isfile(pipelineMarker(stepparameters[steps[istep]][0], steps[istep], runnr)):
+            istep = istep + 1
+        if istep == len(steps):
+            log.info("Run " + runnr + ": all steps were done before")
+        elif istep > 0:
+            log.info("Run " + runnr + ": resuming after step " + steps[istep - 1])
+        for step in steps[istep:]:
+            marker = pipelineMarker(stepparameters[step][0], step, runnr)
+            if os.path.isfile(marker) and not args.dry_run:
+                os.remove(marker)
+        nextstep[run] = istep
+    firststep = dict(nextstep)
+    resumed = sum(firststep.values())
+    total = len(runs) * len(steps) - resumed
+
+    for step in steps:
+        if stepparameters[step][1] > args.memory:
+            log.warning("Step " + step + " needs " + str(stepparameters[step][1]) + " MB, more than the " + str(args.memory) + " MB available; it will only be run alone")
+
+    # same as in main: do not start new steps after ctrl-c, but let the
+    # running ones finish
+    keepRunning = {'Sigint':'no'}
+    def signal_handler(signal, frame):
+        """ log if SIGINT detected, set variable to indicate status """
+        log.critical('You pressed Ctrl+C! Waiting for the running steps to finish')
+        keepRunning['Sigint'] = 'seen'
+    prevINTHandler = signal.signal(signal.SIGINT, signal_handler)
+
+    log.info("Running " + str(total) + " steps of " + str(len(runs)) + " runs on " + str(args.jobs) + " slots with " + str(args.memory) + " MB")
+    running = {} # run -> (process, output file, start time)
+    steptime = dict((step, 0.) for step in steps)
+    stepcount = dict((step, 0) for step in steps)
+    failed = []
+    done = 0
+    start = time.time()
+    try:
+        while True:
+            # collect the finished steps
+            for run, (process, output, started) in running.items():
+                if process.poll() is None:
+                    continue
+                output.close()
+                del running[run]
+                runnr = str(run).zfill(6)
+                step = steps[nextstep[run]]
+                duration = time.time() - started
+                if process.returncode != 0:
+                    log.error("Run " + runnr + ": step " + step + " failed with error code " + str(process.returncode) + ", see " + output.name + "; skipping its remaining steps")
+                    failed.append(run)
+                    continue
+                done = done + 1
+                steptime[step] = steptime[step] + duration
+                stepcount[step] = stepcount[step] + 1
+                if not args.dry_run:
+                    marker = open(pipelineMarker(stepparameters[step][0], step, runnr), "w")
+                    marker.write(time.strftime("%Y-%m-%d %H:%M:%S") + " " + str(int(duration)) + " s\n")
+                    marker.close()
+                nextstep[run] = nextstep[run] + 1
+                elapsed = time.time() - start
+                log.info("Run " + runnr + ": step " + step + " done in " + str(int(duration)) + " s (" + str(done) + "/" + str(total) + " steps, " + str(int(elapsed * (total - done) / done)) + " s remaining)")
+
+            # the runs whose next step can start, later steps first to
+            # finish runs early, otherwise in the order given
+            ready = [run for run in runs if not run in running and not run in failed and nextstep[run] < len(steps)]
+            if not running and (not ready or keepRunning['Sigint'] == 'seen'):
+                break
+            ready.sort(key=lambda run: -nextstep[run])
+            memory = sum(stepparameters[steps[nextstep[run]]][1] for run in running)
+            for run in ready:
+                if keepRunning['Sigint'] == 'seen' or len(running) >= args.jobs:
+                    break
+                step = steps[nextstep[run]]
+                needed = stepparameters[step][1]
+                if running and memory + needed > args.memory:
+                    continue # try a smaller step
+                runnr = str(run).zfill(6)
+                logpath = stepparameters[step][0]
+                if not os.path.isdir(logpath):
+                    os.makedirs(logpath)
+                output = open(os.path.join(logpath, step + '-' + runnr + '.jobsub.log'), "w")
+                log.info("Run " + runnr + ": starting step " + step)
+                log.debug("Executing: " + ' '.join(jobsub + [step, str(run)]))
+                try:
+                    # ignore ctrl-c in the child, the pipeline decides when to stop
+                    process = subprocess.Popen(jobsub + [step, str(run)], stdout=output, stderr=subprocess.STDOUT, preexec_fn=lambda: signal.signal(signal.SIGINT, signal.SIG_IGN))
+                except OSError, e:
+                    output.close()
+                    log.critical("Problem starting step %s of run %s: error #%s, %s", step, runnr, e.errno, e.strerror)
+                    failed.append(run)
+                    continue
+                running[run] = (process, output, time.time())
+                memory = memory + needed
+            time.sleep(0.5)
+    finally:
+        signal.signal(signal.SIGINT, prevINTHandler)
+
+    # throughput report
+    elapsed = time.time() - start
+    # only the runs completed by this call count for the throughput
+    finished = [run for run in runs if firststep[run] < len(steps) and nextstep[run] == len(steps)]
+    log.info("Pipeline finished after " + str(int(elapsed)) + " s: " + str(done) + " steps done, " + str(resumed) + " resumed, " + str(len(failed)) + " runs failed")
+    for step in steps:
+        if stepcount[step]:
+            log.info("  " + step + ": " + str(stepcount[step]) + " runs, " + str(int(steptime[step] / stepcount[step])) + " s per run")
+    if done > 0:
+        busy = sum(steptime.values())
+        log.info("Throughput: " + "%.1f" % (3600. * len(finished) / elapsed) + " runs/h, slot usage " + "%.0f" % (100. * busy / (elapsed * args.jobs)) + "%")
+    if failed:
+        log.error("Failed runs: " + ', '.join(map(str, sorted(failed))))
+    if keepRunning['Sigint'] == 'seen':
+        log.critical("Stopped before all steps were done, call the pipeline again to resume")
+        return 1
+    return 1 if failed else 0
+
 
 def main(argv=None):
     """  main routine of jobsub: a tool for EUTelescope job submission to Marlin """
@@ -464,6 +853,12 @@ def main(argv=None):
     parser.add_argument("-s", "--silent", action="store_true", default=False, help="Suppress non-error (stdout) Marlin output to console")
     parser.add_argument("--dry-run", action="store_true", default=False, help="Write steering files but skip actual Marlin execution")
     parser.add_argument("--plain", action="store_true", default=False, help="Output written to stdout/stderr and log file in prefix-less format i.e. without time stamping")
+    parser.add_argument("--chunks", type=int, default=1, metavar="N", help="Split every run into N event ranges processed by separate Marlin jobs, using the global SkipNEvents and MaxRecordNumber parameters. The template has to mark chunk specific output file names with '@ChunkSuffix@'. Only useful for tasks without state across events, e.g. clustering, hitmaker or fitter. Converters are split into byte ranges of their input file instead, which only the AlibavaConverter and the Ph2ACF2LCIOConverter support.")
+    parser.add_argument("--events", type=int, metavar="N", help="Number of events per run, used to split runs into chunks. Can also be given per run through an 'Events' column of the csv file.")
+    parser.add_argument("-j", "--jobs", type=int, metavar="N", help="Maximum number of Marlin processes running at the same time when processing chunks or a pipeline locally (default: number of CPUs)")
+    parser.add_argument("--merge-chunks", action="store_true", default=False, help="Only merge the outputs of chunks that were processed before, e.g. through batch submission")
+    parser.add_argument("--pipeline", action="store_true", default=False, help="Treat jobtask as a comma-separated chain of tasks (e.g. converter,clustering,hitmaker,align,fitter) run for every run on the local machine. Runs are processed in parallel on --jobs slots; a run resumes after the last step it finished before.")
+    parser.add_argument("--memory", type=int, metavar="MB", help="Memory available to the pipeline; steps are only started as long as the sum of the 'memory' config options (in MB) of the running steps stays below it (default: physical memory)")
     parser.add_argument("jobtask", help="Which task to submit (e.g. convert, hitmaker, align); task names are arbitrary and can be set up by the user; they determine e.g. the config section and default steering file names.")
     parser.add_argument("runs", help="The runs to be analyzed; can be a list of single runs and/or a range, e.g. 1056-1060.", nargs='*')
     args = parser.parse_args(argv)
@@ -513,6 +908,33 @@ def main(argv=None):
         log.error("At least one run is specified multiple times!")
         return 2
 
+    if args.chunks < 1:
+        log.error("The number of chunks has to be at least one!")
+        return 2
+    if args.chunks > 1 and args.concatenate:
+        log.error("Chunks cannot be combined with the concatenation of runs!")
+        return 2
+    if args.jobs is None:
+        import multiprocessing
+        args.jobs = multiprocessing.cpu_count()
+
+    if args.pipeline:
+        if args.chunks > 1 or args.concatenate or args.merge_chunks or args.condor_file or args.lxplus_file:
+            log.error("A pipeline cannot be combined with chunks, concatenation or batch submission!")
+            return 2
+        steps = [step.strip() for step in args.jobtask.split(',') if step.strip()]
+        if len(steps) > len(set(steps)):
+            log.error("At least one task is specified multiple times in the pipeline!")
+            return 2
+        if args.memory is None:
+            args.memory = os.sysconf('SC_PAGE_SIZE') * os.sysconf('SC_PHYS_PAGES') // (1024 * 1024)
+        try:
+            cmdoptions = dict((key.lower(), value) for key, value in (opt.strip().split('=', 1) for optlist in args.option or [] for opt in optlist.split(',')))
+        except ValueError:
+            log.error( "Command line error: cannot parse --option argument(s). Please use a '--option name=value' format. ")
+            return 2
+        return runPipeline(args, steps, runs, cmdoptions)
+
     # dictionary keeping parameters; set some minimal default config values that will (possibly) be overwritten by the config file
     parameters = {"templatepath":".", "templatefile":args.jobtask+"-tmp.xml", "logpath":"./output/logs", "histogrampath":"./output/histograms", "lciopath":"./output/lcio",
                   "databasepath":"./output/database", "steeringpath":"./output/steering"}
@@ -585,7 +1007,7 @@ def main(argv=None):
         # check if we actually find all parameters from the config in the steering file
         try:
             # need not to search for config variables only concerning submission control
-            if (not key == "templatefile" and not key == "templatepath"):
+            if (not key == "templatefile" and not key == "templatepath" and not key == "memory"):
                 # if using concatenation, we have a modified behavior in case the key contains "@RunRange@": then the key is replaced for every run
                 if args.concatenate and parameters[key].lower().find("@runrange@")>-1:
                     log.info("Concatenation: Option '" + key + "' contains string '@RunRange@', will fill for all runs of specified range")
@@ -630,6 +1052,7 @@ def main(argv=None):
     prevINTHandler = signal.signal(signal.SIGINT, signal_handler)
 
     log.info("Will now start processing the following runs: "+', '.join(map(str, runs)))
+    failedRuns = 0 # runs for which Marlin or the merging of chunks failed
     # now loop over all runs
     for run in runs:
         if keepRunning['Sigint'] == 'seen':
@@ -664,8 +1087,37 @@ def main(argv=None):
         except EOFError:
             log.error("No reference to run number ('@RunNumber@') found in template file "+steeringTmpFileName)
             return 1
-                
-        if not checkSteer(steeringString):
+
+        # chunks: the steering files only differ in the event range and the output names
+        chunkRanges = []
+        byteRanges = False # chunks selected through the ByteRange of the converter
+        datasource = findDataSource(steeringString) if args.chunks > 1 else None
+        if datasource and not datasource[1] in BYTERANGECONVERTERS:
+            log.error("The data source " + datasource[1] + " in template file " + steeringTmpFileName + " cannot be split into chunks, only " + ' and '.join(BYTERANGECONVERTERS) + " can")
+            return 2
+        elif datasource:
+            inputfile = getProcessorParameter(steeringString, datasource[0], "InputFileName")
+            if not inputfile or not os.path.isfile(inputfile):
+                log.error("Cannot find the input file '" + str(inputfile) + "' of " + datasource[0] + " to split it into chunks")
+                return 1
+            chunkRanges = splitByteRange(os.path.getsize(inputfile), args.chunks)
+            byteRanges = True
+        elif args.chunks > 1:
+            nevents = args.events
+            if parameters_csv and "events" in parameters_csv[run] and parameters_csv[run]["events"].strip():
+                nevents = int(parameters_csv[run]["events"])
+            if nevents is None:
+                log.error("The number of events of run " + runnr + " is needed to split it into chunks, please use --events or an 'Events' csv column")
+                return 2
+            chunkRanges = splitEventRange(nevents, args.chunks)
+        if chunkRanges:
+            if steeringString.lower().find("@chunksuffix@") == -1:
+                log.error("No reference to the chunk suffix ('@ChunkSuffix@') found in template file "+steeringTmpFileName+", chunk outputs would overwrite each other")
+                return 1
+        elif steeringString.lower().find("@chunksuffix@") > -1:
+            steeringString = ireplace("@ChunkSuffix@", "", steeringString)
+
+        if not checkSteer(steeringString.replace("@ChunkSuffix@", "")):
             return 1
 
         if args.condor_file and args.lxplus_file:
@@ -686,41 +1138,95 @@ def main(argv=None):
         # Write the steering file:
         log.debug ("Writing steering file for run number "+runnr)
         basefilename = parameters["steeringpath"] + "/" + args.jobtask + "-" + runnr
-        steeringFile = open(basefilename + ".xml", "w")
-
-        try:
-            steeringFile.write(steeringString)
-        finally:
-            steeringFile.close()
+        if chunkRanges:
+            chunkfilenames = []
+            for ichunk, chunkRange in enumerate(chunkRanges):
+                chunkString = ireplace("@ChunkSuffix@", chunkSuffix(ichunk), steeringString)
+                chunkfilenames.append(basefilename + chunkSuffix(ichunk))
+                if byteRanges:
+                    firstbyte, lastbyte = chunkRange
+                    chunkString = setProcessorParameter(chunkString, datasource[0], "ByteRange", str(firstbyte) + ("" if lastbyte is None else " " + str(lastbyte)))
+                    log.debug ("Writing steering file for chunk " + str(ichunk) + " of run number " + runnr + ": bytes " + str(firstbyte) + " to " + ("end" if lastbyte is None else str(lastbyte - 1)))
+                else:
+                    firstevent, nchunkevents = chunkRange
+                    try:
+                        chunkString = setGlobalParameter(chunkString, "SkipNEvents", firstevent)
+                        # the run header is a record as well
+                        chunkString = setGlobalParameter(chunkString, "MaxRecordNumber", nchunkevents + 1 if nchunkevents else 0)
+                    except EOFError:
+                        log.error("No <global> section found in template file "+steeringTmpFileName)
+                        return 1
+                    log.debug ("Writing steering file for chunk " + str(ichunk) + " of run number " + runnr + ": events " + str(firstevent) + " to " + (str(firstevent + nchunkevents - 1) if nchunkevents else "end"))
+                steeringFile = open(chunkfilenames[-1] + ".xml", "w")
+                try:
+                    steeringFile.write(chunkString)
+                finally:
+                    steeringFile.close()
+            # the outputs of the chunks are identified through the steering file of the first chunk
+            chunkOutputString = ireplace("@ChunkSuffix@", chunkSuffix(0), steeringString)
+        else:
+            steeringFile = open(basefilename + ".xml", "w")
+            try:
+                steeringFile.write(steeringString)
+            finally:
+                steeringFile.close()
 
         # bail out if running a dry run
-        if args.dry_run:
-            log.info("Dry run: skipping Marlin execution. Steering file written to " + basefilename + '.xml')
-        elif args.condor_file:
-            rcode, condorID = submitHTCondor(args.jobtask, runnr, basefilename, parameters["logpath"], args.condor_file) # start HTCondor submission
-            if rcode == 0:
-                log.info("HTCondor: job submitted with ID "+condorID)
+        if args.merge_chunks:
+            if not chunkRanges:
+                log.error("Merging of chunks requested, but no chunks specified (use --chunks)")
+                return 2
+            if mergeChunkOutputs(args.jobtask, chunkOutputString, len(chunkRanges)) == 0:
+                log.info("Merged the chunk outputs of run " + runnr)
             else:
-                log.error("HTCondor submission returned with error code "+str(rcode))
+                failedRuns = failedRuns + 1
+        elif args.dry_run:
+            log.info("Dry run: skipping Marlin execution. Steering file written to " + basefilename + (chunkSuffix(0) + '.xml and following' if chunkRanges else '.xml'))
+        elif args.condor_file:
+            for ichunk, filenamebase in enumerate(chunkfilenames if chunkRanges else [basefilename]):
+                chunkrunnr = runnr + chunkSuffix(ichunk) if chunkRanges else runnr
+                rcode, condorID = submitHTCondor(args.jobtask, chunkrunnr, filenamebase, parameters["logpath"], args.condor_file) # start HTCondor submission
+                if rcode == 0:
+                    log.info("HTCondor: job submitted with ID "+condorID)
+                else:
+                    log.error("HTCondor submission returned with error code "+str(rcode))
+            if chunkRanges:
+                log.info("Once all chunk jobs are done, merge their outputs by running jobsub again with --merge-chunks")
         elif args.lxplus_file:
-            rcode = submitLXPLUS(args.jobtask, runnr, basefilename, args.lxplus_file) # start LXPLUS submission
-            if rcode == 0:
-                log.info("LXPLUS job submitted")
+            for ichunk, filenamebase in enumerate(chunkfilenames if chunkRanges else [basefilename]):
+                chunkrunnr = runnr + chunkSuffix(ichunk) if chunkRanges else runnr
+                rcode = submitLXPLUS(args.jobtask, chunkrunnr, filenamebase, args.lxplus_file) # start LXPLUS submission
+                if rcode == 0:
+                    log.info("LXPLUS job submitted")
+                else:
+                    log.error("LXPLUS submission returned with error code "+str(rcode))
+            if chunkRanges:
+                log.info("Once all chunk jobs are done, merge their outputs by running jobsub again with --merge-chunks")
+        elif chunkRanges:
+            rcodes = runMarlinChunks(args.jobtask, runnr, chunkfilenames, parameters["logpath"], args.silent, args.jobs) # start parallel Marlin execution
+            failedchunks = [str(ichunk) for ichunk, rcode in enumerate(rcodes) if rcode != 0]
+            if failedchunks:
+                log.error("Marlin returned with an error for chunks " + ', '.join(failedchunks) + ", outputs are not merged")
+                failedRuns = failedRuns + 1
+            elif mergeChunkOutputs(args.jobtask, chunkOutputString, len(chunkRanges)) == 0:
+                log.info("Marlin execution done")
             else:
-                log.error("LXPLUS submission returned with error code "+str(rcode))
+                failedRuns = failedRuns + 1
         else:
             rcode = runMarlin(args.jobtask, runnr, basefilename, parameters["logpath"], args.silent) # start Marlin execution
             if rcode == 0:
                 log.info("Marlin execution done")
             else:
                 log.error("Marlin returned with error code "+str(rcode))
+                failedRuns = failedRuns + 1
 
     # return to the previous signal handler
     signal.signal(signal.SIGINT, prevINTHandler)
     if log.error.counter>0:
         log.warning("There were "+str(log.error.counter)+" error messages reported")
 
-    return 0
+    # non-zero exit code if a run failed, e.g. to stop a pipeline
+    return 1 if failedRuns > 0 else 0
 
 if __name__ == "__main__":
     sys.exit(main())
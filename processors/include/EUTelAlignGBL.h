@@ -24,9 +24,11 @@
 
 //for gbl::MilleBinary
 #include "include/MilleBinary.h"
+#include "include/GblTrajectory.h"
 
 #include "EUTelUtility.h"
 #include "EUTelTripletGBLUtility.h"
+#include "EUTelWorkerPool.h"
 
 // AIDA includes <.h>
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -34,6 +36,8 @@
 #endif
 
 // system includes <>
+#include <array>
+#include <memory>
 #include <string>
 #include <vector>
 #include <map>
@@ -103,6 +107,37 @@ namespace eutelescope {
 
     protected:
       static int const NO_PRINT_EVENT_COUNTER = 3;
+
+      //! The GBL fit of one track and what is needed from it afterwards
+      struct TrackFit {
+        std::unique_ptr<gbl::GblTrajectory> traj;
+        //! Point labels of the planes and arc length of all points
+        std::vector<unsigned int> ilab;
+        std::vector<double> sPoint;
+        //! Hit - triplet residuals and the triplet at the planes
+        std::vector<double> rx;
+        std::vector<double> ry;
+        std::vector<double> xs;
+        std::vector<double> ys;
+        std::vector<bool> hasHit;
+        size_t nDUTHits = 0;
+        double chi2 = 0.;
+        int ndf = 0;
+        double probchi = 0.;
+        //! Fitted x', y', x and y at the planes
+        std::vector<std::array<double,4>> localPar;
+        //! Measurement residuals in x and y and their errors at the planes with a hit
+        std::vector<std::array<double,4>> measResults;
+      };
+
+      //! Builds and fits the GBL trajectory of a track
+      /*! Does not touch any state of the processor, so that the tracks
+       *  of an event can be fitted in parallel.
+       */
+      void fitTrack(EUTelTripletGBLUtility::track & track, TrackFit & fit) const;
+
+      //! Name of the Millepede binary file written by a worker
+      std::string getMilleShardName(unsigned int worker) const;
       //! Ordered sensor ID
       /*! Within the processor all the loops are done up to _nPlanes and
        *  according to their position along the Z axis (beam axis).
@@ -189,6 +224,13 @@ namespace eutelescope {
       std::vector<int> indexconverter;
       std::unique_ptr<gbl::MilleBinary>  milleAlignGBL; // for producing MillePede-II binary file
 
+      //! Number of threads fitting the tracks
+      int _nThreads;
+      //! One Millepede binary file per thread instead of a single one
+      bool _shardedMilleFiles;
+      std::unique_ptr<EUTelWorkerPool> _workerPool;
+      std::vector<std::unique_ptr<gbl::MilleBinary>> _milleShards;
+
     // definition of static members mainly used to name histograms
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 
@@ -10,7 +10,9 @@
 #define EUTELCALCULATEETAPROCESSOR_H 1
 
 // eutelescope includes ".h"
-#include "EUTelPseudo1DHistogram.h"
+#include "EUTELESCOPE.h"
+#include "EUTelEtaAccumulator.h"
+#include "EUTelVirtualCluster.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -26,6 +28,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #undef MARLIN_USE_HISTOGRAM
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -58,9 +61,10 @@ namespace eutelescope {
    *  \li For each cluster, the charge center of mass is calculated;
    *
    *  \li The (signed) distance between the seed pixel and the CoG is
-   *  used to fill in a histogram (pseudo-histogram is used to avoid
-   *  any dependency on a specific histogramming package). This
-   *  histogram is binned from minum half pitch to plus half picth.
+   *  counted in fixed bins from minus half pitch to plus half pitch,
+   *  one EUTelEtaAccumulator per sensor and direction. The cluster
+   *  interfaces are created on the stack, so the accumulation does
+   *  not allocate memory per cluster.
    *
    *  \li When all clusters have been scanned, we can obtain the eta
    *  function as the integral of the produced histogram
@@ -68,6 +72,12 @@ namespace eutelescope {
    *  \li This eta function has to be normalized and shifted by half a
    *  pitch
    *
+   *  The counts are integers, so the eta function does not depend on
+   *  how the events are split. With WriteEtaCounts the counts are
+   *  saved as well, and the counts of jobs running on different parts
+   *  of the data can be merged into the eta function of the full data
+   *  set with the etamerge tool.
+   *
    *  <h4>Input collections </h4>
    *  <b>ClusterCollection</b>. A collection of clusters (TrackerPulse)
    *
@@ -124,6 +134,15 @@ namespace eutelescope {
    *
    *  @param OutputEtaFileName The name of the output file.
    *
+   *  @param WriteEtaCounts Also save the bin counts in the output
+   *  file, for the merging with etamerge.
+   *
+   *  @param EtaCountsXCollectionName The name of the collection with
+   *  the bin counts along X.
+   *
+   *  @param EtaCountsYCollectionName The name of the collection with
+   *  the bin counts along Y.
+   *
    *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
    *  @version $Id$
    *
@@ -162,8 +181,8 @@ namespace eutelescope {
     virtual void processRunHeader(LCRunHeader *run);
 
     //! Called every event
-    /*! This is called for each event in the file. Pseudohistograms
-     *  are filled
+    /*! This is called for each event in the file. The CoG shift
+     *  accumulators are filled
      *
      *  @param evt the current LCEvent event as passed by the
      *  ProcessMgr
@@ -173,6 +192,12 @@ namespace eutelescope {
      */
     virtual void processEvent(LCEvent *evt);
 
+    //! Adds the CoG shift of one cluster to the accumulators
+    /*! @param cluster The cluster, which is not stored
+     *  @param type The type of the cluster
+     */
+    void accumulateCluster(EUTelVirtualCluster *cluster, ClusterType type);
+
     //! Finish the eta calculation
     /*! To calculate the eta function, a certain number of events has
      *  to accumulated, and only when this number
@@ -181,9 +206,8 @@ namespace eutelescope {
      *  calculation and it is called within processEvent(LCEvent*)
      *  when the isLastEvent() is true.
      *
-     *  @throw RewindDataFilesException when the calculation is over,
-     *  so that the user can now re-loop on events and applying the
-     *  calculated eta function
+     *  The counts are accumulated while the events are processed, so
+     *  no rewind of the input files is needed.
      */
     virtual void finalizeProcessor();
 
@@ -309,6 +333,15 @@ namespace eutelescope {
      */
     std::string _outputEtaFileName;
 
+    //! Switch to save the bin counts in the output file
+    bool _writeEtaCounts;
+
+    //! Bin counts X output collection name
+    std::string _etaCountsXCollectionName;
+
+    //! Bin counts Y output collection name
+    std::string _etaCountsYCollectionName;
+
   private:
     //! Boolean return value
     /*! This boolean is used as return value for conditional steering
@@ -320,35 +353,15 @@ namespace eutelescope {
      */
     bool _isEtaCalculationFinished;
 
-    //! Pseudo histograms for CoG along x
-    /*! This is an associative collection of pseudo histogram
-     *  pointer. The key value is the sensor ID.
+    //! CoG shift counts along x
+    /*! The key value is the sensor ID.
      */
-    std::map<int, EUTelPseudo1DHistogram *> _cogHistogramX;
+    std::map<int, EUTelEtaAccumulator> _cogAccumulatorX;
 
-    //! Pseudo histograms for CoG along y
-    /*! This is an associative collection of pseudo histogram
-     *  pointer. The key value is the sensor ID.
-     */
-    std::map<int, EUTelPseudo1DHistogram *> _cogHistogramY;
-
-    //! Pseudo histograms with the CoG integral along x
-    /*! This is an associative collection of pseudo histogram
-     *  pointer. The key value is the sensor ID.
-     *  Those pseudo histograms
-     *  will be filled during the end() with the integral function of
-     *  _cogHistogramX
-     */
-    std::map<int, EUTelPseudo1DHistogram *> _integralHistoX;
-
-    //! Pseudo histograms with the CoG integral along y
-    /*! This is an associative collection of pseudo histogram
-     *  pointer. The key value is the sensor ID.
-     *  Those pseudo histograms
-     *  will be filled during the end() with the integral function of
-     *  _cogHistogramY
+    //! CoG shift counts along y
+    /*! The key value is the sensor ID.
      */
-    std::map<int, EUTelPseudo1DHistogram *> _integralHistoY;
+    std::map<int, EUTelEtaAccumulator> _cogAccumulatorY;
 
     //! Number of detector planes in the run
     /*! This is the total number of detector saved into this input
@@ -373,10 +386,10 @@ namespace eutelescope {
      */
     int _iEvt;
 
-    //! The left end of the pseudo histogram
+    //! The left end of the CoG binning
     static const double _min;
 
-    //! The right end of the pseudo histogram
+    //! The right end of the CoG binning
     static const double _max;
 
 #ifdef MARLIN_USE_HISTOGRAM
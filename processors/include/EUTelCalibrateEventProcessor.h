@@ -195,9 +195,10 @@ namespace eutelescope {
 
     //! Initialize the geometry information
     /*! This method is called to initialize the geometry information,
-     *  namely the order in which the sensorID are organized into the
-     *  input collection. In this function  the _ancillaryIndexMap
-     *  is filled to get the correct pedestal frame object for the input data.
+     *  namely the number of pixels, pixels per row and rows of each
+     *  sensorID in the pedestal collection. The position of each
+     *  sensorID in the ancillary collections is taken from the
+     *  EUTelConditionsCache in every event.
      *
      *  @param event The LCEvent to be used for geometry
      *  initialization.
@@ -406,13 +407,6 @@ namespace eutelescope {
     std::map<std::string, AIDA::IBaseHistogram *> _aidaHistoMap;
 #endif
 
-    //! Map relating ancillary collection position and sensorID
-    /*! The first element is the sensor ID, while the second is the
-     *  position of such a sensorID in all the ancillary collections
-     *  (noise, pedestal and status).
-     */
-    std::map<int, int> _ancillaryIndexMap;
-
     //! Map relating the sensorID and pixels
     std::map<int, unsigned int> _noOfPixelMap;
 
@@ -19,6 +19,7 @@
 
 // system includes <>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -306,10 +307,21 @@ namespace eutelescope {
      *  because they require a global knowledge of the event. There
      *  are no selction criteria of this kind implemented yet.
      *
-     *  All active selection criteria are tested against each
-     *  cluster. This is because at the end of the job a complete
-     *  rejection summary is displayed and the user can evaluate the
-     *  strength of each single item.
+     *  The single cluster based criteria are compiled into an
+     *  ordered pipeline (see compilePipeline()) and all clusters of
+     *  the event are passed through it stage by stage. A cluster
+     *  failing one stage is not tested any further. The quantities a
+     *  stage needs (charges, SNRs, seed, N and NxN sums, center of
+     *  gravity) are computed into flat arrays by the first stage
+     *  needing them, only for the clusters that reach it.
+     *
+     *  The rejection summary at the end of the job is then a cut
+     *  flow: each counter is the number of clusters rejected by that
+     *  criterion after having passed all the previous ones. The
+     *  evaluation order can be changed with the CutOrder parameter.
+     *  With IndependentCutCounters every cluster is tested against
+     *  every criterion, so each counter is independent of the others,
+     *  at the price of the early rejection.
      *
      *  @param evt The input LCEvent
      *
@@ -342,22 +354,22 @@ namespace eutelescope {
      *  a per detector basis and stored into the
      *  _clusterMinTotalChargeVec.
      *
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *  @return True if the @c cluster has a charge below its own threshold.
      *
      */
-    bool isAboveMinTotalCharge(EUTelVirtualCluster *cluster) const;
+    bool isAboveMinTotalCharge(std::size_t iCluster) const;
 
     //! Check if the total cluster SNR is above a certain value
     /*! This is used to select clusters having a total SNR above a
      *  certain value. This threshold value is given on a per detector
      *  basis and stored into the _minTotalSNRVec.
      *
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *  @return True if the @c cluster has a SNR below its own
      *  threshold.
      */
-    bool isAboveMinTotalSNR(EUTelVirtualCluster *cluster) const;
+    bool isAboveMinTotalSNR(std::size_t iCluster) const;
 
     //! Check if the total cluster charge is below a certain value
     /*! This is used to select clusters having a total integrated
@@ -378,10 +390,10 @@ namespace eutelescope {
      *  a per detector basis and stored into the
      *  _clusterMaxTotalChargeVec.    .
      *
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *
      */
-    bool isAboveNumberOfHitPixel(EUTelVirtualCluster *cluster) const;
+    bool isAboveNumberOfHitPixel(std::size_t iCluster) const;
 
     //! Check against the charge collected by N pixels
     /*! This is working in a similar way to the isAboveMinTotalCharge
@@ -393,9 +405,9 @@ namespace eutelescope {
      *  considered.
      *
      *  @return True if the charge is above threshold
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      */
-    bool isAboveNMinCharge(EUTelVirtualCluster *cluster) const;
+    bool isAboveNMinCharge(std::size_t iCluster) const;
 
     //! Check against the SNR of the N most significant pixels
     /*! The SNR of the cluster made by the first N significant pixels
@@ -406,45 +418,45 @@ namespace eutelescope {
      *  considered.
      *
      *  @return True if the SNR is above threshold
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      */
-    bool isAboveNMinSNR(EUTelVirtualCluster *cluster) const;
+    bool isAboveNMinSNR(std::size_t iCluster) const;
 
     //! Check against the charge collected by N x N pixels
     /*! This cut is working on the charge collected by a subframe N x
      *  N pixels wide centered around the seed.
      *
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *  @return True if the charge is above threshold.
      */
-    bool isAboveNxNMinCharge(EUTelVirtualCluster *cluster) const;
+    bool isAboveNxNMinCharge(std::size_t iCluster) const;
 
     //! Check against the SNR collected by N x N pixels
     /*! This cut is working on the SNR collected by a subframe N x
      *  N pixels wide centered around the seed.
      *
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *  @return True if the SNR is above threshold.
      */
-    bool isAboveNxNMinSNR(EUTelVirtualCluster *cluster) const;
+    bool isAboveNxNMinSNR(std::size_t iCluster) const;
 
     //! Seed pixel cut
     /*! This is used to select clusters having a seed pixel charge
      *  above the specified threshold
      *
      *  @return True if the seed pixel charge is above threshold
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      */
-    bool isAboveMinSeedCharge(EUTelVirtualCluster *cluster) const;
+    bool isAboveMinSeedCharge(std::size_t iCluster) const;
 
     //! Seed SNR cut
     /*! This is used to select clusters having a seed pixel SNR above
      *  the specified threshold
      *
      *  @return True if the seed SNR is above threshold
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      */
-    bool isAboveMinSeedSNR(EUTelVirtualCluster *cluster) const;
+    bool isAboveMinSeedSNR(std::size_t iCluster) const;
 
     //! Quality cut
     /*! This is a selection cut based on the cluster quality. Only
@@ -455,9 +467,9 @@ namespace eutelescope {
      *  quality vector.
      *
      *  @return True if the quality is correct
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      */
-    bool hasQuality(EUTelVirtualCluster *cluster) const;
+    bool hasQuality(std::size_t iCluster) const;
 
     //! Same number of hits
     /*! This selection criterion can be used to select events in which
@@ -499,29 +511,29 @@ namespace eutelescope {
      *  having the center within a certain ROI.
      *
      *  @return True if the cluster center is inside the ROI
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *
      */
-    bool isInsideROI(EUTelVirtualCluster *cluster) const;
+    bool isInsideROI(std::size_t iCluster) const;
 
     //! Outside the ROI
     /*! This selection criterion can be used to get only clusters
      *  having the center outside a certain ROI.
      *
      *  @return True if the cluster center is outside the ROI
-     *  @param cluster The cluster under test.
+     *  @param iCluster The index of the cluster in the current batch.
      *
      */
-    bool isOutsideROI(EUTelVirtualCluster *cluster) const;
+    bool isOutsideROI(std::size_t iCluster) const;
 
     //! Below the maximum cluster noise
     /*! This selection criterion is based on the full cluster noise.
      *
      *  @return True if the cluster noise is below the maximum
      *  allowed.
-     *  @param cluster The cluster under test
+     *  @param iCluster The index of the cluster in the current batch.
      */
-    bool isBelowMaxClusterNoise(EUTelVirtualCluster *cluster) const;
+    bool isBelowMaxClusterNoise(std::size_t iCluster) const;
 
     //! Print the rejection summary
     /*! To better understand which cut is more important, a rejection
@@ -550,6 +562,26 @@ namespace eutelescope {
      */
     void initializeGeometry(LCEvent *event);
 
+    //! Compile the selection pipeline
+    /*! All switched on single cluster criteria are put into a vector
+     *  of stages, together with the cluster quantities they need,
+     *  ordered as given in CutOrder and then by increasing evaluation
+     *  cost. It is called by checkCriteria() as soon as the number of
+     *  detectors is known.
+     */
+    void compilePipeline();
+
+    //! Size the quantity arrays of the batch
+    /*! Nothing is computed yet, see computeFeatures().
+     */
+    void prepareBatch();
+
+    //! Compute the missing quantities of a cluster of the batch
+    /*! @param iCluster The index of the cluster in the current batch.
+     *  @param features The ClusterFeature flags needed.
+     */
+    void computeFeatures(std::size_t iCluster, unsigned int features);
+
     //! Check criteria
     /*! This function is called to check if the user selected criteria
      *  are usable or not. Mainly the method checks if the number of
@@ -861,6 +893,118 @@ namespace eutelescope {
     //! Rejection summary map
     mutable std::map<std::string, std::vector<unsigned int>> _rejectionMap;
 
+    //! User defined evaluation order of the cluster selection criteria
+    /*! The names are the ones of the rejection summary, criteria not
+     *  listed are evaluated afterwards, the cheapest first.
+     */
+    std::vector<std::string> _cutOrder;
+
+    //! Test every cluster against every criterion
+    /*! A diagnostic mode: the rejection counters become independent
+     *  of each other instead of a cut flow, but the clusters are not
+     *  rejected early.
+     */
+    bool _independentCutCounters;
+
+    //! Which cluster types a pipeline stage applies to
+    enum StageTarget { kAllClusters, kDFFClusters, kNonDFFClusters };
+
+    //! The cluster quantities stored in the batch, as bit flags
+    enum ClusterFeature {
+      kTotalCharge = 1 << 0,
+      kTotalSNR = 1 << 1,
+      kSeedCharge = 1 << 2,
+      kSeedSNR = 1 << 3,
+      kClusterNoise = 1 << 4,
+      kQuality = 1 << 5,
+      kCenterOfGravity = 1 << 6,
+      kNCharge = 1 << 7,
+      kNSNR = 1 << 8,
+      kNxNCharge = 1 << 9,
+      kNxNSNR = 1 << 10
+    };
+
+    //! Signature of the single cluster selection criteria
+    typedef bool (EUTelClusterFilter::*ClusterPredicate)(std::size_t) const;
+
+    //! One stage of the compiled selection pipeline
+    struct CutStage {
+      //! The name of the criterion in the rejection summary
+      std::string name;
+      //! Position in the pipeline, lower values are evaluated first
+      int cost;
+      //! The cluster quantities the criterion needs
+      unsigned int features;
+      //! The cluster types the stage is applied to
+      StageTarget target;
+      //! Noise related stages are skipped once the noise is unavailable
+      bool noiseRelated;
+      //! The criterion itself
+      ClusterPredicate predicate;
+      //! The rejection counters of this stage in _rejectionMap
+      std::vector<unsigned int> *rejected;
+    };
+
+    //! The compiled selection pipeline
+    std::vector<CutStage> _cutPipeline;
+
+    //! True if any stage of the pipeline needs the pixel noise
+    bool _pipelineNeedsNoise;
+
+    //! The cluster quantities needed by the pipeline
+    unsigned int _pipelineFeatures;
+
+    //! The inside ROIs sorted by sensor position
+    std::vector<std::vector<EUTelROI>> _insideROIByPos;
+
+    //! The outside ROIs sorted by sensor position
+    std::vector<std::vector<EUTelROI>> _outsideROIByPos;
+
+    //! The clusters of the current event as flat arrays
+    /*! The decoded clusters are only used to compute the quantities,
+     *  the selection criteria work on the arrays. Quantities which are
+     *  not needed by the pipeline are left empty, the others are only
+     *  filled for the clusters flagged in computed.
+     */
+    struct ClusterBatch {
+      //! The decoded clusters
+      std::vector<std::unique_ptr<EUTelVirtualCluster>> clusters;
+      //! The sensor position of each cluster
+      std::vector<int> detectorPos;
+      //! Whether each cluster is a digital fixed frame one
+      std::vector<char> isDFF;
+      //! The index in the input collection of each cluster
+      std::vector<int> pulseIndex;
+      //! The ClusterFeature flags already computed for each cluster
+      std::vector<unsigned int> computed;
+      std::vector<float> totalCharge;
+      std::vector<float> totalSNR;
+      std::vector<float> seedCharge;
+      std::vector<float> seedSNR;
+      std::vector<float> clusterNoise;
+      std::vector<int> quality;
+      std::vector<float> cogX;
+      std::vector<float> cogY;
+      //! One array per N of MinNCharge, MinNSNR, MinNxNCharge and
+      //! MinNxNSNR, in the order of the parameter
+      std::vector<std::vector<float>> nCharge;
+      std::vector<std::vector<float>> nSNR;
+      std::vector<std::vector<float>> nxnCharge;
+      std::vector<std::vector<float>> nxnSNR;
+    };
+
+    //! The batch of the current event
+    ClusterBatch _batch;
+
+    //! Run the compiled pipeline on the current batch
+    /*! @param acceptedClusterVec Filled with the input collection
+     *  indices of the accepted clusters
+     */
+    void runPipeline(std::vector<int> &acceptedClusterVec);
+
+    //! Drop all clusters of the current batch
+    void clearBatch();
+
     // digital fixed frame cuts
     std::vector<int> _DFFNHitsCuts;
 
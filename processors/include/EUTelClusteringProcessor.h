@@ -15,8 +15,11 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelDigitalClusterMatrix.h"
 #include "EUTelExceptions.h"
+#include "EUTelFrameCalibrator.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelSeedFinder.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -697,19 +700,39 @@ namespace eutelescope {
   private:
     DISALLOW_COPY_AND_ASSIGN(EUTelClusteringProcessor)
 
-    void getMaxPixels(int sensorID, int &maxX, int &maxY);
+    //! Gets the last pixel indices of a sensor from the geometry
+    /*! @return false for a sensorID unknown to the geometry, maxX and
+     *  maxY are not set then
+     */
+    bool getMaxPixels(int sensorID, int &maxX, int &maxY);
 
     //! read secondary collections
     /*!
      */
     void readCollections(LCEvent *evt);
 
+    //! Calibrates the raw data for the fixed frame clustering
+    /*! Used instead of the NZS input collection when
+     *  _rawDataCollectionName is set: every raw frame is calibrated
+     *  into _calibratedCollection and its seed candidates are stored in
+     *  _calibratedCandidateMap, all in one pass per block of rows (see
+     *  EUTelFrameCalibrator). The calibrated frames are added to the
+     *  event only if _calibratedDataCollectionName is set.
+     *
+     *  @throw SkipEventException if the common mode of a sensor cannot
+     *  be computed, as the EUTelCalibrateEventProcessor does
+     */
+    void calibrateRawData(LCEvent *evt);
+
     //! The seed candidate pixel map.
     /*! This is a vector which stores the seed index and the size of the signal.
      * The signal is the floating point and the unsigned integer is the
      */
     std::vector<std::pair<float, unsigned int>> _seedCandidateMap;
 
+    //! Seed candidate search of the fixed frame clustering
+    EUTelSeedFinder _seedFinder;
+
     //! Total cluster found
     /*! This is a map correlating the sensorID number and the
      *  total number of clusters found on that sensor.
@@ -856,6 +879,53 @@ namespace eutelescope {
 
     std::vector<std::map<int, int>> _hitIndexMapVec;
 
+    //! Bit matrices of the digital fixed frame clustering
+    /*! One matrix per sensor ID, kept across events. The hot pixels of
+     *  _hitIndexMapVec are stored in their mask when they are created.
+     */
+    std::map<int, EUTelDigitalClusterMatrix> _digitalMatrixMap;
+
+    //! Raw data collection name of the fused calibration
+    /*! If set, the FixedFrame clustering calibrates this collection
+     *  itself instead of reading the NZS collection produced by the
+     *  EUTelCalibrateEventProcessor.
+     */
+    std::string _rawDataCollectionName;
+
+    //! Pedestal collection name of the fused calibration
+    std::string _pedestalCollectionName;
+
+    //! Optional output of the fused calibration, for debugging
+    std::string _calibratedDataCollectionName;
+
+    //! Common mode algorithm of the fused calibration
+    /*! 0 -> off, 1 -> full frame, 2 -> row wise, as in the
+     *  EUTelCalibrateEventProcessor
+     */
+    int _doCommonMode;
+
+    //! SNR above which a pixel is excluded from the common mode
+    float _hitRejectionCut;
+
+    //! Maximum number of pixels excluded from the full frame common mode
+    int _maxNoOfRejectedPixels;
+
+    //! Maximum number of pixels excluded from a row common mode
+    int _maxNoOfRejectedPixelPerRow;
+
+    //! Maximum number of rows without common mode
+    int _maxNoOfSkippedRow;
+
+    //! The pedestal, common mode and seed search kernel
+    EUTelFrameCalibrator _frameCalibrator;
+
+    //! The calibrated frames, reused from one event to the next
+    LCCollectionVec *_calibratedCollection;
+
+    //! The seed candidates found during the calibration, per sensor ID
+    std::map<int, std::vector<EUTelSeedFinder::Candidate>>
+        _calibratedCandidateMap;
+
     int ID;
   };
 
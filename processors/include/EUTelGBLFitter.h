@@ -13,6 +13,7 @@
 #define EUTelGBLFitter_h 1
 
 #include "EUTelTripletGBLUtility.h"
+#include "EUTelStraightLineGBLFitter.h"
 
 #include <memory>
 #include "marlin/Processor.h"
@@ -44,6 +45,9 @@
 #include <AIDA/ITree.h>
 #endif
 
+//for gbl::GblPoint
+#include "include/GblTrajectory.h"
+
 // ROOT includes
 #include <TMatrixD.h>
 #include "TH1D.h"
@@ -161,6 +165,26 @@ namespace eutelescope {
       std::vector<Eigen::Vector2d> _planeWscatSi;
       std::vector<Eigen::Vector2d> _planeWscatAir;
 
+      //! Six telescope planes with two air scatterers in each gap
+      typedef EUTelStraightLineGBLFitter<16> SixPlaneGBLFitter;
+
+      //! Use the fixed topology fit instead of gbl::GblTrajectory
+      /*! Off by default until the gblfitbenchmark test, which compares
+       *  it with GBL, passes. Tracks the fixed fit fails on are fitted
+       *  with the generic GBL trajectory.
+       */
+      bool _useFixedTopologyFit;
+
+      //! Fixed topology fitter, only set up for the six plane topology
+      std::unique_ptr<SixPlaneGBLFitter> _fixedFitter;
+
+      //! GBL trajectory points from the measurements indexed by GBL point
+      /*! Points without measurement have precision zero, the same inputs
+       *  are handed to the fixed topology fit.
+       */
+      std::vector<gbl::GblPoint> trajectoryPoints( std::vector<Eigen::Vector2d> const & meas,
+                                                   std::vector<Eigen::Vector2d> const & measPrec );
+
       FloatVec _telResolution;
       FloatVec _dutResolutionX;
       FloatVec _dutResolutionY;
@@ -42,6 +42,15 @@ namespace eutelescope
      *  the estimated position in one axis on your sensor.
      *  No promises that this will work with tilted sensors and/or with magnetic field
      *  One needs to used this with merged hits and after pre-alignment
+     *
+     *  The hits of the second reference plane are sorted along the known
+     *  coordinate once per event. For each DUT hit and hit of the first
+     *  reference plane, only the hits of the second plane in the window
+     *  allowed by MaxResidual are extrapolated, instead of all of them.
+     *  The created hits are the same as with the loop over all pairs. Set
+     *  FillAllPairHistograms to loop over all pairs anyway, so that the
+     *  pointhitmap, failhitmap and faildistance histograms and the residual
+     *  fail count include the pairs outside the window.
      */
 
     class EUTelMissingCoordinateEstimator : public marlin::Processor
@@ -85,10 +94,29 @@ namespace eutelescope
 
 	    TrackerHitImpl* cloneHit ( TrackerHitImpl *inputHit );
 
+	    //! Position of a reference hit
+	    struct ReferenceHit
+	    {
+		double pos[3];
+	    };
+
+	    //! Copies the positions of the given input hits into referenceHits
+	    void fillReferenceHits ( LCCollectionVec * inputHitCollection, const std::vector < int > & hitIndices, std::vector < ReferenceHit > & referenceHits ) const;
+
+	    //! Finds the hits of the second reference plane which can pair with a hit of the first one
+	    /*! The candidates are the indices in _referenceHits2, in increasing order.
+	     *  If useWindow is false, all the hits are candidates, otherwise
+	     *  the extrapolation parameter t of all the pairs has to be in
+	     *  [tMin, tMax], an interval not containing 0.
+	     */
+	    void findCandidates ( const double * dutHitPos, const double * refHit1Pos, double tMin, double tMax, bool useWindow, std::vector < int > & candidates ) const;
+
 	private:
 
 	    bool _multihitmode;
 
+	    bool _fillAllPairHistos;
+
 	    unsigned int _missingHitPos;
 
 	    unsigned int _knownHitPos;
@@ -104,6 +132,18 @@ namespace eutelescope
 	    unsigned int _nResidualFailCount;
 
 	    unsigned int _numberOfCreatedHitsPerDUTHit[10];
+
+	    std::vector < ReferenceHit > _referenceHits1;
+
+	    std::vector < ReferenceHit > _referenceHits2;
+
+	    //! Indices in _referenceHits2 sorted along the known coordinate
+	    std::vector < int > _sortedReferenceHits2;
+
+	    //! Known coordinate of the hits in _sortedReferenceHits2 order
+	    std::vector < double > _sortedKnownPos2;
+
+	    std::vector < int > _candidates;
     };
 
     EUTelMissingCoordinateEstimator gEUTelMissingCoordinateEstimator;
@@ -14,11 +14,13 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include <IMPL/TrackerDataImpl.h>
 
 #include "CrossSection.hpp"
+#include "EUTelBadPixelMap.h"
 #include "TH1.h"
 #include "TH2.h"
 #include "TProfile2D.h"
@@ -131,8 +133,10 @@ private:
   int nNoPAlpideHit;
   int nWrongPAlpideHit;
   int nPlanesWithTooManyHits;
-  std::vector<int> noiseMaskX;
-  std::vector<int> noiseMaskY;
+  //! Bad pixels of the DUT, filled in the first event
+  std::unique_ptr<eutelescope::EUTelBadPixelMap> _hotPixelMap;
+  std::unique_ptr<eutelescope::EUTelBadPixelMap> _noiseMaskMap;
+  std::unique_ptr<eutelescope::EUTelBadPixelMap> _deadColumnMap;
   double xZero;
   double yZero;
   double xPitch;
@@ -17,6 +17,7 @@
 #include "marlin/Processor.h"
 
 // lcio includes <.h>
+#include <IMPL/LCCollectionVec.h>
 #include <IMPL/TrackerHitImpl.h>
 
 // gear includes <.h>
@@ -32,6 +33,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace eutelescope {
 
@@ -53,11 +55,28 @@ namespace eutelescope {
    *  LCGenericObject  containing all the needed alignment constants
    *  calculated by previous processors.
    *
+   *  <br><b>AlignmentConstantNames</b>.
+   *  Optionally, an ordered list of EUTelAlignmentConstant
+   *  collections, e.g. the prealignment followed by several
+   *  alignment iterations. The whole chain is composed into a single
+   *  rotation and translation per sensor at the first event of a run
+   *  and when a conditions handler loads new constants, so that each hit is
+   *  transformed only once, whatever the number of collections. The
+   *  result is the same as running one instance of this processor
+   *  per collection. When this list is given, AlignmentConstantName
+   *  is only used to name the exported collection.
+   *
    *  <h4>Output</h4>
    *
    *  <br><b>OutputHit</b>.
    *  This is a collection of TrackerHit with the correct hits.
    *
+   *  <br><b>ComposedAlignmentConstantLCIOFile</b>.
+   *  If set, the composed alignment chain is written at the end of the
+   *  job into this LCIO file as a single collection of
+   *  EUTelAlignmentConstant named AlignmentConstantName. The errors of
+   *  the composed constants are set to zero.
+   *
    *  @param CorrectionMethod There are actually several different
    *  methods to apply the alignment constants. Here below a list of
    *  available methods:
@@ -124,6 +143,37 @@ namespace eutelescope {
     virtual void end();
 
   protected:
+    //! Alignment of a sensor as an affine transform
+    /*! A hit position @c p is moved to <code>rotation * p +
+     *  translation</code>. The rotation is stored row by row.
+     */
+    struct AffineTransform {
+      double rotation[9];
+      double translation[3];
+    };
+
+    //! Composes the chain of alignment collections
+    /*! The transform of each level is multiplied in front of the ones
+     *  of the previous levels. A sensor missing from a level is not
+     *  moved by it.
+     *
+     *  @param collections The alignment collections, in the order in
+     *  which they have to be applied
+     */
+    void composeAlignment(const std::vector<LCCollection *> &collections);
+
+    //! Applies the composed alignment to the input hits
+    /*! The output collection is added to the event.
+     */
+    void applyComposedAlignment(LCEvent *evt,
+                                IMPL::LCCollectionVec *inputCollectionVec);
+
+    //! Writes the composed alignment to _composedAlignmentFile
+    void writeComposedAlignment() const;
+
+    //! Returns the center of a sensor, the pivot of the rotations
+    static void getPlaneCenter(int sensorID, double center[3]);
+
     //! Input collection name.
     /*! This is the name of the input hit collection.
      */
@@ -167,6 +217,23 @@ namespace eutelescope {
 
     //! Look Up Table for the sensor ID
     std::map<int, int> _lookUpTable;
+
+    //! Ordered list of alignment collections to compose
+    std::vector<std::string> _alignmentCollectionNames;
+
+    //! Output LCIO file of the composed alignment constants
+    std::string _composedAlignmentFile;
+
+    //! Composed alignment transform, the key is the sensor ID
+    std::map<int, AffineTransform> _composedAlignment;
+
+    //! Validity ranges of the alignment collections _composedAlignment
+    //! was built from
+    /*! Counted by the EUTelConditionsCache from the LCCD handlers, empty
+     *  before the first composition of a run. A collection without
+     *  handler is composed once per run.
+     */
+    std::vector<unsigned long> _composedChanges;
   };
 
   //! A global instance of the processor
@@ -0,0 +1,129 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPROCESSOREVENTPREFILTER_H
+#define EUTELPROCESSOREVENTPREFILTER_H
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+
+// lcio includes <.h>
+#include <LCIOTypes.h>
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Early rejection of events with too few planes hit
+  /*! This processor selects events from the per sensor multiplicity
+   *  summary of a collection (see EventSummary), stored as event
+   *  parameters by the processor producing the collection: the
+   *  EUTelProcessorNoisyPixelRemover for the pixels, the sparse and
+   *  geometric clustering for the clusters. No collection is decoded.
+   *
+   *  It is meant to be placed at the beginning of a job reading the
+   *  output of a previous one, before any expensive processor. An
+   *  event failing the selection is skipped with the Marlin skip
+   *  semantics, so none of the following processors sees it. An event
+   *  without summary, e.g. converted before the summaries existed, is
+   *  always accepted. The empty summary of an empty collection counts
+   *  as no sensor hit.
+   *
+   *  A sensor is counted as hit if it has between MinElementsPerPlane
+   *  and MaxElementsPerPlane elements. The event is accepted if at
+   *  least MinNoOfPlanes sensors, not in ExcludedPlanes, are hit and
+   *  all the RequiredPlanes are hit.
+   *
+   *  At the end, the number of rejected events and of the elements
+   *  they carried is reported, as an estimate of the saved work.
+   *
+   *  @param SummaryCollectionName Collection whose summary is used
+   *  @param MinElementsPerPlane Minimum number of elements of a hit plane
+   *  @param MaxElementsPerPlane Maximum number of elements of a hit
+   *  plane, -1 for no limit
+   *  @param MinNoOfPlanes Minimum number of hit planes
+   *  @param RequiredPlanes Sensor IDs which have to be hit
+   *  @param ExcludedPlanes Sensor IDs which are not counted
+   */
+  class EUTelProcessorEventPreFilter : public marlin::Processor {
+
+  public:
+    //! Returns a new instance of EUTelProcessorEventPreFilter
+    virtual Processor *newProcessor() {
+      return new EUTelProcessorEventPreFilter;
+    }
+
+    //! Default constructor
+    EUTelProcessorEventPreFilter();
+
+    //! Called at the job beginning.
+    /*! Prints out the processor parameters and checks them.
+     *
+     *  @throw InvalidParameterException if a parameter is wrongly set
+     */
+    virtual void init();
+
+    //! Called for every run.
+    virtual void processRunHeader(LCRunHeader *run);
+
+    //! Called every event
+    /*! Reads the summary of the event and decides whether the event
+     *  is kept.
+     *
+     *  @throw SkipEventException if the event is rejected
+     */
+    virtual void processEvent(LCEvent *evt);
+
+    //! Called after data processing.
+    /*! Reports the number of rejected events and elements.
+     */
+    virtual void end();
+
+  protected:
+    //! Name of the collection whose summary is used
+    std::string _summaryCollectionName;
+
+    //! Minimum number of elements of a hit plane
+    int _minElementsPerPlane;
+
+    //! Maximum number of elements of a hit plane, -1 for no limit
+    int _maxElementsPerPlane;
+
+    //! Minimum number of hit planes
+    int _minNoOfPlanes;
+
+    //! Sensor IDs which have to be hit
+    std::vector<int> _requiredPlanes;
+
+    //! Sensor IDs which are not counted
+    std::vector<int> _excludedPlanes;
+
+    //! Number of events seen
+    long _noOfEvents;
+
+    //! Number of events without summary
+    long _noOfEventsWithoutSummary;
+
+    //! Number of rejected events
+    long _noOfRejectedEvents;
+
+    //! Number of summarised elements in all events
+    long _noOfElements;
+
+    //! Number of summarised elements in the rejected events
+    long _noOfRejectedElements;
+  };
+
+  //! A global instance of the processor
+  EUTelProcessorEventPreFilter gEUTelProcessorEventPreFilter;
+
+} // namespace eutelescope
+
+#endif
@@ -10,6 +10,7 @@
 #define EUTelProcessorNoisyClusterMasker_H
 
 // eutelescope includes ".h"
+#include "EUTelConditionsCache.h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
 
@@ -139,7 +140,9 @@ namespace eutelescope {
     bool _wrongDataFormat;
 
     //! Map linking the noise vectors of each plane to the plane ID
-    std::map<int, std::vector<int>> _noisyPixelMap;
+    /*! Shared with the other processors through the EUTelConditionsCache
+     */
+    std::shared_ptr<const EUTelConditionsCache::NoisyPixelMap> _noisyPixelMap;
 
     //! Map counting the removed hot pixels per plane
     std::map<int, int> _maskedNoisyClusters;
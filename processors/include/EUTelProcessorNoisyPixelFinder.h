@@ -68,6 +68,10 @@ namespace eutelescope {
    *
    *  @param HotPixelCollectionName The name of the collection in the output
    * file
+   *
+   *  @param HitCountCollectionName If set, the hit counts of all fired pixels
+   *  are stored in the output file as well and the file is written at the
+   *  end of the run, this is used to merge runs processed in chunks
    */
   class EUTelProcessorNoisyPixelFinder : public marlin::Processor {
 
@@ -238,6 +242,17 @@ namespace eutelescope {
     //! Hot Pixel DB output file
     std::string _noisyPixelDBFile;
 
+    //! Name of the optional hit count collection in the db file
+    /*! If not empty, the per pixel hit counts are written into the db
+     *  alongside the hot pixels, allowing chunk databases to be merged.
+     *  The exact counts are the integers of the collection parameter
+     *  HitCounts_<sensorID>, the pixel signal is only a float copy.
+     */
+    std::string _hitCountCollectionName;
+
+    //! apply the firing frequency cut to the hit counts
+    void findNoisyPixels();
+
     //! write out the list of hot pixels
     void noisyPixelDBWriter();
 
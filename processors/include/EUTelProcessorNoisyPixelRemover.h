@@ -10,6 +10,7 @@
 #define EUTELPROCESSORNOISYPIXELREMOVER_H
 
 // eutelescope includes ".h"
+#include "EUTelConditionsCache.h"
 #include "EUTelEventImpl.h"
 
 // marlin includes ".h"
@@ -95,7 +96,8 @@ namespace eutelescope {
     //! Collection name for noisy pixel collection
     std::string _noisyPixelCollectionName;
 
-    std::map<int, std::vector<int>> _noisyPixelMap;
+    //! The noisy pixels, shared through the EUTelConditionsCache
+    std::shared_ptr<const EUTelConditionsCache::NoisyPixelMap> _noisyPixelMap;
     bool _firstEvent = true;
   };
 
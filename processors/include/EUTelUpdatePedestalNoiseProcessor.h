@@ -19,6 +19,8 @@
 #include <LCIOTypes.h>
 
 // system includes <>
+#include <map>
+#include <vector>
 
 namespace eutelescope {
 
@@ -60,6 +62,20 @@ namespace eutelescope {
    *  elements is kept constant to weight value. An analogous approach
    *  is used for the noise calculation.
    *
+   *  \li <b>RunningAverage</b>: corresponding to
+   *  EUTELESCOPE::RUNNINGAVERAGE. The same formula is used, but the
+   *  weight is increased by one at each update, starting from the
+   *  FixedWeightValue: the initial pedestal counts as W events and
+   *  all the following updates are averaged with the same weight. The
+   *  weight is reset at every new run and at every new set of
+   *  pedestal / noise conditions.
+   *
+   *  The update works on a private copy of the pedestal and noise of
+   *  each sensor, which is written back to the LCIO collections only
+   *  when one of the values has moved by more than PedestalTolerance
+   *  ADC counts since the last write back. With the default tolerance
+   *  of 0 every update is written back.
+   *
    *  <h4>Input collections</h4>
    *
    *  <b>Raw data collection</b> the collection with the full raw data matrix.
@@ -83,6 +99,7 @@ namespace eutelescope {
    *  @param UpdateAlgorithm name of the algorithm to be used
    *  @param UpdateFrequency update frequency in events
    *  @param FixedWeightValue the value of the fixed weight
+   *  @param PedestalTolerance the change triggering a write back
    *
    *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
    *  @version $Id$
@@ -152,12 +169,12 @@ namespace eutelescope {
     virtual void end();
 
   protected:
-    //! Fixed weight update algorithm
+    //! Fixed weight and running average update algorithm
     /*! This method is called by the processEvent if the _updateAlgo
-     *  has been set to EUTELESCOPE::FIXEDWEIGHT. It has been set as
-     *  protected because it has to called from within the class
-     *  itself and specifically from the processEvent(LCEvent*)
-     *  method.
+     *  has been set to EUTELESCOPE::FIXEDWEIGHT or
+     *  EUTELESCOPE::RUNNINGAVERAGE. It has been set as protected
+     *  because it has to called from within the class itself and
+     *  specifically from the processEvent(LCEvent*) method.
      *
      *  The algorithm can be described as follows:
      *
@@ -169,10 +186,18 @@ namespace eutelescope {
      *  \li Their signal is added to previous pedestal value according
      *  to this formula: <code>P[i+1] = [(W - 1) / W] * P[i] + (1 / W)
      *  * D </code>, where W is the @c _fixedWeightValue and @c D is
-     *  the pixel current value.
+     *  the pixel current value. For the running average W is
+     *  increased by one at each update.
+     *
+     *  \li The working copy of a sensor is written back to the
+     *  pedestal and noise collections if it differs from them by more
+     *  than @c _pedestalTolerance.
      *
      *  @param evt The current LCEvent event as passed by the
      *  processEvent
+     *
+     *  @throw IncompatibleDataSetException if the raw data and the
+     *  conditions do not match
      */
     void fixedWeightUpdate(LCEvent *evt);
 
@@ -244,6 +269,7 @@ namespace eutelescope {
      *  const string can be found within the EUTELESCOPE class.
      *
      *  @see EUTELESCOPE::FIXEDWEIGHT
+     *  @see EUTELESCOPE::RUNNINGAVERAGE
      */
     std::string _updateAlgo;
 
@@ -290,6 +316,39 @@ namespace eutelescope {
      */
     int _fixedWeight;
 
+    //! Pedestal tolerance
+    /*! The maximum change of the pedestal or noise of a pixel, in ADC
+     *  counts, before the working copy of the sensor is written back
+     *  to the LCIO collections. 0 means at every update.
+     */
+    float _pedestalTolerance;
+
+    //! Number of updates with the current conditions
+    /*! Used to increase the weight of the running average.
+     */
+    int _noOfUpdates;
+
+    //! Working copy of the pedestal and noise of a sensor
+    struct SensorState {
+      std::vector<float> pedestal;
+      std::vector<float> noise;
+    };
+
+    //! Working copies, the key is the sensorID
+    std::map<int, SensorState> _sensorStates;
+
+    //! Validity ranges of the pedestal seen when the working copies
+    //! were taken
+    /*! Counted by the EUTelConditionsCache from the LCCD handler of the
+     *  pedestal collection. A pedestal without handler is kept for the
+     *  whole run.
+     */
+    unsigned long _pedestalChanges;
+
+    //! Scratch arrays of the update kernel
+    std::vector<float> _newPedestal;
+    std::vector<double> _newVariance;
+
     //! Current run number.
     /*! This number is used to store the current run number
      */
@@ -0,0 +1,114 @@
+#ifndef EUTelUtilityProfiler_h
+#define EUTelUtilityProfiler_h 1
+
+// C++
+#include <cstddef>
+#include <string>
+
+// LCIO
+#include "lcio.h"
+
+// Marlin
+#include "marlin/Processor.h"
+
+// AIDA
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+#include <AIDA/IHistogram1D.h>
+#endif
+
+namespace eutelescope {
+
+  /** Profiling checkpoint for a chain of processors.
+   *
+   *  Marlin has no hooks around the single processors, so this
+   *  processor is inserted into the steering file after every
+   *  processor (or group of processors) to be measured. Each instance
+   *  reports the wall clock time, CPU time, heap allocations and peak
+   *  RSS growth spent since the preceding checkpoint, see
+   *  EUTelProfiler. processEvent and check of the processors in
+   *  between are measured together, end is measured separately.
+   *
+   *  The first checkpoint should be the first processor of the chain,
+   *  it then accounts for reading the events. The last checkpoint
+   *  prints a summary table of all checkpoints at the end of the job
+   *  and writes the trace file if one was requested by any checkpoint.
+   *
+   *  @parameter Label The name of the checkpoint in the summary, by
+   *  default the name of the processor
+   *
+   *  @parameter RingBufferSize The number of most recent events kept
+   *  for the trace file
+   *
+   *  @parameter TraceFile Name of a Chrome trace / Perfetto JSON file
+   *  to be written at the end of the job
+   *
+   *  @parameter FillLatencyHistogram Fill a per event latency histogram
+   *  of this checkpoint
+   */
+  class EUTelUtilityProfiler : public marlin::Processor {
+
+  public:
+    /* This method will be called by the marlin package
+     * It returns a processor of the currend type
+     */
+    virtual Processor *newProcessor() { return new EUTelUtilityProfiler; }
+
+    /* the default constructor
+     * here the processor parameters are registered to the marlin package
+     * other initialisation should be placed in the init method
+     */
+    EUTelUtilityProfiler();
+
+    /* Called at the beginning of the job before anything is read.
+     * Adds this checkpoint to the chain and books the histogram.
+     */
+    virtual void init();
+
+    /* Called for every run.
+     */
+    virtual void processRunHeader(lcio::LCRunHeader *run);
+
+    /* Called for every event, passes the checkpoint
+     */
+    virtual void processEvent(lcio::LCEvent *evt);
+
+    /* Nothing to do here, the check of the preceding processors is
+     * part of the event stage
+     */
+    virtual void check(lcio::LCEvent *evt);
+
+    /* Passes the checkpoint for the end stage, the last checkpoint
+     * writes the summary and the trace file
+     */
+    virtual void end();
+
+  protected:
+    //! Label of the checkpoint
+    std::string _label;
+
+    //! Number of intervals kept for the trace
+    int _ringBufferSize;
+
+    //! Name of the trace file
+    std::string _traceFile;
+
+    //! Switch for the latency histogram
+    bool _fillLatencyHistogram;
+
+    //! Position of this checkpoint in the chain
+    std::size_t _position;
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    //! Per event latency in ms, logarithmic binning
+    AIDA::IHistogram1D *_latencyHisto;
+#endif
+
+    //! The trace file requested by any checkpoint
+    static std::string _chainTraceFile;
+  };
+
+  //! A global instance of the processor
+  EUTelUtilityProfiler gEUTelUtilityProfiler;
+}
+
+#endif
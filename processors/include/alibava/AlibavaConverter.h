@@ -80,11 +80,17 @@ namespace alibava
 	    // An option to store pedestal and noise values stored in header of alibava data file
 	    bool _storeHeaderPedestalNoise;
 
+	    // The byte range of the input file to be converted, empty for the whole file
+	    EVENT::StringVec _byteRange;
+
 	private:
 
 	    // To check if the chip selection is valid
 	    void checkIfChipSelectionIsValid();
 
+	    // The length in bytes of one event record for a given data version
+	    static int recordLength ( int version );
+
     };
 
     // A global instance of the processor
@@ -51,6 +51,9 @@ namespace eutelescope
 
 	    std::string _rawDataCollectionNameTop;
 
+	    // the byte range of the input file to convert, empty for the whole file
+	    EVENT::StringVec _byteRange;
+
 	private:
 
 	    int _nFE;
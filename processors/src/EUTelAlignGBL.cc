@@ -94,6 +94,8 @@ EUTelAlignGBL::EUTelAlignGBL(): Processor("EUTelAlignGBL") {
   registerOptionalParameter("maxTrackCandidatesTotal","Maximal number of track candidates (Total)",_maxTrackCandidatesTotal, 10000000);
   registerOptionalParameter("maxTrackCandidates","Maximal number of track candidates",_maxTrackCandidates, 2000);
   registerOptionalParameter("milleBinaryFilename","Name of the Millepede binary file",_binaryFilename, std::string{"mille.bin"});
+  registerOptionalParameter("NumberOfThreads","Number of threads fitting the tracks of an event, 1 fits them sequentially",_nThreads, 1);
+  registerOptionalParameter("ShardedMilleFiles","Let every thread write its own Millepede binary file <name>_<thread><ext> instead of writing all tracks to milleBinaryFilename in event order",_shardedMilleFiles, false);
   registerOptionalParameter("alignMode","Number of alignment constants used. Available mode are:"
                               "\n\t\tXYZShifts - shifts in X and Y"
                               "\n\t\tXYShiftsRotZ - shifts in X and Y and rotation around the Z axis,"
@@ -228,10 +230,23 @@ void EUTelAlignGBL::init() {
   
   streamlog_out( MESSAGE2 ) << "Initialising Mille..." << endl;
 
-  unsigned int reserveSize = 8000;
-  milleAlignGBL = std::make_unique<gbl::MilleBinary>( _binaryFilename, reserveSize );
+  if( _nThreads < 1 ) {
+    streamlog_out(ERROR) << "NumberOfThreads has to be at least 1, it is " << _nThreads << std::endl;
+    throw InvalidParameterException("NumberOfThreads");
+  }
+  _workerPool = std::make_unique<EUTelWorkerPool>( static_cast<unsigned int>(_nThreads) );
 
-  streamlog_out( MESSAGE2 ) << "The filename for the binary file is: " << _binaryFilename.c_str() << endl;
+  unsigned int reserveSize = 8000;
+  _milleShards.clear();
+  if( _shardedMilleFiles ) {
+    for( unsigned int worker = 0; worker < _workerPool->getNoOfWorkers(); ++worker ) {
+      _milleShards.push_back( std::make_unique<gbl::MilleBinary>( getMilleShardName(worker), reserveSize ) );
+      streamlog_out( MESSAGE2 ) << "The filename for the binary file of thread " << worker << " is: " << getMilleShardName(worker) << endl;
+    }
+  } else {
+    milleAlignGBL = std::make_unique<gbl::MilleBinary>( _binaryFilename, reserveSize );
+    streamlog_out( MESSAGE2 ) << "The filename for the binary file is: " << _binaryFilename.c_str() << endl;
+  }
 
   if(_alignModeString.compare("XYShiftsRotZ") == 0 ) {
     _alignMode = Utility::alignMode::XYShiftsRotZ;
@@ -389,152 +404,38 @@ void EUTelAlignGBL::processEvent( LCEvent * event ) {
             }*/
           }
   }
-  for(auto& track: matchedTripletVec) {
-    // GBL point vector for the trajectory, all in [mm] !!
-    // GBL with triplet A as seed
-    std::vector<gbl::GblPoint> traj_points;
-    // build up trajectory:
-    std::vector<unsigned int> ilab; // 0-5 = telescope, 6 = DUT, 7 = REF
-    vector<double> sPoint;
-
-    // the arc length at the first measurement plane is 0.
-    double s = 0;
+  // The track fits are independent of each other and are spread over the
+  // worker pool. Everything filling histograms or writing to the common
+  // Mille file is done afterwards on this thread in the order of the
+  // tracks, so the output does not depend on the number of threads.
+  std::vector<TrackFit> fits(matchedTripletVec.size());
+  _workerPool->run(matchedTripletVec.size(), [&](size_t i, unsigned int worker) {
+    fitTrack(matchedTripletVec[i], fits[i]);
+    // do not pass very bad tracks to mille
+    if(!_milleShards.empty() && fits[i].probchi > 0.001) {
+      fits[i].traj->milleOut( *_milleShards[worker] );
+    }
+  });
 
-    Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
-    Eigen::Vector2d scat = Eigen::Vector2d::Zero(); //mean is zero
+  for(size_t itrack = 0; itrack < matchedTripletVec.size(); ++itrack) {
+    auto& track = matchedTripletVec[itrack];
+    auto& fit = fits[itrack];
+    auto& traj = *fit.traj;
 
     auto triplet = track.get_upstream();
     auto driplet = track.get_downstream();
-    //We need the _T_riplet slope to compute residual
     auto triSlope = triplet.slope();
 
-    std::vector<EUTelTripletGBLUtility::hit> DUThits;
-    for(auto it = triplet.DUT_begin(); it != triplet.DUT_end(); ++it){
-      DUThits.emplace_back(it->second);
-    }
-    for(auto it = driplet.DUT_begin(); it != driplet.DUT_end(); ++it){
-      DUThits.emplace_back(it->second);
-    }
-
-    if(_printEventCounter < NO_PRINT_EVENT_COUNTER) std::cout << "Track has " << DUThits.size() << " DUT hits\n";
-
-    Eigen::Matrix2d alDer2; // alignment derivatives
-    alDer2(0,0) = 1.0; // dx/dx GBL sign convetion
-    alDer2(1,0) = 0.0; // dy/dx
-    alDer2(0,1) = 0.0; // dx/dy
-    alDer2(1,1) = 1.0; // dy/dy
-
-    Eigen::Matrix<double,2,3> alDer3; // alignment derivatives
-    alDer3(0,0) = 1.0; // dx/dx
-    alDer3(1,0) = 0.0; // dy/dx
-    alDer3(0,1) = 0.0; // dx/dy
-    alDer3(1,1) = 1.0; // dy/dy
-
-    Eigen::Matrix<double, 2,4> alDer4; // alignment derivatives
-    alDer4(0,0) = 1.0; // dx/dx
-    alDer4(1,0) = 0.0; // dy/dx
-    alDer4(0,1) = 0.0; // dx/dy
-    alDer4(1,1) = 1.0; // dy/dy
-    alDer4(0,3) = triSlope.x; // dx/dz
-    alDer4(1,3) = triSlope.y; // dx/dz
-
-    size_t DUTCount = _nPlanes-6;
-    std::vector<double> rx (_nPlanes, -1.0);
-    std::vector<double> ry (_nPlanes, -1.0);
-    std::vector<bool> hasHit (_nPlanes, false);
-  
-    double step = .0;
-    unsigned int iLabel;
-
-    for( size_t ipl = 0; ipl < _nPlanes; ++ipl ) {
-      //We have to add all the planes, the up and downstream arm of the telescope will definitely have
-      //hits, the DUTs might not though! The first and last three planes are the telescope.
-      EUTelTripletGBLUtility::hit const * hit = nullptr;
-      auto sensorID = _sensorIDVec[ipl];
-      if(ipl < 3) {
-        hit = &triplet.gethit(sensorID);
-      } else if( ipl < 3+DUTCount) {
-        if(triplet.has_DUT(sensorID)) hit = &triplet.get_DUT_Hit(sensorID);
-        else if(driplet.has_DUT(sensorID)) hit = &driplet.get_DUT_Hit(sensorID);
-      } else {
-        hit = &driplet.gethit(sensorID);
-      }
-
-      //if there is no hit we take the plane position from the geo description
-      double zz = hit ? hit->z : _planePosition[ipl];// [mm]
+    auto const & rx = fit.rx;
+    auto const & ry = fit.ry;
+    auto const & hasHit = fit.hasHit;
 
-      //transport matrix in (q/p, x', y', x, y) space
-      auto jacPointToPoint = Jac55new( step );
-      auto point = gbl::GblPoint( jacPointToPoint );
-      s += step;
-
-      //of there is a hit we will add a measurement to the point
-      if(hit){
-        hasHit[ipl] = true;
-        double xs = triplet.getx_at(zz);
-        double ys = triplet.gety_at(zz);
-
-        if(_printEventCounter < NO_PRINT_EVENT_COUNTER) std::cout << "xs = " << xs << "   ys = " << ys << std::endl;
-
-        rx[ipl] = (hit->x - xs); // resid hit-triplet, in micrometer ...
-        ry[ipl] = (hit->y - ys); // resid
-    
-        Eigen::Vector2d meas;
-        meas[0] = rx[ipl]; // fill meas vector for GBL
-        meas[1] = ry[ipl];
-        point.addMeasurement( proL2m, meas, _planeMeasPrec[ipl] );
-
-        if( _alignMode == Utility::alignMode::XYShifts ) { // only x and y shifts
-          // global labels for MP:
-          std::vector<int> globalLabels(2);
-          globalLabels[0] = 1 + 2*ipl;
-          globalLabels[1] = 2 + 2*ipl;
-          point.addGlobals( globalLabels, alDer2 ); // for MillePede alignment
-        }
-        else if( _alignMode == Utility::alignMode::XYShiftsRotZ ) { // with rot
-          std::vector<int> globalLabels(3);
-          globalLabels[0] = 1 + 3*ipl; // x
-          globalLabels[1] = 2 + 3*ipl; // y
-          globalLabels[2] = 3 + 3*ipl; // rot
-          alDer3(0,2) = -ys; // dx/dphi
-          alDer3(1,2) =  xs; // dy/dphi
-          point.addGlobals( globalLabels, alDer3 ); // for MillePede alignment
-        }
-        else if( _alignMode == Utility::alignMode::XYZShiftsRotZ ) { // with rot and z shift
-          std::vector<int> globalLabels(4);
-          globalLabels[0] = 1 + 4*ipl;
-          globalLabels[1] = 2 + 4*ipl;
-          globalLabels[2] = 3 + 4*ipl;
-          globalLabels[3] = 4 + 4*ipl; // z
-          alDer4(0,2) = -ys; // dx/dphi
-          alDer4(1,2) =  xs; // dy/dphi
-          point.addGlobals( globalLabels, alDer4 ); // for MillePede alignment
-        }
-      }
-
-      point.addScatterer( scat, _planeWscatSi[ipl] );
-      sPoint.push_back( s );
-      iLabel = sPoint.size();
-      ilab.push_back(iLabel);
-      traj_points.push_back(point);
-
-      if( ipl < _nPlanes-1 ) {
-        double distplane = _planePosition[ipl+1] - _planePosition[ipl];
-        step = 0.21*distplane; // in [mm]
-        auto point = gbl::GblPoint( Jac55new( step ) );
-        point.addScatterer( scat, _planeWscatAir[ipl] );
-        s += step;
-        traj_points.push_back(point);
-        sPoint.push_back( s );
-        step = 0.58*distplane; // in [mm]
-        auto point1 = gbl::GblPoint( Jac55new( step ) );
-        point1.addScatterer( scat, _planeWscatAir[ipl] );
-        s += step;
-        traj_points.push_back(point1);
-        sPoint.push_back( s );
-        step = 0.21*distplane; // remaing distance to next plane, in [mm]
+    if(_printEventCounter < NO_PRINT_EVENT_COUNTER) {
+      std::cout << "Track has " << fit.nDUTHits << " DUT hits\n";
+      for( size_t ipl = 0; ipl < _nPlanes; ++ipl ) {
+        if(hasHit[ipl]) std::cout << "xs = " << fit.xs[ipl] << "   ys = " << fit.ys[ipl] << std::endl;
       }
-    } // loop over planes
+    }
 
     // monitor what we put into GBL:
     double xA = triplet.getx_at(zMid);
@@ -561,13 +462,10 @@ void EUTelAlignGBL::processEvent( LCEvent * event ) {
       }
     }
 
-    double Chi2;
-    int Ndf;
-    double lostWeight;
-
-    gbl::GblTrajectory traj(traj_points, false); // curvature = false
-    traj.fit( Chi2, Ndf, lostWeight );
-    //traj.getLabels(ilab); // instead pushback sPoint.size() when adding plane
+    double Chi2 = fit.chi2;
+    int Ndf = fit.ndf;
+    auto const & ilab = fit.ilab;
+    auto const & sPoint = fit.sPoint;
 
     if(_printEventCounter < NO_PRINT_EVENT_COUNTER){
       streamlog_out(DEBUG4) << "traj with " << traj.getNumPoints() << " points:" << endl;
@@ -597,7 +495,7 @@ void EUTelAlignGBL::processEvent( LCEvent * event ) {
 
     gblndfHistGBLAlign->fill( Ndf );
     gblchi2HistGBLAlign->fill( Chi2 );
-    double probchi = TMath::Prob( Chi2, Ndf );
+    double probchi = fit.probchi;
     gblprbHistGBLAlign->fill( probchi );
 
     // bad fits:
@@ -642,54 +540,33 @@ void EUTelAlignGBL::processEvent( LCEvent * event ) {
     } // OK fit
 
     // look at fit:
-    Eigen::VectorXd localPar;
-    Eigen::MatrixXd localCov;
-
-    std::array<double,8> ax;
-    std::array<double,8> ay;
-    size_t k = 0;
-
-    // at plane 0:
-    unsigned int ndata = 2;
-    unsigned int ndim = 2;
-    Eigen::VectorXd aResiduals(ndim);
-    Eigen::VectorXd aMeasErrors(ndim);
-    Eigen::VectorXd aResErrors(ndim);
-    Eigen::VectorXd aDownWeights(ndim);
-
     for(size_t ix = 0; ix < _nPlanes; ++ix) {
-      int ipos = ilab[ix];
-      traj.getResults( ipos, localPar, localCov );
-
       //track = q/p, x', y', x, y
       //        0,   1,  2,  3, 4
-      gblAxHist[ix]->fill( localPar[1]*1E3 );
-      gblAyHist[ix]->fill( localPar[2]*1E3 );
-      gblDxHist[ix]->fill( localPar[3]*1E3 );
-      gblDyHist[ix]->fill( localPar[4]*1E3 );
-      
+      auto const & localPar = fit.localPar[ix];
+      gblAxHist[ix]->fill( localPar[0]*1E3 );
+      gblAyHist[ix]->fill( localPar[1]*1E3 );
+      gblDxHist[ix]->fill( localPar[2]*1E3 );
+      gblDyHist[ix]->fill( localPar[3]*1E3 );
+
       if(hasHit[ix]){
-        traj.getMeasResults( ipos, ndata, aResiduals, aMeasErrors, aResErrors, aDownWeights );
-        gblRxHist[ix]->fill( (aResiduals[0])*1E3 );
-        gblRyHist[ix]->fill( (aResiduals[1])*1E3 );
-        gblPxHist[ix]->fill( aResiduals[0]/aResErrors[0] );
-        gblPyHist[ix]->fill( aResiduals[1]/aResErrors[1] );
+        auto const & measResult = fit.measResults[ix];
+        gblRxHist[ix]->fill( (measResult[0])*1E3 );
+        gblRyHist[ix]->fill( (measResult[1])*1E3 );
+        gblPxHist[ix]->fill( measResult[0]/measResult[2] );
+        gblPyHist[ix]->fill( measResult[1]/measResult[3] );
       }
-
-      ax[k] = localPar[1];
-      ay[k] = localPar[2];
-      ++k;
     }
 
     for(size_t ix = 0; ix < _nPlanes-1; ++ix) {
-      gblKinkXHist[ix]->fill( (ax[ix+1] - ax[ix])*1E3 ); // kink at planes [mrad]
-      gblKinkYHist[ix]->fill( (ay[ix+1] - ay[ix])*1E3 ); // kink at planes [mrad]
+      gblKinkXHist[ix]->fill( (fit.localPar[ix+1][0] - fit.localPar[ix][0])*1E3 ); // kink at planes [mrad]
+      gblKinkYHist[ix]->fill( (fit.localPar[ix+1][1] - fit.localPar[ix][1])*1E3 ); // kink at planes [mrad]
     }
 
     // do not pass very bad tracks to mille
     if(probchi > 0.001) {
-        traj.milleOut( *milleAlignGBL );
-           nm++;
+      if(_milleShards.empty()) traj.milleOut( *milleAlignGBL );
+      nm++;
     }
   }
   nmHistGBLAlign->fill( nm );
@@ -700,9 +577,198 @@ void EUTelAlignGBL::processEvent( LCEvent * event ) {
   if( isFirstEvent() ) _isFirstEvent = false;
 }
 
+//------------------------------------------------------------------------------
+std::string EUTelAlignGBL::getMilleShardName( unsigned int worker ) const {
+  // mille.bin -> mille_0.bin, ...
+  auto slash = _binaryFilename.find_last_of('/');
+  auto dot = _binaryFilename.find_last_of('.');
+  if( dot == std::string::npos || ( slash != std::string::npos && dot < slash ) ) {
+    dot = _binaryFilename.size();
+  }
+  return _binaryFilename.substr(0, dot) + "_" + to_string(worker) + _binaryFilename.substr(dot);
+}
+
+//------------------------------------------------------------------------------
+void EUTelAlignGBL::fitTrack( EUTelTripletGBLUtility::track & track, TrackFit & fit ) const {
+  // GBL point vector for the trajectory, all in [mm] !!
+  // GBL with triplet A as seed
+  std::vector<gbl::GblPoint> traj_points;
+  // build up trajectory:
+  fit.ilab.clear(); // 0-5 = telescope, 6 = DUT, 7 = REF
+  fit.sPoint.clear();
+
+  // the arc length at the first measurement plane is 0.
+  double s = 0;
+
+  Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
+  Eigen::Vector2d scat = Eigen::Vector2d::Zero(); //mean is zero
+
+  auto triplet = track.get_upstream();
+  auto driplet = track.get_downstream();
+  //We need the _T_riplet slope to compute residual
+  auto triSlope = triplet.slope();
+
+  fit.nDUTHits = static_cast<size_t>(std::distance(triplet.DUT_begin(), triplet.DUT_end()) + std::distance(driplet.DUT_begin(), driplet.DUT_end()));
+
+  Eigen::Matrix2d alDer2; // alignment derivatives
+  alDer2(0,0) = 1.0; // dx/dx GBL sign convetion
+  alDer2(1,0) = 0.0; // dy/dx
+  alDer2(0,1) = 0.0; // dx/dy
+  alDer2(1,1) = 1.0; // dy/dy
+
+  Eigen::Matrix<double,2,3> alDer3; // alignment derivatives
+  alDer3(0,0) = 1.0; // dx/dx
+  alDer3(1,0) = 0.0; // dy/dx
+  alDer3(0,1) = 0.0; // dx/dy
+  alDer3(1,1) = 1.0; // dy/dy
+
+  Eigen::Matrix<double, 2,4> alDer4; // alignment derivatives
+  alDer4(0,0) = 1.0; // dx/dx
+  alDer4(1,0) = 0.0; // dy/dx
+  alDer4(0,1) = 0.0; // dx/dy
+  alDer4(1,1) = 1.0; // dy/dy
+  alDer4(0,3) = triSlope.x; // dx/dz
+  alDer4(1,3) = triSlope.y; // dx/dz
+
+  size_t DUTCount = _nPlanes-6;
+  fit.rx.assign(_nPlanes, -1.0);
+  fit.ry.assign(_nPlanes, -1.0);
+  fit.xs.assign(_nPlanes, 0.0);
+  fit.ys.assign(_nPlanes, 0.0);
+  fit.hasHit.assign(_nPlanes, false);
+
+  double step = .0;
+  unsigned int iLabel;
+
+  for( size_t ipl = 0; ipl < _nPlanes; ++ipl ) {
+    //We have to add all the planes, the up and downstream arm of the telescope will definitely have
+    //hits, the DUTs might not though! The first and last three planes are the telescope.
+    EUTelTripletGBLUtility::hit const * hit = nullptr;
+    auto sensorID = _sensorIDVec[ipl];
+    if(ipl < 3) {
+      hit = &triplet.gethit(sensorID);
+    } else if( ipl < 3+DUTCount) {
+      if(triplet.has_DUT(sensorID)) hit = &triplet.get_DUT_Hit(sensorID);
+      else if(driplet.has_DUT(sensorID)) hit = &driplet.get_DUT_Hit(sensorID);
+    } else {
+      hit = &driplet.gethit(sensorID);
+    }
+
+    //if there is no hit we take the plane position from the geo description
+    double zz = hit ? hit->z : _planePosition[ipl];// [mm]
+
+    //transport matrix in (q/p, x', y', x, y) space
+    auto jacPointToPoint = Jac55new( step );
+    auto point = gbl::GblPoint( jacPointToPoint );
+    s += step;
+
+    //of there is a hit we will add a measurement to the point
+    if(hit){
+      fit.hasHit[ipl] = true;
+      double xs = triplet.getx_at(zz);
+      double ys = triplet.gety_at(zz);
+      fit.xs[ipl] = xs;
+      fit.ys[ipl] = ys;
+
+      fit.rx[ipl] = (hit->x - xs); // resid hit-triplet, in micrometer ...
+      fit.ry[ipl] = (hit->y - ys); // resid
+
+      Eigen::Vector2d meas;
+      meas[0] = fit.rx[ipl]; // fill meas vector for GBL
+      meas[1] = fit.ry[ipl];
+      point.addMeasurement( proL2m, meas, _planeMeasPrec[ipl] );
+
+      if( _alignMode == Utility::alignMode::XYShifts ) { // only x and y shifts
+        // global labels for MP:
+        std::vector<int> globalLabels(2);
+        globalLabels[0] = 1 + 2*ipl;
+        globalLabels[1] = 2 + 2*ipl;
+        point.addGlobals( globalLabels, alDer2 ); // for MillePede alignment
+      }
+      else if( _alignMode == Utility::alignMode::XYShiftsRotZ ) { // with rot
+        std::vector<int> globalLabels(3);
+        globalLabels[0] = 1 + 3*ipl; // x
+        globalLabels[1] = 2 + 3*ipl; // y
+        globalLabels[2] = 3 + 3*ipl; // rot
+        alDer3(0,2) = -ys; // dx/dphi
+        alDer3(1,2) =  xs; // dy/dphi
+        point.addGlobals( globalLabels, alDer3 ); // for MillePede alignment
+      }
+      else if( _alignMode == Utility::alignMode::XYZShiftsRotZ ) { // with rot and z shift
+        std::vector<int> globalLabels(4);
+        globalLabels[0] = 1 + 4*ipl;
+        globalLabels[1] = 2 + 4*ipl;
+        globalLabels[2] = 3 + 4*ipl;
+        globalLabels[3] = 4 + 4*ipl; // z
+        alDer4(0,2) = -ys; // dx/dphi
+        alDer4(1,2) =  xs; // dy/dphi
+        point.addGlobals( globalLabels, alDer4 ); // for MillePede alignment
+      }
+    }
+
+    point.addScatterer( scat, _planeWscatSi[ipl] );
+    fit.sPoint.push_back( s );
+    iLabel = fit.sPoint.size();
+    fit.ilab.push_back(iLabel);
+    traj_points.push_back(point);
+
+    if( ipl < _nPlanes-1 ) {
+      double distplane = _planePosition[ipl+1] - _planePosition[ipl];
+      step = 0.21*distplane; // in [mm]
+      auto point = gbl::GblPoint( Jac55new( step ) );
+      point.addScatterer( scat, _planeWscatAir[ipl] );
+      s += step;
+      traj_points.push_back(point);
+      fit.sPoint.push_back( s );
+      step = 0.58*distplane; // in [mm]
+      auto point1 = gbl::GblPoint( Jac55new( step ) );
+      point1.addScatterer( scat, _planeWscatAir[ipl] );
+      s += step;
+      traj_points.push_back(point1);
+      fit.sPoint.push_back( s );
+      step = 0.21*distplane; // remaing distance to next plane, in [mm]
+    }
+  } // loop over planes
+
+  double lostWeight;
+
+  fit.traj = std::make_unique<gbl::GblTrajectory>(traj_points, false); // curvature = false
+  fit.traj->fit( fit.chi2, fit.ndf, lostWeight );
+  fit.probchi = TMath::Prob( fit.chi2, fit.ndf );
+
+  // look at fit:
+  Eigen::VectorXd localPar;
+  Eigen::MatrixXd localCov;
+
+  unsigned int ndata = 2;
+  unsigned int ndim = 2;
+  Eigen::VectorXd aResiduals(ndim);
+  Eigen::VectorXd aMeasErrors(ndim);
+  Eigen::VectorXd aResErrors(ndim);
+  Eigen::VectorXd aDownWeights(ndim);
+
+  fit.localPar.resize(_nPlanes);
+  fit.measResults.resize(_nPlanes);
+  for(size_t ix = 0; ix < _nPlanes; ++ix) {
+    int ipos = fit.ilab[ix];
+    fit.traj->getResults( ipos, localPar, localCov );
+    //track = q/p, x', y', x, y
+    //        0,   1,  2,  3, 4
+    fit.localPar[ix] = {{ localPar[1], localPar[2], localPar[3], localPar[4] }};
+
+    if(fit.hasHit[ix]){
+      fit.traj->getMeasResults( ipos, ndata, aResiduals, aMeasErrors, aResErrors, aDownWeights );
+      fit.measResults[ix] = {{ aResiduals[0], aResiduals[1], aResErrors[0], aResErrors[1] }};
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 void EUTelAlignGBL::end() {
   milleAlignGBL.reset(nullptr);
+  // closing the files before pede might read them
+  _milleShards.clear();
+  _workerPool.reset(nullptr);
 
   // if write the pede steering file
   if( _generatePedeSteerfile ) {
@@ -737,7 +803,13 @@ void EUTelAlignGBL::end() {
       } // end loop over all planes
 
       steerFile << "Cfiles" << endl;
-      steerFile << _binaryFilename << endl;
+      if( _shardedMilleFiles ) {
+        for( unsigned int worker = 0; worker < static_cast<unsigned int>(_nThreads); ++worker ) {
+          steerFile << getMilleShardName(worker) << endl;
+        }
+      } else {
+        steerFile << _binaryFilename << endl;
+      }
       steerFile << endl;
 
       steerFile << "Parameter" << endl;
@@ -13,11 +13,11 @@
 #include "EUTELESCOPE.h"
 #include "EUTelBrickedClusterImpl.h"
 #include "EUTelDFFClusterImpl.h"
+#include "EUTelEtaAccumulator.h"
 #include "EUTelEtaFunctionImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTelExceptions.h"
 #include "EUTelFFClusterImpl.h"
-#include "EUTelPseudo1DHistogram.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelSparseClusterImpl.h"
 #include "EUTelVirtualCluster.h"
@@ -144,6 +144,21 @@ EUTelCalculateEtaProcessor::EUTelCalculateEtaProcessor()
                             "2=reject clusters with two pixels, where the "
                             "second pixel is not diagonal to the seed. ",
                             _rejectsingplepixelcluster, 0);
+
+  registerOptionalParameter("WriteEtaCounts",
+                            "Save also the CoG bin counts in the output file, "
+                            "to merge partial results with etamerge",
+                            _writeEtaCounts, false);
+
+  registerOptionalParameter("EtaCountsXCollectionName",
+                            "Set the name of the CoG bin counts collection "
+                            "along x",
+                            _etaCountsXCollectionName, string("xEtaCounts"));
+
+  registerOptionalParameter("EtaCountsYCollectionName",
+                            "Set the name of the CoG bin counts collection "
+                            "along y",
+                            _etaCountsYCollectionName, string("yEtaCounts"));
 }
 
 void EUTelCalculateEtaProcessor::init() {
@@ -155,11 +170,9 @@ void EUTelCalculateEtaProcessor::init() {
   _iRun = 0;
   _iEvt = 0;
 
-  // reset stl vectors
-  _cogHistogramX.clear();
-  _cogHistogramY.clear();
-  _integralHistoX.clear();
-  _integralHistoY.clear();
+  // reset the accumulators
+  _cogAccumulatorX.clear();
+  _cogAccumulatorY.clear();
 
   if (_rejectsingplepixelcluster != 0 && _rejectsingplepixelcluster != 1 &&
       _rejectsingplepixelcluster != 2) {
@@ -280,32 +293,30 @@ void EUTelCalculateEtaProcessor::processEvent(LCEvent *event) {
         ClusterType type = static_cast<ClusterType>(temp);
 
         // all clusters have to inherit from the virtual cluster (that is
-        // a TrackerDataImpl with some utility methods).
-        EUTelVirtualCluster *cluster;
+        // a TrackerDataImpl with some utility methods). The interfaces
+        // are only wrapping the TrackerData, so they live on the stack.
+        TrackerDataImpl *data =
+            static_cast<TrackerDataImpl *>(pulse->getTrackerData());
         if (type == kEUTelDFFClusterImpl) {
 
           // digital fixed cluster implementation. Remember it can come from
           // both RAW and ZS data
-          cluster = new EUTelDFFClusterImpl(
-              static_cast<TrackerDataImpl *>(pulse->getTrackerData()));
+          EUTelDFFClusterImpl cluster(data);
+          accumulateCluster(&cluster, type);
 
         } else if (type == kEUTelFFClusterImpl) {
 
           // fixed cluster implementation. Remember it can come from
           // both RAW and ZS data
-          cluster = new EUTelFFClusterImpl(
-              static_cast<TrackerDataImpl *>(pulse->getTrackerData()));
-          // streamlog_out ( MESSAGE2 ) <<  "seen a kEUTelFFClusterImpl" <<
-          // endl; //!HACK TAKI
+          EUTelFFClusterImpl cluster(data);
+          accumulateCluster(&cluster, type);
 
         } else if (type == kEUTelBrickedClusterImpl) {
 
           // bricked cluster implementation
           // Remember it can come from both RAW and ZS data
-          cluster = new EUTelBrickedClusterImpl(static_cast<TrackerDataImpl *>(
-              pulse->getTrackerData())); //! HACK TAKI
-          // streamlog_out ( MESSAGE2 ) <<  "seen a kEUTelBrickedClusterImpl" <<
-          // endl; //!HACK TAKI
+          EUTelBrickedClusterImpl cluster(data);
+          accumulateCluster(&cluster, type);
 
         } else if (type == kEUTelSparseClusterImpl) {
 
@@ -326,232 +337,19 @@ void EUTelCalculateEtaProcessor::processEvent(LCEvent *event) {
           // now we know the pixel type. So we can properly create a new
           // instance of the sparse cluster
           if (pixelType == kEUTelGenericSparsePixel) {
-            cluster = new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(
-                static_cast<TrackerDataImpl *>(pulse->getTrackerData()));
+            EUTelSparseClusterImpl<EUTelGenericSparsePixel> cluster(data);
+            accumulateCluster(&cluster, type);
           } else {
             streamlog_out(ERROR4) << "Unknown pixel type.  Sorry for quitting."
                                   << endl;
             throw UnknownDataTypeException("Pixel type unknown");
           }
-          // streamlog_out ( MESSAGE2 ) <<  "seen a kEUTelSparseClusterImpl" <<
-          // endl; //!HACK TAKI
 
         } else {
           streamlog_out(ERROR4) << "Unknown cluster type. Sorry for quitting"
                                 << endl;
           throw UnknownDataTypeException("Cluster type unknown");
         }
-
-        int detectorID = cluster->getDetectorID();
-        float xShift, yShift;
-
-        if (cluster->getClusterQuality() ==
-            static_cast<ClusterQuality>(_clusterQuality)) {
-
-          EUTelBrickedClusterImpl *p_tmpBrickedCluster = nullptr;
-          if (type == kEUTelBrickedClusterImpl) {
-            p_tmpBrickedCluster =
-                dynamic_cast<EUTelBrickedClusterImpl *>(cluster);
-            // Static of cluster to EUTelBrickedClusterImpl* was done for sure
-            // in the case of
-            //( type == kEUTelBrickedClusterImpl ).
-            // So this cast must work as well!
-            // This is just a (different) pointer to the same memory as
-            // "cluster". So no additional delete needed.
-          }
-
-          if (_clusterTypeSelection == "FULL") {
-
-            if (p_tmpBrickedCluster) {
-              // streamlog_out ( MESSAGE2 ) <<  "DEBUG: doing eta FULL on a
-              // bricked cluster!" << endl;
-              p_tmpBrickedCluster
-                  ->getCenterOfGravityShiftWithOutGlobalSeedCoordinateCorrection(
-                      xShift, yShift);
-            } else {
-              cluster->getCenterOfGravityShift(xShift, yShift);
-            }
-
-          } else if (_clusterTypeSelection == "NxMPixel") {
-
-            if (p_tmpBrickedCluster) {
-              streamlog_out(WARNING4)
-                  << "NxM not applicable for a bricked cluster!! Doing FULL!"
-                  << endl;
-              p_tmpBrickedCluster
-                  ->getCenterOfGravityShiftWithOutGlobalSeedCoordinateCorrection(
-                      xShift, yShift);
-            } else {
-              cluster->getCenterOfGravityShift(xShift, yShift, _xyCluSize[0],
-                                               _xyCluSize[1]);
-            }
-
-          } else if (_clusterTypeSelection == "NPixel") {
-
-            if (p_tmpBrickedCluster) {
-              // streamlog_out ( MESSAGE2 ) <<  "DEBUG: doing eta NPixel on a
-              // bricked cluster!" << endl;
-              p_tmpBrickedCluster
-                  ->getCenterOfGravityShiftWithOutGlobalSeedCoordinateCorrection(
-                      xShift, yShift, _nPixel);
-            } else {
-              cluster->getCenterOfGravityShift(xShift, yShift, _nPixel);
-            }
-          }
-
-//#define TAKI_DEBUG_ETA 1
-#ifdef TAKI_DEBUG_ETA
-          if (p_tmpBrickedCluster) {
-            streamlog_out(MESSAGE2) << endl;
-            streamlog_out(MESSAGE2) << "Just done ETA on a BrickedCluster!"
-                                    << endl;
-            p_tmpBrickedCluster->debugOutput();
-          }
-#endif // TAKI_DEBUG_ETA
-
-          // look for the proper pseudo histogram before filling
-          // it. In case the corresponding pseudo histogram is not yet
-          // available, book it on the fly!
-          if (_cogHistogramX.find(detectorID) == _cogHistogramX.end()) {
-            _cogHistogramX[detectorID] =
-                new EUTelPseudo1DHistogram(_noOfBin[0], _min, _max);
-            _integralHistoX[detectorID] =
-                new EUTelPseudo1DHistogram(_noOfBin[0], _min, _max);
-          }
-          if (_cogHistogramY.find(detectorID) == _cogHistogramY.end()) {
-            _cogHistogramY[detectorID] =
-                new EUTelPseudo1DHistogram(_noOfBin[1], _min, _max);
-            _integralHistoY[detectorID] =
-                new EUTelPseudo1DHistogram(_noOfBin[0], _min, _max);
-          }
-          // is this a single pixel cluster?
-
-          bool spc_cut = false;
-          if (_rejectsingplepixelcluster == 2) {
-            spc_cut = type != kEUTelDFFClusterImpl &&
-                      (abs(static_cast<double>(xShift)) <
-                           numeric_limits<double>::min() ||
-                       abs(static_cast<double>(yShift)) <
-                           numeric_limits<double>::min());
-          } else if (_rejectsingplepixelcluster == 1) {
-            spc_cut = type != kEUTelDFFClusterImpl &&
-                      abs(static_cast<double>(xShift)) <
-                          numeric_limits<double>::min() &&
-                      abs(static_cast<double>(yShift)) <
-                          numeric_limits<double>::min();
-          }
-
-          if (!spc_cut) {
-            _cogHistogramX[detectorID]->fill(static_cast<double>(xShift), 1.0);
-            _cogHistogramY[detectorID]->fill(static_cast<double>(yShift), 1.0);
-          }
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-          {
-
-            if (_alreadyBookedSensorID.find(detectorID) ==
-                _alreadyBookedSensorID.end()) {
-              // need booking!
-
-              // the path first!
-              string path = "detector_" + to_string(detectorID);
-              AIDAProcessor::tree(this)->mkdir(path.c_str());
-              path.append("/");
-
-              // Center of gravity along X
-              string name = _cogHistogramXName + "_" + to_string(detectorID);
-              string title =
-                  "CoG shift along X on detector " + to_string(detectorID);
-              AIDA::IHistogram1D *cogHistoX =
-                  AIDAProcessor::histogramFactory(this)->createHistogram1D(
-                      (path + name).c_str(), _noOfBin[0], _min, _max);
-              cogHistoX->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, cogHistoX));
-
-              // Center of gravity along y
-              name = _cogHistogramYName + "_" + to_string(detectorID);
-              title = "CoG shift along Y on detector " + to_string(detectorID);
-              AIDA::IHistogram1D *cogHistoY =
-                  AIDAProcessor::histogramFactory(this)->createHistogram1D(
-                      (path + name).c_str(), _noOfBin[1], _min, _max);
-              cogHistoY->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, cogHistoY));
-
-              // Integral along x
-              name = _cogIntegralXName + "_" + to_string(detectorID);
-              title = "Integral CoG (x) shift histogram on " +
-                      to_string(detectorID);
-              AIDA::IHistogram1D *cogIntegralHistoX =
-                  AIDAProcessor::histogramFactory(this)->createHistogram1D(
-                      (path + name).c_str(), _noOfBin[0], _min, _max);
-              cogIntegralHistoX->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, cogIntegralHistoX));
-
-              // Integral along y
-              name = _cogIntegralYName + "_" + to_string(detectorID);
-              title = "Integral CoG (y) shift histogram on " +
-                      to_string(detectorID);
-              AIDA::IHistogram1D *cogIntegralHistoY =
-                  AIDAProcessor::histogramFactory(this)->createHistogram1D(
-                      (path + name).c_str(), _noOfBin[1], _min, _max);
-              cogIntegralHistoY->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, cogIntegralHistoY));
-
-              // Eta histogram along x
-              name = _etaHistoXName + "_" + to_string(detectorID);
-              title = "Eta profile x for detector " + to_string(detectorID);
-              AIDA::IProfile1D *etaHistoX =
-                  AIDAProcessor::histogramFactory(this)->createProfile1D(
-                      (path + name).c_str(), _noOfBin[0], _min, _max, _min,
-                      _max);
-              etaHistoX->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, etaHistoX));
-
-              // Eta histogram along y
-              name = _etaHistoYName + "_" + to_string(detectorID);
-              title = "Eta profile y for detector " + to_string(detectorID);
-              AIDA::IProfile1D *etaHistoY =
-                  AIDAProcessor::histogramFactory(this)->createProfile1D(
-                      (path + name).c_str(), _noOfBin[1], _min, _max, _min,
-                      _max);
-              etaHistoY->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, etaHistoY));
-
-              // 2D histo with CoG
-              name = _cogHisto2DName + "_" + to_string(detectorID);
-              title =
-                  "2D Histo with the CoG within the seed pixel for detector " +
-                  to_string(detectorID);
-              AIDA::IHistogram2D *cogHisto2D =
-                  AIDAProcessor::histogramFactory(this)->createHistogram2D(
-                      (path + name).c_str(), _noOfBin[0], _min, _max,
-                      _noOfBin[1], _min, _max);
-              cogHisto2D->setTitle(title.c_str());
-              _aidaHistoMap.insert(make_pair(name, cogHisto2D));
-
-              _alreadyBookedSensorID.insert(detectorID);
-            }
-
-            if (!spc_cut) {
-              string name = _cogHistogramXName + "_" + to_string(detectorID);
-              (dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[name]))
-                  ->fill(xShift);
-
-              name = _cogHistogramYName + "_" + to_string(detectorID);
-              (dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[name]))
-                  ->fill(yShift);
-
-              name = _cogHisto2DName + "_" + to_string(detectorID);
-              (dynamic_cast<AIDA::IHistogram2D *>(_aidaHistoMap[name]))
-                  ->fill(xShift, yShift);
-            }
-          }
-#endif
-        } else {
-          // streamlog_out ( MESSAGE2 ) <<  "CLUSTER QUALITY NOT GOOD ENOUGH!!!"
-          // << endl;
-        }
-
-        delete cluster;
       }
 
     } catch (lcio::DataNotAvailableException &e) {
@@ -573,6 +371,222 @@ void EUTelCalculateEtaProcessor::processEvent(LCEvent *event) {
   setReturnValue("isEtaCalculationFinished", _isEtaCalculationFinished);
 }
 
+void EUTelCalculateEtaProcessor::accumulateCluster(EUTelVirtualCluster *cluster,
+                                                   ClusterType type) {
+
+  int detectorID = cluster->getDetectorID();
+  float xShift, yShift;
+
+  if (cluster->getClusterQuality() ==
+      static_cast<ClusterQuality>(_clusterQuality)) {
+
+    EUTelBrickedClusterImpl *p_tmpBrickedCluster = nullptr;
+    if (type == kEUTelBrickedClusterImpl) {
+      p_tmpBrickedCluster =
+          dynamic_cast<EUTelBrickedClusterImpl *>(cluster);
+      // Static of cluster to EUTelBrickedClusterImpl* was done for sure
+      // in the case of
+      //( type == kEUTelBrickedClusterImpl ).
+      // So this cast must work as well!
+      // This is just a (different) pointer to the same memory as
+      // "cluster". So no additional delete needed.
+    }
+
+    if (_clusterTypeSelection == "FULL") {
+
+      if (p_tmpBrickedCluster) {
+        // streamlog_out ( MESSAGE2 ) <<  "DEBUG: doing eta FULL on a
+        // bricked cluster!" << endl;
+        p_tmpBrickedCluster
+            ->getCenterOfGravityShiftWithOutGlobalSeedCoordinateCorrection(
+                xShift, yShift);
+      } else {
+        cluster->getCenterOfGravityShift(xShift, yShift);
+      }
+
+    } else if (_clusterTypeSelection == "NxMPixel") {
+
+      if (p_tmpBrickedCluster) {
+        streamlog_out(WARNING4)
+            << "NxM not applicable for a bricked cluster!! Doing FULL!"
+            << endl;
+        p_tmpBrickedCluster
+            ->getCenterOfGravityShiftWithOutGlobalSeedCoordinateCorrection(
+                xShift, yShift);
+      } else {
+        cluster->getCenterOfGravityShift(xShift, yShift, _xyCluSize[0],
+                                         _xyCluSize[1]);
+      }
+
+    } else if (_clusterTypeSelection == "NPixel") {
+
+      if (p_tmpBrickedCluster) {
+        // streamlog_out ( MESSAGE2 ) <<  "DEBUG: doing eta NPixel on a
+        // bricked cluster!" << endl;
+        p_tmpBrickedCluster
+            ->getCenterOfGravityShiftWithOutGlobalSeedCoordinateCorrection(
+                xShift, yShift, _nPixel);
+      } else {
+        cluster->getCenterOfGravityShift(xShift, yShift, _nPixel);
+      }
+    }
+
+//#define TAKI_DEBUG_ETA 1
+#ifdef TAKI_DEBUG_ETA
+    if (p_tmpBrickedCluster) {
+      streamlog_out(MESSAGE2) << endl;
+      streamlog_out(MESSAGE2) << "Just done ETA on a BrickedCluster!"
+                              << endl;
+      p_tmpBrickedCluster->debugOutput();
+    }
+#endif // TAKI_DEBUG_ETA
+
+    // look for the proper accumulators before filling them. In case
+    // they are not yet available, book them on the fly!
+    auto accumulatorX = _cogAccumulatorX.find(detectorID);
+    if (accumulatorX == _cogAccumulatorX.end()) {
+      accumulatorX =
+          _cogAccumulatorX
+              .emplace(detectorID, EUTelEtaAccumulator(detectorID, _noOfBin[0],
+                                                       _min, _max))
+              .first;
+    }
+    auto accumulatorY = _cogAccumulatorY.find(detectorID);
+    if (accumulatorY == _cogAccumulatorY.end()) {
+      accumulatorY =
+          _cogAccumulatorY
+              .emplace(detectorID, EUTelEtaAccumulator(detectorID, _noOfBin[1],
+                                                       _min, _max))
+              .first;
+    }
+    // is this a single pixel cluster?
+
+    bool spc_cut = false;
+    if (_rejectsingplepixelcluster == 2) {
+      spc_cut = type != kEUTelDFFClusterImpl &&
+                (abs(static_cast<double>(xShift)) <
+                     numeric_limits<double>::min() ||
+                 abs(static_cast<double>(yShift)) <
+                     numeric_limits<double>::min());
+    } else if (_rejectsingplepixelcluster == 1) {
+      spc_cut = type != kEUTelDFFClusterImpl &&
+                abs(static_cast<double>(xShift)) <
+                    numeric_limits<double>::min() &&
+                abs(static_cast<double>(yShift)) <
+                    numeric_limits<double>::min();
+    }
+
+    if (!spc_cut) {
+      accumulatorX->second.fill(static_cast<double>(xShift));
+      accumulatorY->second.fill(static_cast<double>(yShift));
+    }
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    {
+
+      if (_alreadyBookedSensorID.find(detectorID) ==
+          _alreadyBookedSensorID.end()) {
+        // need booking!
+
+        // the path first!
+        string path = "detector_" + to_string(detectorID);
+        AIDAProcessor::tree(this)->mkdir(path.c_str());
+        path.append("/");
+
+        // Center of gravity along X
+        string name = _cogHistogramXName + "_" + to_string(detectorID);
+        string title =
+            "CoG shift along X on detector " + to_string(detectorID);
+        AIDA::IHistogram1D *cogHistoX =
+            AIDAProcessor::histogramFactory(this)->createHistogram1D(
+                (path + name).c_str(), _noOfBin[0], _min, _max);
+        cogHistoX->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, cogHistoX));
+
+        // Center of gravity along y
+        name = _cogHistogramYName + "_" + to_string(detectorID);
+        title = "CoG shift along Y on detector " + to_string(detectorID);
+        AIDA::IHistogram1D *cogHistoY =
+            AIDAProcessor::histogramFactory(this)->createHistogram1D(
+                (path + name).c_str(), _noOfBin[1], _min, _max);
+        cogHistoY->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, cogHistoY));
+
+        // Integral along x
+        name = _cogIntegralXName + "_" + to_string(detectorID);
+        title = "Integral CoG (x) shift histogram on " +
+                to_string(detectorID);
+        AIDA::IHistogram1D *cogIntegralHistoX =
+            AIDAProcessor::histogramFactory(this)->createHistogram1D(
+                (path + name).c_str(), _noOfBin[0], _min, _max);
+        cogIntegralHistoX->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, cogIntegralHistoX));
+
+        // Integral along y
+        name = _cogIntegralYName + "_" + to_string(detectorID);
+        title = "Integral CoG (y) shift histogram on " +
+                to_string(detectorID);
+        AIDA::IHistogram1D *cogIntegralHistoY =
+            AIDAProcessor::histogramFactory(this)->createHistogram1D(
+                (path + name).c_str(), _noOfBin[1], _min, _max);
+        cogIntegralHistoY->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, cogIntegralHistoY));
+
+        // Eta histogram along x
+        name = _etaHistoXName + "_" + to_string(detectorID);
+        title = "Eta profile x for detector " + to_string(detectorID);
+        AIDA::IProfile1D *etaHistoX =
+            AIDAProcessor::histogramFactory(this)->createProfile1D(
+                (path + name).c_str(), _noOfBin[0], _min, _max, _min,
+                _max);
+        etaHistoX->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, etaHistoX));
+
+        // Eta histogram along y
+        name = _etaHistoYName + "_" + to_string(detectorID);
+        title = "Eta profile y for detector " + to_string(detectorID);
+        AIDA::IProfile1D *etaHistoY =
+            AIDAProcessor::histogramFactory(this)->createProfile1D(
+                (path + name).c_str(), _noOfBin[1], _min, _max, _min,
+                _max);
+        etaHistoY->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, etaHistoY));
+
+        // 2D histo with CoG
+        name = _cogHisto2DName + "_" + to_string(detectorID);
+        title =
+            "2D Histo with the CoG within the seed pixel for detector " +
+            to_string(detectorID);
+        AIDA::IHistogram2D *cogHisto2D =
+            AIDAProcessor::histogramFactory(this)->createHistogram2D(
+                (path + name).c_str(), _noOfBin[0], _min, _max,
+                _noOfBin[1], _min, _max);
+        cogHisto2D->setTitle(title.c_str());
+        _aidaHistoMap.insert(make_pair(name, cogHisto2D));
+
+        _alreadyBookedSensorID.insert(detectorID);
+      }
+
+      if (!spc_cut) {
+        string name = _cogHistogramXName + "_" + to_string(detectorID);
+        (dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[name]))
+            ->fill(xShift);
+
+        name = _cogHistogramYName + "_" + to_string(detectorID);
+        (dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[name]))
+            ->fill(yShift);
+
+        name = _cogHisto2DName + "_" + to_string(detectorID);
+        (dynamic_cast<AIDA::IHistogram2D *>(_aidaHistoMap[name]))
+            ->fill(xShift, yShift);
+      }
+    }
+#endif
+  } else {
+    // streamlog_out ( MESSAGE2 ) <<  "CLUSTER QUALITY NOT GOOD ENOUGH!!!"
+    // << endl;
+  }
+}
+
 void EUTelCalculateEtaProcessor::check(LCEvent * /* evt */) {
   // nothing to check here - could be used to fill check plots in reconstruction
   // processor
@@ -583,8 +597,6 @@ void EUTelCalculateEtaProcessor::finalizeProcessor() {
   if (_isEtaCalculationFinished)
     return;
 
-  double integral = 0;
-
   streamlog_out(MESSAGE4) << "Writing the output eta file "
                           << _outputEtaFileName << endl;
 
@@ -608,63 +620,29 @@ void EUTelCalculateEtaProcessor::finalizeProcessor() {
   LCCollectionVec *etaXCollection = new LCCollectionVec(LCIO::LCGENERICOBJECT);
   LCCollectionVec *etaYCollection = new LCCollectionVec(LCIO::LCGENERICOBJECT);
 
-  map<int, EUTelPseudo1DHistogram *>::iterator iter = _cogHistogramX.begin();
-  while (iter != _cogHistogramX.end()) {
-
-    int iDetector = iter->first;
-
-    for (int iBin = 1; iBin <= _cogHistogramX[iDetector]->getNumberOfBins();
-         iBin++) {
-      double x = _cogHistogramX[iDetector]->getBinCenter(iBin);
-      integral = _cogHistogramX[iDetector]->integral(1, iBin);
-      _integralHistoX[iDetector]->fill(x, integral);
-    }
-
-    vector<double> etaBinCenter;
-    vector<double> etaBinValue;
-
-    for (int iBin = 1; iBin <= _integralHistoX[iDetector]->getNumberOfBins();
-         iBin++) {
-      etaBinCenter.push_back(_integralHistoX[iDetector]->getBinCenter(iBin));
-      etaBinValue.push_back(_integralHistoX[iDetector]->getBinContent(iBin) /
-                                integral -
-                            0.5); // - 0.5);
-    }
+  LCCollectionVec *countsXCollection = nullptr;
+  LCCollectionVec *countsYCollection = nullptr;
+  if (_writeEtaCounts) {
+    countsXCollection = new LCCollectionVec(LCIO::LCGENERICOBJECT);
+    countsYCollection = new LCCollectionVec(LCIO::LCGENERICOBJECT);
+  }
 
-    EUTelEtaFunctionImpl *etaX = new EUTelEtaFunctionImpl(
-        etaBinCenter.size(), etaBinCenter, etaBinValue);
-#if ETA_VERSION >= 2
-    etaX->setSensorID(iDetector);
-#endif
-    etaXCollection->push_back(etaX);
+  map<int, EUTelEtaAccumulator>::iterator iter = _cogAccumulatorX.begin();
+  while (iter != _cogAccumulatorX.end()) {
 
-    etaBinCenter.clear();
-    etaBinValue.clear();
+    int iDetector = iter->first;
+    const EUTelEtaAccumulator &accumulatorY = _cogAccumulatorY.at(iDetector);
 
-    for (int iBin = 1; iBin <= _cogHistogramY[iDetector]->getNumberOfBins();
-         iBin++) {
-      double y = _cogHistogramY[iDetector]->getBinCenter(iBin);
-      integral = _cogHistogramY[iDetector]->integral(1, iBin);
-      _integralHistoY[iDetector]->fill(y, integral);
-    }
+    etaXCollection->push_back(iter->second.makeEtaFunction());
+    etaYCollection->push_back(accumulatorY.makeEtaFunction());
 
-    for (int iBin = 1; iBin <= _integralHistoY[iDetector]->getNumberOfBins();
-         iBin++) {
-      etaBinCenter.push_back(_integralHistoY[iDetector]->getBinCenter(iBin));
-      etaBinValue.push_back(_integralHistoY[iDetector]->getBinContent(iBin) /
-                                integral -
-                            0.5); // 0.5);
+    if (_writeEtaCounts) {
+      countsXCollection->push_back(iter->second.makeGenericObject());
+      countsYCollection->push_back(accumulatorY.makeGenericObject());
     }
 
-    EUTelEtaFunctionImpl *etaY = new EUTelEtaFunctionImpl(
-        etaBinCenter.size(), etaBinCenter, etaBinValue);
-#if ETA_VERSION >= 2
-    etaY->setSensorID(iDetector);
-#endif
-    etaYCollection->push_back(etaY);
-
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-    integral = 0;
+    double integral = 0;
     string name = _cogIntegralXName + "_" + to_string(iDetector);
     AIDA::IHistogram1D *integralHisto =
         dynamic_cast<AIDA::IHistogram1D *>(_aidaHistoMap[name]);
@@ -724,6 +702,10 @@ void EUTelCalculateEtaProcessor::finalizeProcessor() {
 
   event->addCollection(etaXCollection, _etaXCollectionName);
   event->addCollection(etaYCollection, _etaYCollectionName);
+  if (_writeEtaCounts) {
+    event->addCollection(countsXCollection, _etaCountsXCollectionName);
+    event->addCollection(countsYCollection, _etaCountsYCollectionName);
+  }
 
   lcWriter->writeEvent(event);
   delete event;
@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelCalibrateEventProcessor.h"
 #include "EUTELESCOPE.h"
+#include "EUTelConditionsCache.h"
 #include "EUTelEventImpl.h"
 #include "EUTelExceptions.h"
 #include "EUTelHistogramManager.h"
@@ -155,8 +156,8 @@ void EUTelCalibrateEventProcessor::processRunHeader(LCRunHeader *rdr) {
 
 void EUTelCalibrateEventProcessor::initializeGeometry(LCEvent *event) {
 
-  // now I need the _ancillaryIndexMap. For this I need to take the
-  // pedestal input collection
+  // the size of each sensor is taken from the pedestal input
+  // collection
   try {
     LCCollectionVec *pedestalCol = dynamic_cast<LCCollectionVec *>(
         event->getCollection(_pedestalCollectionName));
@@ -167,8 +168,6 @@ void EUTelCalibrateEventProcessor::initializeGeometry(LCEvent *event) {
 
       int sensorID = pedestalDecoder(pedestal)["sensorID"];
 
-      _ancillaryIndexMap.insert(make_pair(sensorID, iDetector));
-
       unsigned int noOfPixel = (pedestalDecoder(pedestal)["xMax"] -
                                 pedestalDecoder(pedestal)["xMin"] + 1) *
                                (pedestalDecoder(pedestal)["yMax"] -
@@ -226,6 +225,15 @@ void EUTelCalibrateEventProcessor::processEvent(LCEvent *event) {
         evt->getCollection(_statusCollectionName));
     CellIDDecoder<TrackerRawDataImpl> cellDecoder(inputCollectionVec);
 
+    // the position of each sensor in the ancillary collections, they
+    // do not have to follow the order of the input collection
+    EUTelConditionsCache &conditions = EUTelConditionsCache::getInstance();
+    auto pedestalIndices =
+        conditions.getSensorIndices(evt, _pedestalCollectionName);
+    auto noiseIndices = conditions.getSensorIndices(evt, _noiseCollectionName);
+    auto statusIndices =
+        conditions.getSensorIndices(evt, _statusCollectionName);
+
     // reset the number of consecutive missing
     _noOfConsecutiveMissing = 0;
 
@@ -241,11 +249,10 @@ void EUTelCalibrateEventProcessor::processEvent(LCEvent *event) {
             inputCollectionVec->getElementAt(iDetector));
         int sensorID = cellDecoder(rawData)["sensorID"];
 
-        // To get the proper pedestal collection I need to go through
-        // the _ancillaryIndexMap. This takes the sensorID as input and
-        // gets the position in the collection as output
         TrackerDataImpl *pedestal = dynamic_cast<TrackerDataImpl *>(
-            pedestalCollectionVec->getElementAt(_ancillaryIndexMap[sensorID]));
+            pedestalCollectionVec->getElementAt(
+                EUTelConditionsCache::getSensorIndex(
+                    *pedestalIndices, sensorID, _pedestalCollectionName)));
 
         if (rawData->getADCValues().size() !=
             pedestal->getChargeValues().size()) {
@@ -524,14 +531,18 @@ void EUTelCalibrateEventProcessor::processEvent(LCEvent *event) {
           inputCollectionVec->getElementAt(iDetector));
       int sensorID = cellDecoder(rawData)["sensorID"];
 
-      // this is the corresponding element in the ancillary collections
-      size_t ancillaryPos = _ancillaryIndexMap[sensorID];
+      // these are the corresponding elements in the ancillary collections
       TrackerDataImpl *pedestal = dynamic_cast<TrackerDataImpl *>(
-          pedestalCollectionVec->getElementAt(ancillaryPos));
+          pedestalCollectionVec->getElementAt(
+              EUTelConditionsCache::getSensorIndex(
+                  *pedestalIndices, sensorID, _pedestalCollectionName)));
       TrackerDataImpl *noise = dynamic_cast<TrackerDataImpl *>(
-          noiseCollectionVec->getElementAt(ancillaryPos));
+          noiseCollectionVec->getElementAt(EUTelConditionsCache::getSensorIndex(
+              *noiseIndices, sensorID, _noiseCollectionName)));
       TrackerRawDataImpl *status = dynamic_cast<TrackerRawDataImpl *>(
-          statusCollectionVec->getElementAt(ancillaryPos));
+          statusCollectionVec->getElementAt(
+              EUTelConditionsCache::getSensorIndex(
+                  *statusIndices, sensorID, _statusCollectionName)));
 
       TrackerDataImpl *corrected = new TrackerDataImpl;
       CellIDEncoder<TrackerDataImpl> idDataEncoder(
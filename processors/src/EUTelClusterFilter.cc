@@ -274,8 +274,25 @@ EUTelClusterFilter::EUTelClusterFilter() : Processor("EUTelClusterFilter") {
       "there are no cluster left.",
       _skipEmptyEvent, false);
 
+  registerOptionalParameter(
+      "CutOrder",
+      "The order in which the cluster selection criteria are evaluated, "
+      "using the names of the rejection summary (e.g. MinTotalChargeCut "
+      "InsideROICut).\n"
+      "Criteria not listed are evaluated afterwards, the cheapest first.",
+      _cutOrder, vector<string>());
+
+  registerOptionalParameter(
+      "IndependentCutCounters",
+      "Diagnostic mode: test every cluster against every criterion, so that "
+      "each rejection counter is independent of the others instead of a "
+      "cut flow. Slower, as clusters are not rejected early.",
+      _independentCutCounters, false);
+
   // set the global noise switch to on
   _noiseRelatedCuts = true;
+  _pipelineNeedsNoise = true;
+  _pipelineFeatures = 0;
 
   registerProcessorParameter(
       "DFFNumberOfHits", "This is a cut on the number of hit pixels inside the "
@@ -728,7 +745,7 @@ void EUTelClusterFilter::checkCriteria() {
           << "The number of planes is " << _noOfDetectors
           << " while the thresholds are " << _maxClusterNoiseVec.size() << "\n"
           << "Disabling the selection criterion and continue without" << endl;
-      _maxClusterNoSwitch = false;
+      _maxClusterNoiseSwitch = false;
     } else {
       streamlog_out(DEBUG1)
           << "Maximum cluster noise criterion verified and switched on" << endl;
@@ -774,6 +791,30 @@ void EUTelClusterFilter::checkCriteria() {
     vector<unsigned int> rejectedCounter(_noOfDetectors, 0);
     _rejectionMap.insert(make_pair("SameNumberOfHitCut", rejectedCounter));
   }
+
+  // sort the ROIs by sensor, so that a cluster is only tested against
+  // the ROIs of its own sensor
+  _insideROIByPos.assign(_noOfDetectors, vector<EUTelROI>());
+  for (auto &roi : _insideROIVec) {
+    auto posIter = _ancillaryIndexMap.find(roi.getDetectorID());
+    if (posIter != _ancillaryIndexMap.end())
+      _insideROIByPos[posIter->second].push_back(roi);
+  }
+  _outsideROIByPos.assign(_noOfDetectors, vector<EUTelROI>());
+  for (auto &roi : _outsideROIVec) {
+    auto posIter = _ancillaryIndexMap.find(roi.getDetectorID());
+    if (posIter != _ancillaryIndexMap.end())
+      _outsideROIByPos[posIter->second].push_back(roi);
+  }
+
+  compilePipeline();
+}
+
+void EUTelClusterFilter::clearBatch() {
+  _batch.clusters.clear();
+  _batch.detectorPos.clear();
+  _batch.isDFF.clear();
+  _batch.pulseIndex.clear();
 }
 
 void EUTelClusterFilter::processRunHeader(LCRunHeader *rdr) {
@@ -822,6 +863,7 @@ void EUTelClusterFilter::processEvent(LCEvent *event) {
 
     vector<int> acceptedClusterVec;
     vector<int> clusterNoVec(_noOfDetectors, 0);
+    clearBatch();
 
     // CLUSTER BASED CUTS
     for (int iPulse = 0; iPulse < pulseCollectionVec->getNumberOfElements();
@@ -843,7 +885,7 @@ void EUTelClusterFilter::processEvent(LCEvent *event) {
         cluster = new EUTelBrickedClusterImpl(
             static_cast<TrackerDataImpl *>(pulse->getTrackerData()));
 
-        if (_noiseRelatedCuts) {
+        if (_noiseRelatedCuts && _pipelineNeedsNoise) {
           // the EUTelBrickedClusterImpl doesn't contain the noise and status
           // information in the TrackerData object. So this is the right
           // place to attach to the cluster the noise information.
@@ -932,7 +974,7 @@ void EUTelClusterFilter::processEvent(LCEvent *event) {
         cluster = new EUTelFFClusterImpl(
             static_cast<TrackerDataImpl *>(pulse->getTrackerData()));
 
-        if (_noiseRelatedCuts) {
+        if (_noiseRelatedCuts && _pipelineNeedsNoise) {
           // the EUTelFFClusterImpl doesn't contain the noise and status
           // information in the TrackerData object. So this is the right
           // place to attach to the cluster the noise information.
@@ -1027,7 +1069,7 @@ void EUTelClusterFilter::processEvent(LCEvent *event) {
               dynamic_cast<EUTelSparseClusterImpl<EUTelGenericSparsePixel> *>(
                   cluster);
 
-          if (_noiseRelatedCuts) {
+          if (_noiseRelatedCuts && _pipelineNeedsNoise) {
             // the EUTelSparseClusterImpl<EUTelGenericSparsePixel>
             // doesn't contain any intrinsic noise information. So we
             // need to get them from the input noise collection.
@@ -1072,33 +1114,19 @@ void EUTelClusterFilter::processEvent(LCEvent *event) {
       }
 
       // increment the event counter
-      _totalClusterCounter[_ancillaryIndexMap[cluster->getDetectorID()]]++;
-
-      bool isAccepted = true;
-
-      if (type == kEUTelDFFClusterImpl) {
-        isAccepted &= isAboveNumberOfHitPixel(cluster);
-      } else {
-        isAccepted &= isAboveMinTotalCharge(cluster);
-        isAccepted &= isAboveMinTotalSNR(cluster);
-        isAccepted &= isAboveNMinCharge(cluster);
-        isAccepted &= isAboveNMinSNR(cluster);
-        isAccepted &= isAboveNxNMinCharge(cluster);
-        isAccepted &= isAboveNxNMinSNR(cluster);
-        isAccepted &= isAboveMinSeedCharge(cluster);
-        isAccepted &= isAboveMinSeedSNR(cluster);
-        isAccepted &= isBelowMaxClusterNoise(cluster);
-      }
-      isAccepted &= hasQuality(cluster);
-      isAccepted &= isInsideROI(cluster);
-      isAccepted &= isOutsideROI(cluster);
-
-      if (isAccepted)
-        acceptedClusterVec.push_back(iPulse);
-
-      delete cluster;
+      int detectorPos = _ancillaryIndexMap[cluster->getDetectorID()];
+      _totalClusterCounter[detectorPos]++;
+
+      // the selection is done on the whole batch below
+      _batch.clusters.emplace_back(cluster);
+      _batch.detectorPos.push_back(detectorPos);
+      _batch.isDFF.push_back(type == kEUTelDFFClusterImpl);
+      _batch.pulseIndex.push_back(iPulse);
     }
 
+    runPipeline(acceptedClusterVec);
+    clearBatch();
+
     vector<int>::iterator cluIter = acceptedClusterVec.begin();
     while (cluIter != acceptedClusterVec.end()) {
       TrackerPulseImpl *pulse = dynamic_cast<TrackerPulseImpl *>(
@@ -1253,344 +1281,413 @@ bool EUTelClusterFilter::hasSameNumberOfHit(
   return hasSameNumber;
 }
 
-bool EUTelClusterFilter::isAboveNumberOfHitPixel(
-    EUTelVirtualCluster *cluster) const {
-  if (!_dffnhitsswitch) {
-    return true;
-  }
-  streamlog_out(DEBUG1)
-      << "Filtering against number of hit pixel inside a cluster " << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-
-  if (static_cast<int>(cluster->getTotalCharge()) >= _DFFNHitsCuts[detectorPos])
+bool EUTelClusterFilter::isAboveNumberOfHitPixel(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  const int nHits = static_cast<int>(_batch.totalCharge[iCluster]);
+  if (nHits >= _DFFNHitsCuts[detectorPos])
     return true;
   else {
     streamlog_out(DEBUG2)
-        << "Rejected cluster because the number of hit pixel is "
-        << static_cast<int>(cluster->getTotalCharge())
+        << "Rejected cluster because the number of hit pixel is " << nHits
         << " and the threshold is " << _DFFNHitsCuts[detectorPos] << endl;
-    _rejectionMap["MinHitPixel"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveMinTotalCharge(
-    EUTelVirtualCluster *cluster) const {
-
-  if (!_minTotalChargeSwitch) {
-    return true;
-  }
-  streamlog_out(DEBUG1) << "Filtering against the total charge " << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-
-  if (cluster->getTotalCharge() > _minTotalChargeVec[detectorPos])
+bool EUTelClusterFilter::isAboveMinTotalCharge(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  if (_batch.totalCharge[iCluster] > _minTotalChargeVec[detectorPos])
     return true;
   else {
     streamlog_out(DEBUG2) << "Rejected cluster because its charge is "
-                          << cluster->getTotalCharge()
+                          << _batch.totalCharge[iCluster]
                           << " and the threshold is "
                           << _minTotalChargeVec[detectorPos] << endl;
-    _rejectionMap["MinTotalChargeCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveMinTotalSNR(
-    EUTelVirtualCluster *cluster) const {
-
-  if (!_noiseRelatedCuts)
-    return true;
-  if (!_minTotalSNRSwitch)
-    return true;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-
-  streamlog_out(DEBUG1) << "Filtering against the minimum total SNR " << endl;
-  if (cluster->getClusterSNR() > _minTotalSNRVec[detectorPos])
+bool EUTelClusterFilter::isAboveMinTotalSNR(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  if (_batch.totalSNR[iCluster] > _minTotalSNRVec[detectorPos])
     return true;
   else {
     streamlog_out(DEBUG2) << "Rejected cluster because its SNR is "
-                          << cluster->getClusterSNR()
+                          << _batch.totalSNR[iCluster]
                           << " and the threshold is "
                           << _minTotalSNRVec[detectorPos] << endl;
-    _rejectionMap["MinTotalSNRCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveNMinCharge(EUTelVirtualCluster *cluster) const {
-
-  if (!_minNChargeSwitch)
-    return true;
-
-  streamlog_out(DEBUG1) << "Filtering against the N Pixel charge " << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  vector<float>::const_iterator iter = _minNChargeVec.begin();
-  while (iter != _minNChargeVec.end()) {
-    int nPixel = static_cast<int>(*iter);
-    float charge = cluster->getClusterCharge(nPixel);
-    float threshold = (*(iter + detectorPos + 1));
-    if (charge > threshold) {
-      iter += _noOfDetectors + 1;
-    } else {
+bool EUTelClusterFilter::isAboveNMinCharge(size_t iCluster) const {
+  const size_t stride = _noOfDetectors + 1;
+  const int detectorPos = _batch.detectorPos[iCluster];
+  for (size_t iN = 0; iN < _batch.nCharge.size(); ++iN) {
+    float charge = _batch.nCharge[iN][iCluster];
+    float threshold = _minNChargeVec[iN * stride + 1 + detectorPos];
+    if (!(charge > threshold)) {
       streamlog_out(DEBUG2) << "Rejected cluster because its charge over "
-                            << (*iter) << " is " << charge
+                            << _minNChargeVec[iN * stride] << " is " << charge
                             << " and the threshold is " << threshold << endl;
-      _rejectionMap["MinNChargeCut"][detectorPos]++;
       return false;
     }
   }
   return true;
 }
 
-bool EUTelClusterFilter::isAboveNMinSNR(EUTelVirtualCluster *cluster) const {
-
-  if (!_noiseRelatedCuts)
-    return true;
-  if (!_minNSNRSwitch)
-    return true;
-
-  streamlog_out(DEBUG1) << "Filtering against the N pixel SNR " << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  vector<float>::const_iterator iter = _minNSNRVec.begin();
-  while (iter != _minNSNRVec.end()) {
-    int nPixel = static_cast<int>(*iter);
-    float SNR = cluster->getClusterSNR(nPixel);
-    float threshold = (*(iter + detectorPos + 1));
-    if (SNR > threshold) {
-      iter += _noOfDetectors + 1;
-    } else {
+bool EUTelClusterFilter::isAboveNMinSNR(size_t iCluster) const {
+  const size_t stride = _noOfDetectors + 1;
+  const int detectorPos = _batch.detectorPos[iCluster];
+  for (size_t iN = 0; iN < _batch.nSNR.size(); ++iN) {
+    float SNR = _batch.nSNR[iN][iCluster];
+    float threshold = _minNSNRVec[iN * stride + 1 + detectorPos];
+    if (!(SNR > threshold)) {
       streamlog_out(DEBUG2) << "Rejected cluster because its SNR over "
-                            << (*iter) << " is " << SNR
+                            << _minNSNRVec[iN * stride] << " is " << SNR
                             << " and the threshold is " << threshold << endl;
-      _rejectionMap["MinNSNRCut"][detectorPos]++;
       return false;
     }
   }
   return true;
 }
 
-bool EUTelClusterFilter::isAboveNxNMinCharge(
-    EUTelVirtualCluster *cluster) const {
-
-  if (!_minNxNChargeSwitch)
-    return true;
-
-  streamlog_out(DEBUG1) << "Filtering against the N x N pixel charge" << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  vector<float>::const_iterator iter = _minNxNChargeVec.begin();
-  while (iter != _minNxNChargeVec.end()) {
-    int nxnPixel = static_cast<int>(*iter);
-    float charge = cluster->getClusterCharge(nxnPixel, nxnPixel);
-    float threshold = (*(iter + detectorPos + 1));
-    if ((threshold <= 0) || (charge > threshold)) {
-      iter += _noOfDetectors + 1;
-    } else {
+bool EUTelClusterFilter::isAboveNxNMinCharge(size_t iCluster) const {
+  const size_t stride = _noOfDetectors + 1;
+  const int detectorPos = _batch.detectorPos[iCluster];
+  for (size_t iN = 0; iN < _batch.nxnCharge.size(); ++iN) {
+    float threshold = _minNxNChargeVec[iN * stride + 1 + detectorPos];
+    // the sub cluster is only built if there is a threshold to compare with
+    if (threshold <= 0)
+      continue;
+    float charge = _batch.nxnCharge[iN][iCluster];
+    if (!(charge > threshold)) {
+      float nxnPixel = _minNxNChargeVec[iN * stride];
       streamlog_out(DEBUG2) << "Rejected cluster because its charge within a "
-                            << (*iter) << " x " << (*iter) << " subcluster is "
-                            << charge << " and the threshold is " << threshold
-                            << endl;
-      _rejectionMap["MinNxNChargeCut"][detectorPos]++;
+                            << nxnPixel << " x " << nxnPixel
+                            << " subcluster is " << charge
+                            << " and the threshold is " << threshold << endl;
       return false;
     }
   }
   return true;
 }
 
-bool EUTelClusterFilter::isAboveNxNMinSNR(EUTelVirtualCluster *cluster) const {
-
-  if (!_noiseRelatedCuts)
-    return true;
-  if (!_minNxNSNRSwitch)
-    return true;
-
-  streamlog_out(DEBUG1) << "Filtering against the N x N pixel charge" << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  vector<float>::const_iterator iter = _minNxNSNRVec.begin();
-  while (iter != _minNxNSNRVec.end()) {
-    int nxnPixel = static_cast<int>(*iter);
-    float snr = cluster->getClusterSNR(nxnPixel, nxnPixel);
-    float threshold = (*(iter + detectorPos + 1));
-    if ((threshold <= 0) || (snr > threshold)) {
-      iter += _noOfDetectors + 1;
-    } else {
+bool EUTelClusterFilter::isAboveNxNMinSNR(size_t iCluster) const {
+  const size_t stride = _noOfDetectors + 1;
+  const int detectorPos = _batch.detectorPos[iCluster];
+  for (size_t iN = 0; iN < _batch.nxnSNR.size(); ++iN) {
+    float threshold = _minNxNSNRVec[iN * stride + 1 + detectorPos];
+    if (threshold <= 0)
+      continue;
+    float snr = _batch.nxnSNR[iN][iCluster];
+    if (!(snr > threshold)) {
+      float nxnPixel = _minNxNSNRVec[iN * stride];
       streamlog_out(DEBUG2) << "Rejected cluster because its SNR within a "
-                            << (*iter) << " x " << (*iter) << " subcluster is "
-                            << snr << " and the threshold is " << threshold
-                            << endl;
-      _rejectionMap["MinNxNSNRCut"][detectorPos]++;
+                            << nxnPixel << " x " << nxnPixel
+                            << " subcluster is " << snr
+                            << " and the threshold is " << threshold << endl;
       return false;
     }
   }
   return true;
 }
 
-bool EUTelClusterFilter::isAboveMinSeedCharge(
-    EUTelVirtualCluster *cluster) const {
-
-  if (!_minSeedChargeSwitch)
-    return true;
-
-  streamlog_out(DEBUG1) << "Filtering against the seed charge " << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  if (cluster->getSeedCharge() > _minSeedChargeVec[detectorPos])
+bool EUTelClusterFilter::isAboveMinSeedCharge(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  if (_batch.seedCharge[iCluster] > _minSeedChargeVec[detectorPos])
     return true;
   else {
     streamlog_out(DEBUG2) << "Rejected cluster because its seed charge is "
-                          << cluster->getSeedCharge()
+                          << _batch.seedCharge[iCluster]
                           << " and the threshold is "
                           << _minSeedChargeVec[detectorPos] << endl;
-    _rejectionMap["MinSeedChargeCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isAboveMinSeedSNR(EUTelVirtualCluster *cluster) const {
-
-  if (!_noiseRelatedCuts)
-    return true;
-  if (!_minSeedSNRSwitch)
-    return true;
-
-  streamlog_out(DEBUG1) << "Filtering against the seed SNR " << endl;
-
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  if (cluster->getSeedSNR() > _minSeedSNRVec[detectorPos])
+bool EUTelClusterFilter::isAboveMinSeedSNR(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  if (_batch.seedSNR[iCluster] > _minSeedSNRVec[detectorPos])
     return true;
   else {
-    streamlog_out(DEBUG2) << "Rejected cluster because its seed charge is "
-                          << cluster->getSeedSNR() << " and the threshold is "
+    streamlog_out(DEBUG2) << "Rejected cluster because its seed SNR is "
+                          << _batch.seedSNR[iCluster]
+                          << " and the threshold is "
                           << _minSeedSNRVec[detectorPos] << endl;
-    _rejectionMap["MinSeedSNRCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::hasQuality(EUTelVirtualCluster *cluster) const {
-
-  if (!_clusterQualitySwitch)
+bool EUTelClusterFilter::hasQuality(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  if (_clusterQualityVec[detectorPos] < 0)
     return true;
 
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  if (_clusterQualityVec[detectorID] < 0)
-    return true;
-
-  ClusterQuality actual = cluster->getClusterQuality();
-  ClusterQuality needed =
-      static_cast<ClusterQuality>(_clusterQualityVec[detectorPos]);
-
-  if (actual == needed)
+  if (_batch.quality[iCluster] == _clusterQualityVec[detectorPos])
     return true;
   else {
     streamlog_out(DEBUG2) << "Rejected cluster because its quality "
-                          << static_cast<int>(actual) << " is not "
+                          << _batch.quality[iCluster] << " is not "
                           << _clusterQualityVec[detectorPos] << endl;
-    _rejectionMap["ClusterQualityCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isBelowMaxClusterNoise(
-    EUTelVirtualCluster *cluster) const {
-
-  if (!_noiseRelatedCuts)
-    return true;
-  if (!_maxClusterNoiseSwitch)
+bool EUTelClusterFilter::isBelowMaxClusterNoise(size_t iCluster) const {
+  const int detectorPos = _batch.detectorPos[iCluster];
+  if (_maxClusterNoiseVec[detectorPos] < 0)
     return true;
 
-  streamlog_out(DEBUG1) << "Filtering against the maximum cluster noise"
-                        << endl;
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  if ((cluster->getClusterNoise() < _maxClusterNoiseVec[detectorPos]) ||
-      (_maxClusterNoiseVec[detectorID] < 0))
+  if (_batch.clusterNoise[iCluster] < _maxClusterNoiseVec[detectorPos])
     return true;
   else {
     streamlog_out(DEBUG2) << "Rejected cluster because its noise is "
-                          << cluster->getClusterNoise()
+                          << _batch.clusterNoise[iCluster]
                           << " and the threshold is "
                           << _maxClusterNoiseVec[detectorPos] << endl;
-    _rejectionMap["MaxClusterNoiseCut"][detectorPos]++;
     return false;
   }
 }
 
-bool EUTelClusterFilter::isInsideROI(EUTelVirtualCluster *cluster) const {
+bool EUTelClusterFilter::isInsideROI(size_t iCluster) const {
+  // only the ROIs defined on this sensor are tested
+  const vector<EUTelROI> &roiVec = _insideROIByPos[_batch.detectorPos[iCluster]];
+  for (auto &roi : roiVec) {
+    if (!roi.isInside(_batch.cogX[iCluster], _batch.cogY[iCluster]))
+      return false;
+  }
+  return true;
+}
 
-  if (!_insideROISwitch)
-    return true;
+bool EUTelClusterFilter::isOutsideROI(size_t iCluster) const {
+  const vector<EUTelROI> &roiVec =
+      _outsideROIByPos[_batch.detectorPos[iCluster]];
+  for (auto &roi : roiVec) {
+    if (roi.isInside(_batch.cogX[iCluster], _batch.cogY[iCluster]))
+      return false;
+  }
+  return true;
+}
 
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  float x, y;
-  cluster->getCenterOfGravity(x, y);
-
-  bool tempAccepted = true;
-  vector<EUTelROI>::const_iterator iter = _insideROIVec.begin();
-  vector<EUTelROI>::const_iterator end = _insideROIVec.end();
-  while (true) {
-
-    // the HasSameID requires the sensorID, so don't replace it with
-    // detectorPos
-    iter = find_if(iter, end, HasSameID(detectorID));
-    if (iter != end) {
-      if ((*iter).isInside(x, y)) {
-        tempAccepted &= true;
-      } else {
-        _rejectionMap["InsideROICut"][detectorPos]++;
-        tempAccepted &= false;
-      }
-      ++iter;
-    } else
-      break;
+void EUTelClusterFilter::compilePipeline() {
+
+  // relative evaluation costs: the cluster quality is a single flag,
+  // total and seed charge need one pass over the pixels, the center
+  // of gravity a weighted one, the SNR cuts also touch the noise and
+  // the N and NxN cuts have to sort the pixels or build a sub cluster
+  _cutPipeline.clear();
+  auto addStage = [this](const string &name, int cost, unsigned int features,
+                         StageTarget target, bool noiseRelated,
+                         ClusterPredicate predicate) {
+    CutStage stage;
+    stage.name = name;
+    stage.cost = cost;
+    stage.features = features;
+    stage.target = target;
+    stage.noiseRelated = noiseRelated;
+    stage.predicate = predicate;
+    stage.rejected = &_rejectionMap[name];
+    _cutPipeline.push_back(stage);
+  };
+
+  if (_clusterQualitySwitch)
+    addStage("ClusterQualityCut", 0, kQuality, kAllClusters, false,
+             &EUTelClusterFilter::hasQuality);
+  if (_dffnhitsswitch)
+    addStage("MinHitPixel", 1, kTotalCharge, kDFFClusters, false,
+             &EUTelClusterFilter::isAboveNumberOfHitPixel);
+  if (_minTotalChargeSwitch)
+    addStage("MinTotalChargeCut", 1, kTotalCharge, kNonDFFClusters, false,
+             &EUTelClusterFilter::isAboveMinTotalCharge);
+  if (_minSeedChargeSwitch)
+    addStage("MinSeedChargeCut", 1, kSeedCharge, kNonDFFClusters, false,
+             &EUTelClusterFilter::isAboveMinSeedCharge);
+  if (_insideROISwitch)
+    addStage("InsideROICut", 2, kCenterOfGravity, kAllClusters, false,
+             &EUTelClusterFilter::isInsideROI);
+  if (_outsideROISwitch)
+    addStage("OutsideROICut", 2, kCenterOfGravity, kAllClusters, false,
+             &EUTelClusterFilter::isOutsideROI);
+  if (_minTotalSNRSwitch)
+    addStage("MinTotalSNRCut", 3, kTotalSNR, kNonDFFClusters, true,
+             &EUTelClusterFilter::isAboveMinTotalSNR);
+  if (_minSeedSNRSwitch)
+    addStage("MinSeedSNRCut", 3, kSeedSNR, kNonDFFClusters, true,
+             &EUTelClusterFilter::isAboveMinSeedSNR);
+  if (_maxClusterNoiseSwitch)
+    addStage("MaxClusterNoiseCut", 3, kClusterNoise, kNonDFFClusters, true,
+             &EUTelClusterFilter::isBelowMaxClusterNoise);
+  if (_minNChargeSwitch)
+    addStage("MinNChargeCut", 4, kNCharge, kNonDFFClusters, false,
+             &EUTelClusterFilter::isAboveNMinCharge);
+  if (_minNSNRSwitch)
+    addStage("MinNSNRCut", 5, kNSNR, kNonDFFClusters, true,
+             &EUTelClusterFilter::isAboveNMinSNR);
+  if (_minNxNChargeSwitch)
+    addStage("MinNxNChargeCut", 4, kNxNCharge, kNonDFFClusters, false,
+             &EUTelClusterFilter::isAboveNxNMinCharge);
+  if (_minNxNSNRSwitch)
+    addStage("MinNxNSNRCut", 5, kNxNSNR, kNonDFFClusters, true,
+             &EUTelClusterFilter::isAboveNxNMinSNR);
+
+  // the user given order goes first, all remaining stages follow
+  // cheapest first
+  for (auto &stage : _cutPipeline) {
+    auto userPos = find(_cutOrder.begin(), _cutOrder.end(), stage.name);
+    if (userPos != _cutOrder.end()) {
+      stage.cost = static_cast<int>(userPos - _cutOrder.begin()) -
+                   static_cast<int>(_cutOrder.size());
+    }
+  }
+  stable_sort(_cutPipeline.begin(), _cutPipeline.end(),
+              [](const CutStage &a, const CutStage &b) {
+                return a.cost < b.cost;
+              });
+
+  _pipelineNeedsNoise = false;
+  _pipelineFeatures = 0;
+  for (auto &stage : _cutPipeline) {
+    _pipelineNeedsNoise |= stage.noiseRelated;
+    _pipelineFeatures |= stage.features;
+    streamlog_out(DEBUG2) << "Cut pipeline stage " << stage.name << endl;
   }
-  return tempAccepted;
 }
 
-bool EUTelClusterFilter::isOutsideROI(EUTelVirtualCluster *cluster) const {
+void EUTelClusterFilter::prepareBatch() {
+
+  const size_t nClusters = _batch.clusters.size();
+  const size_t stride = _noOfDetectors + 1;
+  const unsigned int features = _pipelineFeatures;
+
+  _batch.computed.assign(nClusters, 0);
+
+  auto prepare = [nClusters, features](unsigned int feature,
+                                       vector<float> &values) {
+    values.resize((features & feature) ? nClusters : 0);
+  };
+  prepare(kTotalCharge, _batch.totalCharge);
+  prepare(kTotalSNR, _batch.totalSNR);
+  prepare(kSeedCharge, _batch.seedCharge);
+  prepare(kSeedSNR, _batch.seedSNR);
+  prepare(kClusterNoise, _batch.clusterNoise);
+  prepare(kCenterOfGravity, _batch.cogX);
+  prepare(kCenterOfGravity, _batch.cogY);
+  _batch.quality.resize((features & kQuality) ? nClusters : 0);
+
+  // one array per N of the cut vectors
+  auto prepareN = [nClusters, features, stride](
+      unsigned int feature, const vector<float> &cuts,
+      vector<vector<float>> &values) {
+    values.resize((features & feature) ? cuts.size() / stride : 0);
+    for (auto &nValues : values) {
+      nValues.resize(nClusters);
+    }
+  };
+  prepareN(kNCharge, _minNChargeVec, _batch.nCharge);
+  prepareN(kNSNR, _minNSNRVec, _batch.nSNR);
+  prepareN(kNxNCharge, _minNxNChargeVec, _batch.nxnCharge);
+  prepareN(kNxNSNR, _minNxNSNRVec, _batch.nxnSNR);
+}
 
-  if (!_outsideROISwitch)
-    return true;
+void EUTelClusterFilter::computeFeatures(size_t iCluster,
+                                         unsigned int features) {
 
-  int detectorID = cluster->getDetectorID();
-  int detectorPos = _ancillaryIndexMap[detectorID];
-  float x, y;
-  cluster->getCenterOfGravity(x, y);
-
-  bool tempAccepted = true;
-  vector<EUTelROI>::const_iterator iter = _outsideROIVec.begin();
-  vector<EUTelROI>::const_iterator end = _outsideROIVec.end();
-  while (true) {
-    iter = find_if(iter, end, HasSameID(detectorID));
-    if (iter != end) {
-      if (!(*iter).isInside(x, y)) {
-        tempAccepted &= true;
-      } else {
-        _rejectionMap["OutsideROICut"][detectorPos]++;
-        tempAccepted &= false;
+  // only what no earlier stage has computed yet
+  features &= ~_batch.computed[iCluster];
+  if (features == 0)
+    return;
+  _batch.computed[iCluster] |= features;
+
+  EUTelVirtualCluster *cluster = _batch.clusters[iCluster].get();
+  const int detectorPos = _batch.detectorPos[iCluster];
+  const size_t stride = _noOfDetectors + 1;
+
+  if (features & kTotalCharge)
+    _batch.totalCharge[iCluster] = cluster->getTotalCharge();
+  if (features & kQuality)
+    _batch.quality[iCluster] = static_cast<int>(cluster->getClusterQuality());
+  if (features & kCenterOfGravity)
+    cluster->getCenterOfGravity(_batch.cogX[iCluster], _batch.cogY[iCluster]);
+  if (features & kSeedCharge)
+    _batch.seedCharge[iCluster] = cluster->getSeedCharge();
+  if (features & kTotalSNR)
+    _batch.totalSNR[iCluster] = cluster->getClusterSNR();
+  if (features & kSeedSNR)
+    _batch.seedSNR[iCluster] = cluster->getSeedSNR();
+  if (features & kClusterNoise)
+    _batch.clusterNoise[iCluster] = cluster->getClusterNoise();
+
+  for (size_t iN = 0; iN < _batch.nCharge.size() && (features & kNCharge);
+       ++iN) {
+    _batch.nCharge[iN][iCluster] = cluster->getClusterCharge(
+        static_cast<int>(_minNChargeVec[iN * stride]));
+  }
+  for (size_t iN = 0; iN < _batch.nSNR.size() && (features & kNSNR); ++iN) {
+    _batch.nSNR[iN][iCluster] =
+        cluster->getClusterSNR(static_cast<int>(_minNSNRVec[iN * stride]));
+  }
+  // the sub clusters are only built if there is a threshold
+  for (size_t iN = 0; iN < _batch.nxnCharge.size() && (features & kNxNCharge);
+       ++iN) {
+    if (_minNxNChargeVec[iN * stride + 1 + detectorPos] <= 0)
+      continue;
+    int nxnPixel = static_cast<int>(_minNxNChargeVec[iN * stride]);
+    _batch.nxnCharge[iN][iCluster] =
+        cluster->getClusterCharge(nxnPixel, nxnPixel);
+  }
+  for (size_t iN = 0; iN < _batch.nxnSNR.size() && (features & kNxNSNR);
+       ++iN) {
+    if (_minNxNSNRVec[iN * stride + 1 + detectorPos] <= 0)
+      continue;
+    int nxnPixel = static_cast<int>(_minNxNSNRVec[iN * stride]);
+    _batch.nxnSNR[iN][iCluster] = cluster->getClusterSNR(nxnPixel, nxnPixel);
+  }
+}
+
+void EUTelClusterFilter::runPipeline(vector<int> &acceptedClusterVec) {
+
+  prepareBatch();
+
+  // all clusters of the event are pushed through one stage after the
+  // other, each stage only sees the survivors of the previous ones
+  // unless the counters have to be independent
+  const size_t nClusters = _batch.clusters.size();
+  vector<size_t> alive(nClusters);
+  for (size_t i = 0; i < nClusters; ++i)
+    alive[i] = i;
+  vector<char> accepted(nClusters, 1);
+
+  for (auto &stage : _cutPipeline) {
+    if (stage.noiseRelated && !_noiseRelatedCuts)
+      continue;
+
+    size_t nAlive = 0;
+    for (auto i : alive) {
+      bool applies = (stage.target == kAllClusters) ||
+                     ((stage.target == kDFFClusters) == _batch.isDFF[i]);
+      bool passed = true;
+      if (applies) {
+        computeFeatures(i, stage.features);
+        passed = (this->*stage.predicate)(i);
       }
-      ++iter;
-    } else
+      if (passed || _independentCutCounters) {
+        alive[nAlive++] = i;
+      }
+      if (!passed) {
+        accepted[i] = 0;
+        (*stage.rejected)[_batch.detectorPos[i]]++;
+      }
+    }
+    alive.resize(nAlive);
+    if (alive.empty())
       break;
   }
-  return tempAccepted;
+
+  for (auto i : alive) {
+    if (accepted[i])
+      acceptedClusterVec.push_back(_batch.pulseIndex[i]);
+  }
 }
 
 void EUTelClusterFilter::check(LCEvent * /* evt */) {
@@ -1618,20 +1715,32 @@ string EUTelClusterFilter::printSummary() const {
   }
 
   ss << doubleLine.str() << endl
-     << " Rejection summary " << endl
+     << (_independentCutCounters
+             ? " Rejection summary (independent cluster cut counters)"
+             : " Rejection summary (cluster cuts in evaluation order)")
+     << endl
      << doubleLine.str() << endl;
 
-  map<string, vector<unsigned int>>::iterator iter = _rejectionMap.begin();
-  while (iter != _rejectionMap.end()) {
-    ss << " " << setiosflags(ios::left) << setw(bigSpacer) << (*iter).first
+  // first the cluster based cuts in pipeline order, then the event
+  // based ones
+  vector<string> rowNames;
+  for (auto &stage : _cutPipeline) {
+    rowNames.push_back(stage.name);
+  }
+  for (auto &entry : _rejectionMap) {
+    if (find(rowNames.begin(), rowNames.end(), entry.first) == rowNames.end())
+      rowNames.push_back(entry.first);
+  }
+
+  for (auto &rowName : rowNames) {
+    ss << " " << setiosflags(ios::left) << setw(bigSpacer) << rowName
        << resetiosflags(ios::left);
-    vector<unsigned int>::iterator iter2 = (*iter).second.begin();
-    while (iter2 != (*iter).second.end()) {
+    vector<unsigned int>::iterator iter2 = _rejectionMap[rowName].begin();
+    while (iter2 != _rejectionMap[rowName].end()) {
       ss << setw(smallSpacer) << (*iter2);
       ++iter2;
     }
     ss << "\n" << singleLine.str() << endl;
-    ++iter;
   }
   ss << singleLine.str() << "\n"
      << " " << setiosflags(ios::left) << setw(bigSpacer) << "Accepted clusters "
@@ -19,13 +19,16 @@
 #include "EUTelClusteringProcessor.h"
 #include "EUTELESCOPE.h"
 #include "EUTelBrickedClusterImpl.h"
+#include "EUTelConditionsCache.h"
 #include "EUTelDFFClusterImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTelExceptions.h"
 #include "EUTelFFClusterImpl.h"
+#include "EUTelFrameCalibrator.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelMatrixDecoder.h"
 #include "EUTelRunHeaderImpl.h"
+#include "EUTelSeedFinder.h"
 #include "EUTelSparseClusterImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelVirtualCluster.h"
@@ -78,7 +81,8 @@ EUTelClusteringProcessor::EUTelClusteringProcessor()
       _ffYClusterSize(0), _ffSeedCut(0.0), _sparseSeedCut(0.0),
       _ffClusterCut(0.0), _sparseClusterCut(0.0), _sparseMinDistanceSquared(2),
       _sparseMinDistance(0.0), _iEvt(0), _fillHistos(false),
-      _histoInfoFileName(""), _seedCandidateMap(), _totClusterMap(),
+      _histoInfoFileName(""), _seedCandidateMap(), _seedFinder(),
+      _totClusterMap(),
       _noOfDetector(0), _ExcludedPlanes(), _clusterSpectraNVector(),
       _clusterSpectraNxNVector(), _clusterSignalHistos(), _clusterSizeXHistos(),
       _clusterSizeYHistos(), _seedSignalHistos(), _hitMapHistos(),
@@ -91,7 +95,12 @@ EUTelClusteringProcessor::EUTelClusteringProcessor()
       nzsInputDataCollectionVec(nullptr), pulseCollectionVec(nullptr),
       noiseCollectionVec(nullptr), statusCollectionVec(nullptr),
       hotPixelCollectionVec(nullptr), hasNZSData(false), hasZSData(false),
-      _hitIndexMapVec() {
+      _hitIndexMapVec(), _digitalMatrixMap(), _rawDataCollectionName(""),
+      _pedestalCollectionName(""), _calibratedDataCollectionName(""),
+      _doCommonMode(1), _hitRejectionCut(3.5f), _maxNoOfRejectedPixels(3000),
+      _maxNoOfRejectedPixelPerRow(25), _maxNoOfSkippedRow(15),
+      _frameCalibrator(), _calibratedCollection(nullptr),
+      _calibratedCandidateMap() {
 
   // modify processor description
   _description = "EUTelClusteringProcessor is looking for clusters into a "
@@ -235,6 +244,48 @@ EUTelClusteringProcessor::EUTelClusteringProcessor()
       "ExcludedPlanes",
       "The list of sensor ids that have to be excluded from the clustering.",
       _ExcludedPlanes, std::vector<int>());
+
+  // the fused calibration, replacing the EUTelCalibrateEventProcessor
+  // in front of the FixedFrame clustering
+  registerOptionalParameter(
+      "RawDataCollectionName",
+      "Raw data collection to be calibrated by this processor for the "
+      "FixedFrame algorithm. If empty, the calibrated NZS data are read",
+      _rawDataCollectionName, string(""));
+
+  registerOptionalParameter("PedestalCollectionName",
+                            "Pedestal collection name of the calibration",
+                            _pedestalCollectionName, string("pedestal"));
+
+  registerOptionalParameter(
+      "CalibratedDataCollectionName",
+      "If set, the calibrated data are also added to the event (debugging)",
+      _calibratedDataCollectionName, string(""));
+
+  registerOptionalParameter("PerformCommonMode",
+                            "Common mode suppression of the calibration. "
+                            "0 -> off, 1 -> full frame, 2 -> row wise",
+                            _doCommonMode, 1);
+
+  registerOptionalParameter("HitRejectionCut",
+                            "Threshold of pixel SNR for hit rejection",
+                            _hitRejectionCut, 3.5f);
+
+  registerOptionalParameter(
+      "MaxNoOfRejectedPixels",
+      "Maximum allowed number of rejected pixel per event",
+      _maxNoOfRejectedPixels, 3000);
+
+  registerOptionalParameter(
+      "MaxNoOfRejectedPixelPerRow",
+      "Maximum allowed number of rejected pixels per row (only with RowWise)",
+      _maxNoOfRejectedPixelPerRow, 25);
+
+  registerOptionalParameter(
+      "MaxNoOfSkippedRow",
+      "Maximum allowed number of skipped rows (only with RowWise)",
+      _maxNoOfSkippedRow, 15);
+
   _isFirstEvent = true;
 }
 
@@ -275,6 +326,19 @@ void EUTelClusteringProcessor::init() {
     }
   }
 
+  if (!_rawDataCollectionName.empty()) {
+    if (_nzsClusteringAlgo != EUTELESCOPE::FIXEDFRAME) {
+      throw InvalidParameterException(
+          "RawDataCollectionName is only supported by the FixedFrame "
+          "algorithm");
+    }
+    _frameCalibrator.setCommonMode(_doCommonMode);
+    _frameCalibrator.setHitRejectionCut(_hitRejectionCut);
+    _frameCalibrator.setMaxNoOfRejectedPixels(_maxNoOfRejectedPixels);
+    _frameCalibrator.setMaxNoOfRejectedPixelPerRow(_maxNoOfRejectedPixelPerRow);
+    _frameCalibrator.setMaxNoOfSkippedRow(_maxNoOfSkippedRow);
+  }
+
   // reset hotpixel map vectors
   _hitIndexMapVec.clear();
 
@@ -307,15 +371,29 @@ void EUTelClusteringProcessor::initializeGeometry(LCEvent *event) {
   streamlog_out(DEBUG5) << "Initializing geometry" << endl;
 
   try {
-    nzsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
-        event->getCollection(_nzsDataCollectionName));
-    _noOfDetector += nzsInputDataCollectionVec->getNumberOfElements();
-
-    CellIDDecoder<TrackerDataImpl> cellDecoder(nzsInputDataCollectionVec);
-    for (size_t i = 0; i < nzsInputDataCollectionVec->size(); ++i) {
-      TrackerDataImpl *data = dynamic_cast<TrackerDataImpl *>(
-          nzsInputDataCollectionVec->getElementAt(i));
-      _sensorIDVec.push_back(cellDecoder(data)["sensorID"]);
+    if (_rawDataCollectionName.empty()) {
+      nzsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
+          event->getCollection(_nzsDataCollectionName));
+      _noOfDetector += nzsInputDataCollectionVec->getNumberOfElements();
+
+      CellIDDecoder<TrackerDataImpl> cellDecoder(nzsInputDataCollectionVec);
+      for (size_t i = 0; i < nzsInputDataCollectionVec->size(); ++i) {
+        TrackerDataImpl *data = dynamic_cast<TrackerDataImpl *>(
+            nzsInputDataCollectionVec->getElementAt(i));
+        _sensorIDVec.push_back(cellDecoder(data)["sensorID"]);
+      }
+    } else {
+      // the NZS data will be calibrated from these ones
+      LCCollectionVec *rawDataCollectionVec = dynamic_cast<LCCollectionVec *>(
+          event->getCollection(_rawDataCollectionName));
+      _noOfDetector += rawDataCollectionVec->getNumberOfElements();
+
+      CellIDDecoder<TrackerRawDataImpl> rawDecoder(rawDataCollectionVec);
+      for (size_t i = 0; i < rawDataCollectionVec->size(); ++i) {
+        TrackerRawDataImpl *rawData = dynamic_cast<TrackerRawDataImpl *>(
+            rawDataCollectionVec->getElementAt(i));
+        _sensorIDVec.push_back(rawDecoder(rawData)["sensorID"]);
+      }
     }
 
   } catch (lcio::DataNotAvailableException&) {
@@ -546,17 +624,24 @@ void EUTelClusteringProcessor::initializeStatusCollection() {
 
 void EUTelClusteringProcessor::readCollections(LCEvent *event) {
 
-  try {
-    nzsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
-        event->getCollection(_nzsDataCollectionName));
-    streamlog_out(DEBUG4) << "nzsInputDataCollectionVec: "
-                          << _nzsDataCollectionName.c_str() << " found "
-                          << endl;
-  } catch (lcio::DataNotAvailableException&) {
-    // do nothing
-    streamlog_out(DEBUG4) << "nzsInputDataCollectionVec: "
-                          << _nzsDataCollectionName.c_str() << " not found "
-                          << endl;
+  // with the fused calibration, the NZS data are set by
+  // calibrateRawData
+  const string nzsDataCollectionName = _rawDataCollectionName.empty()
+                                           ? _nzsDataCollectionName
+                                           : _rawDataCollectionName;
+  if (_rawDataCollectionName.empty()) {
+    try {
+      nzsInputDataCollectionVec = dynamic_cast<LCCollectionVec *>(
+          event->getCollection(_nzsDataCollectionName));
+      streamlog_out(DEBUG4) << "nzsInputDataCollectionVec: "
+                            << _nzsDataCollectionName.c_str() << " found "
+                            << endl;
+    } catch (lcio::DataNotAvailableException&) {
+      // do nothing
+      streamlog_out(DEBUG4) << "nzsInputDataCollectionVec: "
+                            << _nzsDataCollectionName.c_str() << " not found "
+                            << endl;
+    }
   }
 
   try {
@@ -619,7 +704,7 @@ void EUTelClusteringProcessor::readCollections(LCEvent *event) {
   hasZSData = true;
 
   try {
-    event->getCollection(_nzsDataCollectionName);
+    event->getCollection(nzsDataCollectionName);
   } catch (lcio::DataNotAvailableException &e) {
     hasNZSData = false;
     streamlog_out(DEBUG4) << "No NZS data found in the event" << endl;
@@ -678,6 +763,12 @@ void EUTelClusteringProcessor::processEvent(LCEvent *event) {
                             << endl;
   }
 
+  // the calibration may skip the event, so it has to come before any
+  // output is prepared
+  if (hasNZSData && !_rawDataCollectionName.empty()) {
+    calibrateRawData(evt);
+  }
+
   if (_fillHistos)
     (dynamic_cast<AIDA::IHistogram1D *>(_timeStampHisto))
         ->fill(event->getTimeStamp());
@@ -837,31 +928,37 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
     // reset the status
 
     // now that we know which is the sensorID, we can ask to GEAR
-    // which are the minX, minY, maxX and maxY.
-    int _minX, _minY, _maxX, _maxY;
-    _minX = 0;
-    _minY = 0;
-
-    getMaxPixels(sensorID, _maxX, _maxY);
-
-    // todo: declare a vector of sensormatrizes as a class member in
-    // order to not allocate a new object for each loop iteration.
-    // sensormatrix.push_back(dim2array<bool>((unsigned int)(_maxX+1 - _minX),
-    // (unsigned int)(_maxY+1 - _minY), false));
-    //    dim2array<bool> sensormatrix((unsigned int)(_maxX+1 - _minX),
-    //    (unsigned int)(_maxY+1 - _minY), false);
-
-    std::map<unsigned int, std::map<unsigned int, bool>> sensormatrix;
+    // which are the minX, minY, maxX and maxY. A sensor unknown to the
+    // geometry is skipped.
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    if (!getMaxPixels(sensorID, maxX, maxY)) {
+      continue;
+    }
 
     // prepare the matrix decoder
     EUTelMatrixDecoder matrixDecoder(noiseDecoder, noise);
 
-    // insert some noise pixel by hand. was only used for debugging.
-    // for(int i = 0; i < 250; i++)
-    //       {
-    //         int   index  = matrixDecoder.getIndexFromXY( i,i );
-    //         status->adcValues()[index] = EUTELESCOPE::HITPIXEL;
-    //       }
+    // the bit matrix of this sensor is created at its first event, with
+    // the hot pixels in its mask, and reused afterwards
+    std::map<int, EUTelDigitalClusterMatrix>::iterator matrixIter =
+        _digitalMatrixMap.find(sensorID);
+    if (matrixIter == _digitalMatrixMap.end()) {
+      matrixIter =
+          _digitalMatrixMap
+              .insert(make_pair(sensorID, EUTelDigitalClusterMatrix(
+                                              maxX + 1 - minX,
+                                              maxY + 1 - minY)))
+              .first;
+      if (static_cast<int>(_hitIndexMapVec.size()) > sensorID) {
+        for (auto const &hotPixel : _hitIndexMapVec[sensorID]) {
+          matrixIter->second.maskPixel(
+              matrixDecoder.getXFromIndex(hotPixel.first),
+              matrixDecoder.getYFromIndex(hotPixel.first));
+        }
+      }
+    }
+    EUTelDigitalClusterMatrix &sensormatrix = matrixIter->second;
+    sensormatrix.clear();
 
     // prepare a data vector mimicking the TrackerData data of the
     // standard digitalFixedFrameClustering. Initialize all the entries to zero.
@@ -871,10 +968,8 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
     // seed candidates
     list<seed> seedcandidates;
 
-    const int xoffset = _minX;
-    const int yoffset = _minY;
-
-    //    bool firstfoundhitpixel = true;
+    const int xoffset = minX;
+    const int yoffset = minY;
 
     if (type == kEUTelGenericSparsePixel) {
       // now prepare the EUTelescope interface to sparsified data.
@@ -887,21 +982,17 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
                             << " pixels " << endl;
 
       for (auto &sparsePixel : pixelVec) {
-        int index = matrixDecoder.getIndexFromXY(sparsePixel.getXCoord(),
-                                                 sparsePixel.getYCoord());
-
-        if (static_cast<int>(_hitIndexMapVec.size()) > sensorID) {
-          if (_hitIndexMapVec[sensorID].find(index) !=
-              _hitIndexMapVec[sensorID].end()) {
-            streamlog_out(DEBUG1) << " iDetector " << sensorID
-                                  << " unique index " << index
-                                  << " at x = " << sparsePixel.getXCoord()
-                                  << " y= " << sparsePixel.getYCoord() << endl;
-            continue;
-          }
+        if (!sensormatrix.addHit(sparsePixel.getXCoord(),
+                                 sparsePixel.getYCoord())) {
+          streamlog_out(DEBUG1) << " iDetector " << sensorID
+                                << " pixel outside of the sensor at x = "
+                                << sparsePixel.getXCoord()
+                                << " y= " << sparsePixel.getYCoord() << endl;
         }
-        sensormatrix[sparsePixel.getXCoord()][sparsePixel.getYCoord()] = true;
       }
+
+      // the hot pixels are removed word by word
+      sensormatrix.applyMask();
     } else {
       throw UnknownDataTypeException("Unknown sparsified pixel");
     }
@@ -922,79 +1013,36 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
     ///    expected.
     ///    const int stepy = 1;
 
-    std::map<unsigned int, std::map<unsigned int, bool>>::iterator pos;
-    for (pos = sensormatrix.begin(); pos != sensormatrix.end(); ++pos) {
-      std::map<unsigned int, bool>::iterator sec;
-      for (sec = sensormatrix[(*pos).first].begin();
-           sec != sensormatrix[(*pos).first].end(); ++sec) {
-        //              if(sensormatrix.at(i,j))
-        if (sensormatrix[pos->first][sec->first]) {
-          const unsigned int i = pos->first;
-          const unsigned int j = sec->first;
-
-          // number of neighbours
-          int nb = 0;
-
-          // total number of pixels in a cluster around the seed candidate
-          // (also diagonal elements are counted)
-          int npixel_cl = 0;
-
-          // first npixel_cl will be determined
-          for (unsigned int index_x = i - stepx; index_x <= (i + stepx);
-               index_x++) {
-            for (unsigned int index_y = j - stepy; index_y <= (j + stepy);
-                 index_y++) {
-
-              if (index_x > 0 && index_y > 0) {
-                std::map<unsigned int,
-                         std::map<unsigned int, bool>>::const_iterator z =
-                    sensormatrix.find(index_x);
-                if (z != sensormatrix.end() &&
-                    z->second.find(index_y) != z->second.end()) {
-                  if (sensormatrix[index_x][index_y]) {
-                    npixel_cl++;
-                  }
-                }
-              }
-            }
-          }
-
-          if (npixel_cl > 1) {
-            if (i >= 1)
-              for (int index_x = static_cast<int>(i - 1);
-                   index_x <= static_cast<int>(i + 1); index_x++) {
-                if (index_x >= 0) {
-                  std::map<unsigned int,
-                           std::map<unsigned int, bool>>::const_iterator z =
-                      sensormatrix.find(index_x);
-                  if (z != sensormatrix.end() &&
-                      z->second.find(j) != z->second.end()) {
-                    if (sensormatrix[index_x][j])
-                      nb++;
-                  }
-                }
-              }
-
-            if (j >= 1)
-              for (int index_y = static_cast<int>(j - 1);
-                   index_y <= static_cast<int>(j + 1); index_y++) {
-                if (index_y >= 0) {
-                  std::map<unsigned int,
-                           std::map<unsigned int, bool>>::const_iterator z =
-                      sensormatrix.find(i);
-                  if (z != sensormatrix.end() &&
-                      z->second.find(index_y) != z->second.end()) {
-                    if (sensormatrix[i][index_y])
-                      nb++;
-                  }
-                }
-              }
-          } // could all this passage be skipped ?
+    // the hit pixels ordered by x and then by y
+    std::vector<std::pair<int, int>> hitPixels;
+    sensormatrix.getHits(hitPixels);
+
+    for (auto const &hitPixel : hitPixels) {
+      const int i = hitPixel.first;
+      const int j = hitPixel.second;
+
+      // total number of pixels in a cluster around the seed candidate
+      // (also diagonal elements are counted). As in the former map
+      // based counting, candidates closer than half a cluster to the
+      // lower borders have none and row and column 0 are not counted.
+      unsigned int npixel_cl = 0;
+      if (i >= stepx && j >= stepy) {
+        npixel_cl = sensormatrix.countHits(std::max(i - stepx, 1), i + stepx,
+                                           std::max(j - stepy, 1), j + stepy);
+      }
 
-          // fill this pixel into the list of found seed pixel candidates
-          seedcandidates.push_back(seed(i, j, nb, npixel_cl));
-        }
+      // number of neighbours along x plus along y, the seed candidate
+      // itself is part of both
+      unsigned int nb = 0;
+      if (npixel_cl > 1) {
+        if (i >= 1)
+          nb += sensormatrix.countHits(i - 1, i + 1, j, j);
+        if (j >= 1)
+          nb += sensormatrix.countHits(i, i, j - 1, j + 1);
       }
+
+      // fill this pixel into the list of found seed pixel candidates
+      seedcandidates.push_back(seed(i, j, nb, npixel_cl));
     }
     // sort the list of seed pixel candidates. the first criteria is
     // the number of neighbours without diagonal neighbours. then the
@@ -1012,216 +1060,193 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(
       // loop over all found seed pixel candidates
       for (i = seedcandidates.begin(); i != seedcandidates.end(); ++i) {
         // check that this pixel was not used before.
+        const int seedCandidateX = static_cast<int>(i->x);
+        const int seedCandidateY = static_cast<int>(i->y);
+        if (sensormatrix.isHit(seedCandidateX, seedCandidateY)) {
+          std::vector<pixel> pix;
+          // select pixels around the seed pixel
+
+          if (seedCandidateX >= stepx && seedCandidateY >= stepy) {
+            hitPixels.clear();
+            sensormatrix.getHits(
+                seedCandidateX - stepx, seedCandidateX + stepx,
+                seedCandidateY - stepy, seedCandidateY + stepy, hitPixels);
+            for (auto const &hitPixel : hitPixels) {
+              pix.push_back(pixel(hitPixel.first, hitPixel.second));
+            }
+          }
 
-        std::map<unsigned int, std::map<unsigned int, bool>>::const_iterator z =
-            sensormatrix.find(i->x);
-        if (z != sensormatrix.end() &&
-            z->second.find(i->y) != z->second.end()) {
-          if (sensormatrix[i->x][i->y]) {
-            std::vector<pixel> pix;
-            // select pixels around the seed pixel
-
-            if (i->x >= static_cast<unsigned int>(stepx) &&
-                i->y >= static_cast<unsigned int>(stepy)) {
-              for (int index_x = static_cast<int>(i->x - stepx);
-                   index_x <= static_cast<int>(i->x + stepx); index_x++) {
-                for (int index_y = static_cast<int>(i->y - stepy);
-                     index_y <= static_cast<int>(i->y + stepy); index_y++) {
-                  if (index_x >= 0 && index_y >= 0) {
-                    std::map<unsigned int,
-                             std::map<unsigned int, bool>>::const_iterator z =
-                        sensormatrix.find(index_x);
-                    if (z != sensormatrix.end() &&
-                        z->second.find(index_y) != z->second.end()) {
-                      if (sensormatrix[index_x][index_y]) {
-                        pix.push_back(pixel(index_x, index_y));
-                      }
-                    }
-                  }
-                }
+          // pix is a vector with all found "good" pixel, that
+          // were not used before in a different cluster.
+
+          // cut on the number of pixel. dont
+          // apply this cut here, use it in the
+          // filtering processor?
+
+          if (!pix.empty()) {
+            // we found a cluster ...
+
+            IntVec clusterCandidateIndeces;
+            FloatVec clusterCandidateCharges;
+            ClusterQuality cluQuality = kGoodCluster;
+
+            // the pixel coordinates of the seed pixels are
+            // needed later
+            int seedX = -1;
+            int seedY = -1;
+
+            // reset the pixel matrix
+            // a matrix of pixel for this cluster. it is needed
+            // for decoding issues.
+            pixelmatrix.pad(false);
+
+            // loop over all hit pixels inside this cluster
+            for (unsigned int j = 0; j < pix.size(); j++) {
+              // remove pixels, that were assigned to this
+              // cluster from the dummy sensor map. this
+              // pixel will then not be used then in other clusters
+              sensormatrix.removeHit(pix[j].x, pix[j].y);
+
+              // dont forget to apply the offset correction!
+              //                            int index =
+              //                            matrixDecoder.getIndexFromXY(pix[j].x
+              //                            + xoffset, pix[j].y + yoffset);
+
+              if (pix[j].x == i->x && pix[j].y == i->y) {
+                // this is the seed pixel!
+                seedX = pix[j].x + xoffset;
+                seedY = pix[j].y + yoffset;
+              } else {
+                // this is a neighbour pixel!
+                // nothing to do?
               }
+
+              clusterCandidateIndeces.push_back(-1);
+              cluQuality = cluQuality | kIncompleteCluster | kMergedCluster;
             }
 
-            // pix is a vector with all found "good" pixel, that
-            // were not used before in a different cluster.
-
-            // cut on the number of pixel. dont
-            // apply this cut here, use it in the
-            // filtering processor?
-
-            if (!pix.empty()) {
-              // we found a cluster ...
-
-              IntVec clusterCandidateIndeces;
-              FloatVec clusterCandidateCharges;
-              ClusterQuality cluQuality = kGoodCluster;
-
-              // the pixel coordinates of the seed pixels are
-              // needed later
-              int seedX = -1;
-              int seedY = -1;
-
-              // reset the pixel matrix
-              // a matrix of pixel for this cluster. it is needed
-              // for decoding issues.
-              pixelmatrix.pad(false);
-
-              // loop over all hit pixels inside this cluster
-              for (unsigned int j = 0; j < pix.size(); j++) {
-                // remove pixels, that were assigned to this
-                // cluster from the dummy sensor map. this
-                // pixel will then not be used then in other clusters
-                // sensormatrix.set(pix[j].x,pix[j].y,false);
-
-                std::map<unsigned int,
-                         std::map<unsigned int, bool>>::const_iterator z =
-                    sensormatrix.find(pix[j].x);
-                if (z != sensormatrix.end() &&
-                    z->second.find(pix[j].y) != z->second.end()) {
-                  sensormatrix[pix[j].x][pix[j].y] = false;
-                }
+            // sanity check
+            if (seedX == -1 || seedY == -1) {
+              streamlog_out(DEBUG5)
+                  << "a cluster was found but no seed pixel coordinates!"
+                  << endl;
+              streamlog_out(DEBUG5) << pix.size() << " " << i->x << " "
+                                    << i->y << endl;
+              exit(-1);
+            }
 
-                // dont forget to apply the offset correction!
-                //                            int index =
-                //                            matrixDecoder.getIndexFromXY(pix[j].x
-                //                            + xoffset, pix[j].y + yoffset);
+            // now lets fill the cluster pixel matrix, which is required
+            // by the decoding of the cluster into a 1d array
+            // (clusterCandidateCharges).
+            for (unsigned int j = 0; j < pix.size(); j++) {
+              // set the hits. all other pixels are by
+              // default false. the seed pixel is in the
+              // center of this matrix.
+
+              pixelmatrix.set(pix[j].x + xoffset - seedX +
+                                  _ffXClusterSize / 2,
+                              pix[j].y + yoffset - seedY +
+                                  _ffYClusterSize / 2,
+                              true);
+            }
+
+            // loop over the cluster pixels and fill them into
+            // the 1d array. The ordering of the two loops is
+            // copied from the CoG shift method of the class
+            // EUTelDFFClusterImpl
 
-                if (pix[j].x == i->x && pix[j].y == i->y) {
-                  // this is the seed pixel!
-                  seedX = pix[j].x + xoffset;
-                  seedY = pix[j].y + yoffset;
+            for (int yPixel = 0; yPixel < _ffYClusterSize; yPixel++) {
+              for (int xPixel = 0; xPixel < _ffXClusterSize; xPixel++) {
+                if (pixelmatrix.at(xPixel, yPixel)) {
+                  clusterCandidateCharges.push_back(1.0);
                 } else {
-                  // this is a neighbour pixel!
-                  // nothing to do?
+                  clusterCandidateCharges.push_back(0.0);
                 }
-
-                clusterCandidateIndeces.push_back(-1);
-                cluQuality = cluQuality | kIncompleteCluster | kMergedCluster;
               }
+            }
 
-              // sanity check
-              if (seedX == -1 || seedY == -1) {
-                streamlog_out(DEBUG5)
-                    << "a cluster was found but no seed pixel coordinates!"
-                    << endl;
-                streamlog_out(DEBUG5) << pix.size() << " " << i->x << " "
-                                      << i->y << endl;
-                exit(-1);
-              }
+            // check whether this cluster is partly outside
+            // the sensor matrix
+            if ((seedX - stepx) < minX || (seedX + stepx) > maxX ||
+                (seedY - stepy) < minY || (seedY + stepy) > maxY) {
+              cluQuality = cluQuality | kBorderCluster;
+            }
 
-              // now lets fill the cluster pixel matrix, which is required
-              // by the decoding of the cluster into a 1d array
-              // (clusterCandidateCharges).
-              for (unsigned int j = 0; j < pix.size(); j++) {
-                // set the hits. all other pixels are by
-                // default false. the seed pixel is in the
-                // center of this matrix.
-
-                pixelmatrix.set(pix[j].x + xoffset - seedX +
-                                    _ffXClusterSize / 2,
-                                pix[j].y + yoffset - seedY +
-                                    _ffYClusterSize / 2,
-                                true);
-              }
+            // the final cluster creation
 
-              // loop over the cluster pixels and fill them into
-              // the 1d array. The ordering of the two loops is
-              // copied from the CoG shift method of the class
-              // EUTelDFFClusterImpl
-
-              for (int yPixel = 0; yPixel < _ffYClusterSize; yPixel++) {
-                for (int xPixel = 0; xPixel < _ffXClusterSize; xPixel++) {
-                  if (pixelmatrix.at(xPixel, yPixel)) {
-                    clusterCandidateCharges.push_back(1.0);
-                  } else {
-                    clusterCandidateCharges.push_back(0.0);
-                  }
-                }
-              }
+            // the final result of the clustering will enter in a
+            // TrackerPulseImpl in order to be algorithm independent
 
-              // check whether this cluster is partly outside
-              // the sensor matrix
-              if ((seedX - stepx) < _minX || (seedX + stepx) > _maxX ||
-                  (seedY - stepy) < _minY || (seedY + stepy) > _maxY) {
-                cluQuality = cluQuality | kBorderCluster;
-              }
+            TrackerPulseImpl *pulse = new TrackerPulseImpl;
+            CellIDEncoder<TrackerPulseImpl> idPulseEncoder(
+                EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
+            idPulseEncoder["sensorID"] = _sensorID;
+            idPulseEncoder["xSeed"] = seedX;
+            idPulseEncoder["ySeed"] = seedY;
+            idPulseEncoder["xCluSize"] = _ffXClusterSize;
+            idPulseEncoder["yCluSize"] = _ffYClusterSize;
+            idPulseEncoder["type"] = static_cast<int>(kEUTelDFFClusterImpl);
+            idPulseEncoder.setCellID(pulse);
 
-              // the final cluster creation
-
-              // the final result of the clustering will enter in a
-              // TrackerPulseImpl in order to be algorithm independent
-
-              TrackerPulseImpl *pulse = new TrackerPulseImpl;
-              CellIDEncoder<TrackerPulseImpl> idPulseEncoder(
-                  EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
-              idPulseEncoder["sensorID"] = _sensorID;
-              idPulseEncoder["xSeed"] = seedX;
-              idPulseEncoder["ySeed"] = seedY;
-              idPulseEncoder["xCluSize"] = _ffXClusterSize;
-              idPulseEncoder["yCluSize"] = _ffYClusterSize;
-              idPulseEncoder["type"] = static_cast<int>(kEUTelDFFClusterImpl);
-              idPulseEncoder.setCellID(pulse);
-
-              TrackerDataImpl *cluster = new TrackerDataImpl;
-              CellIDEncoder<TrackerDataImpl> idClusterEncoder(
-                  EUTELESCOPE::CLUSTERDEFAULTENCODING,
-                  sparseClusterCollectionVec);
-              idClusterEncoder["sensorID"] = _sensorID;
-              idClusterEncoder["xSeed"] = seedX;
-              idClusterEncoder["ySeed"] = seedY;
-              idClusterEncoder["xCluSize"] = _ffXClusterSize;
-              idClusterEncoder["yCluSize"] = _ffYClusterSize;
-              idClusterEncoder["quality"] = static_cast<int>(cluQuality);
-              idClusterEncoder.setCellID(cluster);
-
-              streamlog_out(DEBUG0) << "  Cluster no " << clusterID << " seedX "
-                                    << seedX << " seedY " << seedY << endl;
-              /*
-                IntVec::iterator indexIter = clusterCandidateIndeces.begin();
-                while ( indexIter != clusterCandidateIndeces.end() )
-                {
-                if((*indexIter) != -1)
-                {
-                if( _dataFormatType == EUTELESCOPE::BINARY )
-                {
-                status->adcValues()[ _indexMap[(*indexIter)] ] =
-                EUTELESCOPE::HITPIXEL;
-                }else{
-                status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
-                }
-                }
-                ++indexIter;
-                }
-              */
-
-              // copy the candidate charges inside the cluster
-              cluster->setChargeValues(clusterCandidateCharges);
-              sparseClusterCollectionVec->push_back(cluster);
-
-              // continue;
-
-              EUTelDFFClusterImpl *eutelCluster =
-                  new EUTelDFFClusterImpl(cluster);
-              pulse->setCharge(eutelCluster->getTotalCharge());
-
-              delete eutelCluster;
-
-              pulse->setQuality(static_cast<int>(cluQuality));
-              pulse->setTrackerData(cluster);
-              pulseCollection->push_back(pulse);
-
-              // increment the cluster counters
-              _totClusterMap[sensorID] += 1;
-              ++clusterID;
-              if (clusterID >= MAXCLUSTERSIZE) {
-                ++limitExceed;
-                --clusterID;
-                streamlog_out(WARNING2)
-                    << "Event " << evt->getEventNumber() << " in run "
-                    << evt->getRunNumber() << " on detector " << _sensorID
-                    << " contains more than " << MAXCLUSTERSIZE << " cluster ("
-                    << clusterID + limitExceed << ")" << endl;
+            TrackerDataImpl *cluster = new TrackerDataImpl;
+            CellIDEncoder<TrackerDataImpl> idClusterEncoder(
+                EUTELESCOPE::CLUSTERDEFAULTENCODING,
+                sparseClusterCollectionVec);
+            idClusterEncoder["sensorID"] = _sensorID;
+            idClusterEncoder["xSeed"] = seedX;
+            idClusterEncoder["ySeed"] = seedY;
+            idClusterEncoder["xCluSize"] = _ffXClusterSize;
+            idClusterEncoder["yCluSize"] = _ffYClusterSize;
+            idClusterEncoder["quality"] = static_cast<int>(cluQuality);
+            idClusterEncoder.setCellID(cluster);
+
+            streamlog_out(DEBUG0) << "  Cluster no " << clusterID << " seedX "
+                                  << seedX << " seedY " << seedY << endl;
+            /*
+              IntVec::iterator indexIter = clusterCandidateIndeces.begin();
+              while ( indexIter != clusterCandidateIndeces.end() )
+              {
+              if((*indexIter) != -1)
+              {
+              if( _dataFormatType == EUTELESCOPE::BINARY )
+              {
+              status->adcValues()[ _indexMap[(*indexIter)] ] =
+              EUTELESCOPE::HITPIXEL;
+              }else{
+              status->adcValues()[(*indexIter)] = EUTELESCOPE::HITPIXEL;
+              }
+              }
+              ++indexIter;
               }
+            */
+
+            // copy the candidate charges inside the cluster
+            cluster->setChargeValues(clusterCandidateCharges);
+            sparseClusterCollectionVec->push_back(cluster);
+
+            // continue;
+
+            EUTelDFFClusterImpl *eutelCluster =
+                new EUTelDFFClusterImpl(cluster);
+            pulse->setCharge(eutelCluster->getTotalCharge());
+
+            delete eutelCluster;
+
+            pulse->setQuality(static_cast<int>(cluQuality));
+            pulse->setTrackerData(cluster);
+            pulseCollection->push_back(pulse);
+
+            // increment the cluster counters
+            _totClusterMap[sensorID] += 1;
+            ++clusterID;
+            if (clusterID >= MAXCLUSTERSIZE) {
+              ++limitExceed;
+              --clusterID;
+              streamlog_out(WARNING2)
+                  << "Event " << evt->getEventNumber() << " in run "
+                  << evt->getRunNumber() << " on detector " << _sensorID
+                  << " contains more than " << MAXCLUSTERSIZE << " cluster ("
+                  << clusterID + limitExceed << ")" << endl;
             }
           }
         }
@@ -1313,12 +1338,12 @@ void EUTelClusteringProcessor::zsFixedFrameClustering(
     if (foundexcludedsensor)
       continue;
     // now that we know which is the sensorID, we can ask to GEAR
-    // which are the minX, minY, maxX and maxY.
-    int minX, minY, maxX, maxY;
-    minX = 0;
-    minY = 0;
-
-    getMaxPixels(sensorID, maxX, maxY);
+    // which are the minX, minY, maxX and maxY. A sensor unknown to the
+    // geometry is skipped.
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    if (!getMaxPixels(sensorID, maxX, maxY)) {
+      continue;
+    }
 
     // reset the cluster counter for the clusterID
     int clusterID = 0;
@@ -1600,12 +1625,12 @@ void EUTelClusteringProcessor::zsBrickedClustering(
     int sensorID = static_cast<int>(cellDecoder(zsData)["sensorID"]);
 
     // now that we know which is the sensorID, we can ask to GEAR
-    // which are the minX, minY, maxX and maxY.
-    int minX, minY, maxX, maxY;
-    minX = 0;
-    minY = 0;
-
-    getMaxPixels(sensorID, maxX, maxY);
+    // which are the minX, minY, maxX and maxY. A sensor unknown to the
+    // geometry is skipped.
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    if (!getMaxPixels(sensorID, maxX, maxY)) {
+      continue;
+    }
 
     // reset the cluster counter for the clusterID
     int clusterID = 0;
@@ -2266,12 +2291,12 @@ void EUTelClusteringProcessor::fixedFrameClustering(
     if (foundexcludedsensor)
       continue;
     // now that we know which is the sensorID, we can ask to GEAR
-    // which are the minX, minY, maxX and maxY.
-    int minX, minY, maxX, maxY;
-    minX = 0;
-    minY = 0;
-
-    getMaxPixels(sensorID, maxX, maxY);
+    // which are the minX, minY, maxX and maxY. A sensor unknown to the
+    // geometry is skipped.
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    if (!getMaxPixels(sensorID, maxX, maxY)) {
+      continue;
+    }
 
     streamlog_out(DEBUG0) << "  Working on detector " << sensorID << endl;
 
@@ -2290,17 +2315,17 @@ void EUTelClusteringProcessor::fixedFrameClustering(
     short clusterCounter = 0;
     short limitExceed = 0;
 
-    _seedCandidateMap.clear();
+    const FloatVec &charges = nzsData->getChargeValues();
+    const FloatVec &noiseValues = noise->getChargeValues();
+    const ShortVec &statusValues = status->getADCValues();
 
-    for (unsigned int iPixel = 0; iPixel < nzsData->getChargeValues().size();
-         iPixel++) {
-      if (status->getADCValues()[iPixel] == EUTELESCOPE::GOODPIXEL) {
-        if (nzsData->getChargeValues()[iPixel] >
-            _ffSeedCut * noise->getChargeValues()[iPixel]) {
-          _seedCandidateMap.push_back(
-              make_pair(nzsData->getChargeValues()[iPixel], iPixel));
-        }
-      }
+    if (_rawDataCollectionName.empty()) {
+      _seedFinder.findCandidates(charges, noiseValues, statusValues,
+                                 static_cast<short>(EUTELESCOPE::GOODPIXEL),
+                                 _ffSeedCut, _seedCandidateMap);
+    } else {
+      // already found by calibrateRawData
+      _seedCandidateMap.swap(_calibratedCandidateMap[sensorID]);
     }
 
     // continue only if seed candidate map is not empty!
@@ -2309,16 +2334,15 @@ void EUTelClusteringProcessor::fixedFrameClustering(
       streamlog_out(DEBUG0) << "There are << " << _seedCandidateMap.size()
                             << " seed candidates." << endl;
 
-      // now built up a cluster for each seed candidate
-      // Start by sorting the vector in order of smallest to largest seed signal
-      std::sort(_seedCandidateMap.begin(), _seedCandidateMap.end());
-      vector<pair<float, unsigned int>>::iterator mapIter =
-          _seedCandidateMap.end();
-      while (mapIter != _seedCandidateMap.begin()) {
-        --mapIter;
+      // now built up a cluster for each seed candidate, starting from
+      // the largest seed signal
+      EUTelSeedFinder::orderCandidates(_seedCandidateMap);
+      while (!_seedCandidateMap.empty()) {
+        const EUTelSeedFinder::Candidate candidate =
+            EUTelSeedFinder::popCandidate(_seedCandidateMap);
         // check if this seed candidate has not been already added to a
         // cluster
-        if (status->adcValues()[(*mapIter).second] == EUTELESCOPE::GOODPIXEL) {
+        if (statusValues[candidate.second] == EUTELESCOPE::GOODPIXEL) {
           // if we enter here, this means that at least the seed pixel
           // wasn't added yet to another cluster.  Note that now we need
           // to build a candidate cluster that has to pass the
@@ -2328,7 +2352,7 @@ void EUTelClusteringProcessor::fixedFrameClustering(
           FloatVec clusterCandidateCharges;
           IntVec clusterCandidateIndeces;
           int seedX, seedY;
-          matrixDecoder.getXYFromIndex((*mapIter).second, seedX, seedY);
+          matrixDecoder.getXYFromIndex(candidate.second, seedX, seedY);
 
           // start looping around the seed pixel. Remember that the seed
           // pixel has to stay in the center of cluster
@@ -2342,10 +2366,8 @@ void EUTelClusteringProcessor::fixedFrameClustering(
                   (yPixel <= maxY)) {
                 int index = matrixDecoder.getIndexFromXY(xPixel, yPixel);
 
-                bool isHit =
-                    (status->getADCValues()[index] == EUTELESCOPE::HITPIXEL);
-                bool isGood =
-                    (status->getADCValues()[index] == EUTELESCOPE::GOODPIXEL);
+                bool isHit = (statusValues[index] == EUTELESCOPE::HITPIXEL);
+                bool isGood = (statusValues[index] == EUTELESCOPE::GOODPIXEL);
 
                 if (isGood)
                   clusterCandidateIndeces.push_back(index);
@@ -2353,11 +2375,10 @@ void EUTelClusteringProcessor::fixedFrameClustering(
                   clusterCandidateIndeces.push_back(-1);
 
                 if (isGood && !isHit) {
-                  clusterCandidateSignal += nzsData->getChargeValues()[index];
-                  clusterCandidateNoise2 +=
-                      pow(noise->getChargeValues()[index], 2);
-                  clusterCandidateCharges.push_back(
-                      nzsData->getChargeValues()[index]);
+                  const double pixelNoise = noiseValues[index];
+                  clusterCandidateSignal += charges[index];
+                  clusterCandidateNoise2 += pixelNoise * pixelNoise;
+                  clusterCandidateCharges.push_back(charges[index]);
                 } else if (isHit) {
                   // this can be a good place to flag the current
                   // cluster as kMergedCluster, but it would introduce
@@ -2467,6 +2488,121 @@ void EUTelClusteringProcessor::fixedFrameClustering(
   }
 }
 
+void EUTelClusteringProcessor::calibrateRawData(LCEvent *evt) {
+
+  LCCollectionVec *rawDataCollectionVec = dynamic_cast<LCCollectionVec *>(
+      evt->getCollection(_rawDataCollectionName));
+  LCCollectionVec *pedestalCollectionVec = nullptr;
+  shared_ptr<const EUTelConditionsCache::SensorIndexMap> pedestalIndices;
+  try {
+    pedestalCollectionVec = dynamic_cast<LCCollectionVec *>(
+        evt->getCollection(_pedestalCollectionName));
+    pedestalIndices = EUTelConditionsCache::getInstance().getSensorIndices(
+        evt, _pedestalCollectionName);
+  } catch (lcio::DataNotAvailableException &e) {
+    streamlog_out(WARNING2) << "No pedestal collection found in the event "
+                            << evt->getEventNumber() << endl;
+    throw SkipEventException(this);
+  }
+  if (noiseCollectionVec == nullptr || statusCollectionVec == nullptr) {
+    streamlog_out(WARNING2) << "No noise or status collection found in the "
+                               "event "
+                            << evt->getEventNumber() << endl;
+    throw SkipEventException(this);
+  }
+
+  // the calibrated frames are kept from one event to the next, so
+  // that their charge vectors are not reallocated
+  if (_calibratedCollection == nullptr ||
+      _calibratedCollection->size() != rawDataCollectionVec->size()) {
+    delete _calibratedCollection;
+    _calibratedCollection = new LCCollectionVec(LCIO::TRACKERDATA);
+    for (size_t i = 0; i < rawDataCollectionVec->size(); ++i) {
+      _calibratedCollection->push_back(new TrackerDataImpl);
+    }
+  }
+
+  CellIDDecoder<TrackerRawDataImpl> rawDecoder(rawDataCollectionVec);
+  CellIDEncoder<TrackerDataImpl> idDataEncoder(
+      EUTELESCOPE::MATRIXDEFAULTENCODING, _calibratedCollection);
+
+  for (size_t iDetector = 0; iDetector < rawDataCollectionVec->size();
+       ++iDetector) {
+    TrackerRawDataImpl *rawData = dynamic_cast<TrackerRawDataImpl *>(
+        rawDataCollectionVec->getElementAt(iDetector));
+    TrackerDataImpl *calibrated = dynamic_cast<TrackerDataImpl *>(
+        _calibratedCollection->getElementAt(iDetector));
+
+    int sensorID = rawDecoder(rawData)["sensorID"];
+    int xMin = rawDecoder(rawData)["xMin"];
+    int xMax = rawDecoder(rawData)["xMax"];
+    idDataEncoder["sensorID"] = sensorID;
+    idDataEncoder["xMin"] = xMin;
+    idDataEncoder["xMax"] = xMax;
+    idDataEncoder["yMin"] = static_cast<int>(rawDecoder(rawData)["yMin"]);
+    idDataEncoder["yMax"] = static_cast<int>(rawDecoder(rawData)["yMax"]);
+    idDataEncoder.setCellID(calibrated);
+
+    auto pedestalIter = pedestalIndices->find(sensorID);
+    if (pedestalIter == pedestalIndices->end()) {
+      stringstream ss;
+      ss << "No pedestal for detector " << sensorID << " in "
+         << _pedestalCollectionName;
+      throw IncompatibleDataSetException(ss.str());
+    }
+    TrackerDataImpl *pedestal = dynamic_cast<TrackerDataImpl *>(
+        pedestalCollectionVec->getElementAt(pedestalIter->second));
+    size_t ancillaryPos = _ancillaryIndexMap[sensorID];
+    TrackerDataImpl *noise = dynamic_cast<TrackerDataImpl *>(
+        noiseCollectionVec->getElementAt(ancillaryPos));
+    TrackerRawDataImpl *status = dynamic_cast<TrackerRawDataImpl *>(
+        statusCollectionVec->getElementAt(ancillaryPos));
+
+    // the pixels of the previous event clusters are good again before
+    // the seed search
+    resetStatus(status);
+
+    if (!_frameCalibrator.calibrate(
+            rawData->getADCValues(), pedestal->getChargeValues(),
+            noise->getChargeValues(), status->getADCValues(),
+            static_cast<size_t>(xMax - xMin + 1),
+            static_cast<short>(EUTELESCOPE::GOODPIXEL), _ffSeedCut,
+            calibrated->chargeValues(), _calibratedCandidateMap[sensorID])) {
+      if (_doCommonMode == EUTelFrameCalibrator::kFullFrameCommonMode) {
+        streamlog_out(WARNING4)
+            << "Skipping event " << evt->getEventNumber()
+            << " because of maximum number of pixel exceeded ("
+            << _frameCalibrator.getNoOfSkippedPixels() << ")" << endl;
+      } else {
+        streamlog_out(WARNING4)
+            << "Skipping event " << evt->getEventNumber()
+            << " because of maximum number of skipped row exceeded ("
+            << _frameCalibrator.getNoOfSkippedRows() << ")" << endl;
+      }
+      throw SkipEventException(this);
+    }
+  }
+
+  nzsInputDataCollectionVec = _calibratedCollection;
+
+  if (!_calibratedDataCollectionName.empty()) {
+    LCCollectionVec *calibratedDataCollection =
+        new LCCollectionVec(LCIO::TRACKERDATA);
+    calibratedDataCollection->parameters().setValue(
+        LCIO::CellIDEncoding, EUTELESCOPE::MATRIXDEFAULTENCODING);
+    for (size_t i = 0; i < _calibratedCollection->size(); ++i) {
+      TrackerDataImpl *calibrated = dynamic_cast<TrackerDataImpl *>(
+          _calibratedCollection->getElementAt(i));
+      TrackerDataImpl *copy = new TrackerDataImpl;
+      copy->setCellID0(calibrated->getCellID0());
+      copy->setChargeValues(calibrated->getChargeValues());
+      calibratedDataCollection->push_back(copy);
+    }
+    evt->addCollection(calibratedDataCollection,
+                       _calibratedDataCollectionName);
+  }
+}
+
 void EUTelClusteringProcessor::nzsBrickedClustering(
     LCEvent *evt, LCCollectionVec *pulseCollection) {
   streamlog_out(DEBUG4) << "Looking for clusters in the RAW data with "
@@ -2540,12 +2676,12 @@ void EUTelClusteringProcessor::nzsBrickedClustering(
     int sensorID = static_cast<int>(cellDecoder(nzsData)["sensorID"]);
 
     // now that we know which is the sensorID, we can ask to GEAR
-    // which are the minX, minY, maxX and maxY.
-    int minX, minY, maxX, maxY;
-    minX = 0;
-    minY = 0;
-
-    getMaxPixels(sensorID, maxX, maxY);
+    // which are the minX, minY, maxX and maxY. A sensor unknown to the
+    // geometry is skipped.
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    if (!getMaxPixels(sensorID, maxX, maxY)) {
+      continue;
+    }
 
     // get the noise and the status matrix with the right detectorID
     TrackerDataImpl *noise = dynamic_cast<TrackerDataImpl *>(
@@ -2906,6 +3042,9 @@ void EUTelClusteringProcessor::end() {
                             << " clusters on detector " << iter->first << endl;
     ++iter;
   }
+
+  delete _calibratedCollection;
+  _calibratedCollection = nullptr;
 }
 
 void EUTelClusteringProcessor::resetStatus(IMPL::TrackerRawDataImpl *status) {
@@ -3561,7 +3700,7 @@ void EUTelClusteringProcessor::bookHistos() {
   streamlog_out(DEBUG5) << "end of Booking histograms " << endl;
 }
 
-void EUTelClusteringProcessor::getMaxPixels(int sensorID, int &maxX,
+bool EUTelClusteringProcessor::getMaxPixels(int sensorID, int &maxX,
                                             int &maxY) {
   try {
     maxX = geo::gGeometry().getPlaneNumberOfPixelsX(sensorID) - 1;
@@ -3573,8 +3712,9 @@ void EUTelClusteringProcessor::getMaxPixels(int sensorID, int &maxX,
     // sensorID ));
     streamlog_out(ERROR5) << "Unknown sensorID " << sensorID
                           << ", perhaps your GEAR file is incomplete." << endl;
-    return;
+    return false;
   }
+  return true;
 }
 
 #endif
@@ -28,6 +28,7 @@
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelSimpleVirtualCluster.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelTrackHitAssociation.h"
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 #include <AIDA/IHistogram1D.h>
@@ -288,11 +289,17 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
   }
 #endif
 
-  // Match measured and fitted positions
+  // Match measured and fitted positions: every track, one after the
+  // other, takes the closest DUT hit not taken yet. The hits are looked
+  // up in a grid, matched hits are only flagged, so that the hit indices
+  // stay valid for the cluster information.
 
   int nMatch = 0;
   double distmin;
 
+  EUTelTrackHitAssociation association(_distMax);
+  association.setHits(_measuredX, _measuredY);
+
   for (int itrack = 0; itrack < _maptrackid; itrack++) {
     int bestfit = -1;
     int besthit = -1;
@@ -304,37 +311,30 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
 
     for (int ifit = 0; ifit < static_cast<int>(_fittedX[itrack].size());
          ifit++) {
-      if (_measuredX.empty())
-        continue;
-
-      for (int ihit = 0; ihit < static_cast<int>(_measuredX.size()); ihit++) {
-
-        double dist2rd = (_measuredX[ihit] - _fittedX[itrack][ifit]) *
-                             (_measuredX[ihit] - _fittedX[itrack][ifit]) +
-                         (_measuredY[ihit] - _fittedY[itrack][ifit]) *
-                             (_measuredY[ihit] - _fittedY[itrack][ifit]);
-
-        if (streamlog_level(DEBUG5)) {
-          message<DEBUG5>(log() << "Fit [" << itrack << ":" << _maptrackid
-                                << "], ifit= " << ifit << " ["
-                                << _fittedX[itrack][ifit] << ":"
-                                << _fittedY[itrack][ifit] << "]" << endl);
-          message<DEBUG5>(log() << "rec " << ihit << " [" << _measuredX[ihit]
-                                << ":" << _measuredY[ihit] << "]" << endl);
-          message<DEBUG5>(log() << "distance : " << TMath::Sqrt(dist2rd)
-                                << endl);
-        }
-        if (dist2rd < distmin) {
-          distmin = dist2rd;
-          besthit = ihit;
-          bestfit = ifit;
-        }
+      double dist2rd;
+      int ihit = association.findClosestFreeHit(
+          _fittedX[itrack][ifit], _fittedY[itrack][ifit], dist2rd);
+
+      if (ihit >= 0 && dist2rd < distmin) {
+        distmin = dist2rd;
+        besthit = ihit;
+        bestfit = ifit;
       }
     }
 
     // Match found:
 
-    if (distmin < _distMax * _distMax) {
+    if (besthit >= 0) {
+
+      if (streamlog_level(DEBUG5)) {
+        message<DEBUG5>(log() << "Fit [" << itrack << ":" << _maptrackid
+                              << "], ifit= " << bestfit << " ["
+                              << _fittedX[itrack][bestfit] << ":"
+                              << _fittedY[itrack][bestfit] << "] matched to rec "
+                              << besthit << " [" << _measuredX[besthit] << ":"
+                              << _measuredY[besthit] << "], distance : "
+                              << TMath::Sqrt(distmin) << endl);
+      }
 
       nMatch++;
 
@@ -536,14 +536,13 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
 
 #endif
 
-      // Remove matched entries from the list (so the next matching pair
-      // can be looked for)
+      // Remove the matched fit from the list and flag the hit (so the
+      // next matching pair can be looked for)
 
       _fittedX[itrack].erase(_fittedX[itrack].begin() + bestfit);
       _fittedY[itrack].erase(_fittedY[itrack].begin() + bestfit);
 
-      _measuredX.erase(_measuredX.begin() + besthit);
-      _measuredY.erase(_measuredY.begin() + besthit);
+      association.setUsed(static_cast<size_t>(besthit));
 
       _localX[itrack].erase(_localX[itrack].begin() + bestfit);
       _localY[itrack].erase(_localY[itrack].begin() + bestfit);
@@ -553,7 +552,7 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
 
     if (streamlog_level(DEBUG5)) {
       message<DEBUG5>(log() << nMatch << " DUT hits matched to fitted tracks ");
-      message<DEBUG5>(log() << _measuredX.size()
+      message<DEBUG5>(log() << _measuredX.size() - nMatch
                             << " DUT hits not matched to any track ");
       message<DEBUG5>(
           log() << "track " << itrack << " has " << _fittedX[itrack].size()
@@ -587,6 +586,9 @@ void EUTelDUTHistograms::processEvent(LCEvent *event) {
   // Noise plots - unmatched hits
 
   for (int ihit = 0; ihit < static_cast<int>(_measuredX.size()); ihit++) {
+    if (association.isUsed(static_cast<size_t>(ihit)))
+      continue;
+
     (dynamic_cast<AIDA::IProfile1D *>(_NoiseHistos.at(projX)))
         ->fill(_measuredX[ihit], 1.);
     (dynamic_cast<AIDA::IProfile1D *>(_NoiseHistos.at(projY)))
@@ -66,6 +66,7 @@
 #include <Exceptions.h>
 
 // system includes <>
+#include <array>
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -121,6 +122,8 @@ EUTelGBLFitter::EUTelGBLFitter() : Processor("EUTelGBLFitter"), _inputCollection
   registerOptionalParameter( "DUTXResolutions", "Same as TelescopeResolution, but now only for y-direction. Also, there needs to be an additional leading NEGATIVE number for the sensorID. E.g. -20 0.5 0.7 0.4 0.3 would correspond to <sensorID (20)> <avg> <CS 1> <CS 2> <CS greater 2>, this could be followed by a further section which again starts with a negative number for the next sensorID", _dutResolutionX, FloatVec(8, 3.5*1e-3));
 
   registerOptionalParameter( "DUTYResolutions", "Same as DUTXResolutions but in y-direction.", _dutResolutionY, FloatVec(8., 3.5*1e-3));
+
+  registerOptionalParameter( "UseFixedTopologyFit", "Fit six plane tracks with the specialised straight line GBL fit with precomputed topology instead of the generic GBL trajectory. Other set-ups always use the generic GBL fit. Off until the gblfitbenchmark test against GBL passes.", _useFixedTopologyFit, false);
 }
 
 void EUTelGBLFitter::init() {
@@ -169,6 +172,27 @@ void EUTelGBLFitter::init() {
     _planeWscatAir.emplace_back( 1.0/(tetAir*tetAir), 1.0/(tetAir*tetAir) );
   }
 
+  //The trajectory of a six plane telescope is the same for all tracks: each plane
+  //followed by two air scatterers at 21% and 79% of the gap to the next plane
+  _fixedFitter.reset();
+  if(_useFixedTopologyFit && _nPlanes == 6) {
+    std::array<double, 15> steps;
+    SixPlaneGBLFitter::PointVector2dArray scatPrecision;
+    for(size_t ipl = 0; ipl < _nPlanes; ++ipl) {
+      scatPrecision[3*ipl] = _planeWscatSi[ipl];
+      if(ipl < 5) {
+        double distplane = _planePosition[ipl+1] - _planePosition[ipl];
+        steps[3*ipl] = 0.21*distplane;
+        steps[3*ipl+1] = 0.58*distplane;
+        steps[3*ipl+2] = 0.21*distplane;
+        scatPrecision[3*ipl+1] = _planeWscatAir[ipl];
+        scatPrecision[3*ipl+2] = _planeWscatAir[ipl];
+      }
+    }
+    _fixedFitter.reset(new SixPlaneGBLFitter(steps, scatPrecision));
+    streamlog_out(MESSAGE4) << "Using the fixed topology GBL fit for the six plane telescope" << std::endl;
+  }
+
   streamlog_out(MESSAGE0) << "Beam energy " << _eBeam << " GeV" <<  std::endl;
 
   for(auto& sensorID: _sensorIDVec) {
@@ -265,6 +289,35 @@ void EUTelGBLFitter::init() {
 }//init
 
 //------------------------------------------------------------------------------
+std::vector<gbl::GblPoint> EUTelGBLFitter::trajectoryPoints( std::vector<Eigen::Vector2d> const & meas,
+                                                               std::vector<Eigen::Vector2d> const & measPrec ) {
+  //Each plane is followed by two air scatterers, the measurements are indexed
+  //by GBL point and points without measurement have precision zero
+  Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
+  Eigen::Vector2d scat = Eigen::Vector2d::Zero();
+  std::vector<gbl::GblPoint> points;
+
+  double step = 0.;
+  for( size_t ipl = 0; ipl < _nPlanes; ++ipl ){
+    points.emplace_back( gblutil.JacobianPointToPoint( step ) );
+    size_t ipoint = points.size()-1;
+    if( !measPrec[ipoint].isZero() ) {
+      points.back().addMeasurement( proL2m, meas[ipoint], measPrec[ipoint] );
+    }
+    points.back().addScatterer( scat, _planeWscatSi[ipl] );
+
+    if( ipl < 5) {
+      double distplane = _planePosition[ipl+1] - _planePosition[ipl];
+      points.emplace_back( gblutil.JacobianPointToPoint( 0.21*distplane ) );
+      points.back().addScatterer( scat, _planeWscatAir[ipl] );
+      points.emplace_back( gblutil.JacobianPointToPoint( 0.58*distplane ) );
+      points.back().addScatterer( scat, _planeWscatAir[ipl] );
+      step = 0.21*distplane; // remaing distance to next plane
+    }
+  }
+  return points;
+}
+
 void EUTelGBLFitter::processRunHeader( LCRunHeader* runHeader) {
   // we want the gblutil class (which is NOT a marlin processor) to be able to write its own histograms, but into the same root file of the processor class, which uses the util class. Therefore, we let gblutil know its parent, which knows about the AIDA histogram handle
   gblutil.setParent(this);
@@ -623,23 +676,15 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
     double dx = xB - xA; // driplet - triplet
     double dy = yB - yA;
 
-    // GBL with triplet A as seed:
-    std::vector<gbl::GblPoint> traj_points;
-
     // build up trajectory:
     std::vector<double> sPoint;
 
     // plane 0:
     double s = 0;
 
-    Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
-
     //double res = 3.42E-3; // [mm] Anemone telescope intrinsic resolution
     //res = 4.5E-3; // EUDET
 
-    // scatter:
-    Eigen::Vector2d scat = Eigen::Vector2d::Zero(); //mean is zero
-    
     std::vector<unsigned int> ilab;
     std::map<size_t, size_t> ilabToSensorID;
 
@@ -652,6 +697,12 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
     std::vector<double> trackhityloc (_nPlanes, -1.0);
     std::vector<bool> hasHit (_nPlanes, false);
 
+    //The measurements are collected indexed by GBL point, both the fixed topology
+    //fit and the GBL trajectory built by trajectoryPoints() use them
+    bool useGBL = !_fixedFitter;
+    std::vector<Eigen::Vector2d> pointMeas;
+    std::vector<Eigen::Vector2d> pointMeasPrec;
+
     double step = 0.;
     s = 0.;
     for( size_t ipl = 0; ipl < _nPlanes; ++ipl ){
@@ -672,7 +723,8 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
       //if there is no hit we take the plane position from the geo description
       //double zz = trackhit ? trackhit->z : _planePosition[ipl];// [mm]
 
-      auto point = gbl::GblPoint( gblutil.JacobianPointToPoint( step ) );
+      pointMeas.push_back( Eigen::Vector2d::Zero() );
+      pointMeasPrec.push_back( Eigen::Vector2d::Zero() );
 
       if(trackhit){
         //fill the trackhit relevant histograms
@@ -706,7 +758,8 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
         //The measurement is only included if it is a non excluded plane
         auto currentSensorID = _sensorIDVec[ipl];
         if( !_excludedSensorMap[currentSensorID]  ) {
-          point.addMeasurement( proL2m, meas, measPrec );
+          pointMeas.back() = meas;
+          pointMeasPrec.back() = measPrec;
         }
 
         // monitor what we put into GBL:
@@ -728,11 +781,9 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
         seldx5Histo->fill( rx[5]*1E3 );
         seldy5Histo->fill( ry[5]*1E3 );
       }  
-      point.addScatterer( scat, _planeWscatSi[ipl] );
 
       // streamlog_out(DEBUG4) << "Added Scatterer:\n" << _planeWscatSi[ipl] << std::endl; 
       // streamlog_out(DEBUG4) << "Meas Precision:\n" << measPrec << std::endl; 
-      traj_points.emplace_back(point);
       s += step;
       sPoint.push_back( s );
       ilab.push_back( sPoint.size() );
@@ -741,19 +792,16 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
       if( ipl < 5) {
         double distplane = _planePosition[ipl+1] - _planePosition[ipl];
         step = 0.21*distplane;
-
-        auto point = gbl::GblPoint( gblutil.JacobianPointToPoint( step ) );
-        point.addScatterer( scat, _planeWscatAir[ipl] );
+        pointMeas.push_back( Eigen::Vector2d::Zero() );
+        pointMeasPrec.push_back( Eigen::Vector2d::Zero() );
         s += step;
-        traj_points.push_back(point);
         sPoint.push_back( s );
 
         // streamlog_out(DEBUG4) << "Added Air Scatterer:\n" << _planeWscatAir[ipl] << "\nat: " << s << std::endl; 
         step = 0.58*distplane;
-        auto point1 = gbl::GblPoint( gblutil.JacobianPointToPoint( step ) );
-        point1.addScatterer( scat, _planeWscatAir[ipl] );
+        pointMeas.push_back( Eigen::Vector2d::Zero() );
+        pointMeasPrec.push_back( Eigen::Vector2d::Zero() );
         s += step;
-        traj_points.push_back(point1);
         sPoint.push_back( s );
         // streamlog_out(DEBUG4) << "Added Air Scatterer:\n" << _planeWscatAir[ipl] << "\nat :" << s << std::endl; 
 	      
@@ -765,13 +813,34 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
     int Ndf;
     double lostWeight;
 
-    gbl::GblTrajectory traj(traj_points, false ); // curvature = false
-    std::string fit_optionList = "";
-    traj.fit( Chi2, Ndf, lostWeight, fit_optionList );
+    std::unique_ptr<gbl::GblTrajectory> traj;
+    SixPlaneGBLFitter::Result fixedResult;
+    bool trajValid = true;
+    if(!useGBL) {
+      SixPlaneGBLFitter::PointVector2dArray fixedMeas;
+      SixPlaneGBLFitter::PointVector2dArray fixedMeasPrec;
+      std::copy( pointMeas.begin(), pointMeas.end(), fixedMeas.begin() );
+      std::copy( pointMeasPrec.begin(), pointMeasPrec.end(), fixedMeasPrec.begin() );
+      if(_fixedFitter->fit(fixedMeas, fixedMeasPrec, fixedResult)) {
+        Chi2 = fixedResult.getChi2();
+        Ndf = fixedResult.getNdf();
+        lostWeight = 0.;
+      } else {
+        //Tracks the fixed topology cannot fit are not lost, they get the generic GBL fit
+        streamlog_out(DEBUG4) << "Fixed topology fit failed, using the generic GBL fit for this track" << std::endl;
+        useGBL = true;
+      }
+    }
+    if(useGBL) {
+      traj.reset(new gbl::GblTrajectory(trajectoryPoints(pointMeas, pointMeasPrec), false )); // curvature = false
+      std::string fit_optionList = "";
+      traj->fit( Chi2, Ndf, lostWeight, fit_optionList );
+      trajValid = traj->isValid();
+    }
 
     // debug:
     if(_printEventCounter < 10){
-      streamlog_out(MESSAGE4) << "traj with " << traj.getNumPoints() << " points:" << endl;
+      streamlog_out(MESSAGE4) << "traj with " << sPoint.size() << " points:" << endl;
       for( unsigned int ipl = 0; ipl < sPoint.size(); ++ipl ){
         streamlog_out(DEBUG4) << "  GBL point " << ipl;
         streamlog_out(DEBUG4) << "  z " << sPoint[ipl]; 
@@ -787,7 +856,7 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
         streamlog_out(DEBUG4) << endl;
       }
 
-      streamlog_out(DEBUG4)  << " Is traj valid? " << traj.isValid() << std::endl;
+      streamlog_out(DEBUG4)  << " Is traj valid? " << trajValid << std::endl;
       _printEventCounter++;
     }
 
@@ -863,9 +932,19 @@ void EUTelGBLFitter::processEvent( LCEvent * event ) {
         ipos = ilab[ipl];
         currentSensor = ilabToSensorID[ipos];
 
-        traj.getResults( ipos, aCorrection, aCovariance );
-        traj.getMeasResults( ipos, ndata, aResiduals, aMeasErrors, aResErrors, aDownWeights );
-        traj.getScatResults( ipos, ndata, aKinks, aKinkErrors, kResErrors, kDownWeights );
+        if(useGBL) {
+          traj->getResults( ipos, aCorrection, aCovariance );
+          traj->getMeasResults( ipos, ndata, aResiduals, aMeasErrors, aResErrors, aDownWeights );
+          traj->getScatResults( ipos, ndata, aKinks, aKinkErrors, kResErrors, kDownWeights );
+        } else {
+          //same layout as the GBL local parameters: q/p, x', y', x, y
+          int ipoint = static_cast<int>(ipos) - 1;
+          aCorrection.resize(5);
+          aCorrection << 0., fixedResult.getSlope(ipoint, 0), fixedResult.getSlope(ipoint, 1),
+                         fixedResult.getOffset(ipoint, 0), fixedResult.getOffset(ipoint, 1);
+          aResErrors << fixedResult.getMeasResidualError(ipoint, 0), fixedResult.getMeasResidualError(ipoint, 1);
+          aKinks << fixedResult.getKinkResidual(ipoint, 0), fixedResult.getKinkResidual(ipoint, 1);
+        }
 
         aResiduals[0] = rx[ipl] - aCorrection[3];
         aResiduals[1] = ry[ipl] - aCorrection[4];
@@ -40,6 +40,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdio>
+#include <cmath>
 
 using namespace std;
 using namespace marlin;
@@ -63,7 +64,12 @@ _missingHitPos ( 0 ),
 _knownHitPos ( 0 ),
 _nDutHits ( 0 ),
 _nDutHitsCreated ( 0 ),
-_maxExpectedCreatedHitPerDUTHit ( 10 )
+_maxExpectedCreatedHitPerDUTHit ( 10 ),
+_referenceHits1 ( ),
+_referenceHits2 ( ),
+_sortedReferenceHits2 ( ),
+_sortedKnownPos2 ( ),
+_candidates ( )
 {
     // modify processor description
     _description =  "EUTelMissingCoordinateEstimator:This processor estimates the missing coordinate on a strip sensor by extrapolating a straight line from two reference planes. No promises that this will work with tilted sensors and/or with magnetic fields. The merged input hits should be pre aligned for better results.";
@@ -81,6 +87,8 @@ _maxExpectedCreatedHitPerDUTHit ( 10 )
     registerProcessorParameter ( "MaxResidual", "This processor will look for hits in the known coordinate to determine if the hits are correlated. The hits will be considered as correlated if the residual is smaller than MaxResidual", _maxResidual, float ( 10.0 ) );
 
     registerProcessorParameter ( "MultiHitMode", "Allow an individual DUT hit to be transformed into multiple hits? If false, only the closest extrapolated position will be used.", _multihitmode, true );
+
+    registerProcessorParameter ( "FillAllPairHistograms", "Extrapolate all the reference hit pairs to fill the pointhitmap, failhitmap and faildistance histograms. If false, only the pairs which can pass MaxResidual are extrapolated. The created hits are the same.", _fillAllPairHistos, false );
     
 
 }
@@ -233,6 +241,41 @@ void EUTelMissingCoordinateEstimator::processEvent ( LCEvent * event )
 	}
     }
 
+    // copy the reference hit positions once per event, the second plane
+    // is also sorted along the known coordinate
+    fillReferenceHits ( inputHitCollection, referencePlaneHits1, _referenceHits1 );
+    fillReferenceHits ( inputHitCollection, referencePlaneHits2, _referenceHits2 );
+
+    _sortedReferenceHits2.resize ( _referenceHits2.size ( ) );
+    for ( unsigned int j = 0; j < _referenceHits2.size ( ); j++ )
+    {
+	_sortedReferenceHits2[j] = j;
+    }
+    std::sort ( _sortedReferenceHits2.begin ( ), _sortedReferenceHits2.end ( ), [this] ( int a, int b ) { return _referenceHits2[a].pos[_knownHitPos] < _referenceHits2[b].pos[_knownHitPos]; } );
+    _sortedKnownPos2.clear ( );
+    for ( unsigned int j = 0; j < _sortedReferenceHits2.size ( ); j++ )
+    {
+	_sortedKnownPos2.push_back ( _referenceHits2[_sortedReferenceHits2[j]].pos[_knownHitPos] );
+    }
+
+    // z range of the reference planes, used to bound the extrapolation parameter
+    double z1Min = 0, z1Max = 0, z2Min = 0, z2Max = 0;
+    if ( !_referenceHits1.empty ( ) && !_referenceHits2.empty ( ) )
+    {
+	z1Min = z1Max = _referenceHits1[0].pos[2];
+	for ( unsigned int i = 0; i < _referenceHits1.size ( ); i++ )
+	{
+	    z1Min = std::min ( z1Min, _referenceHits1[i].pos[2] );
+	    z1Max = std::max ( z1Max, _referenceHits1[i].pos[2] );
+	}
+	z2Min = z2Max = _referenceHits2[0].pos[2];
+	for ( unsigned int j = 0; j < _referenceHits2.size ( ); j++ )
+	{
+	    z2Min = std::min ( z2Min, _referenceHits2[j].pos[2] );
+	    z2Max = std::max ( z2Max, _referenceHits2[j].pos[2] );
+	}
+    }
+
     /*
      The line that passes through 2 points can be written as L(t)= P1 + V*t
      where V is the displacement vector and P1 is the starting point
@@ -242,55 +285,65 @@ void EUTelMissingCoordinateEstimator::processEvent ( LCEvent * event )
      * z=z1+(z2−z1)t
      */
 
-    // ugly way, to be optimised
-    if ( _multihitmode == true )
+    // loop over DUT hits
+    for ( unsigned int k = 0; k < dutPlaneHits.size ( ); k++ )
     {
-	// loop over DUT hits
-	for ( unsigned int k = 0; k < dutPlaneHits.size ( ); k++ )
+	TrackerHitImpl * dutHit = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlaneHits[k] ) );
+	const double* dutHitPos = dutHit -> getPosition ( );
+	double newDutHitPos[3] = { dutHitPos[0], dutHitPos[1], dutHitPos[2] };
+
+	// t = (z-z1)/(z2-z1) is monotonic in z1 and z2 as long as the planes
+	// do not overlap in z, so its range is given by the corners
+	bool useWindow = !_fillAllPairHistos && !_referenceHits1.empty ( ) && ( z2Min > z1Max || z2Max < z1Min );
+	double tMin = 0;
+	double tMax = 0;
+	if ( useWindow )
+	{
+	    const double corners[4] = { ( dutHitPos[2] - z1Min ) / ( z2Min - z1Min ), ( dutHitPos[2] - z1Min ) / ( z2Max - z1Min ), ( dutHitPos[2] - z1Max ) / ( z2Min - z1Max ), ( dutHitPos[2] - z1Max ) / ( z2Max - z1Max ) };
+	    tMin = *std::min_element ( corners, corners + 4 );
+	    tMax = *std::max_element ( corners, corners + 4 );
+
+	    // close to the first plane any hit of the second one can pair
+	    useWindow = ( tMin > 0 || tMax < 0 );
+	}
+
+	int hitsperhit = 0;
+	bool foundhit = false;
+	double closestresidual = _maxResidual;
+
+	// loop over first reference plane hits
+	for ( unsigned int i = 0; i < _referenceHits1.size ( ); i++ )
 	{
-	    TrackerHitImpl * dutHit = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlaneHits[k] ) );
-	    const double* dutHitPos = dutHit -> getPosition ( );
-	    double newDutHitPos[3];
+	    const double* refHit1Pos = _referenceHits1[i].pos;
 
-	    int hitsperhit = 0;
+	    findCandidates ( dutHitPos, refHit1Pos, tMin, tMax, useWindow, _candidates );
 
-	    // loop over first reference plane hits
-	    for ( unsigned int i = 0; i < referencePlaneHits1.size ( ); i++ )
+	    // loop over the second reference plane hits which can pass the residual cut
+	    for ( unsigned int j = 0; j < _candidates.size ( ); j++ )
 	    {
-		TrackerHitImpl * refHit1 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( referencePlaneHits1[i] ) );
-		const double* refHit1Pos = refHit1 -> getPosition ( );
+		const double* refHit2Pos = _referenceHits2[_candidates[j]].pos;
 
-		// loop over second reference plane hits
-		for ( unsigned int j = 0; j < referencePlaneHits2.size ( ); j++ )
-		{
-		    TrackerHitImpl * refHit2 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( referencePlaneHits2[j] ) );
-		    const double* refHit2Pos = refHit2 -> getPosition ( );
+		// t = (z-z1)/(z2-z1)
+		double t = ( dutHitPos[2] - refHit1Pos[2] ) / ( refHit2Pos[2] - refHit1Pos[2] );
 
-		    // t = (z-z1)/(z2-z1)
-		    double t = ( dutHitPos[2] - refHit1Pos[2] ) / ( refHit2Pos[2] - refHit1Pos[2] );
+		// find the known coordinate value that correcponds to that z on the line
+		double knownHitPosOnLine = refHit1Pos[_knownHitPos] + ( refHit2Pos[_knownHitPos] - refHit1Pos[_knownHitPos] ) * t;
 
-		    // find the known coordinate value that correcponds to that z on the line
-		    double knownHitPosOnLine = refHit1Pos[_knownHitPos] + ( refHit2Pos[_knownHitPos] - refHit1Pos[_knownHitPos] ) * t;
+		pointhitmaphisto -> fill ( ( refHit1Pos[0] + ( refHit2Pos[0] - refHit1Pos[0] ) * t ), ( refHit1Pos[1] + ( refHit2Pos[1] - refHit1Pos[1] ) * t ) );
 
-		    pointhitmaphisto -> fill ( ( refHit1Pos[0] + ( refHit2Pos[0] - refHit1Pos[0] ) * t ), ( refHit1Pos[1] + ( refHit2Pos[1] - refHit1Pos[1] ) * t ) );
+		double residual = fabs ( knownHitPosOnLine - dutHitPos[_knownHitPos] );
 
+		if ( _multihitmode == true )
+		{
 		    // if knownHitPosOnLine is close to the actual DUT hit position
-		    if ( fabs ( knownHitPosOnLine - dutHitPos[_knownHitPos] ) < _maxResidual )
+		    if ( residual < _maxResidual )
 		    {
-			// first copy old DUT hit position to the new one
-			newDutHitPos[0] = dutHitPos[0];
-			newDutHitPos[1] = dutHitPos[1];
-			newDutHitPos[2] = dutHitPos[2];
-
-			// then replace the unknown one with the estimated one
-			double estimatedHitPos = refHit1Pos[_missingHitPos] + ( refHit2Pos[_missingHitPos] - refHit1Pos[_missingHitPos] ) * t;
-
-			newDutHitPos[_missingHitPos] = estimatedHitPos;
+			// replace the unknown coordinate with the estimated one
+			newDutHitPos[_missingHitPos] = refHit1Pos[_missingHitPos] + ( refHit2Pos[_missingHitPos] - refHit1Pos[_missingHitPos] ) * t;
 
 			// now store new hit position in the collection
 			TrackerHitImpl * newHit = cloneHit ( dutHit );
-			const double* hitpos = newDutHitPos;
-			newHit -> setPosition ( &hitpos[0] );
+			newHit -> setPosition ( newDutHitPos );
 			outputHitCollection -> push_back ( newHit );
 			streamlog_out ( DEBUG0 ) << "New hit: x: " << newDutHitPos[0] << ", y: " << newDutHitPos[1] << ", z: " << newDutHitPos[2] << endl;
 			hitmaphisto -> fill ( newDutHitPos[0], newDutHitPos[1] );
@@ -298,7 +351,6 @@ void EUTelMissingCoordinateEstimator::processEvent ( LCEvent * event )
 			// count new created hits
 			hitsperhit ++;
 			_nDutHitsCreated++;
-
 		    }
 		    else
 		    {
@@ -307,93 +359,38 @@ void EUTelMissingCoordinateEstimator::processEvent ( LCEvent * event )
 			faildistancehisto -> fill ( knownHitPosOnLine - dutHitPos[_knownHitPos] );
 			_nResidualFailCount++;
 		    }
-
-		} // end of loop over second reference plane hits
-	    } // end of loop over first reference plane hits
-
-	    if ( hitsperhit > 9 )
-	    {
-		hitsperhit = 9;
-	    }
-	    _numberOfCreatedHitsPerDUTHit[hitsperhit]++;
-	} // end of loop over DUT hits
-    } // end _multihitmode == true
-
-    // ugly way, to be optimised
-    if ( _multihitmode == false )
-    {
-	bool foundhit = false;
-	double closestresidual = _maxResidual;
-	// loop over DUT hits
-	for ( unsigned int k = 0; k < dutPlaneHits.size ( ); k++ )
-	{
-	    TrackerHitImpl * dutHit = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( dutPlaneHits[k] ) );
-	    const double* dutHitPos = dutHit -> getPosition ( );
-	    double newDutHitPos[3];
-
-	    int hitsperhit = 0;
-
-	    // loop over first reference plane hits
-	    for ( unsigned int i = 0; i < referencePlaneHits1.size ( ); i++ )
-	    {
-		TrackerHitImpl * refHit1 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( referencePlaneHits1[i] ) );
-		const double* refHit1Pos = refHit1 -> getPosition ( );
-
-		// loop over second reference plane hits
-		for ( unsigned int j = 0; j < referencePlaneHits2.size ( ); j++ )
+		}
+		else if ( residual < closestresidual )
 		{
-		    TrackerHitImpl * refHit2 = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( referencePlaneHits2[j] ) );
-		    const double* refHit2Pos = refHit2 -> getPosition ( );
-
-		    // t = (z-z1)/(z2-z1)
-		    double t = ( dutHitPos[2] - refHit1Pos[2] ) / ( refHit2Pos[2] - refHit1Pos[2] );
-
-		    // find the known coordinate value that correcponds to that z on the line
-		    double knownHitPosOnLine = refHit1Pos[_knownHitPos] + ( refHit2Pos[_knownHitPos] - refHit1Pos[_knownHitPos] ) * t;
-
-		    pointhitmaphisto -> fill ( ( refHit1Pos[0] + ( refHit2Pos[0] - refHit1Pos[0] ) * t ), ( refHit1Pos[1] + ( refHit2Pos[1] - refHit1Pos[1] ) * t ) );
-
-		    // if knownHitPosOnLine is close to the actual DUT hit position
-		    if ( fabs ( knownHitPosOnLine - dutHitPos[_knownHitPos] ) < closestresidual )
-		    {
-			foundhit = true;
-			closestresidual = knownHitPosOnLine - dutHitPos[_knownHitPos];
-			// first copy old DUT hit position to the new one
-			newDutHitPos[0] = dutHitPos[0];
-			newDutHitPos[1] = dutHitPos[1];
-			newDutHitPos[2] = dutHitPos[2];
-
-			// then replace the unknown one with the estimated one
-			double estimatedHitPos = refHit1Pos[_missingHitPos] + ( refHit2Pos[_missingHitPos] - refHit1Pos[_missingHitPos] ) * t;
-
-			newDutHitPos[_missingHitPos] = estimatedHitPos;
-		    }
+		    // keep only the closest extrapolated position
+		    foundhit = true;
+		    closestresidual = residual;
+		    newDutHitPos[_missingHitPos] = refHit1Pos[_missingHitPos] + ( refHit2Pos[_missingHitPos] - refHit1Pos[_missingHitPos] ) * t;
+		}
 
-		} // end of loop over second reference plane hits
-	    } // end of loop over first reference plane hits
+	    } // end of loop over second reference plane hits
+	} // end of loop over first reference plane hits
 
-	    if ( foundhit == true )
-	    {
-		// now store new hit position in the collection
-		TrackerHitImpl * newHit = cloneHit ( dutHit );
-		const double* hitpos = newDutHitPos;
-		newHit -> setPosition ( &hitpos[0] );
-		outputHitCollection -> push_back ( newHit );
-		streamlog_out ( DEBUG0 ) << "New hit: x: " << newDutHitPos[0] << ", y: " << newDutHitPos[1] << ", z: " << newDutHitPos[2] << endl;
-		hitmaphisto -> fill ( newDutHitPos[0], newDutHitPos[1] );
-
-		// count new created hits
-		hitsperhit ++;
-		_nDutHitsCreated++;
-	    }
+	if ( foundhit == true )
+	{
+	    // now store new hit position in the collection
+	    TrackerHitImpl * newHit = cloneHit ( dutHit );
+	    newHit -> setPosition ( newDutHitPos );
+	    outputHitCollection -> push_back ( newHit );
+	    streamlog_out ( DEBUG0 ) << "New hit: x: " << newDutHitPos[0] << ", y: " << newDutHitPos[1] << ", z: " << newDutHitPos[2] << endl;
+	    hitmaphisto -> fill ( newDutHitPos[0], newDutHitPos[1] );
+
+	    // count new created hits
+	    hitsperhit ++;
+	    _nDutHitsCreated++;
+	}
 
-	    if ( hitsperhit > 9 )
-	    {
-		hitsperhit = 9;
-	    }
-	    _numberOfCreatedHitsPerDUTHit[hitsperhit]++;
-	} // end of loop over DUT hits
-    } // end _multihitmode == false
+	if ( hitsperhit > 9 )
+	{
+	    hitsperhit = 9;
+	}
+	_numberOfCreatedHitsPerDUTHit[hitsperhit]++;
+    } // end of loop over DUT hits
 
     if ( referencePlaneHits1.size ( ) == 0 || referencePlaneHits2.size ( ) == 0 )
     {
@@ -413,6 +410,56 @@ void EUTelMissingCoordinateEstimator::processEvent ( LCEvent * event )
 }
 
 
+void EUTelMissingCoordinateEstimator::fillReferenceHits ( LCCollectionVec * inputHitCollection, const std::vector < int > & hitIndices, std::vector < ReferenceHit > & referenceHits ) const
+{
+    referenceHits.resize ( hitIndices.size ( ) );
+    for ( unsigned int i = 0; i < hitIndices.size ( ); i++ )
+    {
+	const double* hitPos = dynamic_cast < TrackerHitImpl* > ( inputHitCollection -> getElementAt ( hitIndices[i] ) ) -> getPosition ( );
+	std::copy ( hitPos, hitPos + 3, referenceHits[i].pos );
+    }
+}
+
+
+void EUTelMissingCoordinateEstimator::findCandidates ( const double * dutHitPos, const double * refHit1Pos, double tMin, double tMax, bool useWindow, std::vector < int > & candidates ) const
+{
+    candidates.clear ( );
+
+    if ( !useWindow )
+    {
+	for ( unsigned int j = 0; j < _referenceHits2.size ( ); j++ )
+	{
+	    candidates.push_back ( j );
+	}
+	return;
+    }
+
+    // |k1 + (k2 - k1) t - kD| < R means that k2 - k1 is between
+    // (kD - k1 - R) / t and (kD - k1 + R) / t, take the widest window
+    // for t in [tMin, tMax]
+    const double below = dutHitPos[_knownHitPos] - refHit1Pos[_knownHitPos] - _maxResidual;
+    const double above = dutHitPos[_knownHitPos] - refHit1Pos[_knownHitPos] + _maxResidual;
+    const double bounds[4] = { below / tMin, below / tMax, above / tMin, above / tMax };
+    double low = *std::min_element ( bounds, bounds + 4 );
+    double high = *std::max_element ( bounds, bounds + 4 );
+
+    // a margin against the rounding, the exact cut is applied by the caller
+    const double margin = 1e-9 * ( fabs ( low ) + fabs ( high ) ) + 1e-12;
+    low += refHit1Pos[_knownHitPos] - margin;
+    high += refHit1Pos[_knownHitPos] + margin;
+
+    std::vector < double >::const_iterator first = std::lower_bound ( _sortedKnownPos2.begin ( ), _sortedKnownPos2.end ( ), low );
+    std::vector < double >::const_iterator last = std::upper_bound ( first, _sortedKnownPos2.end ( ), high );
+    for ( ; first != last; ++first )
+    {
+	candidates.push_back ( _sortedReferenceHits2[first - _sortedKnownPos2.begin ( )] );
+    }
+
+    // same order as the loop over all pairs
+    std::sort ( candidates.begin ( ), candidates.end ( ) );
+}
+
+
 TrackerHitImpl* EUTelMissingCoordinateEstimator::cloneHit ( TrackerHitImpl *inputHit )
 {
     TrackerHitImpl * newHit = new TrackerHitImpl;
@@ -1,7 +1,10 @@
 #include "EUTelProcessorAnalysisPALPIDEfs.h"
 #include "EUTelAlignmentConstant.h"
+#include "EUTelBadPixelMap.h"
+#include "EUTelConditionsCache.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelHistogramManager.h"
+#include "EUTelTrackHitAssociation.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 
 #include "marlin/AIDAProcessor.h"
@@ -306,8 +309,23 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
       _hotpixelAvailable = false;
     }
     if (_hotpixelAvailable) {
-      hotData = dynamic_cast<TrackerDataImpl *>(
-          hotPixelCollectionVec->getElementAt(layerIndex));
+      // the hot pixel collection follows the order of the noisy pixel
+      // finder input, the DUT is looked up by its sensor ID
+      auto hotPixelIndices =
+          EUTelConditionsCache::getInstance().getSensorIndices(
+              evt, _hotPixelCollectionName);
+      auto hotPixelIndex = hotPixelIndices->find(_dutID);
+      if (hotPixelIndex == hotPixelIndices->end()) {
+        streamlog_out(WARNING5)
+            << "hotPixelCollectionName: " << _hotPixelCollectionName.c_str()
+            << " has no entry for the DUT " << _dutID << endl;
+        _hotpixelAvailable = false;
+      } else {
+        hotData = dynamic_cast<TrackerDataImpl *>(
+            hotPixelCollectionVec->getElementAt(hotPixelIndex->second));
+      }
+    }
+    if (_hotpixelAvailable) {
       auto sparseData = std::make_unique<
           EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(hotData);
       auto &pixelVec = sparseData->getPixels();
@@ -315,6 +333,9 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
         hotpixelHisto->Fill(sparsePixel.getXCoord() * xPitch + xPitch / 2.,
                             sparsePixel.getYCoord() * yPitch + yPitch / 2.);
       }
+      _hotPixelMap =
+          std::make_unique<EUTelBadPixelMap>(xPixel, yPixel, xPitch, yPitch);
+      _hotPixelMap->addPixels(hotData);
     }
 
     // Noise mask
@@ -323,12 +344,13 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
     if (noiseMaskFile.is_open()) {
       streamlog_out(MESSAGE4)
           << "Running with noise mask: " << _noiseMaskFileName.c_str() << endl;
+      _noiseMaskMap =
+          std::make_unique<EUTelBadPixelMap>(xPixel, yPixel, xPitch, yPitch);
       int region, doubleColumn, address;
       while (noiseMaskFile >> region >> doubleColumn >> address) {
         int x = AddressToColumn(region, doubleColumn, address);
         int y = AddressToRow(address);
-        noiseMaskX.push_back(x);
-        noiseMaskY.push_back(y);
+        _noiseMaskMap->addPixel(x, y);
         hotpixelHisto->Fill(x * xPitch + xPitch / 2., y * yPitch + yPitch / 2.);
       }
     } else
@@ -356,6 +378,9 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
         deadColumnHisto->Fill(sparsePixel.getXCoord() * xPitch + xPitch / 2.,
                               sparsePixel.getYCoord() * yPitch + yPitch / 2.);
       }
+      _deadColumnMap =
+          std::make_unique<EUTelBadPixelMap>(xPixel, yPixel, xPitch, yPitch);
+      _deadColumnMap->addPixels(deadColumn);
     }
 
     // Writing output file
@@ -664,62 +689,24 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
         }
 
         // reject tracks too close to hot pixels
-        if (_hotpixelAvailable) {
-          auto sparseData = std::make_unique<
-              EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(hotData);
-          bool hotpixel = false;
-          auto &pixelVec = sparseData->getPixels();
-          for (auto &sparsePixel : pixelVec) {
-            if (abs(xposfit -
-                    (sparsePixel.getXCoord() * xPitch + xPitch / 2.)) < limit &&
-                abs(yposfit -
-                    (sparsePixel.getYCoord() * yPitch + yPitch / 2.)) < limit) {
-              hotpixel = true;
-              break;
-            }
-          }
-          if (hotpixel) {
-            stats->Fill(kHotPixel);
-            continue;
-          }
+        if (_hotPixelMap &&
+            _hotPixelMap->hasBadPixelWithin(xposfit, yposfit, limit)) {
+          stats->Fill(kHotPixel);
+          continue;
         }
 
         // reject tracks too close to masked pixels
-        if (_noiseMaskAvailable) {
-          bool noisePixel = false;
-          for (size_t iNoise = 0; iNoise < noiseMaskX.size(); iNoise++) {
-            if (abs(xposfit - (noiseMaskX[iNoise] * xPitch + xPitch / 2.)) <
-                    limit &&
-                abs(yposfit - (noiseMaskY[iNoise] * yPitch + yPitch / 2.)) <
-                    limit) {
-              noisePixel = true;
-              break;
-            }
-          }
-          if (noisePixel) {
-            stats->Fill(kMaskedPixel);
-            continue;
-          }
+        if (_noiseMaskMap &&
+            _noiseMaskMap->hasBadPixelWithin(xposfit, yposfit, limit)) {
+          stats->Fill(kMaskedPixel);
+          continue;
         }
 
         // reject tracks too close to dead columns
-        if (_deadColumnAvailable) {
-          auto sparseData = std::make_unique<
-              EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(
-              deadColumn);
-          bool dead = false;
-          auto &pixelVec = sparseData->getPixels();
-          for (auto &sparsePixel : pixelVec) {
-            if (abs(xposfit -
-                    (sparsePixel.getXCoord() * xPitch + xPitch / 2.)) < limit) {
-              dead = true;
-              break;
-            }
-          }
-          if (dead) {
-            stats->Fill(kDeadColumn);
-            continue;
-          }
+        if (_deadColumnMap &&
+            _deadColumnMap->hasBadColumnWithin(xposfit, limit)) {
+          stats->Fill(kDeadColumn);
+          continue;
         }
 
         nTrackPerEvent++;
@@ -1411,111 +1398,21 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt) {
                         // association while doesn't allow hits to be shared
                         // between tracks.
   {
-    int nH = pH.size();
     int nT = pT.size();
-    std::vector<int> aH(nH);
-    std::vector<int> aT(nT);
-    for (int i = 0; i < nH; i++)
-      aH[i] = -1;
-    for (int i = 0; i < nT; i++)
-      aT[i] = -1;
-    int temp;
-    bool changed = true;
-    while (changed) {
-      changed = false;
-      for (int iT = 0; iT < nT; iT++) {
-        if (aT[iT] == -1) {
-          int associations = 0;
-          for (int iH = 0; iH < nH; iH++) {
-            if (aH[iH] == -1) {
-              if (abs(pH.at(iH).at(0) - pT.at(iT).at(0)) < limit &&
-                  abs(pH.at(iH).at(1) - pT.at(iT).at(1)) < limit) {
-                associations++;
-                temp = iH;
-              }
-            }
-          }
-          if (associations == 1) {
-            changed = true;
-            aH[temp] = iT;
-            aT[iT] = temp;
-          }
-          if (associations == 0) {
-            aT[iT] = -2;
-          }
-        }
-      }
-    }
-    std::vector<int> aTFinal(nT);
-    std::vector<int> aHFinal(nH);
-    std::vector<int> order;
-    for (int iT = 0; iT < nT; iT++) {
-      if (aT[iT] == -1)
-        order.push_back(iT);
+    std::vector<double> hitX, hitY, trackX, trackY;
+    for (auto &hit : pH) {
+      hitX.push_back(hit.at(0));
+      hitY.push_back(hit.at(1));
     }
-    if (order.size() > 0) {
-      unsigned int maxAssociations = 0;
-      double minDistance = 1e10;
-      bool run1 = true;
-      do {
-        double totaldistance = 0;
-        unsigned int associations = 0;
-        std::vector<int> aTTemp(nT);
-        std::vector<int> aHTemp(nH);
-        for (int iT = 0; iT < nT; iT++)
-          aTTemp[iT] = aT[iT];
-        for (int iH = 0; iH < nH; iH++)
-          aHTemp[iH] = aH[iH];
-        bool run2 = true;
-        for (unsigned int i = 0; i < order.size() && run2; i++) {
-          int iT = order[i];
-          double min = 1e10;
-          bool associated = false;
-          for (int iH = 0; iH < nH; iH++) {
-            if (aHTemp[iH] == -1) {
-              if (abs(pH.at(iH).at(0) - pT.at(iT).at(0)) < limit &&
-                  abs(pH.at(iH).at(1) - pT.at(iT).at(1)) < limit) {
-                double dist =
-                    sqrt(pow(abs(pH.at(iH).at(0) - pT.at(iT).at(0)), 2) +
-                         pow(abs(pH.at(iH).at(1) - pT.at(iT).at(1)), 2));
-                if (dist < min) {
-                  min = dist;
-                  temp = iH;
-                  associated = true;
-                }
-              }
-            }
-          }
-          if (associated) {
-            associations++;
-            aHTemp[temp] = iT;
-            aTTemp[iT] = temp;
-            totaldistance += min;
-          }
-          if (totaldistance > minDistance)
-            run2 = false;
-          if ((i - associations + 1) > (order.size() - maxAssociations))
-            run2 = false;
-        }
-        if (associations == order.size())
-          run1 = false;
-        if (associations >= maxAssociations) {
-          if (totaldistance < minDistance) {
-            for (int iT = 0; iT < nT; iT++)
-              aTFinal[iT] = aTTemp[iT];
-            for (int iH = 0; iH < nH; iH++)
-              aHFinal[iH] = aHTemp[iH];
-            maxAssociations = associations;
-            minDistance = totaldistance;
-          }
-        }
-      } while (std::next_permutation(order.begin(), order.end()) && run1);
-    } else {
-      for (int iT = 0; iT < nT; iT++)
-        aTFinal[iT] = aT[iT];
-      for (int iH = 0; iH < nH; iH++)
-        aHFinal[iH] = aH[iH];
+    for (auto &track : pT) {
+      trackX.push_back(track.at(0));
+      trackY.push_back(track.at(1));
     }
+    EUTelTrackHitAssociation association(limit,
+                                         EUTelTrackHitAssociation::kBox);
+    association.setHits(hitX, hitY);
+    std::vector<int> aTFinal =
+        association.associateUniqueFirst(trackX, trackY);
     for (int iT = 0; iT < nT; iT++) {
       int index = -1;
       for (int iSector = 0; iSector < _nSectors; iSector++) {
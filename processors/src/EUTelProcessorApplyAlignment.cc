@@ -14,6 +14,7 @@
 // eutelescope includes ".h"
 #include "EUTelProcessorApplyAlignment.h"
 #include "EUTelAlignmentConstant.h"
+#include "EUTelConditionsCache.h"
 #include "EUTelEventImpl.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelRunHeaderImpl.h"
@@ -24,10 +25,15 @@
 
 // lcio includes <.h>
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
 #include <IMPL/TrackerDataImpl.h>
 #include <IMPL/TrackerHitImpl.h>
+#include <IO/LCWriter.h>
 #include <UTIL/CellIDDecoder.h>
 #include <UTIL/CellIDEncoder.h>
+#include <UTIL/LCTime.h>
+#include <lcio.h>
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 // aida includes
@@ -60,11 +66,48 @@ using namespace marlin;
 using namespace eutelescope;
 using namespace gear;
 
+namespace {
+
+  //! Copies everything but the position of a hit
+  TrackerHitImpl *copyHit(const TrackerHitImpl *inputHit) {
+    TrackerHitImpl *outputHit = new TrackerHitImpl;
+    outputHit->setType(inputHit->getType());
+    outputHit->rawHits() = inputHit->getRawHits();
+    FloatVec cov = inputHit->getCovMatrix();
+    outputHit->setCovMatrix(cov);
+    outputHit->setCellID0(inputHit->getCellID0());
+    outputHit->setCellID1(inputHit->getCellID1());
+    outputHit->setTime(inputHit->getTime());
+    return outputHit;
+  }
+
+  //! Product of two 3x3 matrices stored row by row
+  void multiplyMatrix(const double a[9], const double b[9],
+                      double result[9]) {
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        result[3 * i + j] = a[3 * i] * b[j] + a[3 * i + 1] * b[3 + j] +
+                            a[3 * i + 2] * b[6 + j];
+      }
+    }
+  }
+
+  //! Product of a 3x3 matrix stored row by row and a vector
+  void multiplyVector(const double a[9], const double v[3],
+                      double result[3]) {
+    for (int i = 0; i < 3; ++i) {
+      result[i] = a[3 * i] * v[0] + a[3 * i + 1] * v[1] + a[3 * i + 2] * v[2];
+    }
+  }
+
+} // namespace
+
 EUTelProcessorApplyAlign::EUTelProcessorApplyAlign()
     : Processor("EUTelProcessorApplyAlignment"), _inputHitCollectionName("hit"),
       _alignmentCollectionName("alignment"),
       _outputHitCollectionName("correctedHit"), _correctionMethod(0), _iRun(0),
-      _iEvt(0), _lookUpTable() {
+      _iEvt(0), _lookUpTable(), _alignmentCollectionNames(),
+      _composedAlignmentFile(""), _composedAlignment(), _composedChanges() {
   _description = "Apply alignment constants to hit collection";
 
   registerInputCollection(LCIO::TRACKERHIT, "InputHitCollectionName",
@@ -76,6 +119,16 @@ EUTelProcessorApplyAlign::EUTelProcessorApplyAlign()
   registerOutputCollection(LCIO::TRACKERHIT, "OutputHitCollectionName",
                            "The name of the output hit collection",
                            _outputHitCollectionName, string("correctedHit"));
+  registerOptionalParameter(
+      "AlignmentConstantNames",
+      "Ordered list of alignment constant collections composed into a single "
+      "transform per sensor (replaces AlignmentConstantName)",
+      _alignmentCollectionNames, vector<string>());
+  registerOptionalParameter(
+      "ComposedAlignmentConstantLCIOFile",
+      "LCIO file where the composed alignment constants are written at the "
+      "end (empty for none)",
+      _composedAlignmentFile, string(""));
 }
 
 void EUTelProcessorApplyAlign::init() {
@@ -101,6 +154,9 @@ void EUTelProcessorApplyAlign::processRunHeader(LCRunHeader *rdr) {
       std::make_unique<EUTelRunHeaderImpl>(rdr);
   runHeader->addProcessor(type());
   ++_iRun;
+
+  // compose the chain again with the conditions of the new run
+  _composedChanges.clear();
 }
 
 void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
@@ -122,6 +178,24 @@ void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
   try {
     LCCollectionVec *inputCollectionVec = dynamic_cast<LCCollectionVec *>(
         evt->getCollection(_inputHitCollectionName));
+
+    if (!_alignmentCollectionNames.empty()) {
+      // compose again when a conditions handler reports new constants
+      EUTelConditionsCache &conditions = EUTelConditionsCache::getInstance();
+      vector<LCCollection *> alignmentCollections;
+      vector<unsigned long> changes;
+      for (const string &name : _alignmentCollectionNames) {
+        alignmentCollections.push_back(evt->getCollection(name));
+        changes.push_back(conditions.getChanges(name));
+      }
+      if (changes != _composedChanges) {
+        composeAlignment(alignmentCollections);
+        _composedChanges = changes;
+      }
+      applyComposedAlignment(evt, inputCollectionVec);
+      return;
+    }
+
     LCCollectionVec *alignmentCollectionVec = dynamic_cast<LCCollectionVec *>(
         evt->getCollection(_alignmentCollectionName));
 
@@ -159,14 +233,7 @@ void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
       const int sensorID = hitDecoder(inputHit)["sensorID"];
 
       // copy the input to the output, at least for the common part
-      TrackerHitImpl *outputHit = new TrackerHitImpl;
-      outputHit->setType(inputHit->getType());
-      outputHit->rawHits() = inputHit->getRawHits();
-      FloatVec cov = inputHit->getCovMatrix();
-      outputHit->setCovMatrix(cov);
-      outputHit->setCellID0(inputHit->getCellID0());
-      outputHit->setCellID1(inputHit->getCellID1());
-      outputHit->setTime(inputHit->getTime());
+      TrackerHitImpl *outputHit = copyHit(inputHit);
 
       // now that we know at which sensor the hit belongs to, we can
       // get the corresponding alignment constants
@@ -181,22 +248,19 @@ void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
             static_cast<EUTelAlignmentConstant *>(
                 alignmentCollectionVec->getElementAt(positionIter->second));
         // Rotations
-        double xPlaneCenter = geo::gGeometry().getPlaneXPosition(sensorID);
-        double yPlaneCenter = geo::gGeometry().getPlaneYPosition(sensorID);
-        double zPlaneThickness = geo::gGeometry().getPlaneZSize(sensorID);
-        double zPlaneCenter =
-            geo::gGeometry().getPlaneZPosition(sensorID) + zPlaneThickness / 2.;
-
-        TVector3 inputVec(inputPosition[0] - xPlaneCenter,
-                          inputPosition[1] - yPlaneCenter,
-                          inputPosition[2] - zPlaneCenter);
+        double planeCenter[3];
+        getPlaneCenter(sensorID, planeCenter);
+
+        TVector3 inputVec(inputPosition[0] - planeCenter[0],
+                          inputPosition[1] - planeCenter[1],
+                          inputPosition[2] - planeCenter[2]);
         inputVec.RotateX(-alignment->getAlpha());
         inputVec.RotateY(-alignment->getBeta());
         inputVec.RotateZ(-alignment->getGamma());
 
-        outputPosition[0] = inputVec.X() + xPlaneCenter;
-        outputPosition[1] = inputVec.Y() + yPlaneCenter;
-        outputPosition[2] = inputVec.Z() + zPlaneCenter;
+        outputPosition[0] = inputVec.X() + planeCenter[0];
+        outputPosition[1] = inputVec.Y() + planeCenter[1];
+        outputPosition[2] = inputVec.Z() + planeCenter[2];
         // Shifts
         outputPosition[0] -= alignment->getXOffset();
         outputPosition[1] -= alignment->getYOffset();
@@ -226,7 +290,177 @@ void EUTelProcessorApplyAlign::processEvent(LCEvent *event) {
   }
 }
 
+void EUTelProcessorApplyAlign::getPlaneCenter(int sensorID, double center[3]) {
+  center[0] = geo::gGeometry().getPlaneXPosition(sensorID);
+  center[1] = geo::gGeometry().getPlaneYPosition(sensorID);
+  center[2] = geo::gGeometry().getPlaneZPosition(sensorID) +
+              geo::gGeometry().getPlaneZSize(sensorID) / 2.;
+}
+
+void EUTelProcessorApplyAlign::composeAlignment(
+    const vector<LCCollection *> &collections) {
+
+  _composedAlignment.clear();
+  const AffineTransform identity = {{1., 0., 0., 0., 1., 0., 0., 0., 1.},
+                                    {0., 0., 0.}};
+
+  for (size_t iLevel = 0; iLevel < collections.size(); ++iLevel) {
+    for (int iPos = 0; iPos < collections[iLevel]->getNumberOfElements();
+         ++iPos) {
+      EUTelAlignmentConstant *alignment = static_cast<EUTelAlignmentConstant *>(
+          collections[iLevel]->getElementAt(iPos));
+      const int sensorID = alignment->getSensorID();
+
+      // the level moves p to R (p - c) + c - offset: the columns of R
+      // are the rotated axes, with the rotations of the single
+      // collection mode
+      AffineTransform level;
+      for (int j = 0; j < 3; ++j) {
+        TVector3 axis(j == 0 ? 1. : 0., j == 1 ? 1. : 0., j == 2 ? 1. : 0.);
+        axis.RotateX(-alignment->getAlpha());
+        axis.RotateY(-alignment->getBeta());
+        axis.RotateZ(-alignment->getGamma());
+        level.rotation[j] = axis.X();
+        level.rotation[3 + j] = axis.Y();
+        level.rotation[6 + j] = axis.Z();
+      }
+      double center[3];
+      getPlaneCenter(sensorID, center);
+      double rotatedCenter[3];
+      multiplyVector(level.rotation, center, rotatedCenter);
+      level.translation[0] =
+          center[0] - rotatedCenter[0] - alignment->getXOffset();
+      level.translation[1] =
+          center[1] - rotatedCenter[1] - alignment->getYOffset();
+      level.translation[2] =
+          center[2] - rotatedCenter[2] - alignment->getZOffset();
+
+      // a sensor not moved by the previous levels starts from the identity
+      AffineTransform &composed =
+          _composedAlignment.insert(make_pair(sensorID, identity))
+              .first->second;
+
+      // level after composed
+      AffineTransform result;
+      multiplyMatrix(level.rotation, composed.rotation, result.rotation);
+      multiplyVector(level.rotation, composed.translation, result.translation);
+      for (int i = 0; i < 3; ++i) {
+        result.translation[i] += level.translation[i];
+      }
+      composed = result;
+    }
+  }
+
+  streamlog_out(MESSAGE5) << "Composed " << collections.size()
+                          << " alignment collections for "
+                          << _composedAlignment.size() << " sensors" << endl;
+}
+
+void EUTelProcessorApplyAlign::applyComposedAlignment(
+    LCEvent *evt, LCCollectionVec *inputCollectionVec) {
+
+  LCCollectionVec *outputCollectionVec = new LCCollectionVec(LCIO::TRACKERHIT);
+  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
+
+  for (size_t iHit = 0; iHit < inputCollectionVec->size(); iHit++) {
+    TrackerHitImpl *inputHit =
+        dynamic_cast<TrackerHitImpl *>(inputCollectionVec->getElementAt(iHit));
+    const int sensorID = hitDecoder(inputHit)["sensorID"];
+    TrackerHitImpl *outputHit = copyHit(inputHit);
+
+    const double *inputPosition = inputHit->getPosition();
+    double outputPosition[3] = {inputPosition[0], inputPosition[1],
+                                inputPosition[2]};
+
+    map<int, AffineTransform>::const_iterator transform =
+        _composedAlignment.find(sensorID);
+    if (transform != _composedAlignment.end()) {
+      multiplyVector(transform->second.rotation, inputPosition, outputPosition);
+      for (int i = 0; i < 3; ++i) {
+        outputPosition[i] += transform->second.translation[i];
+      }
+    } else {
+      streamlog_out(DEBUG5) << "Sensor ID " << sensorID
+                            << " not found. Skipping alignment for hit "
+                            << iHit << endl;
+    }
+    outputHit->setPosition(outputPosition);
+    outputCollectionVec->push_back(outputHit);
+  }
+  evt->addCollection(outputCollectionVec, _outputHitCollectionName);
+}
+
+void EUTelProcessorApplyAlign::writeComposedAlignment() const {
+
+  LCWriter *lcWriter = LCFactory::getInstance()->createLCWriter();
+  try {
+    lcWriter->open(_composedAlignmentFile, LCIO::WRITE_NEW);
+  } catch (IOException &e) {
+    streamlog_out(ERROR4) << e.what() << endl
+                          << "The composed alignment cannot be saved" << endl;
+    delete lcWriter;
+    return;
+  }
+
+  // write an almost empty run header
+  LCRunHeaderImpl *lcHeader = new LCRunHeaderImpl;
+  lcHeader->setRunNumber(0);
+  lcWriter->writeRunHeader(lcHeader);
+  delete lcHeader;
+
+  LCEventImpl *event = new LCEventImpl;
+  event->setRunNumber(0);
+  event->setEventNumber(0);
+  LCTime now;
+  event->setTimeStamp(now.timeStamp());
+
+  LCCollectionVec *constantsCollection =
+      new LCCollectionVec(LCIO::LCGENERICOBJECT);
+
+  map<int, AffineTransform>::const_iterator iter = _composedAlignment.begin();
+  for (; iter != _composedAlignment.end(); ++iter) {
+    const double *rotation = iter->second.rotation;
+
+    // rotation = Rz(-gamma) Ry(-beta) Rx(-alpha)
+    const double beta = asin(max(-1., min(1., rotation[6])));
+    const double alpha = atan2(-rotation[7], rotation[8]);
+    const double gamma = atan2(-rotation[3], rotation[0]);
+
+    // translation = c - rotation c - offset
+    double center[3];
+    getPlaneCenter(iter->first, center);
+    double rotatedCenter[3];
+    multiplyVector(rotation, center, rotatedCenter);
+    double offset[3];
+    for (int i = 0; i < 3; ++i) {
+      offset[i] = center[i] - rotatedCenter[i] - iter->second.translation[i];
+    }
+
+    constantsCollection->push_back(new EUTelAlignmentConstant(
+        iter->first, offset[0], offset[1], offset[2], alpha, beta, gamma, 0.,
+        0., 0., 0., 0., 0.));
+  }
+
+  event->addCollection(constantsCollection, _alignmentCollectionName);
+  lcWriter->writeEvent(event);
+  delete event;
+
+  lcWriter->close();
+  delete lcWriter;
+
+  streamlog_out(MESSAGE5) << "Composed alignment constants written to "
+                          << _composedAlignmentFile << endl;
+}
+
 void EUTelProcessorApplyAlign::end() {
+  if (!_composedAlignmentFile.empty()) {
+    if (_composedAlignment.empty()) {
+      streamlog_out(WARNING2) << "No composed alignment to write to "
+                              << _composedAlignmentFile << endl;
+    } else {
+      writeComposedAlignment();
+    }
+  }
   streamlog_out(MESSAGE2) << "Successfully finished" << endl;
 }
 
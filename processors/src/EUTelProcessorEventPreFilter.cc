@@ -0,0 +1,168 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelProcessorEventPreFilter.h"
+#include "EUTELESCOPE.h"
+#include "EUTelEventImpl.h"
+#include "EUTelEventSummary.h"
+#include "EUTelExceptions.h"
+#include "EUTelRunHeaderImpl.h"
+
+// marlin includes ".h"
+#include "marlin/Exceptions.h"
+#include "marlin/Processor.h"
+
+// system includes <>
+#include <algorithm>
+#include <map>
+#include <memory>
+
+using namespace std;
+using namespace lcio;
+using namespace marlin;
+using namespace eutelescope;
+
+EUTelProcessorEventPreFilter::EUTelProcessorEventPreFilter()
+    : Processor("EUTelProcessorEventPreFilter"), _summaryCollectionName(""),
+      _minElementsPerPlane(1), _maxElementsPerPlane(-1), _minNoOfPlanes(1),
+      _requiredPlanes(), _excludedPlanes(), _noOfEvents(0),
+      _noOfEventsWithoutSummary(0), _noOfRejectedEvents(0), _noOfElements(0),
+      _noOfRejectedElements(0) {
+
+  _description = "EUTelProcessorEventPreFilter skips the events with too few "
+                 "planes hit, using the per sensor summary stored as event "
+                 "parameters instead of decoding the collections";
+
+  registerProcessorParameter(
+      "SummaryCollectionName",
+      "Collection whose per sensor summary is used (e.g. zsdata, cluster)",
+      _summaryCollectionName, string("zsdata"));
+
+  registerProcessorParameter("MinNoOfPlanes",
+                             "Minimum number of hit planes", _minNoOfPlanes,
+                             1);
+
+  registerOptionalParameter("MinElementsPerPlane",
+                            "Minimum number of elements of a hit plane",
+                            _minElementsPerPlane, 1);
+
+  registerOptionalParameter(
+      "MaxElementsPerPlane",
+      "Maximum number of elements of a hit plane (-1 for no limit)",
+      _maxElementsPerPlane, -1);
+
+  registerOptionalParameter("RequiredPlanes",
+                            "The list of sensor ids which have to be hit",
+                            _requiredPlanes, vector<int>());
+
+  registerOptionalParameter(
+      "ExcludedPlanes",
+      "The list of sensor ids that are not counted as hit planes",
+      _excludedPlanes, vector<int>());
+}
+
+void EUTelProcessorEventPreFilter::init() {
+  printParameters();
+
+  if (_minElementsPerPlane < 1) {
+    throw InvalidParameterException("MinElementsPerPlane has to be positive");
+  }
+  if (_maxElementsPerPlane != -1 &&
+      _maxElementsPerPlane < _minElementsPerPlane) {
+    throw InvalidParameterException(
+        "MaxElementsPerPlane has to be -1 or at least MinElementsPerPlane");
+  }
+
+  _noOfEvents = 0;
+  _noOfEventsWithoutSummary = 0;
+  _noOfRejectedEvents = 0;
+  _noOfElements = 0;
+  _noOfRejectedElements = 0;
+}
+
+void EUTelProcessorEventPreFilter::processRunHeader(LCRunHeader *rdr) {
+  auto runHeader = std::make_unique<EUTelRunHeaderImpl>(rdr);
+  runHeader->addProcessor(type());
+}
+
+void EUTelProcessorEventPreFilter::processEvent(LCEvent *event) {
+
+  EUTelEventImpl *evt = static_cast<EUTelEventImpl *>(event);
+  if (evt->getEventType() == kEORE) {
+    streamlog_out(DEBUG4) << "EORE found: nothing else to do." << endl;
+    return;
+  }
+
+  ++_noOfEvents;
+
+  map<int, int> counts;
+  if (!EventSummary::getCounts(event, _summaryCollectionName, counts)) {
+    if (_noOfEventsWithoutSummary == 0) {
+      streamlog_out(WARNING2)
+          << "Event " << event->getEventNumber() << " in run "
+          << event->getRunNumber() << " has no summary of "
+          << _summaryCollectionName
+          << ". Events without summary are accepted." << endl;
+    }
+    ++_noOfEventsWithoutSummary;
+    return;
+  }
+
+  long noOfElements = 0;
+  int noOfHitPlanes = 0;
+  for (map<int, int>::const_iterator iter = counts.begin();
+       iter != counts.end(); ++iter) {
+    noOfElements += iter->second;
+    if (find(_excludedPlanes.begin(), _excludedPlanes.end(), iter->first) ==
+            _excludedPlanes.end() &&
+        iter->second >= _minElementsPerPlane &&
+        (_maxElementsPerPlane == -1 || iter->second <= _maxElementsPerPlane)) {
+      ++noOfHitPlanes;
+    }
+  }
+  _noOfElements += noOfElements;
+
+  bool accepted = (noOfHitPlanes >= _minNoOfPlanes);
+  for (size_t i = 0; accepted && i < _requiredPlanes.size(); ++i) {
+    map<int, int>::const_iterator iter = counts.find(_requiredPlanes[i]);
+    accepted = (iter != counts.end() &&
+                iter->second >= _minElementsPerPlane &&
+                (_maxElementsPerPlane == -1 ||
+                 iter->second <= _maxElementsPerPlane));
+  }
+
+  if (!accepted) {
+    ++_noOfRejectedEvents;
+    _noOfRejectedElements += noOfElements;
+    streamlog_out(DEBUG4) << "Event " << event->getEventNumber() << " has "
+                          << noOfHitPlanes << " planes hit: skipped" << endl;
+    throw SkipEventException(this);
+  }
+}
+
+void EUTelProcessorEventPreFilter::end() {
+  streamlog_out(MESSAGE4)
+      << "Rejected " << _noOfRejectedEvents << " of " << _noOfEvents
+      << " events ("
+      << (_noOfEvents != 0 ? 100. * _noOfRejectedEvents / _noOfEvents : 0.)
+      << "%)" << endl;
+  streamlog_out(MESSAGE4)
+      << "The rejected events carried " << _noOfRejectedElements << " of "
+      << _noOfElements << " " << _summaryCollectionName << " elements ("
+      << (_noOfElements != 0 ? 100. * _noOfRejectedElements / _noOfElements
+                             : 0.)
+      << "%), not processed by the following processors" << endl;
+  if (_noOfEventsWithoutSummary != 0) {
+    streamlog_out(WARNING2) << _noOfEventsWithoutSummary
+                            << " events without summary have been accepted"
+                            << endl;
+  }
+  streamlog_out(MESSAGE2) << "Successfully finished" << endl;
+}
@@ -15,6 +15,7 @@
 
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
+#include "EUTelEventSummary.h"
 #include "EUTelExceptions.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelRunHeaderImpl.h"
@@ -54,6 +55,7 @@
 #endif
 
 // system includes
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -270,6 +272,9 @@ void EUTelProcessorGeometricClustering::geometricClustering(
   CellIDEncoder<TrackerPulseImpl> idZSPulseEncoder(
       EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
+  // number of clusters found per sensor
+  std::map<int, int> clusterCounts;
+
   // in the _zsInputDataCollectionVec we should have one TrackerData for each
   // detector working in ZS mode. We need to loop over all of them
   for (unsigned int idetector = 0;
@@ -299,6 +304,9 @@ void EUTelProcessorGeometricClustering::geometricClustering(
       continue;
     }
 
+    // a sensor without clusters is summarised with a zero count
+    clusterCounts.insert(std::make_pair(sensorID, 0));
+
     // now that we know which is the sensorID, we can ask which are the minX,
     // minY, maxX and maxY.
     int minX, minY, maxX, maxY;
@@ -368,9 +376,11 @@ void EUTelProcessorGeometricClustering::geometricClustering(
       hitPixelVec.push_back(hitPixel);
     }
 
-    std::vector<EUTelGeometricPixel> newlyAdded;
-    // We now cluster those hits together
-    while (!hitPixelVec.empty()) {
+    auto clusters =
+        Utility::findGeometricClusters(std::move(hitPixelVec), _cutT);
+
+    // We now store the found clusters
+    for (auto const &pixels : clusters) {
       // prepare a TrackerData to store the cluster candidate
       std::unique_ptr<TrackerDataImpl> zsCluster =
           std::make_unique<TrackerDataImpl>();
@@ -379,68 +389,8 @@ void EUTelProcessorGeometricClustering::geometricClustering(
           sparseCluster = std::make_unique<
               EUTelGenericSparseClusterImpl<EUTelGeometricPixel>>(
               zsCluster.get());
-
-      // First we need to take any pixel, so let's take the first one
-      // Add it to the cluster as well as the newly added pixels
-      newlyAdded.push_back(hitPixelVec.front());
-      sparseCluster->push_back(hitPixelVec.front());
-      // And remove it from the original collection
-      hitPixelVec.erase(hitPixelVec.begin());
-
-      // Now process all newly added pixels, initially this is the just
-      // previously added one
-      // but in the process of neighbour finding we continue to add new pixels
-      while (!newlyAdded.empty()) {
-        bool newlyDone = true;
-        float x1, x2, y1, y2, dX, dY, cx1, cy1, cx2, cy2, cutX, cutY, t1, t2,
-            dT;
-
-        // check against all pixels in the hitPixelVec
-        for (std::vector<EUTelGeometricPixel>::iterator hitVec =
-                 hitPixelVec.begin();
-             hitVec != hitPixelVec.end(); ++hitVec) {
-          // get the relevant infos from the newly added pixel
-          x1 = newlyAdded.front().getPosX();
-          y1 = newlyAdded.front().getPosY();
-          t1 = newlyAdded.front().getTime();
-          cx1 = newlyAdded.front().getBoundaryX();
-          cy1 = newlyAdded.front().getBoundaryY();
-
-          // and the pixel we test against
-          x2 = hitVec->getPosX();
-          y2 = hitVec->getPosY();
-          t2 = hitVec->getTime();
-          cx2 = hitVec->getBoundaryX();
-          cy2 = hitVec->getBoundaryY();
-
-          dX = x1 - x2;
-          dY = y1 - y2;
-          dT = t1 - t2;
-          cutX = (cx1 + cx2) *
-                 1.01; // this additional 1% is accounting for precision
-          cutY = (cy1 + cy2) * 1.01; // uncertainty with the geo framework
-
-          // if they pass the spatial and temporal cuts, we add them
-          if ((dX * dX <= cutX * cutX) && (dY * dY <= cutY * cutY) &&
-              (dT * dT <= _cutT * _cutT)) {
-            // add them to the cluster as well as to the newly added ones
-            newlyAdded.push_back(*hitVec);
-            sparseCluster->push_back(*hitVec);
-            // and remove it from the original collection
-            hitPixelVec.erase(hitVec);
-            // for the pixel we test there might be other neighbours, we still
-            // have to check
-            newlyDone = false;
-            break;
-          }
-        }
-
-        // if no neighbours are found, we can delete the pixel from the newly
-        // added
-        // we tested against _ALL_ non cluster pixels, there are no other pixels
-        // which could be neighbours
-        if (newlyDone)
-          newlyAdded.erase(newlyAdded.begin());
+      for (auto const &pixel : pixels) {
+        sparseCluster->push_back(pixel);
       }
 
       // Now we need to process the found cluster
@@ -476,6 +426,7 @@ void EUTelProcessorGeometricClustering::geometricClustering(
 
         // last but not least increment the totClusterMap
         _totClusterMap[sensorID] += 1;
+        ++clusterCounts[sensorID];
 
       } // cluster processing if
 
@@ -487,6 +438,9 @@ void EUTelProcessorGeometricClustering::geometricClustering(
     } // loop over all found clusters
   }   // this is the end of the loop over all ZS detectors
 
+  // the cheap per sensor multiplicity for the event pre-filter
+  EventSummary::addCounts(evt, _pulseCollectionName, clusterCounts);
+
   // if the sparseClusterCollectionVec isn't empty add it to the
   // current event. The pulse collection will be added afterwards
   if (!isDummyAlreadyExisting) {
@@ -85,8 +85,8 @@ namespace eutelescope {
     if (_firstEvent) {
       // The noisy pixel collection stores all thot pixels in event #1
       // Thus we have to read it in in that case
-      _noisyPixelMap =
-          Utility::readNoisyPixelList(event, _noisyPixelCollectionName);
+      _noisyPixelMap = EUTelConditionsCache::getInstance().getNoisyPixels(
+          event, _noisyPixelCollectionName);
       _firstEvent = false;
     }
 
@@ -120,7 +120,11 @@ namespace eutelescope {
       int sensorID = cellDecoder(pulseData)["sensorID"];
 
       // get the noise vector for the given plane
-      std::vector<int> *noiseVector = &(_noisyPixelMap[sensorID]);
+      static const std::vector<int> noNoisyPixels;
+      auto noiseIter = _noisyPixelMap->find(sensorID);
+      const std::vector<int> *noiseVector =
+          (noiseIter != _noisyPixelMap->end()) ? &noiseIter->second
+                                               : &noNoisyPixels;
 
       // each pulse has the tracker data attached to it
       TrackerDataImpl *trackerData =
@@ -64,7 +64,7 @@ namespace eutelescope {
       : Processor("EUTelProcessorNoisyPixelFinder"), _zsDataCollectionName(""),
         _noisyPixelCollectionName(""), _excludedPlanes(), _noOfEvents(0),
         _maxAllowedFiringFreq(0.0), _iRun(0), _iEvt(0), _sensorIDVec(),
-        _noisyPixelDBFile(""), _finished(false) {
+        _noisyPixelDBFile(""), _hitCountCollectionName(""), _finished(false) {
     // processor description
     _description = "EUTelProcessorNoisyPixelFinder computes the firing "
                    "frequency of pixels and applies a cut on this value to "
@@ -105,6 +105,14 @@ namespace eutelescope {
                               _noisyPixelCollectionName,
                               std::string("noisyPixel"));
 
+    registerOptionalParameter(
+        "HitCountCollectionName",
+        "If set, the hit count of every fired pixel is also written into the "
+        "db file in a collection of this name. The db is then written at the "
+        "end of the run even if NoOfEvents was not reached, so that the "
+        "databases of a run processed in chunks can be merged with chunkmerge",
+        _hitCountCollectionName, std::string(""));
+
   registerOptionalParameter("NoisyPixelNoHistogramUpperLimit",
                               "Upper limit for noisy pixel count versus noise cut histogram",
                               _noisyPixelVsCutHistUpperLimit, 0.0006);
@@ -310,6 +318,15 @@ namespace eutelescope {
     if (_finished) {
       streamlog_out(MESSAGE4) << "Noisy pixel finder has successfully finished!"
                               << std::endl;
+    } else if (!_hitCountCollectionName.empty() && _iEvt > 0) {
+      // a chunk of a run: write out what we have, the hit counts allow the
+      // chunk databases to be merged afterwards (see chunkmerge)
+      streamlog_out(MESSAGE4)
+          << "End of run reached after " << _iEvt
+          << " events, writing out partial noisy pixel database with hit counts"
+          << std::endl;
+      findNoisyPixels();
+      noisyPixelDBWriter();
     } else {
       streamlog_out(ERROR3)
           << "End of run reached before enough events were processed for noisy "
@@ -337,49 +354,7 @@ namespace eutelescope {
           << "Finished determining hot pixels, writing them out..."
           << std::endl;
 
-      // iterate over all the sensors in our sensorMap
-      for (auto &thisSensor : _sensorMap) {
-        auto sensorID = thisSensor.first;
-        streamlog_out(MESSAGE3) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~"
-                                   "~~~~~~~~~~~~~~~~~~~~~~~"
-                                << std::endl;
-        streamlog_out(MESSAGE3)
-            << "Noisy pixels found on plane " << sensorID
-            << " (max. fire freq set to: " << _maxAllowedFiringFreq << ")"
-            << std::endl;
-        streamlog_out(MESSAGE3) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~"
-                                   "~~~~~~~~~~~~~~~~~~~~~~~"
-                                << std::endl;
-
-        // get the correpsonding hit array-like vector of vectors
-        std::vector<std::vector<long int>> *hitVector = &_hitVecMap[sensorID];
-        // and the sensor which stores offsets
-        sensor *currentSensor = &_sensorMap[sensorID];
-		auto& firingFreqVec = _firingFreqForAllPixels[sensorID]; 
-
-        // loop over all pixels
-        for (auto xIt = hitVector->begin(); xIt != hitVector->end(); ++xIt) {
-          for (auto yIt = xIt->begin(); yIt != xIt->end(); ++yIt) {
-            // compute the firing frequency
-            double fireFreq = static_cast<double>(*yIt) / static_cast<double>(_iEvt);
-            // if it is larger than the allowed one, we write this pixel into a
-            // collection
-            firingFreqVec.push_back(fireFreq);
-            if (fireFreq > _maxAllowedFiringFreq) {
-              streamlog_out(MESSAGE3)
-                  << "Pixel: " << xIt - hitVector->begin() + currentSensor->offX
-                  << "|" << yIt - xIt->begin() + currentSensor->offY
-                  << " fired " << fireFreq << std::endl;
-              EUTelGenericSparsePixel pixel;
-              pixel.setXCoord(xIt - hitVector->begin() + currentSensor->offX);
-              pixel.setYCoord(yIt - xIt->begin() + currentSensor->offY);
-              pixel.setSignal(fireFreq);
-              // writing out is done here
-              _noisyPixelMap[sensorID].push_back(pixel);
-            }
-          }
-        }
-      }
+      findNoisyPixels();
 
       // write out the databases and histograms
       noisyPixelDBWriter();
@@ -389,6 +364,52 @@ namespace eutelescope {
     }
   }
 
+  void EUTelProcessorNoisyPixelFinder::findNoisyPixels() {
+    // iterate over all the sensors in our sensorMap
+    for (auto &thisSensor : _sensorMap) {
+      auto sensorID = thisSensor.first;
+      streamlog_out(MESSAGE3) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~"
+                                 "~~~~~~~~~~~~~~~~~~~~~~~"
+                              << std::endl;
+      streamlog_out(MESSAGE3)
+          << "Noisy pixels found on plane " << sensorID
+          << " (max. fire freq set to: " << _maxAllowedFiringFreq << ")"
+          << std::endl;
+      streamlog_out(MESSAGE3) << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~"
+                                 "~~~~~~~~~~~~~~~~~~~~~~~"
+                              << std::endl;
+
+      // get the correpsonding hit array-like vector of vectors
+      std::vector<std::vector<long int>> *hitVector = &_hitVecMap[sensorID];
+      // and the sensor which stores offsets
+      sensor *currentSensor = &_sensorMap[sensorID];
+      auto& firingFreqVec = _firingFreqForAllPixels[sensorID];
+
+      // loop over all pixels
+      for (auto xIt = hitVector->begin(); xIt != hitVector->end(); ++xIt) {
+        for (auto yIt = xIt->begin(); yIt != xIt->end(); ++yIt) {
+          // compute the firing frequency
+          double fireFreq = static_cast<double>(*yIt) / static_cast<double>(_iEvt);
+          // if it is larger than the allowed one, we write this pixel into a
+          // collection
+          firingFreqVec.push_back(fireFreq);
+          if (fireFreq > _maxAllowedFiringFreq) {
+            streamlog_out(MESSAGE3)
+                << "Pixel: " << xIt - hitVector->begin() + currentSensor->offX
+                << "|" << yIt - xIt->begin() + currentSensor->offY
+                << " fired " << fireFreq << std::endl;
+            EUTelGenericSparsePixel pixel;
+            pixel.setXCoord(xIt - hitVector->begin() + currentSensor->offX);
+            pixel.setYCoord(yIt - xIt->begin() + currentSensor->offY);
+            pixel.setSignal(fireFreq);
+            // writing out is done here
+            _noisyPixelMap[sensorID].push_back(pixel);
+          }
+        }
+      }
+    }
+  }
+
   void EUTelProcessorNoisyPixelFinder::noisyPixelDBWriter() {
     streamlog_out(DEBUG5) << "Writing out hot pixel db into "
                           << _noisyPixelDBFile.c_str() << std::endl;
@@ -477,6 +498,61 @@ namespace eutelescope {
                               << " noisy pixels on sensor: " << mapEntry.first
                               << std::endl;
     }
+
+    // the number of events and the cut are needed to merge the databases of
+    // a run processed in chunks, the configured number of events tells if
+    // the merged database still equals a single job over the run
+    event->parameters().setValue("NoOfEvents", _iEvt);
+    event->parameters().setValue("ConfiguredNoOfEvents", _noOfEvents);
+    event->parameters().setValue("MaxAllowedFiringFreq", _maxAllowedFiringFreq);
+
+    // optionally also store the raw hit count of every pixel which fired at
+    // least once, the hot pixels of several chunks can then be re-determined
+    // exactly from the summed counts. The signal of the sparse pixels is a
+    // float, exact only up to 2^24, so the counts are stored as integers in
+    // the collection parameter HitCounts_<sensorID>, in the pixel order
+    if (!_hitCountCollectionName.empty()) {
+      LCCollectionVec *hitCountCollection =
+          new LCCollectionVec(lcio::LCIO::TRACKERDATA);
+      event->addCollection(hitCountCollection, _hitCountCollectionName);
+
+      for (auto &mapEntry : _hitVecMap) {
+        CellIDEncoder<TrackerDataImpl> hitCountEncoder(
+            EUTELESCOPE::ZSDATADEFAULTENCODING, hitCountCollection);
+        hitCountEncoder["sensorID"] = mapEntry.first;
+        hitCountEncoder["sparsePixelType"] = kEUTelGenericSparsePixel;
+
+        std::unique_ptr<lcio::TrackerDataImpl> currentFrame(
+            new lcio::TrackerDataImpl);
+        hitCountEncoder.setCellID(currentFrame.get());
+
+        std::unique_ptr<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>
+            sparseFrame(
+                new EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(
+                    currentFrame.get()));
+
+        sensor *currentSensor = &_sensorMap[mapEntry.first];
+        auto &hitVector = mapEntry.second;
+        lcio::IntVec hitCounts;
+        for (size_t iX = 0; iX < hitVector.size(); ++iX) {
+          for (size_t iY = 0; iY < hitVector[iX].size(); ++iY) {
+            if (hitVector[iX][iY] == 0) {
+              continue;
+            }
+            EUTelGenericSparsePixel pixel;
+            pixel.setXCoord(static_cast<int>(iX) + currentSensor->offX);
+            pixel.setYCoord(static_cast<int>(iY) + currentSensor->offY);
+            pixel.setSignal(static_cast<float>(hitVector[iX][iY]));
+            sparseFrame->push_back(pixel);
+            hitCounts.push_back(static_cast<int>(hitVector[iX][iY]));
+          }
+        }
+        hitCountCollection->push_back(currentFrame.release());
+        hitCountCollection->parameters().setValues(
+            "HitCounts_" + std::to_string(mapEntry.first), hitCounts);
+      }
+    }
+
     lcWriter->writeEvent(event.get());
     lcWriter->close();
   }
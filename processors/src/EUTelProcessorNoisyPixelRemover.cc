@@ -13,6 +13,7 @@
 // eutelescope includes ".h"
 #include "EUTelProcessorNoisyPixelRemover.h"
 #include "EUTELESCOPE.h"
+#include "EUTelEventSummary.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelUtility.h"
 
@@ -34,6 +35,7 @@
 
 // system includes
 #include <algorithm>
+#include <map>
 #include <memory>
 
 namespace eutelescope {
@@ -74,8 +76,8 @@ namespace eutelescope {
     if (_firstEvent) {
       // The noisy pixel collection stores all thot pixels in event #1
       // Thus we have to read it in in that case
-      _noisyPixelMap =
-          Utility::readNoisyPixelList(event, _noisyPixelCollectionName);
+      _noisyPixelMap = EUTelConditionsCache::getInstance().getNoisyPixels(
+          event, _noisyPixelCollectionName);
       _firstEvent = false;
     }
 
@@ -115,6 +117,9 @@ namespace eutelescope {
 
     auto trackerData = std::make_unique<lcio::TrackerDataImpl>();
 
+    // number of pixels kept per sensor
+    std::map<int, int> pixelCounts;
+
     for (size_t iEntry = 0; iEntry < inputCollection->size(); ++iEntry) {
 
       if (iEntry > 0) {
@@ -135,7 +140,11 @@ namespace eutelescope {
       trackerData->setTime(inputData->getTime());
 
       // get the noise vector for the given plane
-      std::vector<int> *noiseVector = &(_noisyPixelMap[sensorID]);
+      static const std::vector<int> noNoisyPixels;
+      auto noiseIter = _noisyPixelMap->find(sensorID);
+      const std::vector<int> *noiseVector =
+          (noiseIter != _noisyPixelMap->end()) ? &noiseIter->second
+                                               : &noNoisyPixels;
 
       // interface to sparsified data
       auto sparseDataInterface = Utility::getSparseData(inputData, pixelType);
@@ -150,9 +159,13 @@ namespace eutelescope {
           sparseOutputData->push_back(pixel);
         }
       }
+      pixelCounts[sensorID] += static_cast<int>(sparseOutputData->size());
     }
     outputCollection->push_back(trackerData.release());
 
+    // the cheap per sensor multiplicity for the event pre-filter
+    EventSummary::addCounts(event, _outputCollectionName, pixelCounts);
+
     // add the collection if we created it and added elements
     if (!outputCollectionExists) {
       if (outputCollection->size() != initialOutputCollectionSize) {
@@ -15,6 +15,7 @@
 
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
+#include "EUTelEventSummary.h"
 #include "EUTelExceptions.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelRunHeaderImpl.h"
@@ -54,6 +55,7 @@
 // system includes
 #include <cmath>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -273,6 +275,9 @@ void EUTelProcessorSparseClustering::sparseClustering(
   CellIDEncoder<TrackerPulseImpl> idZSPulseEncoder(
       EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
+  // number of clusters found per sensor
+  std::map<int, int> clusterCounts;
+
   // in the zsInputDataCollectionVec we should have one TrackerData for each
   // detector working in ZS mode. We need to loop over all of them
   for (size_t idetector = 0;
@@ -295,64 +300,22 @@ void EUTelProcessorSparseClustering::sparseClustering(
       continue;
     }
 
+    // a sensor without clusters is summarised with a zero count
+    clusterCounts.insert(std::make_pair(sensorID, 0));
+
     auto sparseData = Utility::getSparseData(zsData, type);
-    auto hitPixelVec = sparseData->getPixels();
-    std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> newlyAdded;
+    auto clusters = Utility::findSparseClusters(sparseData->getPixels(),
+                                                _sparseMinDistanceSquared);
 
-    // We now cluster those hits together
-    while (!hitPixelVec.empty()) {
+    // We now store the found clusters
+    for (auto const &pixels : clusters) {
       // prepare a TrackerData to store the cluster candidate
       std::unique_ptr<TrackerDataImpl> zsCluster =
           std::make_unique<TrackerDataImpl>();
       // prepare a reimplementation of sparsified cluster
       auto sparseCluster = Utility::getClusterData(zsCluster.get(), type);
-
-      // First we need to take any pixel, so let's take the first one
-      // Add it to the cluster as well as the newly added pixels
-      newlyAdded.push_back(hitPixelVec.front());
-      sparseCluster->push_back(hitPixelVec.front().get());
-      // And remove it from the original collection
-      hitPixelVec.erase(hitPixelVec.begin());
-
-      // Now process all newly added pixels, initially this is the just
-      // previously added one
-      // but in the process of neighbour finding we continue to add new pixels
-      while (!newlyAdded.empty()) {
-        bool newlyDone = true;
-        // check against all pixels in the hitPixelVec
-        for (auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end();
-             ++hitVec) {
-          // get the relevant infos from the newly added pixel
-          auto x1 = newlyAdded.front().get().getXCoord();
-          auto y1 = newlyAdded.front().get().getYCoord();
-
-          // and the pixel we test against
-          auto x2 = (hitVec->get()).getXCoord();
-          auto y2 = (hitVec->get()).getYCoord();
-
-          auto dX = x1 - x2;
-          auto dY = y1 - y2;
-          int distance = dX * dX + dY * dY;
-          // if they pass the spatial and temporal cuts, we add them
-          if (distance <= _sparseMinDistanceSquared) {
-            // add them to the cluster as well as to the newly added ones
-            newlyAdded.push_back(*hitVec);
-            sparseCluster->push_back(*hitVec);
-            // and remove it from the original collection
-            hitPixelVec.erase(hitVec);
-            // for the pixel we test there might be other neighbours, we still
-            // have to check
-            newlyDone = false;
-            break;
-          }
-        }
-
-        // if no neighbours are found, we can delete the pixel from the newly
-        // added
-        // we tested against _ALL_ non cluster pixels, there are no other pixels
-        // which could be neighbours
-        if (newlyDone)
-          newlyAdded.erase(newlyAdded.begin());
+      for (auto const &pixel : pixels) {
+        sparseCluster->push_back(pixel.get());
       }
 
       // Now we need to process the found cluster
@@ -379,6 +342,7 @@ void EUTelProcessorSparseClustering::sparseClustering(
 
         // last but not least increment the totClusterMap
         _totClusterMap[sensorID] += 1;
+        ++clusterCounts[sensorID];
       } // cluster processing if
       else {
         // in the case the cluster candidate is not passing the threshold ...
@@ -388,6 +352,9 @@ void EUTelProcessorSparseClustering::sparseClustering(
     } // loop over all found clusters
   }   // this is the end of the loop over all ZS detectors
 
+  // the cheap per sensor multiplicity for the event pre-filter
+  EventSummary::addCounts(evt, _pulseCollectionName, clusterCounts);
+
   // if the sparseClusterCollectionVec isn't empty add it to the
   // current event. The pulse collection will be added afterwards
   if (!isDummyAlreadyExisting) {
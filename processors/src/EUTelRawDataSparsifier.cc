@@ -13,6 +13,7 @@
 #include "EUTelRawDataSparsifier.h"
 #include "EUTELESCOPE.h"
 #include "EUTelBaseSparsePixel.h"
+#include "EUTelConditionsCache.h"
 #include "EUTelEventImpl.h"
 #include "EUTelExceptions.h"
 #include "EUTelGenericSparsePixel.h"
@@ -122,6 +123,15 @@ void EUTelRawDataSparsifier::processEvent(LCEvent *event) {
         evt->getCollection(_statusCollectionName));
     CellIDDecoder<TrackerRawDataImpl> cellDecoder(inputCollectionVec);
 
+    // the position of each sensor in the pedestal, noise and status
+    // collections
+    EUTelConditionsCache &conditions = EUTelConditionsCache::getInstance();
+    auto pedestalIndices =
+        conditions.getSensorIndices(evt, _pedestalCollectionName);
+    auto noiseIndices = conditions.getSensorIndices(evt, _noiseCollectionName);
+    auto statusIndices =
+        conditions.getSensorIndices(evt, _statusCollectionName);
+
     if (isFirstEvent()) {
 
       // this is the right place to cross check wheter the pedestal and
@@ -155,14 +165,17 @@ void EUTelRawDataSparsifier::processEvent(LCEvent *event) {
 
         TrackerRawDataImpl *rawData = dynamic_cast<TrackerRawDataImpl *>(
             inputCollectionVec->getElementAt(iDetector));
+        int sensorID = static_cast<int>(cellDecoder(rawData)["sensorID"]);
         TrackerDataImpl *pedestal = dynamic_cast<TrackerDataImpl *>(
-            pedestalCollectionVec->getElementAt(iDetector));
+            pedestalCollectionVec->getElementAt(
+                EUTelConditionsCache::getSensorIndex(
+                    *pedestalIndices, sensorID, _pedestalCollectionName)));
 
         if (rawData->getADCValues().size() !=
             pedestal->getChargeValues().size()) {
           stringstream ss;
           ss << "Input data and pedestal are incompatible" << endl
-             << "Detector " << iDetector << " has "
+             << "Detector " << sensorID << " has "
              << rawData->getADCValues().size() << " pixels in the input data "
              << endl
              << "while " << pedestal->getChargeValues().size()
@@ -186,23 +199,27 @@ void EUTelRawDataSparsifier::processEvent(LCEvent *event) {
 
     for (size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
 
-      // we are assuming that the input rawData, pedestal, noise and
-      // status collections are aligned according to the sensorID. In
-      // other words, we are assuming the element i-th in the all the
-      // collections corresponds to the same sensorID.
+      // the pedestal, noise and status of this sensor are looked up by
+      // sensorID, the collections do not have to follow the order of the
+      // input rawData
       TrackerRawDataImpl *rawData = dynamic_cast<TrackerRawDataImpl *>(
           inputCollectionVec->getElementAt(iDetector));
+      int sensorID = static_cast<int>(cellDecoder(rawData)["sensorID"]);
       TrackerDataImpl *pedestal = dynamic_cast<TrackerDataImpl *>(
-          pedestalCollectionVec->getElementAt(iDetector));
+          pedestalCollectionVec->getElementAt(
+              EUTelConditionsCache::getSensorIndex(
+                  *pedestalIndices, sensorID, _pedestalCollectionName)));
       TrackerDataImpl *noise = dynamic_cast<TrackerDataImpl *>(
-          noiseCollectionVec->getElementAt(iDetector));
+          noiseCollectionVec->getElementAt(EUTelConditionsCache::getSensorIndex(
+              *noiseIndices, sensorID, _noiseCollectionName)));
       TrackerRawDataImpl *status = dynamic_cast<TrackerRawDataImpl *>(
-          statusCollectionVec->getElementAt(iDetector));
+          statusCollectionVec->getElementAt(
+              EUTelConditionsCache::getSensorIndex(
+                  *statusIndices, sensorID, _statusCollectionName)));
 
       TrackerDataImpl *sparsified = new TrackerDataImpl;
       CellIDEncoder<TrackerDataImpl> sparseDataEncoder(
           EUTELESCOPE::ZSDATADEFAULTENCODING, sparsifiedDataCollection);
-      int sensorID = static_cast<int>(cellDecoder(rawData)["sensorID"]);
       sparseDataEncoder["sensorID"] = sensorID;
       sparseDataEncoder["sparsePixelType"] = _pixelType;
       sparseDataEncoder.setCellID(sparsified);
@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelUpdatePedestalNoiseProcessor.h"
 #include "EUTELESCOPE.h"
+#include "EUTelConditionsCache.h"
 #include "EUTelEventImpl.h"
 #include "EUTelExceptions.h"
 #include "EUTelRunHeaderImpl.h"
@@ -37,14 +38,62 @@
 #include <UTIL/CellIDDecoder.h>
 
 // system includes <>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <memory>
+#include <sstream>
 
 using namespace std;
 using namespace marlin;
 using namespace eutelescope;
 
+namespace {
+
+  //! Updates the pedestal and noise of the good pixels of a sensor
+  /*! <code>P' = ((W - 1) P + D) / W</code> and <code>N'^2 = ((W - 1)
+   *  N^2 + (D - P')^2) / W</code>. The new values of all pixels are
+   *  first computed in a branch free loop and then copied for the good
+   *  pixels only: the divisions cannot be made conditional without
+   *  preventing the vectorisation. The arrays must not overlap.
+   *
+   *  The loop is marked "omp simd": this file is compiled with
+   *  -fopenmp-simd, so that it is vectorised also at -O2, where GCC
+   *  does not vectorise otherwise.
+   */
+  void updateSensor(const short *__restrict__ rawValues,
+                    const short *__restrict__ status, size_t noOfPixels,
+                    int weight, float *__restrict__ pedestal,
+                    float *__restrict__ noise,
+                    float *__restrict__ newPedestal,
+                    double *__restrict__ newVariance) {
+#pragma omp simd
+    for (size_t i = 0; i < noOfPixels; ++i) {
+      newPedestal[i] = ((weight - 1) * pedestal[i] + rawValues[i]) / weight;
+      const double sigma = noise[i];
+      const double residual = rawValues[i] - newPedestal[i];
+      newVariance[i] =
+          ((weight - 1) * (sigma * sigma) + residual * residual) / weight;
+    }
+    for (size_t i = 0; i < noOfPixels; ++i) {
+      if (status[i] == EUTELESCOPE::GOODPIXEL) {
+        pedestal[i] = newPedestal[i];
+        noise[i] = static_cast<float>(sqrt(newVariance[i]));
+      }
+    }
+  }
+
+  //! Largest absolute difference between two arrays of the same size
+  float maxDifference(const vector<float> &a, const FloatVec &b) {
+    float difference = 0.f;
+    for (size_t i = 0; i < a.size(); ++i) {
+      difference = max(difference, fabs(a[i] - b[i]));
+    }
+    return difference;
+  }
+
+} // namespace
+
 const unsigned short
     EUTelUpdatePedestalNoiseProcessor::_maxNoOfConsecutiveMissing = 10;
 
@@ -53,7 +102,9 @@ EUTelUpdatePedestalNoiseProcessor::EUTelUpdatePedestalNoiseProcessor()
       _rawDataCollectionName(""), _pedestalCollectionName(""),
       _noiseCollectionName(""), _statusCollectionName(""), _updateAlgo(""),
       _monitoredPixel(), _monitoredPixelPedestal(), _monitoredPixelNoise(),
-      _updateFrequency(0), _fixedWeight(0), _iRun(0), _iEvt(0),
+      _updateFrequency(0), _fixedWeight(0), _pedestalTolerance(0.f),
+      _noOfUpdates(0), _sensorStates(), _pedestalChanges(0),
+      _newPedestal(), _newVariance(), _iRun(0), _iEvt(0),
       _noOfConsecutiveMissing(0) {
 
   // modify processor description
@@ -90,6 +141,12 @@ EUTelUpdatePedestalNoiseProcessor::EUTelUpdatePedestalNoiseProcessor()
       "The value of the fixed weight (only for fixed weight algorithm",
       _fixedWeight, 100);
 
+  registerOptionalParameter(
+      "PedestalTolerance",
+      "The change of pedestal or noise (in ADC) above which the updated "
+      "values are written back to the collections (0 for every update)",
+      _pedestalTolerance, 0.f);
+
   IntVec monitorPixelExample;
   monitorPixelExample.push_back(0);
   monitorPixelExample.push_back(10);
@@ -106,11 +163,16 @@ void EUTelUpdatePedestalNoiseProcessor::init() {
   // usually a good idea to
   printParameters();
 
-  if (_updateAlgo == EUTELESCOPE::FIXEDWEIGHT) {
-    if (_fixedWeight <= 0) {
-      throw InvalidParameterException(
-          "FixedWeightValue has to be a positive integer number");
-    }
+  if (_updateAlgo != EUTELESCOPE::FIXEDWEIGHT &&
+      _updateAlgo != EUTELESCOPE::RUNNINGAVERAGE) {
+    throw InvalidParameterException("Unknown UpdateAlgorithm " + _updateAlgo);
+  }
+  if (_fixedWeight <= 0) {
+    throw InvalidParameterException(
+        "FixedWeightValue has to be a positive integer number");
+  }
+  if (_pedestalTolerance < 0) {
+    throw InvalidParameterException("PedestalTolerance cannot be negative");
   }
 
   if (_updateFrequency <= 0) {
@@ -138,6 +200,10 @@ void EUTelUpdatePedestalNoiseProcessor::init() {
 
   // reset the missing collection counter
   _noOfConsecutiveMissing = 0;
+
+  _sensorStates.clear();
+  _pedestalChanges = 0;
+  _noOfUpdates = 0;
 }
 
 void EUTelUpdatePedestalNoiseProcessor::processRunHeader(LCRunHeader *rdr) {
@@ -145,6 +211,11 @@ void EUTelUpdatePedestalNoiseProcessor::processRunHeader(LCRunHeader *rdr) {
   runHeader->addProcessor(type());
   ++_iRun;
   _iEvt = 0;
+
+  // the working copies are taken again from the next event conditions
+  _sensorStates.clear();
+  _pedestalChanges = 0;
+  _noOfUpdates = 0;
 }
 
 void EUTelUpdatePedestalNoiseProcessor::processEvent(LCEvent *event) {
@@ -211,8 +282,7 @@ void EUTelUpdatePedestalNoiseProcessor::processEvent(LCEvent *event) {
 
   if (_iEvt % _updateFrequency == 0) {
 
-    if (_updateAlgo == EUTELESCOPE::FIXEDWEIGHT)
-      fixedWeightUpdate(evt);
+    fixedWeightUpdate(evt);
 
     streamlog_out(MESSAGE5) << "Updating pedestal and noise ... ok" << endl;
   }
@@ -275,36 +345,89 @@ void EUTelUpdatePedestalNoiseProcessor::fixedWeightUpdate(LCEvent *evt) {
         evt->getCollection(_rawDataCollectionName));
     CellIDDecoder<TrackerRawDataImpl> rawDataDecoder(rawDataCollection);
 
+    EUTelConditionsCache &conditions = EUTelConditionsCache::getInstance();
+    auto pedestalIndices =
+        conditions.getSensorIndices(evt, _pedestalCollectionName);
+    auto noiseIndices = conditions.getSensorIndices(evt, _noiseCollectionName);
+    auto statusIndices =
+        conditions.getSensorIndices(evt, _statusCollectionName);
+
     _noOfConsecutiveMissing = 0;
 
+    // new conditions: restart from their values
+    unsigned long pedestalChanges =
+        conditions.getChanges(_pedestalCollectionName);
+    if (pedestalChanges != _pedestalChanges) {
+      _sensorStates.clear();
+      _pedestalChanges = pedestalChanges;
+      _noOfUpdates = 0;
+    }
+
+    int weight = _fixedWeight;
+    if (_updateAlgo == EUTELESCOPE::RUNNINGAVERAGE) {
+      weight += _noOfUpdates;
+    }
+    ++_noOfUpdates;
+
     for (int i = 0; i < rawDataCollection->getNumberOfElements(); i++) {
 
       TrackerRawDataImpl *rawData = dynamic_cast<TrackerRawDataImpl *>(
           rawDataCollection->getElementAt(i));
       int iDetector = static_cast<int>(rawDataDecoder(rawData)["sensorID"]);
 
+      auto pedestalIndex = pedestalIndices->find(iDetector);
+      auto noiseIndex = noiseIndices->find(iDetector);
+      auto statusIndex = statusIndices->find(iDetector);
+      if (pedestalIndex == pedestalIndices->end() ||
+          noiseIndex == noiseIndices->end() ||
+          statusIndex == statusIndices->end()) {
+        stringstream ss;
+        ss << "No pedestal, noise or status for sensor " << iDetector;
+        throw IncompatibleDataSetException(ss.str());
+      }
+
       TrackerRawDataImpl *status = dynamic_cast<TrackerRawDataImpl *>(
-          statusCollection->getElementAt(iDetector));
+          statusCollection->getElementAt(statusIndex->second));
       TrackerDataImpl *noise = dynamic_cast<TrackerDataImpl *>(
-          noiseCollection->getElementAt(iDetector));
+          noiseCollection->getElementAt(noiseIndex->second));
       TrackerDataImpl *pedestal = dynamic_cast<TrackerDataImpl *>(
-          pedestalCollection->getElementAt(iDetector));
+          pedestalCollection->getElementAt(pedestalIndex->second));
+
+      const ShortVec &rawValues = rawData->getADCValues();
+      const ShortVec &statusValues = status->adcValues();
+      FloatVec &pedestalValues = pedestal->chargeValues();
+      FloatVec &noiseValues = noise->chargeValues();
+      const size_t noOfPixels = rawValues.size();
+      if (statusValues.size() != noOfPixels ||
+          pedestalValues.size() != noOfPixels ||
+          noiseValues.size() != noOfPixels) {
+        stringstream ss;
+        ss << "Sensor " << iDetector << " has " << noOfPixels
+           << " raw values, " << pedestalValues.size() << " pedestal, "
+           << noiseValues.size() << " noise and " << statusValues.size()
+           << " status values";
+        throw IncompatibleDataSetException(ss.str());
+      }
 
-      for (unsigned int iPixel = 0; iPixel < status->adcValues().size();
-           iPixel++) {
-
-        if (status->adcValues()[iPixel] == EUTELESCOPE::GOODPIXEL) {
-          pedestal->chargeValues()[iPixel] =
-              ((_fixedWeight - 1) * pedestal->chargeValues()[iPixel] +
-               rawData->getADCValues()[iPixel]) /
-              _fixedWeight;
-          noise->chargeValues()[iPixel] =
-              sqrt(((_fixedWeight - 1) * pow(noise->chargeValues()[iPixel], 2) +
-                    pow(rawData->getADCValues()[iPixel] -
-                            pedestal->chargeValues()[iPixel],
-                        2)) /
-                   _fixedWeight);
-        }
+      SensorState &state = _sensorStates[iDetector];
+      if (state.pedestal.empty()) {
+        state.pedestal.assign(pedestalValues.begin(), pedestalValues.end());
+        state.noise.assign(noiseValues.begin(), noiseValues.end());
+      }
+      _newPedestal.resize(noOfPixels);
+      _newVariance.resize(noOfPixels);
+
+      updateSensor(rawValues.data(), statusValues.data(), noOfPixels, weight,
+                   state.pedestal.data(), state.noise.data(),
+                   _newPedestal.data(), _newVariance.data());
+
+      if (max(maxDifference(state.pedestal, pedestalValues),
+              maxDifference(state.noise, noiseValues)) > _pedestalTolerance) {
+        copy(state.pedestal.begin(), state.pedestal.end(),
+             pedestalValues.begin());
+        copy(state.noise.begin(), state.noise.end(), noiseValues.begin());
+        streamlog_out(DEBUG5) << "Pedestal and noise of sensor " << iDetector
+                              << " written back" << endl;
       }
     }
   } catch (DataNotAvailableException &e) {
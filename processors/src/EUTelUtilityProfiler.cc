@@ -0,0 +1,140 @@
+#include "EUTelUtilityProfiler.h"
+
+// eutelescope includes
+#include "EUTelExceptions.h"
+#include "EUTelProfiler.h"
+
+// C++
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Aida
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+// AIDA
+#include <AIDA/AIDA.h>
+#include <marlin/AIDAProcessor.h>
+#endif
+
+using namespace lcio;
+using namespace marlin;
+using namespace eutelescope;
+
+EUTelUtilityProfiler aProfiler;
+
+std::string EUTelUtilityProfiler::_chainTraceFile = "";
+
+EUTelUtilityProfiler::EUTelUtilityProfiler()
+    : Processor("EUTelUtilityProfiler"), _label(""), _ringBufferSize(4096),
+      _traceFile(""), _fillLatencyHistogram(true), _position(0)
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+      ,
+      _latencyHisto(nullptr)
+#endif
+{
+
+  _description = "EUTelUtilityProfiler is a profiling checkpoint. It measures "
+                 "the time and memory used since the preceding checkpoint "
+                 "in the steering file.";
+
+  registerOptionalParameter("Label", "Name of the checkpoint in the summary, "
+                                     "by default the processor name",
+                            _label, std::string(""));
+
+  registerOptionalParameter("RingBufferSize",
+                            "Number of most recent events kept for the trace",
+                            _ringBufferSize, 4096);
+
+  registerOptionalParameter("TraceFile",
+                            "Chrome trace / Perfetto JSON file written at the "
+                            "end of the job, if any checkpoint sets it",
+                            _traceFile, std::string(""));
+
+  registerOptionalParameter("FillLatencyHistogram",
+                            "Fill a per event latency histogram",
+                            _fillLatencyHistogram, true);
+}
+
+void EUTelUtilityProfiler::init() {
+  // this method is called only once even when the rewind is active
+
+  printParameters();
+
+  if (_label.empty()) {
+    _label = name();
+  }
+  if (_ringBufferSize < 0) {
+    throw InvalidParameterException("RingBufferSize must not be negative");
+  }
+  if (!_traceFile.empty()) {
+    _chainTraceFile = _traceFile;
+  }
+
+  // processors are initialised in the order of the steering file, so this
+  // is also the position in the chain
+  _position = EUTelProfiler::getInstance().addCheckpoint(
+      _label, static_cast<std::size_t>(_ringBufferSize));
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+  if (_fillLatencyHistogram) {
+    // same binning as the latency histogram of the profiler, in ms
+    std::vector<double> edges;
+    for (int bin = 0; bin <= EUTelProfiler::NOOFBINS; ++bin) {
+      edges.push_back(EUTelProfiler::getBinEdge(bin) * 1e-3);
+    }
+    _latencyHisto = AIDAProcessor::histogramFactory(this)->createHistogram1D(
+        "Latency", "Time per event since the preceding checkpoint;t [ms]",
+        edges);
+  }
+#endif
+}
+
+void EUTelUtilityProfiler::processRunHeader(LCRunHeader * /* run */) {
+  /* Nothing to do here... */
+}
+
+void EUTelUtilityProfiler::processEvent(LCEvent *evt) {
+
+  EUTelProfiler::Interval interval;
+  if (EUTelProfiler::getInstance().pass(_position, EUTelProfiler::kEvent,
+                                        evt->getRunNumber(),
+                                        evt->getEventNumber(), interval)) {
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    if (_latencyHisto) {
+      _latencyHisto->fill(interval.wall * 1e-3);
+    }
+#endif
+  }
+}
+
+void EUTelUtilityProfiler::check(LCEvent * /* evt */) {
+  /* Nothing to do here... */
+}
+
+void EUTelUtilityProfiler::end() {
+
+  EUTelProfiler &profiler = EUTelProfiler::getInstance();
+  EUTelProfiler::Interval interval;
+  profiler.pass(_position, EUTelProfiler::kEnd, -1, -1, interval);
+
+  if (_position + 1 != profiler.getNoOfCheckpoints()) {
+    return;
+  }
+
+  std::stringstream summary;
+  profiler.printSummary(summary);
+  streamlog_out(MESSAGE4) << "Profiling summary (time and memory used since "
+                             "the preceding checkpoint)"
+                          << std::endl
+                          << summary.str();
+
+  if (!_chainTraceFile.empty()) {
+    try {
+      profiler.writeChromeTrace(_chainTraceFile);
+      streamlog_out(MESSAGE4) << "Profiling trace written to "
+                              << _chainTraceFile << std::endl;
+    } catch (InvalidParameterException &e) {
+      streamlog_out(ERROR5) << e.what() << std::endl;
+    }
+  }
+}
@@ -13,6 +13,10 @@
 #include "AlibavaRunHeaderImpl.h"
 #include "AlibavaEventImpl.h"
 
+// eutelescope includes
+#include "EUTelExceptions.h"
+#include "EUTelRawRecordReader.h"
+
 // marlin includes
 #include "marlin/Global.h"
 #include "marlin/Exceptions.h"
@@ -40,6 +44,8 @@
 using namespace std;
 using namespace marlin;
 using namespace alibava;
+using eutelescope::EUTelRawRecordReader;
+using eutelescope::IncompatibleDataSetException;
 
 AlibavaConverter::AlibavaConverter ( ) : DataSourceProcessor ( "AlibavaConverter" ),
 _fileName ( ALIBAVA::NOTSET ),
@@ -51,7 +57,8 @@ _rawChipHeaderCollectionName ( "chipheader" ),
 _chipSelection ( ),
 _startEventNum ( -1 ),
 _stopEventNum ( -1 ),
-_storeHeaderPedestalNoise ( false )
+_storeHeaderPedestalNoise ( false ),
+_byteRange ( )
 {
     // initialize few variables
     _description = "Reads data streams produced by an ALiBaVa and produces the corresponding LCIO output";
@@ -75,6 +82,8 @@ _storeHeaderPedestalNoise ( false )
 
     registerOptionalParameter ( "StoreHeaderPedestalNoise", "Alibava stores a pedestal and a noise set in the run header. These values are not used in the rest of the analysis, so it is optional to store them. By default they will not be stored, but it you want you can set this variable to true to store them in the header of the slcio file", _storeHeaderPedestalNoise, false );
 
+    registerOptionalParameter ( "ByteRange", "Only convert events whose record starts inside the byte range [first, last) of the input file. Give the first and (optionally) one past the last byte, e.g. \"0 1073741824\". Events keep the event number they have in the full file, so that the outputs of several ranges can be concatenated. If not set, the whole file is converted", _byteRange, EVENT::StringVec ( ) );
+
 }
 
 AlibavaConverter * AlibavaConverter::newProcessor ( )
@@ -116,17 +125,22 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
     _runNumber = atoi ( _formattedRunNumber.c_str ( ) );
 
     //  Open File
-    ifstream infile;
-    infile.open ( _fileName.c_str ( ) );
-    if ( !infile.is_open ( ) )
+    int64_t firstByte = 0;
+    int64_t lastByte = -1;
+    EUTelRawRecordReader::parseByteRange ( _byteRange, firstByte, lastByte );
+
+    EUTelRawRecordReader infile;
+    try
     {
-	streamlog_out ( ERROR5 ) << "AlibavaConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input" << endl;
-	exit ( -1 );
+	infile.open ( _fileName, firstByte, lastByte );
     }
-    else
+    catch ( lcio::Exception & e )
     {
-	streamlog_out ( MESSAGE4 ) << "Input file " << _fileName << " is opened!" << endl;
+	streamlog_out ( ERROR5 ) << "AlibavaConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input" << endl;
+	streamlog_out ( ERROR5 ) << e.what ( ) << endl;
+	exit ( -1 );
     }
+    streamlog_out ( MESSAGE4 ) << "Input file " << _fileName << " is opened!" << endl;
 
     time_t date;
     int type;
@@ -135,16 +149,15 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
     int version; // Alibava firmware version
 
     // Read Header
-    infile.read ( reinterpret_cast < char * > ( &date ), sizeof ( time_t ) );
-    infile.read ( reinterpret_cast < char * > ( &type ), sizeof ( int ) );
+    infile.read ( date );
+    infile.read ( type );
 
-    header.clear ( );
-    infile.read ( reinterpret_cast < char * > ( &lheader ), sizeof ( unsigned int ) ); //length of header
-    for ( unsigned int ic = 0; ic < lheader; ic++ )
+    infile.read ( lheader ); //length of header
+    header.assign ( lheader, '\0' );
+    if ( !infile.read ( &header[0], lheader ) )
     {
-	char tmp_c;
-	infile.read ( &tmp_c, sizeof ( char ) );
-	header.append ( 1, tmp_c );
+	streamlog_out ( ERROR5 ) << "AlibavaConverter could not read the header of " << _fileName << endl;
+	return;
     }
 
     header = trim_str ( header );
@@ -161,22 +174,11 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 
     // Read header pedestal and noise
     // Alibava stores a pedestal and noise set in the run header. These values are not used in te rest of the analysis, so it is optional to store it. By default it will not be stored, but it you want you can set _storeHeaderPedestalNoise variable to true.
-    float tmp_float;
-    FloatVec headerPedestal;
-    FloatVec headerNoise;
-
-    // first pedestal
-    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS; ichan++ )
-    {
-	infile.read ( reinterpret_cast < char * > ( &tmp_float ), sizeof ( double ) );
-	headerPedestal.push_back ( tmp_float );
-    }
-    // now noise
-    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS; ichan++ )
-    {
-	infile.read ( reinterpret_cast < char * > ( &tmp_float ), sizeof ( double ) );
-	headerNoise.push_back ( tmp_float );
-    }
+    // both are stored as doubles, first pedestal then noise
+    double headerPedNoi[2][ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS];
+    infile.read ( headerPedNoi, sizeof ( headerPedNoi ) );
+    FloatVec headerPedestal ( headerPedNoi[0], headerPedNoi[0] + ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS );
+    FloatVec headerNoise ( headerPedNoi[1], headerPedNoi[1] + ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS );
 
     // Process Header
     LCRunHeaderImpl * arunHeader = new LCRunHeaderImpl ( );
@@ -216,6 +218,33 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 	return;
     }
 
+    // when only a byte range is converted, jump to the first record inside it.
+    // Alibava writes fixed length records, so the event number follows from the offset.
+    // This only holds for records of the length decoded here: the first record of the
+    // file has to be followed directly by the next one, and every record in the range
+    // has to start at its expected offset with the same event size (checked below)
+    const int64_t dataStart = infile.tell ( );
+    unsigned int rangeEventSize = 0;
+    if ( !_byteRange.empty ( ) )
+    {
+	unsigned int firstHeaderCode = 0, nextHeaderCode = 0;
+	bool fixedLength = infile.read ( firstHeaderCode ) && ( ( firstHeaderCode >> 16 ) & 0xFFFF ) == 0xcafe && infile.read ( rangeEventSize ) && infile.skip ( recordLength ( version ) - 2 * sizeof ( unsigned int ) );
+	if ( fixedLength && infile.read ( nextHeaderCode ) )
+	{
+	    fixedLength = ( ( nextHeaderCode >> 16 ) & 0xFFFF ) == 0xcafe;
+	}
+	if ( !fixedLength )
+	{
+	    stringstream ss;
+	    ss << "AlibavaConverter: the first record of " << _fileName << " is not " << recordLength ( version ) << " bytes long as expected for data version " << version << ", cannot convert a byte range of it";
+	    throw IncompatibleDataSetException ( ss.str ( ) );
+	}
+	const int64_t firstRecord = infile.firstRecordInRange ( dataStart, recordLength ( version ) );
+	eventCounter = int ( ( firstRecord - dataStart ) / recordLength ( version ) );
+	infile.seek ( firstRecord );
+	streamlog_out ( MESSAGE4 ) << "Converting bytes " << infile.getRangeBegin ( ) << " to " << infile.getRangeEnd ( ) << ", starting with event " << eventCounter << endl;
+    }
+
     do
     {
 	if ( eventCounter % 1000 == 0 )
@@ -223,11 +252,17 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 	    streamlog_out ( MESSAGE4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
 	}
 
+	// records starting beyond the range belong to the next job
+	if ( infile.tell ( ) >= infile.getRangeEnd ( ) )
+	{
+	    break;
+	}
+
+	const int64_t recordStart = infile.tell ( );
 	unsigned int headerCode, eventSize, userEventTypeCode = 0, eventTypeCode = 0;
 	do
 	{
-	    infile.read ( reinterpret_cast < char * > ( &headerCode ), sizeof ( unsigned int ) );
-	    if ( infile.bad ( ) || infile.eof ( ) )
+	    if ( !infile.read ( headerCode ) )
 	    {
 		return;
 	    }
@@ -244,10 +279,18 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 	    return;
 	}
 
-	infile.read ( reinterpret_cast < char * > ( &eventSize ), sizeof ( unsigned int ) );
+	infile.read ( eventSize );
+
+	// the event number of a byte range is only right if no record had another length
+	if ( !_byteRange.empty ( ) && ( infile.tell ( ) != recordStart + int64_t ( 2 * sizeof ( unsigned int ) ) || eventSize != rangeEventSize ) )
+	{
+	    stringstream ss;
+	    ss << "AlibavaConverter: record of event " << eventCounter << " at byte " << recordStart << " of " << _fileName << " does not have the fixed length of " << recordLength ( version ) << " bytes (event size " << eventSize << " instead of " << rangeEventSize << "), cannot convert a byte range of it";
+	    throw IncompatibleDataSetException ( ss.str ( ) );
+	}
 
 	double value, charge, delay;
-	infile.read ( reinterpret_cast < char * > ( &value ), sizeof ( double ) );
+	infile.read ( value );
 
 	//see AlibavaGUI.cc
 	charge = int ( value ) & 0xff;
@@ -263,14 +306,18 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 	// firmware v3 introduces the clock to the header
 	if ( version == 3 )
 	{
-	    infile.read ( reinterpret_cast < char * > ( &clock ), sizeof ( unsigned int ) );
+	    infile.read ( clock );
 	}
 
-	infile.read ( reinterpret_cast < char * > ( &tdcTime ), sizeof ( unsigned int ) );
-	infile.read ( reinterpret_cast < char * > ( &temp ), sizeof ( unsigned short ) );
+	infile.read ( tdcTime );
+	infile.read ( temp );
 
-	unsigned short chipHeader[2][ALIBAVA::CHIPHEADERLENGTH];
-	short tmp_short;
+	// per chip: the chip header followed by the channel data, all read at once
+	short chipPayload[ALIBAVA::NOOFCHIPS][ALIBAVA::CHIPHEADERLENGTH + ALIBAVA::NOOFCHANNELS];
+	if ( !infile.read ( chipPayload, sizeof ( chipPayload ) ) )
+	{
+	    break;
+	}
 
 	// vector for data
 	FloatVec all_data;
@@ -284,22 +331,20 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 	FloatVec::iterator it;
 	for ( int ichip = 0; ichip < ALIBAVA::NOOFCHIPS; ichip++ )
 	{
-	    infile.read ( reinterpret_cast < char * > ( chipHeader[ichip] ), ALIBAVA::CHIPHEADERLENGTH * sizeof ( unsigned short ) );
-
 	    // store chip header in all_chipheaders vector
 	    streamlog_out ( DEBUG0 ) << "Chip " << ichip << " Header: " ;
 	    for ( int j = 0; j < ALIBAVA::CHIPHEADERLENGTH; j++ )
 	    {
-		streamlog_out ( DEBUG0 ) << " " << chipHeader[ichip][j];
-		all_chipheaders.push_back ( float ( chipHeader[ichip][j] ) );
+		unsigned short chipHeader = static_cast < unsigned short > ( chipPayload[ichip][j] );
+		streamlog_out ( DEBUG0 ) << " " << chipHeader;
+		all_chipheaders.push_back ( float ( chipHeader ) );
 	    }
 	    streamlog_out ( DEBUG0 ) << endl;
 
 	    // store data in all_data vector
 	    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
 	    {
-		infile.read ( reinterpret_cast < char * > ( &tmp_short ), sizeof ( unsigned short ) );
-		all_data.push_back ( float ( tmp_short ) );
+		all_data.push_back ( float ( chipPayload[ichip][ALIBAVA::CHIPHEADERLENGTH + ichan] ) );
 	    }
 	}
 
@@ -380,7 +425,7 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
 	delete anEvent;
 
     }
-    while ( !( infile.bad ( ) || infile.eof ( ) ) );
+    while ( !infile.eof ( ) );
 
     infile.close ( );
 
@@ -419,6 +464,18 @@ double AlibavaConverter::get_temperature ( unsigned short temp )
     }
 }
 
+int AlibavaConverter::recordLength ( int version )
+{
+    // header code, event size, value, (clock), tdc time, temperature and the chip payloads
+    int length = 2 * sizeof ( unsigned int ) + sizeof ( double ) + sizeof ( unsigned int ) + sizeof ( unsigned short );
+    if ( version == 3 )
+    {
+	length += sizeof ( unsigned int );
+    }
+    length += ALIBAVA::NOOFCHIPS * ( ALIBAVA::CHIPHEADERLENGTH + ALIBAVA::NOOFCHANNELS ) * sizeof ( short );
+    return length;
+}
+
 void AlibavaConverter::checkIfChipSelectionIsValid ( )
 {
     bool resetChipSelection = false;
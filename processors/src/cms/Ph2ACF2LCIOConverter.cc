@@ -24,6 +24,7 @@
 // eutelescope includes
 #include "EUTelEventImpl.h"
 #include "EUTelRunHeaderImpl.h"
+#include "EUTelRawRecordReader.h"
 
 // system includes
 #include <iostream>
@@ -42,13 +43,16 @@ using namespace std;
 using namespace marlin;
 using namespace eutelescope;
 
-Ph2ACF2LCIOConverter::Ph2ACF2LCIOConverter ( ) : DataSourceProcessor ( "Ph2ACF2LCIOConverter" )
+Ph2ACF2LCIOConverter::Ph2ACF2LCIOConverter ( ) : DataSourceProcessor ( "Ph2ACF2LCIOConverter" ),
+_byteRange ( )
 
 {
     _description = "Reads Ph2ACF data streams and converts to LCIO";
 
     registerProcessorParameter ( "DataFormat", "The Ph2ACF data type, options are 'raw' and 'slink'", _dataformat, string ( "raw" ) );
 
+    registerOptionalParameter ( "ByteRange", "Only convert records starting inside the byte range [first, last) of the input file, given as the first and (optionally) one past the last byte. Records keep their event number from the full file, so the outputs of several ranges can be concatenated. If not set, the whole file is converted", _byteRange, EVENT::StringVec ( ) );
+
     registerProcessorParameter ( "InputFileName", "This is the input file name", _fileName, string ( "runXXXXXX.dat" ) );
 
     registerProcessorParameter ( "MaxRecordNumber", "The maximum number of events to read", _maxRecordNumber, -1 );
@@ -93,42 +97,111 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
     _runNumber = atoi ( _formattedRunNumber.c_str ( ) );
 
     // open file
-    ifstream infile;
-    infile.open ( _fileName.c_str ( ) );
-    if ( !infile.is_open ( ) )
+    int64_t firstByte = 0;
+    int64_t lastByte = -1;
+    EUTelRawRecordReader::parseByteRange ( _byteRange, firstByte, lastByte );
+
+    EUTelRawRecordReader infile;
+    try
+    {
+	infile.open ( _fileName, firstByte, lastByte );
+    }
+    catch ( lcio::Exception & e )
     {
 	streamlog_out ( ERROR5 ) << "Ph2ACF2LCIOConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input!" << endl;
+	streamlog_out ( ERROR5 ) << e.what ( ) << endl;
 	exit ( -1 );
     }
+    streamlog_out ( DEBUG4 ) << "Input file " << _fileName << " successfully opened!" << endl;
+    if ( _dataformat == "raw" )
+    {
+	streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in RAW file format!" << endl;
+    }
+    else if ( _dataformat == "slink" )
+    {
+	streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in SLINK file format!" << endl;
+    }
     else
     {
-	streamlog_out ( DEBUG4 ) << "Input file " << _fileName << " successfully opened!" << endl;
-	if ( _dataformat == "raw" )
+	streamlog_out ( ERROR5 ) << "Unknown file format set! Valid inputs are 'raw' and 'slink'!" << endl;
+	exit ( -1 );
+    }
+
+    LCRunHeaderImpl * runHeader = new LCRunHeaderImpl ( );
+    runHeader -> setRunNumber ( _runNumber );
+    runHeader -> setDetectorName ( "CBC" );
+    ProcessorMgr::instance ( ) -> processRunHeader ( runHeader ) ;
+    delete runHeader;
+
+    // the raw file format starts with a file header
+    if ( _dataformat == "raw" )
+    {
+	uint32_t cMask = 0xAAAAAAAA;
+	std::vector < uint32_t > headervec;
+	streamlog_out ( DEBUG0 ) << "File Header: ";
+	for ( int i = 0; i < 12; i++ )
 	{
-	    streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in RAW file format!" << endl;
+	    uint32_t tempint = 0;
+	    infile.read ( tempint );
+	    headervec.push_back ( tempint );
+	    streamlog_out ( DEBUG0 ) << tempint << " ";
 	}
-	else if ( _dataformat == "slink" )
+	streamlog_out ( DEBUG0 ) << endl;
+	if ( headervec.at ( 0 ) == cMask && headervec.at ( 3 ) == cMask && headervec.at ( 6 ) == cMask && headervec.at ( 9 ) == cMask && headervec.at ( 11 ) == cMask )
 	{
-	    streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in SLINK file format!" << endl;
+	    char cType[8] = { 0 };
+	    cType[0] = ( headervec.at ( 1 ) && 0xFF000000 ) >> 24;
+	    cType[1] = ( headervec.at ( 1 ) && 0x00FF0000 ) >> 16;
+	    cType[2] = ( headervec.at ( 1 ) && 0x0000FF00 ) >> 8;
+	    cType[3] = ( headervec.at ( 1 ) && 0x000000FF );
+
+	    cType[4] = ( headervec.at ( 2 ) && 0xFF000000 ) >> 24;
+	    cType[5] = ( headervec.at ( 2 ) && 0x00FF0000 ) >> 16;
+	    cType[6] = ( headervec.at ( 2 ) && 0x0000FF00 ) >> 8;
+	    cType[7] = ( headervec.at ( 2 ) && 0x000000FF );
+
+	    std::string cTypeString ( cType );
+	    std::string fType = cTypeString;
+
+	    uint32_t fVersionMajor = headervec.at ( 4 );
+	    uint32_t fVersionMinor = headervec.at ( 5 );
+
+	    uint32_t fBeId = headervec.at ( 7 ) & 0x000003FF;
+	    uint32_t fNCbc = headervec.at ( 8 );
+
+	    uint32_t fEventSize32 = headervec.at ( 10 );
+	    streamlog_out ( DEBUG4 ) << "Board Type: " << fType << endl;
+	    streamlog_out ( DEBUG4 ) << "FWMajor: " << fVersionMajor << endl;
+	    streamlog_out ( DEBUG4 ) << "FWMinor: " << fVersionMinor << endl;
+	    streamlog_out ( DEBUG4 ) << "BeId: " << fBeId << endl;
+	    streamlog_out ( DEBUG4 ) << "NCbc: " << fNCbc << endl;
+	    streamlog_out ( DEBUG4 ) << "EventSize32: " << fEventSize32 << endl;
+	    streamlog_out ( DEBUG4 ) << "Valid header!" << endl;
 	}
 	else
 	{
-	    streamlog_out ( ERROR5 ) << "Unknown file format set! Valid inputs are 'raw' and 'slink'!" << endl;
+	    streamlog_out ( ERROR5 ) << "Error, this is not a valid header!" << endl;
 	    exit ( -1 );
 	}
     }
 
-    LCRunHeaderImpl * runHeader = new LCRunHeaderImpl ( );
-    runHeader -> setRunNumber ( _runNumber );
-    runHeader -> setDetectorName ( "CBC" );
-    ProcessorMgr::instance ( ) -> processRunHeader ( runHeader ) ;
-    delete runHeader;
+    // every record has a fixed number of 32 bit words: the event header, and per FE the
+    // second header plus 9 trigger and 2 stub data words for each chip
+    const int recordWords = ( _dataformat == "raw" ) ? 5 + _nFE * ( 1 + _nChips * 11 ) : 19;
+    const int64_t recordLength = recordWords * int64_t ( sizeof ( uint32_t ) );
+    std::vector < uint32_t > record ( recordWords );
 
-    // the header in raw file format
-    bool raw_headeropen = false;
-    bool maxreached = false;
+    // when only a byte range is converted, jump to the first record inside it
+    if ( !_byteRange.empty ( ) )
+    {
+	const int64_t dataStart = infile.tell ( );
+	const int64_t firstRecord = infile.firstRecordInRange ( dataStart, recordLength );
+	eventCounter = int ( ( firstRecord - dataStart ) / recordLength );
+	infile.seek ( firstRecord );
+	streamlog_out ( DEBUG4 ) << "Converting bytes " << infile.getRangeBegin ( ) << " to " << infile.getRangeEnd ( ) << ", starting with event " << eventCounter << endl;
+    }
 
-    do
+    while ( true )
     {
 
 	// header / event parameters
@@ -169,10 +242,17 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 
 	if ( eventCounter > _maxRecordNumber && _maxRecordNumber > 0 )
 	{
-	    maxreached = true;
 	    break ;
 	}
 
+	// records starting beyond the range belong to the next job, and a truncated
+	// record at the end of the file is not converted
+	if ( infile.tell ( ) >= infile.getRangeEnd ( ) || !infile.read ( record.data ( ), recordLength ) )
+	{
+	    break;
+	}
+	const uint32_t * word = record.data ( );
+
 	if ( eventCounter % 1000 == 0 || eventCounter < 10 )
 	{
 	    streamlog_out ( DEBUG4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
@@ -181,60 +261,6 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 	if ( _dataformat == "raw" )
 	{
 
-	    // the first event has a header
-	    if ( raw_headeropen == false )
-	    {
-		uint32_t cMask = 0xAAAAAAAA;
-		std::vector < uint32_t > headervec;
-		raw_headeropen = true;
-		streamlog_out ( DEBUG0 ) << "File Header: ";
-		for ( int i = 0; i < 12; i++ )
-		{
-		    uint32_t tempint;
-		    infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		    headervec.push_back ( tempint );
-		    streamlog_out ( DEBUG0 ) << tempint << " ";
-		}
-		streamlog_out ( DEBUG0 ) << endl;
-		if ( headervec.at ( 0 ) == cMask && headervec.at ( 3 ) == cMask && headervec.at ( 6 ) == cMask && headervec.at ( 9 ) == cMask && headervec.at ( 11 ) == cMask )
-		{
-		    char cType[8] = { 0 };
-		    cType[0] = ( headervec.at ( 1 ) && 0xFF000000 ) >> 24;
-		    cType[1] = ( headervec.at ( 1 ) && 0x00FF0000 ) >> 16;
-		    cType[2] = ( headervec.at ( 1 ) && 0x0000FF00 ) >> 8;
-		    cType[3] = ( headervec.at ( 1 ) && 0x000000FF );
-
-		    cType[4] = ( headervec.at ( 2 ) && 0xFF000000 ) >> 24;
-		    cType[5] = ( headervec.at ( 2 ) && 0x00FF0000 ) >> 16;
-		    cType[6] = ( headervec.at ( 2 ) && 0x0000FF00 ) >> 8;
-		    cType[7] = ( headervec.at ( 2 ) && 0x000000FF );
-
-		    std::string cTypeString ( cType );
-		    std::string fType = cTypeString;
-
-		    uint32_t fVersionMajor = headervec.at ( 4 );
-		    uint32_t fVersionMinor = headervec.at ( 5 );
-
-		    uint32_t fBeId = headervec.at ( 7 ) & 0x000003FF;
-		    uint32_t fNCbc = headervec.at ( 8 );
-
-		    uint32_t fEventSize32 = headervec.at ( 10 );
-		    streamlog_out ( DEBUG4 ) << "Board Type: " << fType << endl;
-		    streamlog_out ( DEBUG4 ) << "FWMajor: " << fVersionMajor << endl;
-		    streamlog_out ( DEBUG4 ) << "FWMinor: " << fVersionMinor << endl;
-		    streamlog_out ( DEBUG4 ) << "BeId: " << fBeId << endl;
-		    streamlog_out ( DEBUG4 ) << "NCbc: " << fNCbc << endl;
-		    streamlog_out ( DEBUG4 ) << "EventSize32: " << fEventSize32 << endl;
-		    streamlog_out ( DEBUG4 ) << "Valid header!" << endl;
-		}
-		else
-		{
-		    streamlog_out ( ERROR5 ) << "Error, this is not a valid header!" << endl;
-		    exit ( -1 );
-		}
-
-	    }
-
 	    // the output vectors
 	    FloatVec dataoutputvec_top;
 	    FloatVec dataoutputvec_bot;
@@ -246,7 +272,7 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 	    std::vector < uint32_t > vec_header1;
 	    for ( int i = 0; i < 5; i++ )
 	    {
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
+		tempint = *word++;
 		vec_header1.push_back ( tempint );
 	    }
 
@@ -318,8 +344,7 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 	    {
 		// read header 2
 		std::vector < uint32_t > vec_header2;
-		uint32_t tempint;
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
+		uint32_t tempint = *word++;
 		vec_header2.push_back ( tempint );
 		streamlog_out ( DEBUG2 ) << endl;
 		streamlog_out ( DEBUG2 ) << "CBC Header2, FE " << iFE << ":" << endl;
@@ -362,8 +387,7 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 		    // 9 for trg data, 2 for stub
 		    for ( int i = 0; i < 11; i++ )
 		    {
-			uint32_t tempint;
-			infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
+			uint32_t tempint = *word++;
 
 			if ( i < 4 )
 			{
@@ -559,9 +583,8 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 	    // FIXME
 	    for ( int i = 0; i < 19; i++ )
 	    {
-		uint32_t tempint;
+		uint32_t tempint = *word++;
 		std::vector < uint32_t > inputvec;
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
 		inputvec.push_back ( tempint );
 		streamlog_out ( DEBUG0 ) << tempint << " ";
 	    }
@@ -601,7 +624,7 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
 
 	} // done _dataformat if
 
-    } while ( !( infile.bad ( ) || infile.eof ( ) ) || maxreached == true );
+    }
 
     infile.close ( );
 
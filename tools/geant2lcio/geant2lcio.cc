@@ -1,22 +1,36 @@
 // This test program reads GEANT simuation output from text file
 // and write it out in LCIO format
 //
-// Compile with: 
-//  g++ -o geant2lcio geant2lcio.cc -lgsl -lgslcblas -lm -llcio -lsio -lz
+// Compile with:
+//  g++ -std=c++11 -pthread -o geant2lcio geant2lcio.cc -llcio -lsio -lz
 //
-// after setting proper include path (for LCIO) and lib paths (for LCIO and GSL)
+// after setting proper include path and lib path for LCIO
 //
 // A.F.Zarnecki   March 2007
 // updated January 2008 for use with new simulation results
 // (backside hits only in the ascii input file)
+//
+// The conversion runs as a pipeline: one thread parses the Geant records
+// and groups them into events, worker threads do the digitisation
+// (beam spot, smearing, efficiency, noise) and one thread writes the
+// events in their original order. Random numbers are taken from a
+// counter-based generator keyed by the seed and the event number, so the
+// output only depends on the seed and not on the number of threads.
 
 // system includes
 
-#include <iostream>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
 #include <string>
-#include <stdlib.h>
-#include <math.h>
+#include <thread>
+#include <vector>
 
 // lcio includes
 
@@ -27,475 +41,700 @@
 #include "IMPL/SimTrackerHitImpl.h"
 #include "IMPL/LCCollectionVec.h"
 
-// gsl includes
-
-#include <gsl/gsl_rng.h>
-#include <gsl/gsl_randist.h>
-
 using namespace std;
 using namespace lcio;
 
-int main(int argc, char ** argv) {
-
-  // Input parameters are input and putput file names
-
-  if(argc<3){
-    cerr << "Parameters missing: [input file] [output file] {geometry file}"  << endl;
-    return -1;
-  }
-
-  // input, output and geometry file names
-
-  string inputFileName  = argv[1]; 
-  string outputFileName = argv[2];
-  string geometryFileName = (argc>3)?argv[3]:"geant2lcio.geom";
-
-  cerr << "Converting " << inputFileName.c_str()
-       << " to "        <<  outputFileName.c_str() <<  endl;
-
-  cerr << "Using geometry description from " << geometryFileName.c_str() <<  endl;
-
-  // Initialize input stream; exeption handling taken from AB
-
-  ifstream inputFile;
-  inputFile.exceptions(ifstream::failbit | ifstream::badbit);
-  
-  // open the input file
-  try {
-    inputFile.open(inputFileName.c_str(),ios::in);
-  }
-  catch (exception& e) {
-    cerr << "IO exception " << e.what() << " with " 
-	 << inputFileName << ".\nExiting." << endl;
-    return -1;
-  }
-  
-  // Open geometry description file
-
-  ifstream geometryFile;
-  geometryFile.open(geometryFileName.c_str(),ios::in);
-
-
-  // Now prepare the output slcio file.
-  
-  LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
-
-  // open the file
-  try {
-    lcWriter->open(outputFileName.c_str(),LCIO::WRITE_NEW);
-  }
-  catch (IOException& e) {
-    cerr << e.what() << endl;
-    return -1;
-  }
-
-/* create GSL generator chosen by the 
-   environment variable GSL_RNG_TYPE */
+namespace {
 
-  const gsl_rng_type * T;
-  gsl_rng * r;
+  // Philox4x32-10 counter-based random number generator (Salmon et al.,
+  // "Parallel random numbers: as easy as 1, 2, 3", SC11). Every block of
+  // four numbers is a function of the key and the counter only, which
+  // allows to give each event its own independent stream.
 
-  gsl_rng_env_setup();
-  T = gsl_rng_default;
-  r = gsl_rng_alloc (T);
+  class CounterRng {
 
- // Prepare a run header
-
-  int runNumber       = 1;
-  int eventNumber     = 0;
-  string detectorName = "Eutelescope";
-  string detectorDescription = "EUDET telescope, WN-WW configuration";
-
-  LCRunHeaderImpl * runHeader = new LCRunHeaderImpl();
-  runHeader->setRunNumber(runNumber);
-  runHeader->setDetectorName(detectorName);
-  runHeader->setDescription(detectorDescription);
-
-  // Read detector data from geometry description file
-
-  int Ndet,beamaxis,ix,iy,iz;
-  double pileup,noise,beamspot;
+  public:
+    typedef uint32_t result_type;
 
-  geometryFile >> Ndet >> pileup >> noise >> beamaxis >> beamspot ;
+    // Stream of the given event, the stream number separates the
+    // different uses within the same event
 
-// set axis directions for decoding input file
-// beamaxis = 1..3
-
-  iz=beamaxis-1;
-  ix=(iz+1)%3;
-  iy=(iz+2)%3;
-
-  cerr << "Telescope setup with " << Ndet << " layers" <<  endl;
+    CounterRng(uint64_t seed, uint64_t event, uint32_t stream)
+        : _next(4) {
+      _key[0] = static_cast<uint32_t>(seed);
+      _key[1] = static_cast<uint32_t>(seed >> 32);
+      _counter[0] = 0;
+      _counter[1] = stream;
+      _counter[2] = static_cast<uint32_t>(event);
+      _counter[3] = static_cast<uint32_t>(event >> 32);
+    }
 
-  double * zdet = new double[Ndet];
-  double * xmin = new double[Ndet];
-  double * xmax = new double[Ndet];
-  double * ymin = new double[Ndet];
-  double * ymax = new double[Ndet];
-  double * resol = new double[Ndet];
-  double * effi = new double[Ndet];
-
-  for(int idet=0; idet < Ndet; idet++)
-     {
-      string detName;
-      geometryFile >> zdet[idet] >> xmin[idet] >> xmax[idet] 
-                   >> ymin[idet] >> ymax[idet] >> resol[idet] >> effi[idet];
-      
-      // change resolution units to mm
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFF; }
 
-      resol[idet]/=1000.;
-
-      std::getline(geometryFile,detName,'\n');
-
-     // Add plane names to run header
-
-      runHeader->addActiveSubdetector(detName);
+    result_type operator()() {
+      if (_next == 4) {
+        generateBlock();
+        ++_counter[0];
+        _next = 0;
       }
+      return _block[_next++];
+    }
+
+  private:
+    void generateBlock() {
+      uint32_t c[4] = {_counter[0], _counter[1], _counter[2], _counter[3]};
+      uint32_t k[2] = {_key[0], _key[1]};
+      for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+          k[0] += 0x9E3779B9;
+          k[1] += 0xBB67AE85;
+        }
+        uint64_t p0 = static_cast<uint64_t>(0xD2511F53) * c[0];
+        uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57) * c[2];
+        uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+        uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+        c[0] = hi1 ^ c[1] ^ k[0];
+        c[1] = static_cast<uint32_t>(p1);
+        c[2] = hi0 ^ c[3] ^ k[1];
+        c[3] = static_cast<uint32_t>(p0);
+      }
+      for (int i = 0; i < 4; ++i)
+        _block[i] = c[i];
+    }
+
+    uint32_t _key[2];
+    uint32_t _counter[4];
+    uint32_t _block[4];
+    int _next;
+  };
+
+  // Random streams used per event
+
+  const uint32_t PILEUPSTREAM = 0;   // number of pileup tracks, parser
+  const uint32_t DIGISTREAM = 1;     // digitisation, workers
+
+  // Detector description read from the geometry file
+
+  struct Geometry {
+    int Ndet;
+    double pileup, noise, beamspot;
+    int ix, iy, iz;
+    vector<double> zdet, xmin, xmax, ymin, ymax, resol, effi;
+  };
+
+  // One Geant track: generated position on each plane in mm,
+  // before the beam spot offset
+
+  struct GeantTrack {
+    vector<double> x, y, z;
+  };
+
+  // Geant tracks merged into one event
+
+  struct RawEvent {
+    int eventNumber;
+    vector<GeantTrack> tracks;
+  };
+
+  // Queue with a maximum size between the parser and the workers
+
+  template <class T> class BoundedQueue {
+
+  public:
+    explicit BoundedQueue(size_t capacity)
+        : _capacity(capacity), _closed(false) {}
+
+    // blocks while the queue is full
+
+    void push(T item) {
+      unique_lock<mutex> lock(_mutex);
+      _notFull.wait(lock, [this] { return _items.size() < _capacity || _closed; });
+      if (_closed)
+        return;
+      _items.push_back(std::move(item));
+      _notEmpty.notify_one();
+    }
+
+    // returns false once the queue is closed and empty
+
+    bool pop(T &item) {
+      unique_lock<mutex> lock(_mutex);
+      _notEmpty.wait(lock, [this] { return !_items.empty() || _closed; });
+      if (_items.empty())
+        return false;
+      item = std::move(_items.front());
+      _items.pop_front();
+      _notFull.notify_one();
+      return true;
+    }
+
+    void close() {
+      lock_guard<mutex> lock(_mutex);
+      _closed = true;
+      _notEmpty.notify_all();
+      _notFull.notify_all();
+    }
+
+  private:
+    size_t _capacity;
+    bool _closed;
+    deque<T> _items;
+    mutex _mutex;
+    condition_variable _notEmpty;
+    condition_variable _notFull;
+  };
+
+  // Digitised events waiting to be written in order. The number of
+  // events in flight (parsed but not yet written) is limited, which
+  // bounds the memory also if one worker falls behind.
+
+  class OrderedOutput {
+
+  public:
+    explicit OrderedOutput(size_t maxInFlight)
+        : _maxInFlight(maxInFlight), _inFlight(0), _nextEvent(1),
+          _lastEvent(-1), _aborted(false) {}
+
+    // called by the parser before an event is queued,
+    // returns false if the writing was aborted
+
+    bool reserve() {
+      unique_lock<mutex> lock(_mutex);
+      _slotFree.wait(lock, [this] { return _inFlight < _maxInFlight || _aborted; });
+      ++_inFlight;
+      return !_aborted;
+    }
+
+    // called by the parser with the number of the last event
+
+    void setLastEvent(int eventNumber) {
+      lock_guard<mutex> lock(_mutex);
+      _lastEvent = eventNumber;
+      _ready.notify_all();
+    }
+
+    void put(int eventNumber, LCEventImpl *event) {
+      lock_guard<mutex> lock(_mutex);
+      _done[eventNumber] = event;
+      if (eventNumber == _nextEvent)
+        _ready.notify_all();
+    }
+
+    // waits for the next events and returns all of them which are
+    // consecutive, empty once everything is written
+
+    vector<LCEventImpl *> takeBatch() {
+      vector<LCEventImpl *> batch;
+      unique_lock<mutex> lock(_mutex);
+      _ready.wait(lock, [this] {
+        return _aborted || _done.count(_nextEvent) ||
+               (_lastEvent >= 0 && _nextEvent > _lastEvent);
+      });
+      if (_aborted)
+        return batch;
+      map<int, LCEventImpl *>::iterator it = _done.begin();
+      while (it != _done.end() && it->first == _nextEvent) {
+        batch.push_back(it->second);
+        it = _done.erase(it);
+        ++_nextEvent;
+      }
+      return batch;
+    }
+
+    // called by the writer after the batch is written
+
+    void release(size_t noOfEvents) {
+      lock_guard<mutex> lock(_mutex);
+      _inFlight -= noOfEvents;
+      _slotFree.notify_all();
+    }
+
+    void abort() {
+      lock_guard<mutex> lock(_mutex);
+      _aborted = true;
+      _slotFree.notify_all();
+      _ready.notify_all();
+    }
+
+    // deletes the events which were never written
+
+    ~OrderedOutput() {
+      for (map<int, LCEventImpl *>::iterator it = _done.begin();
+           it != _done.end(); ++it)
+        delete it->second;
+    }
+
+  private:
+    size_t _maxInFlight;
+    size_t _inFlight;
+    int _nextEvent;
+    int _lastEvent;
+    bool _aborted;
+    map<int, LCEventImpl *> _done;
+    mutex _mutex;
+    condition_variable _slotFree;
+    condition_variable _ready;
+  };
+
+  // Parsing thread: reads the Geant records and merges 1 + Poisson(pileup)
+  // of them into each event
+
+  void parseInput(ifstream &inputFile, const Geometry &geo, uint64_t seed,
+                  BoundedQueue<RawEvent> &queue, OrderedOutput &output) {
+
+    //  int Nsub = 2*Ndet+2;  // front and back side for each sensor plane
+
+    const int Nsides = 1;                // back side only
+    const int Nsub = Nsides * geo.Ndet + 2;
+    double rawpos[3];
+
+    int eventNumber = 0;
+    bool endOfInput = false;
+
+    while (!endOfInput) {
+
+      RawEvent raw;
+      raw.eventNumber = eventNumber + 1;
+
+      // Number of tracks to include
+
+      CounterRng rng(seed, raw.eventNumber, PILEUPSTREAM);
+      unsigned int npile = 1;
+      if (geo.pileup > 0.)
+        npile += poisson_distribution<unsigned int>(geo.pileup)(rng);
+
+      for (unsigned int ipile = 0; ipile < npile; ipile++) {
+
+        GeantTrack track;
+        track.x.assign(geo.Ndet, 0.);
+        track.y.assign(geo.Ndet, 0.);
+        track.z.assign(geo.Ndet, 0.);
+
+        int nread = 0;
+        try {
+          for (int isub = 0; isub < Nsub; isub++) {
+            // Geant4 input: beam along Z axis
+            inputFile >> rawpos[2] >> rawpos[0] >> rawpos[1];
+
+            // Input file is in um -> convert to mm
+
+            int idet = (isub - 1) / Nsides;
+
+            if (isub > 0 && idet < geo.Ndet) {
+              track.x[idet] += rawpos[0] / 1000. / Nsides;
+              track.y[idet] += rawpos[1] / 1000. / Nsides;
+              track.z[idet] += rawpos[2] / 1000. / Nsides;
+            }
+            ++nread;
+          }
+        } catch (exception &e) {
+
+          if (!inputFile.eof())
+            cerr << " a read exception occured : " << e.what() << endl;
+
+          if (nread != 0 && nread != Nsub) {
+            cerr << " less than " << Nsub
+                 << " points read - event is incomplete ! " << endl;
+          }
+          endOfInput = true;
+          break;
+        }
 
-  // Check subdetector list
-
-  const std::vector<std::string> * subDets = 
-                               runHeader->getActiveSubdetectors();
-
-  Ndet = subDets->size();
-
-  cerr << Ndet << " subdetectors defined :" << endl;
-  for(int idet=0;idet<Ndet;idet++)
-    cerr << idet+1 << " : " << subDets->at(idet) << endl;
-
-  // write the header to the output file
-
-  lcWriter->writeRunHeader(runHeader);
-
-  // delete the run header since not used anymore
-
-  delete runHeader;
-
-
-// Input form Geant
-
-//  int Nsub = 2*Ndet+2;  // front and back side for each sensor plane
-  
-  int Nsides = 1;            // back side only
-  int Nsub = Nsides*Ndet+2;   
-  double rawpos[3];
-
-// Beamspot offset
+        raw.tracks.push_back(track);
 
-  double offset[3]; 
+        // Just in case of EOF
 
-// MC point tables:
+        if (inputFile.eof()) {
+          endOfInput = true;
+          break;
+        }
+      }
 
-  double * xgen = new double[Ndet];
-  double * ygen = new double[Ndet];
-  double * zgen = new double[Ndet];
+      // an event with none of its tracks read is not written
 
-// Measured points tables:
+      if (raw.tracks.empty())
+        break;
 
-  double * xmes = new double[Ndet];
-  double * ymes = new double[Ndet];
-  double * zmes = new double[Ndet];
-  bool  * fired = new bool[Ndet];
+      if (!output.reserve())
+        break;
+      ++eventNumber;
+      queue.push(std::move(raw));
+    }
 
-// Event loop
+    output.setLastEvent(eventNumber);
+    queue.close();
+  }
 
-  while ( true ) {
-    
+  // Covariance matrix of the position
+  // (stored as lower triangle matrix, i.e.  cov(xx),cov(y,x),cov(y,y) ).
 
+  void setCovariance(TrackerHitImpl *meshit, const Geometry &geo, int idet) {
+    float cov[TRKHITNCOVMATRIX];
 
-    // Prepare event header and collections 
+    cov[geo.ix + geo.ix * geo.ix] = geo.resol[idet] * geo.resol[idet];
+    cov[geo.iy + geo.iy * geo.iy] = geo.resol[idet] * geo.resol[idet];
+    cov[geo.iz + geo.iz * geo.iz] = 0.;
 
-     eventNumber++;
+    cov[1] = cov[3] = cov[4] = 0.;
 
-        if (eventNumber%1000 == 0) 
-              cout << "Converting event number " << eventNumber << endl;
+    meshit->setCovMatrix(cov);
+  }
 
-     LCEventImpl * event = new LCEventImpl();
+  // Digitisation of one event: beam spot, smearing, efficiency and noise
 
-        event->setDetectorName(detectorName);
+  LCEventImpl *digitise(const RawEvent &raw, const Geometry &geo,
+                        uint64_t seed, int runNumber,
+                        const string &detectorName) {
 
-        event->setRunNumber(runNumber);
+    CounterRng rng(seed, raw.eventNumber, DIGISTREAM);
+    normal_distribution<double> gauss(0., 1.);
+    uniform_real_distribution<double> uniform(0., 1.);
 
-        event->setEventNumber(eventNumber);
+    // Prepare event header and collections
 
+    LCEventImpl *event = new LCEventImpl();
+    event->setDetectorName(detectorName);
+    event->setRunNumber(runNumber);
+    event->setEventNumber(raw.eventNumber);
 
-    // prepare a collection to store generated points 
+    // prepare a collection to store generated points
 
-    LCCollectionVec     * simhitvec = new LCCollectionVec(LCIO::SIMTRACKERHIT);
+    LCCollectionVec *simhitvec = new LCCollectionVec(LCIO::SIMTRACKERHIT);
 
     // prepare a collection to store measured points
 
-    LCCollectionVec     * meshitvec = new LCCollectionVec(LCIO::TRACKERHIT);
+    LCCollectionVec *meshitvec = new LCCollectionVec(LCIO::TRACKERHIT);
 
+    for (size_t ipile = 0; ipile < raw.tracks.size(); ipile++) {
+      const GeantTrack &track = raw.tracks[ipile];
 
-   // Loop over geant events to simulate pileup
+      // Beam spot
 
-   // Number of tracks to include
+      double offset[2];
+      offset[0] = geo.beamspot * gauss(rng);
+      offset[1] = geo.beamspot * gauss(rng);
 
-    unsigned int npile=1;
+      for (int idet = 0; idet < geo.Ndet; idet++) {
 
-    npile += gsl_ran_poisson(r,pileup);
+        double xgen = track.x[idet] + offset[0];
+        double ygen = track.y[idet] + offset[1];
+        double zgen = track.z[idet];
 
-    for(int ipile=0; ipile<npile;ipile++)
-      {
-      int nread=0;
+        // Fill and store single MC points
+        // Cell ID is just the plane number  ID=1...Ndet
 
-// Beam spot
+        SimTrackerHitImpl *simhit = new SimTrackerHitImpl;
+        simhit->setCellID(idet + 1);
 
-   offset[0]=gsl_ran_gaussian(r,beamspot);
-   offset[1]=gsl_ran_gaussian(r,beamspot);
-   offset[2]=0.;
+        // Get position, change axis according to the beam direction
 
-// Read one Geant event from file
+        double pos[3];
+        pos[geo.ix] = xgen;
+        pos[geo.iy] = ygen;
+        pos[geo.iz] = zgen;
+        simhit->setPosition(pos);
+        simhitvec->push_back(simhit);
 
-    for(int idet=0;idet<Ndet;idet++)
-             {
-             xgen[idet]=offset[0];
-             ygen[idet]=offset[1];
-             zgen[idet]=offset[2];
-             }
+        // Apply Gaussian smearing
 
-    try{ 
-      
-      for(int isub=0 ; isub <  Nsub ; isub++ )
-        {
-// Geant4 input: beam along Z axis
-	  inputFile >> rawpos[2] >> rawpos[0] >> rawpos[1] ;
+        double xmes = xgen + geo.resol[idet] * gauss(rng);
+        double ymes = ygen + geo.resol[idet] * gauss(rng);
 
-// Input file is in um -> convert to mm
+        // check detector range and detector efficiency
 
-          int idet=(isub-1)/Nsides;
+        bool fired = true;
+        if (xmes < geo.xmin[idet] || xmes > geo.xmax[idet])
+          fired = false;
+        if (ymes < geo.ymin[idet] || ymes > geo.ymax[idet])
+          fired = false;
+        if (uniform(rng) > geo.effi[idet])
+          fired = false;
 
-          if(isub>0 && idet<Ndet)
-             {
-             xgen[idet]+=rawpos[0]/1000./Nsides;
-             ygen[idet]+=rawpos[1]/1000./Nsides;
-             zgen[idet]+=rawpos[2]/1000./Nsides;
-             }
+        // take only valid hits:
 
-	  ++nread ;
-	}
+        if (fired) {
 
-    }      
-    catch(exception& e){
+          // Store plane number  as hit type:
 
-      if( !inputFile.eof() ) 
-	cerr << " a read exception occured : " << e.what() << endl  ;
+          TrackerHitImpl *meshit = new TrackerHitImpl;
+          meshit->setType(idet + 1);
 
-      if( nread != 0 && nread != Nsub ){
-	cerr << " less than " << Nsub << " points read - event is incomplete ! " 
-	     << endl ;
+          pos[geo.ix] = xmes;
+          pos[geo.iy] = ymes;
+          pos[geo.iz] = zgen;
+          meshit->setPosition(pos);
+          setCovariance(meshit, geo, idet);
+          meshitvec->push_back(meshit);
+        }
       }
-      break ;
-    }    
-
-// calculate measured points
-
-    for(int idet=0;idet<Ndet;idet++)
-        {
-
-       // Apply Gaussian smearing
+    }
 
-        xmes[idet]=xgen[idet]+gsl_ran_gaussian(r,resol[idet]);
-        ymes[idet]=ygen[idet]+gsl_ran_gaussian(r,resol[idet]);
-        zmes[idet]=zgen[idet];
+    // Add noise:
 
+    if (geo.noise > 0.) {
+      poisson_distribution<unsigned int> poisson(geo.noise);
+      for (int idet = 0; idet < geo.Ndet; idet++) {
 
-        fired[idet]=true;
+        unsigned int nnoise = poisson(rng);
 
-        // check detector range
+        for (unsigned int inoise = 0; inoise < nnoise; inoise++) {
 
-        if(xmes[idet]<xmin[idet] || xmes[idet]>xmax[idet])fired[idet]=false;
-        if(ymes[idet]<ymin[idet] || ymes[idet]>ymax[idet])fired[idet]=false;
+          TrackerHitImpl *meshit = new TrackerHitImpl;
+          meshit->setType(idet + 1);
 
-        // Detector efficiency
-
-        if(gsl_rng_uniform(r)>effi[idet])fired[idet]=false;
+          // noise position : uniform close to true hit
 
+          double pos[3];
+          pos[geo.ix] =
+              uniform(rng) * (geo.xmax[idet] - geo.xmin[idet]) + geo.xmin[idet];
+          pos[geo.iy] =
+              uniform(rng) * (geo.ymax[idet] - geo.ymin[idet]) + geo.ymin[idet];
+          pos[geo.iz] = geo.zdet[idet];
+          meshit->setPosition(pos);
+          setCovariance(meshit, geo, idet);
+          meshitvec->push_back(meshit);
         }
+      }
+    }
 
+    // add hit collections to an event
 
-// Add generated points to collection
-
-    for(int idet=0;idet<Ndet;idet++)
-        {
-
-    // Fill and store single MC points 
-    // Each point has to remain in memory until event is written out !
-
-        SimTrackerHitImpl * simhit = new SimTrackerHitImpl;
-
-    // Cell ID is just the plane number  ID=1...Ndet
-        
-        simhit->setCellID(idet+1);
-
-    // Get position, change axis according to the beam direction 
-
-        double pos[3];
-
-        pos[ix]=xgen[idet];
-        pos[iy]=ygen[idet];
-        pos[iz]=zgen[idet];
+    event->addCollection(simhitvec, "simhit");
+    event->addCollection(meshitvec, "meshit");
 
-        simhit->setPosition(pos);
+    return event;
+  }
 
-     // store this hit
+  // Worker thread: digitises the events from the queue
 
-       simhitvec->push_back(simhit);
+  void digitiseEvents(BoundedQueue<RawEvent> &queue, OrderedOutput &output,
+                      const Geometry &geo, uint64_t seed, int runNumber,
+                      const string &detectorName) {
+    RawEvent raw;
+    while (queue.pop(raw)) {
+      output.put(raw.eventNumber,
+                 digitise(raw, geo, seed, runNumber, detectorName));
+    }
+  }
 
+  // Writer thread: writes the digitised events in order, in batches of
+  // all consecutive events which are ready
+
+  void writeEvents(LCWriter *lcWriter, OrderedOutput &output, bool &failed) {
+    int noOfEvents = 0;
+    while (true) {
+      vector<LCEventImpl *> batch = output.takeBatch();
+      if (batch.empty())
+        break;
+
+      try {
+        for (size_t i = 0; i < batch.size(); i++) {
+          lcWriter->writeEvent(batch[i]);
+          if (++noOfEvents % 1000 == 0)
+            cout << "Converting event number " << noOfEvents << endl;
         }
+      } catch (IOException &e) {
+        cerr << e.what() << endl;
+        failed = true;
+      }
 
-// Add measured points to collection
-
-    for(int idet=0;idet<Ndet;idet++)
-        {
-
-       // take only valid hits:
-
-        if(fired[idet])
-            {
-       // Fill and store measured points 
-       // Each point has to remain in memory until event is written out !
-
-            TrackerHitImpl * meshit = new TrackerHitImpl;
-
-            if(meshit == nullptr) 
-                  cerr << "TrackerHitImpl allocation failed" << endl;
-
-       // Store plane number  as hit type:
-
-             meshit->setType(idet+1);
-
-      // store measured position
-
-             double pos[3];
-
-             pos[ix]=xmes[idet];
-             pos[iy]=ymes[idet];
-             pos[iz]=zmes[idet];
-
-             meshit->setPosition(pos);
-
-      // Covariance matrix of the position 
-      // (stored as lower triangle matrix, i.e.  cov(xx),cov(y,x),cov(y,y) ).
-
-            float cov[TRKHITNCOVMATRIX];
-
-            cov[ix+ix*ix]=resol[idet]*resol[idet];
-            cov[iy+iy*iy]=resol[idet]*resol[idet];
-            cov[iz+iz*iz]=0.;
-
-            cov[1]=cov[3]=cov[4]=0.;
+      // deleting an event also delets everything what was put into this event...
 
-            meshit->setCovMatrix(cov);
+      for (size_t i = 0; i < batch.size(); i++)
+        delete batch[i];
+      output.release(batch.size());
 
+      if (failed) {
+        output.abort();
+        break;
+      }
+    }
+  }
 
-      // store measured hit 
+  void printUsage() {
+    cerr << "Usage: geant2lcio [-j threads] [-s seed] [input file] [output file] {geometry file}"
+         << endl;
+  }
+}
 
-             meshitvec->push_back(meshit);
+int main(int argc, char ** argv) {
 
-             }       // if(fired[idet])
-       }    // idet loop
+  // Options: number of worker threads and seed of the random numbers
+
+  unsigned int noOfThreads = thread::hardware_concurrency();
+  if (noOfThreads == 0)
+    noOfThreads = 1;
+  uint64_t seed = 0;
+
+  vector<string> args;
+  for (int iarg = 1; iarg < argc; iarg++) {
+    string arg = argv[iarg];
+    if ((arg == "-j" || arg == "-s") && iarg + 1 < argc) {
+      long long value = atoll(argv[++iarg]);
+      if (arg == "-j") {
+        if (value < 1) {
+          cerr << "The number of threads must be at least 1" << endl;
+          return -1;
+        }
+        noOfThreads = static_cast<unsigned int>(value);
+      } else {
+        seed = static_cast<uint64_t>(value);
+      }
+    } else {
+      args.push_back(arg);
+    }
+  }
 
+  // Input parameters are input and putput file names
 
-// Just in case of EOF
+  if (args.size() < 2) {
+    cerr << "Parameters missing: [input file] [output file] {geometry file}"  << endl;
+    printUsage();
+    return -1;
+  }
 
-  if (inputFile.eof()) break;
+  // input, output and geometry file names
 
-      }    // pileup event loop
+  string inputFileName  = args[0];
+  string outputFileName = args[1];
+  string geometryFileName = (args.size() > 2) ? args[2] : "geant2lcio.geom";
 
+  cerr << "Converting " << inputFileName.c_str()
+       << " to "        <<  outputFileName.c_str() <<  endl;
 
-// Add noise:
+  cerr << "Using geometry description from " << geometryFileName.c_str() <<  endl;
 
-    for(int idet=0;idet<Ndet;idet++)
-        {
+  cerr << "Digitising with " << noOfThreads << " threads, seed " << seed << endl;
 
-        unsigned int nnoise=gsl_ran_poisson(r,noise);
+  // Initialize input stream; exeption handling taken from AB
 
-        for(int inoise=0;inoise<nnoise;inoise++)
-            {
-       // Fill and store noise points 
+  ifstream inputFile;
+  inputFile.exceptions(ifstream::failbit | ifstream::badbit);
 
-             TrackerHitImpl * meshit = new TrackerHitImpl;
+  // open the input file
+  try {
+    inputFile.open(inputFileName.c_str(),ios::in);
+  }
+  catch (exception& e) {
+    cerr << "IO exception " << e.what() << " with "
+	 << inputFileName << ".\nExiting." << endl;
+    return -1;
+  }
 
-       // Store plane number  as hit type:
+  // Open geometry description file
 
-             meshit->setType(idet+1);
+  ifstream geometryFile;
+  geometryFile.open(geometryFileName.c_str(),ios::in);
 
-      // noise position : uniform close to true hit
 
-             double pos[3];
+  // Now prepare the output slcio file.
 
-             pos[ix]=gsl_rng_uniform(r)*(xmax[idet]-xmin[idet])+xmin[idet];
-             pos[iy]=gsl_rng_uniform(r)*(ymax[idet]-ymin[idet])+ymin[idet];
-             pos[iz]=zdet[idet];
+  LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
 
-             meshit->setPosition(pos);
+  // open the file
+  try {
+    lcWriter->open(outputFileName.c_str(),LCIO::WRITE_NEW);
+  }
+  catch (IOException& e) {
+    cerr << e.what() << endl;
+    return -1;
+  }
 
-      // Covariance matrix of the position 
-      // (stored as lower triangle matrix, i.e.  cov(xx),cov(y,x),cov(y,y) ).
+ // Prepare a run header
 
-            float cov[TRKHITNCOVMATRIX];
+  int runNumber       = 1;
+  string detectorName = "Eutelescope";
+  string detectorDescription = "EUDET telescope, WN-WW configuration";
 
-            cov[ix+ix*ix]=resol[idet]*resol[idet];
-            cov[iy+iy*iy]=resol[idet]*resol[idet];
-            cov[iz+iz*iz]=0.;
+  LCRunHeaderImpl * runHeader = new LCRunHeaderImpl();
+  runHeader->setRunNumber(runNumber);
+  runHeader->setDetectorName(detectorName);
+  runHeader->setDescription(detectorDescription);
 
-            cov[1]=cov[3]=cov[4]=0.;
+  // Read detector data from geometry description file
 
-            meshit->setCovMatrix(cov);
+  Geometry geo;
+  int beamaxis;
 
+  geometryFile >> geo.Ndet >> geo.pileup >> geo.noise >> beamaxis >> geo.beamspot;
 
-      // store measured hit 
+// set axis directions for decoding input file
+// beamaxis = 1..3
 
-             meshitvec->push_back(meshit);
+  geo.iz = beamaxis - 1;
+  geo.ix = (geo.iz + 1) % 3;
+  geo.iy = (geo.iz + 2) % 3;
 
-             }       // noise loop
+  cerr << "Telescope setup with " << geo.Ndet << " layers" <<  endl;
 
-        }    // idet loop
+  for (int idet = 0; idet < geo.Ndet; idet++) {
+      string detName;
+      double zdet, xmin, xmax, ymin, ymax, resol, effi;
+      geometryFile >> zdet >> xmin >> xmax >> ymin >> ymax >> resol >> effi;
 
+      geo.zdet.push_back(zdet);
+      geo.xmin.push_back(xmin);
+      geo.xmax.push_back(xmax);
+      geo.ymin.push_back(ymin);
+      geo.ymax.push_back(ymax);
 
+      // change resolution units to mm
 
+      geo.resol.push_back(resol / 1000.);
+      geo.effi.push_back(effi);
 
-    //  if(npile>2)cerr << "Pileup of " << npile << " MC particles in event " << eventNumber << endl;
+      std::getline(geometryFile,detName,'\n');
 
+     // Add plane names to run header
 
-// add hit collections to an event
+      runHeader->addActiveSubdetector(detName);
+  }
 
-    event->addCollection(simhitvec,"simhit");
+  // Check subdetector list
 
+  const std::vector<std::string> * subDets =
+                               runHeader->getActiveSubdetectors();
 
-// add measured hit collection to an event
+  geo.Ndet = subDets->size();
 
-    event->addCollection(meshitvec,"meshit");
+  cerr << geo.Ndet << " subdetectors defined :" << endl;
+  for(int idet=0;idet<geo.Ndet;idet++)
+    cerr << idet+1 << " : " << subDets->at(idet) << endl;
 
+  // write the header to the output file
 
-    // write event out
+  lcWriter->writeRunHeader(runHeader);
 
-    lcWriter->writeEvent(event);
-    
-    // clean
-    // deleting an event also delets everything what was put into this event...
+  // delete the run header since not used anymore
 
-    delete event;
+  delete runHeader;
 
-   // if the file is at the end ... break the loop!
+  // Run the pipeline: parser -> workers -> ordered writer
 
-  if (inputFile.eof()) break;
+  BoundedQueue<RawEvent> queue(4 * noOfThreads);
+  OrderedOutput output(16 * noOfThreads);
+  bool failed = false;
 
-// End of event loop
-}
+  thread writer(writeEvents, lcWriter, ref(output), ref(failed));
+  vector<thread> workers;
+  for (unsigned int ithread = 0; ithread < noOfThreads; ithread++)
+    workers.push_back(thread(digitiseEvents, ref(queue), ref(output),
+                             cref(geo), seed, runNumber, cref(detectorName)));
+  thread parser(parseInput, ref(inputFile), cref(geo), seed, ref(queue),
+                ref(output));
 
+  parser.join();
+  for (size_t ithread = 0; ithread < workers.size(); ithread++)
+    workers[ithread].join();
+  writer.join();
 
 // That is all! Close all streams...
 
-  gsl_rng_free (r);
-  
   lcWriter->close();
+  delete lcWriter;
   inputFile.close();
   geometryFile.close();
 
- 
-  return 0;
+  return failed ? -1 : 0;
 }
-